@@ -27,12 +27,15 @@ import java.io.InputStream;
 import java.io.ObjectInputStream;
 import java.io.ObjectOutputStream;
 import java.io.PrintWriter;
+import java.io.RandomAccessFile;
 import java.io.Serializable;
 import java.lang.reflect.InvocationTargetException;
 import java.math.BigDecimal;
 import java.math.BigInteger;
 import java.math.RoundingMode;
 import java.nio.channels.FileChannel.MapMode;
+import java.nio.file.Files;
+import java.nio.file.StandardCopyOption;
 import java.text.DecimalFormat;
 import java.text.NumberFormat;
 import java.util.Arrays;
@@ -45,6 +48,7 @@ import java.util.concurrent.ExecutorCompletionService;
 import java.util.concurrent.ExecutorService;
 import java.util.concurrent.Executors;
 import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicIntegerArray;
 
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
@@ -64,10 +68,13 @@ import it.unimi.dsi.Util;
 import it.unimi.dsi.bits.Fast;
 import it.unimi.dsi.fastutil.ints.IntArrayList;
 import it.unimi.dsi.fastutil.ints.IntArrays;
+import it.unimi.dsi.fastutil.ints.IntIterator;
+import it.unimi.dsi.fastutil.ints.IntIterators;
 import it.unimi.dsi.fastutil.io.BinIO;
 import it.unimi.dsi.fastutil.io.FastMultiByteArrayInputStream;
 import it.unimi.dsi.fastutil.longs.LongBigList;
 import it.unimi.dsi.fastutil.longs.LongIterator;
+import it.unimi.dsi.fastutil.longs.LongIterators;
 import it.unimi.dsi.io.ByteBufferInputStream;
 import it.unimi.dsi.io.InputBitStream;
 import it.unimi.dsi.io.NullOutputStream;
@@ -90,12 +97,30 @@ import it.unimi.dsi.sux4j.util.EliasFanoMonotoneLongBigList;
  * <code>.graph</code>), an <em>offset file</em> (with extension
  * <code>.offsets</code>) and a <em>property file</em> (with extension
  * <code>.properties</code>). The latter, not surprisingly, is a Java property file.
+ * Compression also creates an <em>Elias&ndash;Fano offset file</em> (with extension
+ * <code>.ef</code>) that is used when {@linkplain #loadMapped(CharSequence) memory-mapping a graph}.
  * Optionally, an <em>offset big-list file</em> (with extension
  * <code>.obl</code>) can be created to load graphs faster.
  *
  * <p>As a rule of thumb, random access is faster using {@link #successors(int)}, whereas
  * while iterating using a {@link NodeIterator} it is better to use {@link NodeIterator#successorArray()}.
  *
+ * <p>Optionally, an {@linkplain OutdegreeIndex outdegree index} (with extension {@link OutdegreeIndex#OUTDEGREE_INDEX_EXTENSION})
+ * can be created at compression time. If it is available and up to date, graphs loaded with offsets
+ * use it to compute {@linkplain #outdegree(int) outdegrees} without decoding the graph, and to create
+ * {@linkplain #splitNodeIterators(int) node iterators scanning approximately the same number of arcs}.
+ *
+ * <h2>Thread-safe random access</h2>
+ *
+ * <p>Albeit {@link ImmutableGraph} implementations need not be thread-safe, random access to a
+ * {@link BVGraph} loaded with offsets (i.e., {@link #outdegree(int)}, {@link #successors(int)} and
+ * {@link #successorArray(int)}) is thread-safe: each call to {@link #successors(int)} reads the graph
+ * using a new bit stream, and the one-entry cache used to read outdegrees is thread-local. The thread-local
+ * state contains just a few integers, and no reference to the graph, so threads of a long-lived pool do
+ * not retain the memory of graphs that have been discarded. Thus, a single instance can be shared by any number of threads performing random
+ * access without resorting to {@link #copy()}. Node iterators and lazy iterators, instead, must
+ * not be shared between threads.
+ *
  * <h2>Parallel compression</h2>
  *
  * <p>Starting with version 3.5.0, this classes uses {@link ImmutableGraph#splitNodeIterators(int)} to compress
@@ -193,6 +218,14 @@ import it.unimi.dsi.sux4j.util.EliasFanoMonotoneLongBigList;
  *     less than <var>x</var>); the remaining residuals are expressed as decremented differences from the previous residual.
  *  </OL>
  *
+ * <P>Outdegrees and residuals can also be coded using a {@linkplain HuffmanCoder canonical Huffman code} tailored
+ * on the graph (see {@link #OUTDEGREES_HUFFMAN} and {@link #RESIDUALS_HUFFMAN}). In this case, compression
+ * requires two passes over the graph: the first pass compresses the graph using the default codes and gathers the distributions of
+ * outdegrees and residuals, from which the codes are built. Thus, Huffman codes cannot be used with read-once graphs
+ * (compression fails if the two passes do not see the same number of nodes and arcs). Huffman codes are not available
+ * for other quantities. The lengths of the codewords are stored in the property file, and
+ * graphs using Huffman codes have format version 1, so they cannot be read by older versions of this class.
+ *
  * <H2>The Offset File</H2>
  *
  * <P>Since the graph is stored as a bit stream, we must have some way to know where each successor list starts.
@@ -221,12 +254,16 @@ import it.unimi.dsi.sux4j.util.EliasFanoMonotoneLongBigList;
  * <dd>the number of bits per link (overall graph size in bits divided by the number of arcs).
  * <dt><code>bitspernode</code>
  * <dd>the number of bits per node (overall graph size in bits divided by the number of nodes).
+ * <dt><code>offsetsbits</code>
+ * <dd>the length in bits of the offsets stream (used when {@linkplain #append(CharSequence, ImmutableGraph, ProgressLogger) appending}).
  * <dt><code>compratio</code>
  * <dd>the ratio between the graph size and the information-theoretical lower bound (the binary logarithm of the number of subsets of size <code>arcs</code> out of a universe of <code>nodes</code><sup>2</sup> elements).
  * <dt><code>compressionflags</code>
  * <dd>flags specifying the codes used for the components of the compression algorithm.
  * <dt><code>zetak</code>
  * <dd>if &zeta; codes are selected for residuals, the parameter <var>k</var>.
+ * <dt><code>outdegreecodelengths</code>, <code>residualcodelengths</code>
+ * <dd>if Huffman codes are selected for outdegrees or residuals, the lengths of the codewords of the {@linkplain HuffmanCoder canonical Huffman code}, separated by a comma.
  * <dt><code>windowsize</code>
  * <dd>the window size.
  * <dt><code>maxref</code>
@@ -250,6 +287,9 @@ import it.unimi.dsi.sux4j.util.EliasFanoMonotoneLongBigList;
  * <dt><code>*avg[log]gap</code>
  * <dd>the average of the gaps (or of their logarithm) of successors and residuals: note that this data is computed from the exponential statistics above, and
  * thus it is necessarily approximate.
+ * <dt><code>fingerprint</code>, <code>fingerprintkey</code>
+ * <dd>the {@linkplain GraphFingerprint fingerprint} of the graph and the key used to compute it, in hexadecimal; computing the fingerprint
+ * costs two hash evaluations per arc during compression.
  * <dd>
  * </dl>
  *
@@ -275,6 +315,13 @@ import it.unimi.dsi.sux4j.util.EliasFanoMonotoneLongBigList;
  * extension <code>.obl</code>. The list will be quickly deserialised
  * if its modification date is later than that of the offset file.
  *
+ * <p>When {@linkplain #loadMapped(CharSequence) memory-mapping a graph}, instead, offsets are
+ * read from a {@link MappedEliasFanoMonotoneLongBigList} stored in a file with extension <code>.ef</code>, which is
+ * memory-mapped, too, provided that its modification date is not earlier than that of the offset file.
+ * No construction or deserialisation is necessary, so loading takes constant time, and the pages of the list are shared through
+ * the page cache by all processes mapping the same graph. The file is written at compression time, and the main method of this class
+ * has an option that will generate it for existing graphs.
+ *
  * <H2>Not Loading the Graph File at All</H2>
  *
  * <P>For some applications (such as transposing a graph) it is not necessary to load the graph
@@ -304,6 +351,8 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 	public static final String OFFSETS_EXTENSION = ".offsets";
 	/** The standard extension for the cached {@link LongBigList} containing the graph offsets. */
 	public static final String OFFSETS_BIG_LIST_EXTENSION = ".obl";
+	/** The standard extension for the memory-mappable {@linkplain MappedEliasFanoMonotoneLongBigList Elias&ndash;Fano list} of graph offsets. */
+	public static final String OFFSETS_ELIAS_FANO_EXTENSION = ".ef";
 	/** The standard extension for the stream of node outdegrees. */
 	public static final String OUTDEGREES_EXTENSION = ".outdegrees";
 	/** The buffer size we use for most operations. */
@@ -313,7 +362,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 
 	/** This number classifies the present graph format. When new features require introducing binary incompatibilities,
 		this number is bumped so to ensure that old classes do not try to read graphs they cannot understand. */
-	public final static int BVGRAPH_VERSION = 0;
+	public final static int BVGRAPH_VERSION = 1;
 
 	/** The initial length of an array that will contain a successor list. */
 	protected static final int INITIAL_SUCCESSOR_LIST_LENGTH = 1024;
@@ -368,17 +417,14 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 	 * the bit streams of one each {@link #offsetType} nodes. */
 	protected LongBigList offsets;
 
+	/** The outdegree index of this graph, or <code>null</code> if the index was not available at loading time
+	 * or {@link #offsetType} is zero or less. */
+	protected transient OutdegreeIndex outdegreeIndex;
+
 	/** The offset type: 2 is memory-mapping, 1 is normal random-access loading, 0 means that we do not want to load offsets at all, -1 that
 	 * the we do not want even load the graph file. */
 	protected int offsetType;
 
-	/** If not -1, the node whose degree is cached in {@link #cachedOutdegree}. */
-	protected transient int cachedNode = Integer.MIN_VALUE;
-	/** If {@link #cachedNode} is not {@link Integer#MIN_VALUE}, its cached outdegree. */
-	protected int cachedOutdegree;
-	/** If {@link #cachedNode} is not {@link Integer#MIN_VALUE}, the position immediately after the coding of the outdegree of {@link #cachedNode}. */
-	protected long cachedPointer;
-
 	/** The maximum reference count. */
 	protected int maxRefCount = DEFAULT_MAX_REF_COUNT;
 
@@ -409,6 +455,9 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 	/** Flag: write outdegrees using &delta; coding. */
 	public static final int OUTDEGREES_DELTA = DELTA;
 
+	/** Flag: write outdegrees using a canonical Huffman code tailored on the graph. */
+	public static final int OUTDEGREES_HUFFMAN = HUFFMAN;
+
 	/** Flag: write copy-block lists using &gamma; coding (default). */
 	public static final int BLOCKS_GAMMA = GAMMA << 4;
 
@@ -430,6 +479,9 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 	/** Flag: write residuals using Golomb coding. */
 	public static final int RESIDUALS_GOLOMB = GOLOMB << 8;
 
+	/** Flag: write residuals using a canonical Huffman code tailored on the graph. */
+	public static final int RESIDUALS_HUFFMAN = HUFFMAN << 8;
+
 	/** Flag: write references using &gamma; coding. */
 	public static final int REFERENCES_GAMMA = GAMMA << 12;
 
@@ -472,6 +524,12 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 	/** The coding for offsets. By default, we use &gamma; coding. */
 	protected int offsetCoding = GAMMA;
 
+	/** The Huffman coder for outdegrees, if {@link #outdegreeCoding} is {@link #HUFFMAN}. */
+	protected HuffmanCoder outdegreeCoder;
+
+	/** The Huffman coder for residuals, if {@link #residualCoding} is {@link #HUFFMAN}. */
+	protected HuffmanCoder residualCoder;
+
 	/** The compression flags used. */
 	private int flags = 0;
 
@@ -492,6 +550,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		result.graphStream = graphStream != null ? new FastMultiByteArrayInputStream(graphStream) : null;
 		result.mappedGraphStream = mappedGraphStream != null ? mappedGraphStream.copy() : null;
 		result.offsets = offsets;
+		result.outdegreeIndex = outdegreeIndex;
 		result.maxRefCount = maxRefCount;
 		result.windowSize = windowSize;
 		result.minIntervalLength = minIntervalLength;
@@ -503,8 +562,10 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		result.referenceCoding = referenceCoding;
 		result.blockCountCoding = blockCountCoding;
 		result.offsetCoding = offsetCoding;
+		result.outdegreeCoder = outdegreeCoder;
+		result.residualCoder = residualCoder;
 		result.flags = flags;
-		result.outdegreeIbs = offsetType <= 0 ? null : isMemory ? new InputBitStream(graphMemory): new InputBitStream(isMapped ? mappedGraphStream.copy() : new FastMultiByteArrayInputStream(graphStream), 0);
+		if (offsetType >= 0) result.initOutdegreeCache();
 		return result;
 	}
 
@@ -551,6 +612,30 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		return windowSize;
 	}
 
+	/** Returns the minimum interval length of this graph.
+	 *
+	 * @return the minimum interval length.
+	 */
+	public int minIntervalLength() {
+		return minIntervalLength;
+	}
+
+	/** Returns the value of <var>k</var> used for &zeta;<sub><var>k</var></sub> coding by this graph.
+	 *
+	 * @return the value of <var>k</var>.
+	 */
+	public int zetaK() {
+		return zetaK;
+	}
+
+	/** Returns the compression flags of this graph.
+	 *
+	 * @return the mask of compression flags used to store this graph.
+	 */
+	public int flags() {
+		return flags;
+	}
+
 	/* This family of protected methods is used throughout the class to read data
 	from the graph file following the codings indicated by the compression
 	flags. */
@@ -591,6 +676,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		switch(outdegreeCoding) {
 		case GAMMA: return ibs.readGamma();
 		case DELTA: return ibs.readDelta();
+		case HUFFMAN: return outdegreeCoder.readInt(ibs);
 		default: throw new UnsupportedOperationException("The required outdegree coding (" + outdegreeCoding + ") is not supported.");
 		}
 	}
@@ -616,6 +702,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		switch(outdegreeCoding) {
 		case GAMMA: return obs.writeGamma(d);
 		case DELTA: return obs.writeDelta(d);
+		case HUFFMAN: return outdegreeCoder.write(obs, d);
 		default: throw new UnsupportedOperationException("The required outdegree coding (" + outdegreeCoding + ") is not supported.");
 		}
 	}
@@ -727,6 +814,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		case DELTA: return ibs.readDelta();
 		case GOLOMB: return ibs.readGolomb(zetaK);
 		case NIBBLE: return ibs.readNibble();
+		case HUFFMAN: return residualCoder.readInt(ibs);
 		default: throw new UnsupportedOperationException("The required residuals coding (" + residualCoding + ") is not supported.");
 		}
 	}
@@ -743,6 +831,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		case DELTA: return ibs.readLongDelta();
 		case GOLOMB: return ibs.readLongGolomb(zetaK);
 		case NIBBLE: return ibs.readLongNibble();
+		case HUFFMAN: return residualCoder.readLong(ibs);
 		default: throw new UnsupportedOperationException("The required residuals coding (" + residualCoding + ") is not supported.");
 		}
 	}
@@ -760,6 +849,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		case DELTA: return obs.writeDelta(residual);
 		case GOLOMB: return obs.writeGolomb(residual, zetaK);
 		case NIBBLE: return obs.writeNibble(residual);
+		case HUFFMAN: return residualCoder.write(obs, residual);
 		default: throw new UnsupportedOperationException("The required residuals coding (" + residualCoding + ") is not supported.");
 		}
 	}
@@ -777,46 +867,80 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		case DELTA: return obs.writeLongDelta(residual);
 		case GOLOMB: return (int)obs.writeLongGolomb(residual, zetaK);
 		case NIBBLE: return obs.writeLongNibble(residual);
+		case HUFFMAN: return residualCoder.write(obs, residual);
 		default: throw new UnsupportedOperationException("The required residuals coding (" + residualCoding + ") is not supported.");
 		}
 	}
 
-	/** A bit stream wrapping {@link #graphMemory}, or {@link #graphStream}, used <em>only</em> by {@link #outdegree(int)} and {@link #outdegreeInternal(int)}. */
-	private transient InputBitStream outdegreeIbs;
+	/** The state used by {@link #outdegree(int)} and {@link #outdegreeCache(int, InputBitStream)}: a one-entry cache for outdegrees.
+	 * There is one such state per thread. On purpose, the state does not refer to the graph (e.g., through a bit stream): as
+	 * the runtime purges thread-local values of discarded graphs lazily, this way threads of long-lived pools retain
+	 * a few bytes, rather than the whole graph. */
+	private final static class OutdegreeCache {
+		/** If not {@link Integer#MIN_VALUE}, the node whose degree is cached in {@link #outdegree}. */
+		private int node = Integer.MIN_VALUE;
+		/** If {@link #node} is not {@link Integer#MIN_VALUE}, its cached outdegree. */
+		private int outdegree;
+		/** If {@link #node} is not {@link Integer#MIN_VALUE}, the position immediately after the coding of the outdegree of {@link #node}. */
+		private long pointer;
+	}
+
+	/** The key of the {@linkplain GraphFingerprint fingerprint} computed by compression threads. */
+	private transient long fingerprintKey;
 
-	/* The code of the following two methods must be kept in sync. */
+	/** The thread-local outdegree caches, or <code>null</code> if {@link #offsetType} is -1. */
+	private transient ThreadLocal<OutdegreeCache> outdegreeCache;
+
+	/** Sets up {@link #outdegreeCache}. */
+	private void initOutdegreeCache() {
+		outdegreeCache = ThreadLocal.withInitial(OutdegreeCache::new);
+	}
+
+	/** Returns a new bit stream wrapping {@link #graphMemory}, {@link #mappedGraphStream} or {@link #graphStream}.
+	 *
+	 * @return a new bit stream that can be used for random access to the graph.
+	 */
+	private InputBitStream randomAccessInputBitStream() {
+		return isMemory ? new InputBitStream(graphMemory) : new InputBitStream(isMapped ? mappedGraphStream.copy() : new FastMultiByteArrayInputStream(graphStream), 0);
+	}
 
 	@Override
 	public int outdegree(final int x) throws IllegalStateException {
-		if (x == cachedNode) return cachedOutdegree;
 		if (x < 0 || x >= n) throw new IllegalArgumentException("Node index out of range: " + x);
+		if (outdegreeIndex != null) return outdegreeIndex.outdegree(x);
 
 		/* Computing the outdegree is a most basic operation. Thus, it must be always
 		   possible to compute the outdegree of a node independently of any other state
-		   in a BVGraph. To this purpose, we have special-purpose input bit stream that
-		   is used just to read outdegrees. */
+		   in a BVGraph. To this purpose, each thread has its own one-entry cache, and on a miss
+		   we read the outdegree using a new bit stream. */
 
+		// Without offsets, we just give up.
+		if (offsetType <= 0) throw new IllegalStateException("You cannot compute the outdegree of a random node without offsets");
 		try {
-			// Without offsets, we just give up.
-			if (offsetType <= 0) throw new IllegalStateException("You cannot compute the outdegree of a random node without offsets");
-			// We just position and read.
-			outdegreeIbs.position(offsets.getLong(cachedNode = x));
-			cachedOutdegree = readOutdegree(outdegreeIbs);
-			cachedPointer = outdegreeIbs.position();
-			return cachedOutdegree;
+			final OutdegreeCache cache = outdegreeCache.get();
+			return x == cache.node ? cache.outdegree : outdegreeCache(x, randomAccessInputBitStream()).outdegree;
 		}
 		catch (final IOException e) {
 			throw new RuntimeException(e);
 		}
 	}
 
-	private int outdegreeInternal(final int x) throws IOException {
-		if (x == cachedNode) return cachedOutdegree;
+	/** Returns the outdegree cache of the current thread, updated so to contain the outdegree of a given node.
+	 *
+	 * @param x a node.
+	 * @param ibs a bit stream on the graph that will be used to read the outdegree of <code>x</code> if it is not
+	 * cached; its position is undefined after this call.
+	 * @return the outdegree cache of the current thread, containing data about <code>x</code>.
+	 */
+	private OutdegreeCache outdegreeCache(final int x, final InputBitStream ibs) throws IOException {
+		final OutdegreeCache cache = outdegreeCache.get();
+		if (x == cache.node) return cache;
 		// We just position and read.
-		outdegreeIbs.position(offsets.getLong(cachedNode = x));
-		cachedOutdegree = readOutdegree(outdegreeIbs);
-		cachedPointer = outdegreeIbs.position();
-		return cachedOutdegree;
+		ibs.position(offsets.getLong(x));
+		cache.outdegree = readOutdegree(ibs);
+		cache.pointer = ibs.position();
+		cache.node = x;
+		return cache;
 	}
 
 
@@ -831,8 +955,30 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		// a newly created input bit stream and null elsewhere.
 		if (x < 0 || x >= n) throw new IllegalArgumentException("Node index out of range: " + x);
 		if (offsetType <= 0) throw new UnsupportedOperationException("Random access to successor lists is not possible with sequential or offline graphs");
-		final InputBitStream ibs = isMemory ? new InputBitStream(graphMemory) : new InputBitStream(isMapped ? mappedGraphStream.copy() : new FastMultiByteArrayInputStream(graphStream), 0);
-		return successors(x, ibs, null, null);
+		return successors(x, randomAccessInputBitStream(), null, null);
+	}
+
+	/** {@inheritDoc}
+	 *
+	 * <p>If an {@linkplain OutdegreeIndex outdegree index} is available, outdegrees are read from the index.
+	 */
+	@Override
+	public IntIterator outdegrees() {
+		return outdegreeIndex != null ? outdegreeIndex.outdegrees() : super.outdegrees();
+	}
+
+	/** {@inheritDoc}
+	 *
+	 * <p>If an {@linkplain OutdegreeIndex outdegree index} is available, the returned iterators
+	 * will scan approximately the same number of arcs.
+	 */
+	@Override
+	public NodeIterator[] splitNodeIterators(final int howMany) {
+		if (outdegreeIndex == null || howMany < 1) return super.splitNodeIterators(howMany);
+		final NodeIterator[] result = new NodeIterator[howMany];
+		final int[] split = outdegreeIndex.splitPoints(howMany);
+		for(int i = 0; i < howMany; i++) result[i] = split[i] == split[i + 1] ? NodeIterator.EMPTY : nodeIterator(split[i]).copy(split[i + 1]);
+		return result;
 	}
 
 
@@ -846,9 +992,26 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		private final BVGraph g;
 
 		private OffsetsLongIterator(final BVGraph g, final InputBitStream offsetIbs) {
+			this(g, offsetIbs, g.numNodes());
+		}
+
+		private OffsetsLongIterator(final BVGraph g, final InputBitStream offsetIbs, final int n) {
+			this(g, offsetIbs, n, 0);
+		}
+
+		/** Creates an iterator returning <var>n</var>&nbsp;+&nbsp;1 offsets, each obtained by adding a delta read from a stream
+		 * to the previous offset.
+		 *
+		 * @param g the graph providing the offset coding.
+		 * @param offsetIbs the stream of deltas.
+		 * @param n the number of offsets to return, minus one.
+		 * @param start the offset the first delta is added to.
+		 */
+		private OffsetsLongIterator(final BVGraph g, final InputBitStream offsetIbs, final int n, final long start) {
 			this.offsetIbs = offsetIbs;
 			this.g = g;
-			this.n = g.numNodes();
+			this.n = n;
+			this.off = start;
 		}
 
 		@Override
@@ -937,7 +1100,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 	 * successor lists (even when no offsets were loaded).
 	 * </OL>
 	 *
-	 * <P>This method may modify the offset and the outdegree caches if <code>window</code> is <code>null</code>.
+	 * <P>This method may modify the outdegree cache of the current thread if <code>window</code> is <code>null</code>.
 	 *
 	 * @param x a node.
 	 * @param ibs an input bit stream wrapping a graph file. After this method returns, the state of <code>ibs</code> is undefined:
@@ -966,8 +1129,9 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 			//long nextOffset = -1;
 
 			if (window == null) {
-				d = outdegreeInternal(x);
-				ibs.position(cachedPointer);
+				final OutdegreeCache cache = outdegreeCache(x, ibs);
+				d = cache.outdegree;
+				ibs.position(cache.pointer);
 			}
 			else d = outd[x % cyclicBufferSize] = readOutdegree(ibs);
 
@@ -990,7 +1154,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 				}
 				// If the block count is even, we must compute the number of successors copied implicitly.
 				//if (window == null) nextOffset = offsets.getLong(x - ref);
-				if ((blockCount & 1) == 0) copied += (window != null ? outd[refIndex] : outdegreeInternal(x - ref)) - total;
+				if ((blockCount & 1) == 0) copied += (window != null ? outd[refIndex] : outdegree(x - ref)) - total;
 				extraCount = d - copied;
 			}
 			else extraCount = d;
@@ -1041,7 +1205,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 									? LazyIntIterators.wrap(window[refIndex], outd[refIndex])
 											:
 												// This is the recursive lazy part of the construction.
-												successors(x - ref, isMemory ? new InputBitStream(graphMemory) : new InputBitStream(isMapped ? mappedGraphStream.copy() : new FastMultiByteArrayInputStream(graphStream), 0), null, null)
+												successors(x - ref, randomAccessInputBitStream(), null, null)
 									);
 
 			if (ref <= 0) return extraIterator;
@@ -1099,7 +1263,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 				int pos;
 				for(int i = 1; i < Math.min(from + 1, cyclicBufferSize); i++) {
 					pos = (int)(((long)from - i + cyclicBufferSize) % cyclicBufferSize);
-					this.outd[pos] = BVGraph.this.outdegreeInternal(from - i);
+					this.outd[pos] = BVGraph.this.outdegreeCache(from - i, this.ibs).outdegree;
 					System.arraycopy(BVGraph.this.successorArray(from - i), 0, this.window[pos] = IntArrays.grow(this.window[pos], this.outd[pos], 0), 0, this.outd[pos]);
 				}
 				this.ibs.position(offsets.getLong(from)); // We must fix the bit stream position so that we are *before* the outdegree.
@@ -1236,8 +1400,10 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 	 *  is anyway not checked for).
 	 *
 	 * @param flags a mask of flags as specified by the constants of this class.
+	 * @throws IllegalArgumentException if {@link #HUFFMAN} is specified for something else than outdegrees or residuals.
 	 */
 	private void setFlags(final int flags) {
+		checkFlags(flags);
 		this.flags = flags;
 		if ((flags & 0xF) != 0) outdegreeCoding = flags & 0xF;
 		if (((flags >>> 4) & 0xF) != 0) blockCoding = (flags >>> 4) & 0xF;
@@ -1247,6 +1413,18 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		if (((flags >>> 20) & 0xF) != 0) offsetCoding = (flags >>> 20) & 0xF;
 	}
 
+	/** Checks that {@link #HUFFMAN} coding is specified only for outdegrees and residuals.
+	 *
+	 * @param flags a flag mask.
+	 * @throws IllegalArgumentException if {@link #HUFFMAN} is specified for something else than outdegrees or residuals.
+	 */
+	private static void checkFlags(final int flags) {
+		if (((flags >>> 4) & 0xF) == HUFFMAN) throw new IllegalArgumentException("Huffman coding is not supported for blocks");
+		if (((flags >>> 12) & 0xF) == HUFFMAN) throw new IllegalArgumentException("Huffman coding is not supported for references");
+		if (((flags >>> 16) & 0xF) == HUFFMAN) throw new IllegalArgumentException("Huffman coding is not supported for block counts");
+		if (((flags >>> 20) & 0xF) == HUFFMAN) throw new IllegalArgumentException("Huffman coding is not supported for offsets");
+	}
+
 	/** Produces a string representing the values coded in the given flag mask.
 	 *
 	 * @param flags a flag mask.
@@ -1285,6 +1463,12 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 				throw new IOException("Compression flag " + element + " unknown.");
 			}
 		}
+		try {
+			checkFlags(flags);
+		}
+		catch(final IllegalArgumentException e) {
+			throw new IOException("Invalid compression flags " + flagString + ": " + e.getMessage());
+		}
 		return flags;
 	}
 
@@ -1453,6 +1637,8 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		maxRefCount = Integer.parseInt(properties.getProperty("maxrefcount"));
 		minIntervalLength = Integer.parseInt(properties.getProperty("minintervallength"));
 		if (properties.getProperty("zetak") != null) zetaK = Integer.parseInt(properties.getProperty("zetak"));
+		if (outdegreeCoding == HUFFMAN) outdegreeCoder = getHuffmanCoder(properties, "outdegree");
+		if (residualCoding == HUFFMAN) residualCoder = getHuffmanCoder(properties, "residual");
 
 		if (offsetType < -1 || offsetType > 2) throw new IllegalArgumentException("Illegal offset type " + offsetType);
 		final InputBitStream offsetIbs = offsetType > 0 ? new InputBitStream(new FileInputStream(basename + OFFSETS_EXTENSION), STD_BUFFER_SIZE) : null;
@@ -1494,9 +1680,12 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 				pl.start("Loading offsets...");
 			}
 
+			// When mapping, we try to map a precomputed Elias-Fano list.
+			if (offsetType == 2) offsets = mapOffsets(basename);
+
 			// We try to load a cached big list.
 			final File offsetsBigListFile = new File(basename + OFFSETS_BIG_LIST_EXTENSION);
-			if (offsetsBigListFile.exists()) if (new File(basename + OFFSETS_EXTENSION).lastModified() > offsetsBigListFile.lastModified()) LOGGER.warn("A cached long big list of offsets was found, but the corresponding offsets file has a later modification time");
+			if (offsets == null && offsetsBigListFile.exists()) if (new File(basename + OFFSETS_EXTENSION).lastModified() > offsetsBigListFile.lastModified()) LOGGER.warn("A cached long big list of offsets was found, but the corresponding offsets file has a later modification time");
 			else try {
 				offsets = (LongBigList)BinIO.loadObject(offsetsBigListFile);
 			}
@@ -1509,17 +1698,83 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 				pl.count = n + 1L;
 				pl.done();
 				if (offsets instanceof EliasFanoMonotoneLongBigList) pl.logger().info("Pointer bits per node: " + Util.format(((EliasFanoMonotoneLongBigList)offsets).numBits() / (n + 1.0)));
+				if (offsets instanceof MappedEliasFanoMonotoneLongBigList) pl.logger().info("Pointer bits per node: " + Util.format(((MappedEliasFanoMonotoneLongBigList)offsets).numBits() / (n + 1.0)));
 			}
 		}
 
 		if (offsetIbs != null) offsetIbs.close();
 
-		// We finally create the outdegreeIbs and, if needed, the two caches
-		if (offsetType >= 0) outdegreeIbs = isMemory ? new InputBitStream(graphMemory): new InputBitStream(isMapped ? mappedGraphStream.copy() : new FastMultiByteArrayInputStream(graphStream), 0);
+		if (offsetType > 0) outdegreeIndex = OutdegreeIndex.load(basename, n, offsetType == 2);
+
+		// We finally set up the thread-local outdegree caches
+		if (offsetType >= 0) initOutdegreeCache();
 
 		return this;
 	}
 
+	/** Memory-maps the {@linkplain MappedEliasFanoMonotoneLongBigList Elias&ndash;Fano list} of offsets of this graph, if available, up to date and sound.
+	 *
+	 * <p>A list that cannot be mapped (e.g., because it is truncated or its header is corrupted) or whose
+	 * first and last offsets are inconsistent with the graph is ignored with a warning, so that offsets
+	 * are decoded from the offsets file instead. Corruption of the body of the list cannot be detected without a full scan.
+	 *
+	 * @param basename the basename of the graph.
+	 * @return the list of offsets, or <code>null</code> if no up-to-date, sound list is available.
+	 */
+	private LongBigList mapOffsets(final CharSequence basename) {
+		final File offsetsEliasFanoFile = new File(basename + OFFSETS_ELIAS_FANO_EXTENSION);
+		if (! offsetsEliasFanoFile.exists()) return null;
+		if (new File(basename + OFFSETS_EXTENSION).lastModified() > offsetsEliasFanoFile.lastModified()) {
+			LOGGER.warn("An Elias-Fano list of offsets was found, but the corresponding offsets file has a later modification time");
+			return null;
+		}
+		try {
+			final MappedEliasFanoMonotoneLongBigList offsets = MappedEliasFanoMonotoneLongBigList.loadMapped(offsetsEliasFanoFile.toString());
+			if (offsets.size64() != n + 1L) {
+				LOGGER.warn("An Elias-Fano list of offsets was found, but it contains " + offsets.size64() + " offsets instead of " + (n + 1L));
+				return null;
+			}
+			if (offsets.getLong(0) != 0 || offsets.getLong(n) > mappedGraphStream.length() * Byte.SIZE) {
+				LOGGER.warn("An Elias-Fano list of offsets was found, but its offsets are inconsistent with the graph file");
+				return null;
+			}
+			return offsets;
+		}
+		catch(final IOException | RuntimeException e) {
+			LOGGER.warn("An Elias-Fano list of offsets was found, but it cannot be read: decoding the offsets file instead", e);
+			return null;
+		}
+	}
+
+	/** Stores a {@linkplain MappedEliasFanoMonotoneLongBigList memory-mappable Elias&ndash;Fano list} of the offsets of a graph
+	 * compressed using the flags of this graph.
+	 *
+	 * <p>The list is written to a temporary file that is then renamed, so processes that
+	 * memory-mapped a previous version of the list will not be affected.
+	 *
+	 * @param basename the basename of the graph.
+	 * @param n the number of nodes of the graph.
+	 */
+	private void storeOffsetsEliasFano(final CharSequence basename, final int n) throws IOException {
+		final InputBitStream offsetIbs = new InputBitStream(basename + OFFSETS_EXTENSION, STD_BUFFER_SIZE);
+		storeOffsetsEliasFano(basename, new OffsetsLongIterator(this, offsetIbs, n), n);
+		offsetIbs.close();
+	}
+
+	/** Stores a {@linkplain MappedEliasFanoMonotoneLongBigList memory-mappable Elias&ndash;Fano list} of given offsets.
+	 *
+	 * @param basename the basename of the graph.
+	 * @param offsets an iterator returning the <var>n</var>&nbsp;+&nbsp;1 offsets of the graph.
+	 * @param n the number of nodes of the graph.
+	 * @see #storeOffsetsEliasFano(CharSequence, int)
+	 */
+	private static void storeOffsetsEliasFano(final CharSequence basename, final LongIterator offsets, final int n) throws IOException {
+		final File offsetsEliasFanoFile = new File(basename + OFFSETS_ELIAS_FANO_EXTENSION).getAbsoluteFile();
+		final File tempFile = File.createTempFile(BVGraph.class.getSimpleName(), "-tmp" + OFFSETS_ELIAS_FANO_EXTENSION, offsetsEliasFanoFile.getParentFile());
+		MappedEliasFanoMonotoneLongBigList.store(offsets, n + 1L, new File(basename + GRAPH_EXTENSION).length() * Byte.SIZE + 1, tempFile.toString());
+		Files.move(tempFile.toPath(), offsetsEliasFanoFile.toPath(), StandardCopyOption.REPLACE_EXISTING);
+	}
+
 
 
 	/** This method tries to express an increasing sequence of natural numbers <code>x</code> as a union of an increasing
@@ -1585,13 +1840,65 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 	 */
 	public static void store(final ImmutableGraph graph, final CharSequence basename, final int windowSize, final int maxRefCount, final int minIntervalLength,
 			final int zetaK, final int flags, final int numberOfThreads, final ProgressLogger pl) throws IOException {
+		BVGraph.store(graph, basename, windowSize, maxRefCount, minIntervalLength, zetaK, flags, numberOfThreads, false, pl);
+	}
+
+	/** Writes the given graph using a given base name, optionally storing a {@linkplain GraphSketch sketch}.
+	 *
+	 * <p>The sketch is computed during compression and serialized in a file with extension {@link GraphSketch#SKETCH_EXTENSION}.
+	 * It requires approximately 4 bytes per node of additional core memory, plus 4 bytes per node per thread, as each thread
+	 * accumulates indegrees in a private array (if such arrays would use more than half of the available memory, a shared array of
+	 * atomic integers is used instead).
+	 *
+	 * @param graph a graph to be compressed.
+	 * @param basename a base name.
+	 * @param windowSize the window size (-1 for the default value).
+	 * @param maxRefCount the maximum reference count (-1 for the default value).
+	 * @param minIntervalLength the minimum interval length (-1 for the default value, {@link #NO_INTERVALS} to disable).
+	 * @param zetaK the parameter used for residual &zeta;-coding, if used (-1 for the default value).
+	 * @param flags the flag mask.
+	 * @param numberOfThreads the number of threads to use; if 0 or negative, it will be replaced by {@link Runtime#availableProcessors()}. Note that if
+	 * {@link ImmutableGraph#numNodes()} is not implemented by {@code graph}, the number of threads will be automatically set to one, possibly logging a warning.
+	 * @param sketch whether to store a sketch of the graph.
+	 * @param pl a progress logger to log the state of compression, or <code>null</code> if no logging is required.
+	 * @throws IOException if some exception is raised while writing the graph.
+	 */
+	public static void store(final ImmutableGraph graph, final CharSequence basename, final int windowSize, final int maxRefCount, final int minIntervalLength,
+			final int zetaK, final int flags, final int numberOfThreads, final boolean sketch, final ProgressLogger pl) throws IOException {
+		BVGraph.store(graph, basename, windowSize, maxRefCount, minIntervalLength, zetaK, flags, numberOfThreads, sketch, false, pl);
+	}
+
+	/** Writes the given graph using a given base name, optionally storing a {@linkplain GraphSketch sketch} and an {@linkplain OutdegreeIndex outdegree index}.
+	 *
+	 * <p>The sketch and the outdegree index are computed during compression and stored in files with extension
+	 * {@link GraphSketch#SKETCH_EXTENSION} and {@link OutdegreeIndex#OUTDEGREE_INDEX_EXTENSION}, respectively.
+	 * The sketch requires approximately 4 bytes per node of additional core memory, plus 4 bytes per node per thread
+	 * (see {@link #store(ImmutableGraph, CharSequence, int, int, int, int, int, int, boolean, ProgressLogger)}), and the outdegree
+	 * index 4 bytes per node, which are shared with the sketch.
+	 *
+	 * @param graph a graph to be compressed.
+	 * @param basename a base name.
+	 * @param windowSize the window size (-1 for the default value).
+	 * @param maxRefCount the maximum reference count (-1 for the default value).
+	 * @param minIntervalLength the minimum interval length (-1 for the default value, {@link #NO_INTERVALS} to disable).
+	 * @param zetaK the parameter used for residual &zeta;-coding, if used (-1 for the default value).
+	 * @param flags the flag mask.
+	 * @param numberOfThreads the number of threads to use; if 0 or negative, it will be replaced by {@link Runtime#availableProcessors()}. Note that if
+	 * {@link ImmutableGraph#numNodes()} is not implemented by {@code graph}, the number of threads will be automatically set to one, possibly logging a warning.
+	 * @param sketch whether to store a sketch of the graph.
+	 * @param outdegreeIndex whether to store an outdegree index of the graph.
+	 * @param pl a progress logger to log the state of compression, or <code>null</code> if no logging is required.
+	 * @throws IOException if some exception is raised while writing the graph.
+	 */
+	public static void store(final ImmutableGraph graph, final CharSequence basename, final int windowSize, final int maxRefCount, final int minIntervalLength,
+			final int zetaK, final int flags, final int numberOfThreads, final boolean sketch, final boolean outdegreeIndex, final ProgressLogger pl) throws IOException {
 		final BVGraph g = new BVGraph();
 		if (windowSize != -1) g.windowSize = windowSize;
 		if (maxRefCount != -1) g.maxRefCount = maxRefCount;
 		if (minIntervalLength != -1) g.minIntervalLength = minIntervalLength;
 		if (zetaK != -1) g.zetaK = zetaK;
 		g.setFlags(flags);
-		g.storeInternal(graph, basename, numberOfThreads, pl);
+		g.storeInternal(graph, basename, numberOfThreads, sketch, outdegreeIndex, pl);
 	}
 
 	/** Writes the given graph using a given base name.
@@ -1696,6 +2003,17 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		if (msb >= 0) bin[msb]++;
 	}
 
+	/** Updates the frequencies of the {@linkplain HuffmanCoder#symbol(long) symbols} used to code a list of residuals.
+	 * @param currNode the current node.
+	 * @param residual a strictly increasing list of residuals.
+	 * @param length the number of valid elements in <code>residual</code>.
+	 * @param stats the frequencies of the symbols.
+	 */
+	private static void updateSymbolStats(final int currNode, final int[] residual, final int length, final long[] stats) {
+		stats[HuffmanCoder.symbol(Fast.int2nat((long)residual[0] - currNode))]++;
+		for(int i = 1; i < length; i++) stats[HuffmanCoder.symbol(residual[i] - residual[i - 1] - 1)]++;
+	}
+
 	@SuppressWarnings("unused")
 	private final class CompressionThread implements Callable<Void> {
 		public final CharSequence threadBasename;
@@ -1706,6 +2024,10 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		public long[] successorGapStats;
 		/** Statistics for the gap width of residuals (exponentially binned). */
 		public long[] residualGapStats;
+		/** If not {@code null}, the frequencies of the {@linkplain HuffmanCoder#symbol(long) symbols} used to code outdegrees. */
+		public long[] outdegreeSymbolStats;
+		/** If not {@code null}, the frequencies of the {@linkplain HuffmanCoder#symbol(long) symbols} used to code residuals. */
+		public long[] residualSymbolStats;
 		/** Bits used for outdegress. */
 		public long bitsForOutdegrees;
 		/** Bits used to write backward references. */
@@ -1724,12 +2046,31 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		public long residualArcs;
 
 		public long totRef = 0, totDist = 0, totLinks = 0;
+		/** The number of nodes compressed by this thread. */
+		public long nodes;
+		/** The sums of the two {@linkplain GraphFingerprint fingerprint} hashes over the arcs compressed by this thread. */
+		public long fingerprint0, fingerprint1;
+		/** If not {@code null}, outdegrees will be stored here for the sketch. */
+		private final int[] sketchOutdegree;
+		/** If not {@code null}, this thread will allocate a private array, which it will store at position {@link #index}, in which indegrees will be accumulated for the sketch. */
+		private final int[][] sketchIndegree;
+		/** If not {@code null}, indegrees will be accumulated here for the sketch. */
+		private final AtomicIntegerArray sharedSketchIndegree;
 		private final int index;
 		private final int numNodes;
+		/** If not {@code null}, the successor lists of the nodes preceding the first node to be compressed, in reverse order. */
+		private int[][] seedList;
+		/** If {@link #seedList} is not {@code null}, the reference counts of the nodes in {@link #seedList}. */
+		private int[] seedRefCount;
+		/** If {@link #seedList} is not {@code null}, the first node to be compressed. */
+		private int seedNode;
 
 
-		private CompressionThread(final int index, final int numNodes, final NodeIterator nodeIterator, final CharSequence basename, final int bufferSize, final int statsThreshold, final ProgressLogger pl) {
+		private CompressionThread(final int index, final int numNodes, final NodeIterator nodeIterator, final CharSequence basename, final int bufferSize, final int statsThreshold, final int[] sketchOutdegree, final int[][] sketchIndegree, final AtomicIntegerArray sharedSketchIndegree, final ProgressLogger pl) {
 			this.index = index;
+			this.sketchOutdegree = sketchOutdegree;
+			this.sketchIndegree = sketchIndegree;
+			this.sharedSketchIndegree = sharedSketchIndegree;
 			this.numNodes = numNodes;
 			this.nodeIterator = nodeIterator;
 			this.bufferSize = bufferSize;
@@ -1738,6 +2079,27 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 			this.pl = pl;
 		}
 
+		/** Seeds the compression window, so that the first node to be compressed can refer to previous nodes.
+		 *
+		 * @param firstNode the first node that will be returned by the node iterator.
+		 * @param list the successor lists of the nodes preceding {@code firstNode}, in reverse order.
+		 * @param refCount the reference counts of the nodes preceding {@code firstNode}, in reverse order.
+		 */
+		private void seed(final int firstNode, final int[][] list, final int[] refCount) {
+			seedNode = firstNode;
+			seedList = list;
+			seedRefCount = refCount;
+		}
+
+		/** Makes this thread gather the frequencies of the symbols used to code outdegrees and residuals.
+		 *
+		 * @see HuffmanCoder#build(long[])
+		 */
+		private void collectSymbolStats() {
+			outdegreeSymbolStats = new long[HuffmanCoder.NUMBER_OF_SYMBOLS];
+			residualSymbolStats = new long[HuffmanCoder.NUMBER_OF_SYMBOLS];
+		}
+
 		/** Scratch variables used by the {@link #diffComp(OutputBitStream, int, int, int[], int, int[], int, boolean)} method. */
 		private final IntArrayList extras = new IntArrayList(), blocks = new IntArrayList(), residuals = new IntArrayList(),
 				left = new IntArrayList(), len = new IntArrayList();
@@ -1913,6 +2275,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 					if (forReal) {
 						residualArcs += residualCount;
 						updateBins(currNode, residual, residualCount, residualGapStats);
+						if (residualSymbolStats != null) updateSymbolStats(currNode, residual, residualCount, residualSymbolStats);
 					}
 					t = writeResidual(obs, Fast.int2nat((long)(prev = residual[0]) - currNode));
 					if (forReal) bitsForResiduals += t;
@@ -1939,14 +2302,17 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 
 		@Override
 		public Void call() throws Exception {
+			// We allocate the private array even if there is nothing to compress, so that all arrays can be summed
+			final int[] indegree = sketchIndegree != null ? sketchIndegree[index] = new int[numNodes] : null;
 			if (nodeIterator == null) return null;
 			// Used for differential compression
 			final OutputBitStream bitCount = new OutputBitStream(NullOutputStream.getInstance(), 0);
 			int outd, currIndex;
 			long bitOffset = 0;
 
-			graphObs = new OutputBitStream(new FileOutputStream(threadBasename + BVGraph.GRAPH_EXTENSION), bufferSize);
-			final OutputBitStream offsetObs = new OutputBitStream(new FileOutputStream(threadBasename + BVGraph.OFFSETS_EXTENSION), bufferSize);
+			// If there is no basename, we are just gathering statistics
+			graphObs = threadBasename == null ? new OutputBitStream(NullOutputStream.getInstance(), 0) : new OutputBitStream(new FileOutputStream(threadBasename + BVGraph.GRAPH_EXTENSION), bufferSize);
+			final OutputBitStream offsetObs = threadBasename == null ? new OutputBitStream(NullOutputStream.getInstance(), 0) : new OutputBitStream(new FileOutputStream(threadBasename + BVGraph.OFFSETS_EXTENSION), bufferSize);
 
 			if (STATS) {
 				offsetStats = new PrintWriter(new FileWriter(threadBasename + ".offsetStats"));
@@ -1971,6 +2337,13 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 			successorGapStats = new long[32];
 			residualGapStats = new long[32];
 
+			if (seedList != null) for(int i = seedList.length; i-- != 0;) {
+				final int index = (seedNode - 1 - i) % cyclicBufferSize;
+				list[index] = seedList[i];
+				listLen[index] = seedList[i].length;
+				refCount[index] = seedRefCount[i];
+			}
+
 			nodeIterator.hasNext();
 
 			if (pl != null && index == 0) { // Only the first thread starts the logger
@@ -1989,6 +2362,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 				final int currNode = nodeIterator.nextInt();
 				outd = nodeIterator.outdegree();// get the number of successors of currNode
 				currIndex = currNode % cyclicBufferSize;
+				nodes++;
 
 				// We write the current offset to the offset stream
 				writeOffset(offsetObs, graphObs.writtenBits() - bitOffset);
@@ -1999,6 +2373,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 
 				// We write the node outdegree
 				bitsForOutdegrees += writeOutdegree(graphObs, outd);
+				if (outdegreeSymbolStats != null) outdegreeSymbolStats[HuffmanCoder.symbol(outd)]++;
 
 				if (STATS) outdegreeStats.println(outd);
 
@@ -2008,6 +2383,18 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 				System.arraycopy(nodeIterator.successorArray(), 0, list[currIndex], 0, outd);
 				listLen[currIndex] = outd;
 
+				final int[] currList = list[currIndex];
+				for(int i = outd; i-- != 0;) {
+					fingerprint0 += GraphFingerprint.hash0(fingerprintKey, currNode, currList[i]);
+					fingerprint1 += GraphFingerprint.hash1(fingerprintKey, currNode, currList[i]);
+				}
+
+				if (sketchOutdegree != null) {
+					sketchOutdegree[currNode] = outd;
+					if (indegree != null) for(int i = outd; i-- != 0;) indegree[currList[i]]++;
+					else if (sharedSketchIndegree != null) for(int i = outd; i-- != 0;) sharedSketchIndegree.incrementAndGet(currList[i]);
+				}
+
 				if (outd > 0) {
 					updateBins(currNode, list[currIndex], outd, successorGapStats);
 					try {
@@ -2091,8 +2478,8 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		return v;
 	}
 
-	private static final long[] aggregateStats(final CompressionThread[] compressionThread, final String fieldName) {
-		final long[] stats = new long[32];
+	private static final long[] aggregateStats(final CompressionThread[] compressionThread, final String fieldName, final int length) {
+		final long[] stats = new long[length];
 
 		for(final CompressionThread t: compressionThread)
 			try {
@@ -2106,6 +2493,90 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		return stats;
 	}
 
+	/** Compresses a graph using the compression parameters and flags of this graph object.
+	 *
+	 * @param graph a graph to be compressed.
+	 * @param basename a base name, or {@code null} if the compressed graph must be discarded.
+	 * @param n the number of nodes of {@code graph}, or &minus;1 if it is not known.
+	 * @param numberOfThreads the number of threads to use.
+	 * @param symbolStats whether to gather the frequencies of the symbols used to code outdegrees and residuals.
+	 * @param sketchOutdegree if not {@code null}, outdegrees will be stored here.
+	 * @param sketchIndegree if not {@code null}, an array of {@code numberOfThreads} elements; each thread will accumulate indegrees
+	 * in a private array, and at the end the first element will contain the indegrees.
+	 * @param sharedSketchIndegree if not {@code null}, indegrees will be accumulated here.
+	 * @param pl a progress logger to measure the state of compression, or <code>null</code> if no logging is required.
+	 * @return the compression threads; if {@code numberOfThreads} is greater than one, they wrote their data in temporary files.
+	 */
+	private CompressionThread[] compress(final ImmutableGraph graph, final CharSequence basename, final int n, final int numberOfThreads, final boolean symbolStats, final int[] sketchOutdegree, final int[][] sketchIndegree, final AtomicIntegerArray sharedSketchIndegree, final ProgressLogger pl) throws IOException {
+		final int statsThreshold = (1 << (20 + Math.min(30, Fast.mostSignificantBit(numberOfThreads)))) - 1;
+
+		final ExecutorService executorService = Executors.newFixedThreadPool(numberOfThreads, new ThreadFactoryBuilder().setNameFormat("ProcessingThread-%d").build());
+		final ExecutorCompletionService<Void> executorCompletionService = new ExecutorCompletionService<>(executorService);
+
+		final CompressionThread[] compressionThread = new CompressionThread[numberOfThreads];
+
+		if (numberOfThreads == 1) compressionThread[0] = new CompressionThread(0, n, graph.nodeIterator(), basename, STD_BUFFER_SIZE, statsThreshold, sketchOutdegree, sketchIndegree, sharedSketchIndegree, pl);
+		else {
+			final NodeIterator[] splitNodeIterators = graph.splitNodeIterators(numberOfThreads);
+			for(int i = numberOfThreads; i-- != 0;) {
+				File tempFile = null;
+				if (basename != null) {
+					tempFile = File.createTempFile(BVGraph.class.getSimpleName(), "-tmp.graph");
+					tempFile.deleteOnExit();
+				}
+				compressionThread[i] = new CompressionThread(i, n, splitNodeIterators[i], tempFile == null ? null : tempFile.toString(), MULTITHREAD_BUFFER_SIZE, statsThreshold, sketchOutdegree, sketchIndegree, sharedSketchIndegree, pl);
+			}
+		}
+
+		for(final CompressionThread t : compressionThread) {
+			if (symbolStats) t.collectSymbolStats();
+			executorCompletionService.submit(t);
+		}
+
+		Throwable problem = null;
+		for(int i = numberOfThreads; i-- != 0;)
+			try {
+				executorCompletionService.take().get();
+			}
+		catch(final Exception e) {
+			problem = e.getCause(); // We keep only the last one. They will be logged anyway.
+		}
+
+		// We sum in parallel the private arrays of indegrees into the first one, each thread taking care of a slice of nodes
+		if (problem == null && sketchIndegree != null && numberOfThreads > 1) {
+			for(int i = numberOfThreads; i-- != 0;) {
+				final int from = (int)((long)n * i / numberOfThreads), to = (int)((long)n * (i + 1) / numberOfThreads);
+				executorCompletionService.submit(() -> {
+					final int[] indegree = sketchIndegree[0];
+					for(int t = 1; t < sketchIndegree.length; t++) {
+						final int[] other = sketchIndegree[t];
+						for(int x = from; x < to; x++) indegree[x] += other[x];
+					}
+					return null;
+				});
+			}
+
+			for(int i = numberOfThreads; i-- != 0;)
+				try {
+					executorCompletionService.take().get();
+				}
+			catch(final Exception e) {
+				problem = e.getCause(); // We keep only the last one.
+			}
+
+			Arrays.fill(sketchIndegree, 1, sketchIndegree.length, null);
+		}
+
+		executorService.shutdown();
+		if (problem != null) {
+			Throwables.throwIfUnchecked(problem);
+			throw new RuntimeException(problem);
+		}
+
+		if (pl != null) pl.done();
+		return compressionThread;
+	}
+
 	/** Writes the given graph <code>graph</code> using a given base name, and the compression parameters and flags
 	 * of this graph object. Note that the latter is relevant only as far as parameters and flags are concerned; its
 	 * content is really irrelevant.
@@ -2114,10 +2585,12 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 	 * @param basename a base name.
 	 * @param numberOfThreads the number of threads to use; if 0 or negative, it will be replaced by {@link Runtime#availableProcessors()}. Note that if
 	 * {@link ImmutableGraph#numNodes()} is not implemented, the number of threads will be automatically set to one, possibly logging a warning.
+	 * @param sketch whether to store a {@linkplain GraphSketch sketch} of the graph.
+	 * @param outdegreeIndex whether to store an {@linkplain OutdegreeIndex outdegree index} of the graph.
 	 * @param pl a progress logger to measure the state of compression, or <code>null</code> if no logging is required.
 	 * @throws IOException if some exception is raised while writing the graph.
 	 */
-	private void storeInternal(final ImmutableGraph graph, final CharSequence basename, int numberOfThreads, final ProgressLogger pl) throws IOException {
+	private void storeInternal(final ImmutableGraph graph, final CharSequence basename, int numberOfThreads, final boolean sketch, final boolean outdegreeIndex, final ProgressLogger pl) throws IOException {
 		int n;
 		try {
 			n = graph.numNodes();
@@ -2141,40 +2614,40 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		}
 
 		LOGGER.info("Compressing using " + numberOfThreads + " threads");
-		final int statsThreshold = (1 << (20 + Math.min(30, Fast.mostSignificantBit(numberOfThreads)))) - 1;
-
-		final ExecutorService executorService = Executors.newFixedThreadPool(numberOfThreads, new ThreadFactoryBuilder().setNameFormat("ProcessingThread-%d").build());
-		final ExecutorCompletionService<Void> executorCompletionService = new ExecutorCompletionService<>(executorService);
-
-		final CompressionThread[] compressionThread = new CompressionThread[numberOfThreads];
 
-		if (numberOfThreads == 1) executorCompletionService.submit(compressionThread[0] = new CompressionThread(0, n, graph.nodeIterator(), basename, STD_BUFFER_SIZE, statsThreshold, pl));
-		else {
-			final NodeIterator[] splitNodeIterators = graph.splitNodeIterators(numberOfThreads);
-			for(int i = numberOfThreads; i-- != 0;) {
-				final File tempFile = File.createTempFile(BVGraph.class.getSimpleName(), "-tmp.graph");
-				tempFile.deleteOnExit();
-				executorCompletionService.submit(compressionThread[i] = new CompressionThread(i, n, splitNodeIterators[i], tempFile.toString(), MULTITHREAD_BUFFER_SIZE, statsThreshold, pl));
+		// The number of nodes and arcs seen by the first pass, if Huffman codes are used
+		long firstPassNodes = -1, firstPassArcs = -1;
+		if (outdegreeCoding == HUFFMAN || residualCoding == HUFFMAN) {
+			// A first pass with the default codes gathers the frequencies of the symbols of the Huffman codes
+			final boolean outdegreeHuffman = outdegreeCoding == HUFFMAN, residualHuffman = residualCoding == HUFFMAN;
+			if (outdegreeHuffman) outdegreeCoding = GAMMA;
+			if (residualHuffman) residualCoding = ZETA;
+			if (pl != null) pl.logger().info("Computing Huffman codes...");
+			final CompressionThread[] compressionThread = compress(graph, null, n, numberOfThreads, true, null, null, null, pl);
+			if (outdegreeHuffman) {
+				outdegreeCoder = HuffmanCoder.build(aggregateStats(compressionThread, "outdegreeSymbolStats", HuffmanCoder.NUMBER_OF_SYMBOLS));
+				outdegreeCoding = HUFFMAN;
 			}
-		}
-
-		Throwable problem = null;
-		for(int i = numberOfThreads; i-- != 0;)
-			try {
-				executorCompletionService.take().get();
+			if (residualHuffman) {
+				residualCoder = HuffmanCoder.build(aggregateStats(compressionThread, "residualSymbolStats", HuffmanCoder.NUMBER_OF_SYMBOLS));
+				residualCoding = HUFFMAN;
 			}
-		catch(final Exception e) {
-			problem = e.getCause(); // We keep only the last one. They will be logged anyway.
-		}
-
-		executorService.shutdown();
-		if (problem != null) {
-			Throwables.throwIfUnchecked(problem);
-			throw new RuntimeException(problem);
+			firstPassNodes = aggregateLong(compressionThread, "nodes");
+			firstPassArcs = aggregateLong(compressionThread, "totLinks");
 		}
 
-		if (pl != null) pl.done();
-
+		// If the number of nodes is not known in advance, the sketch and the outdegree index will be computed from the compressed graph
+		final int[] sketchOutdegree = (sketch || outdegreeIndex) && n != -1 ? new int[n] : null;
+		// Private arrays of indegrees avoid contention on high-indegree nodes, but we do not want them to fill the memory
+		final boolean privateIndegrees = numberOfThreads == 1 || (long)numberOfThreads * n * Integer.BYTES <= Runtime.getRuntime().maxMemory() / 2;
+		if (sketch && n != -1 && ! privateIndegrees) LOGGER.warn("Not enough memory for " + numberOfThreads + " arrays of indegrees: using a shared array");
+		final int[][] sketchIndegree = sketch && n != -1 && privateIndegrees ? new int[numberOfThreads][] : null;
+		final AtomicIntegerArray sharedSketchIndegree = sketch && n != -1 && ! privateIndegrees ? new AtomicIntegerArray(n) : null;
+		fingerprintKey = GraphFingerprint.storeKey();
+		final CompressionThread[] compressionThread = compress(graph, basename, n, numberOfThreads, false, sketchOutdegree, sketchIndegree, sharedSketchIndegree, pl);
+		long offsetsBits = aggregateLong(compressionThread, "offsetsWrittenBits");
+		if (firstPassNodes != -1 && (firstPassNodes != aggregateLong(compressionThread, "nodes") || firstPassArcs != aggregateLong(compressionThread, "totLinks")))
+			throw new IllegalStateException("The source graph returned different nodes or arcs when scanned twice: Huffman codes require a graph that can be scanned twice (read-once graphs are not supported)");
 
 		if (numberOfThreads > 1) {
 			if (pl != null) pl.logger().info("Copying streams...");
@@ -2197,6 +2670,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 			}
 
 			graphObs.close();
+			offsetsBits = offsetsObs.writtenBits();
 			offsetsObs.close();
 			if (pl != null) pl.logger().info("Copy completed.");
 		}
@@ -2221,6 +2695,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		properties.setProperty("intervalisedarcs", String.valueOf(aggregateLong(compressionThread, "intervalisedArcs")));
 		properties.setProperty("residualarcs", String.valueOf(aggregateLong(compressionThread, "residualArcs")));
 		final long writtenBits = aggregateLong(compressionThread, "graphWrittenBits");
+		properties.setProperty("offsetsbits", String.valueOf(offsetsBits));
 		properties.setProperty("bitsperlink", format.format((double)writtenBits / totLinks));
 		properties.setProperty("compratio", format.format(writtenBits * Math.log(2) / (stirling((double)n * n) - stirling(totLinks) - stirling((double)n * n - totLinks))));
 		properties.setProperty("bitspernode", format.format((double)writtenBits / n));
@@ -2234,56 +2709,39 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		properties.setProperty("bitsforblocks", Long.toString(aggregateLong(compressionThread, "bitsForBlocks")));
 		properties.setProperty("bitsforresiduals", Long.toString(aggregateLong(compressionThread, "bitsForResiduals")));
 		properties.setProperty("bitsforintervals", Long.toString(aggregateLong(compressionThread, "bitsForIntervals")));
+		GraphFingerprint.setProperties(properties, fingerprintKey, n, aggregateLong(compressionThread, "fingerprint0"), aggregateLong(compressionThread, "fingerprint1"));
 		properties.setProperty(ImmutableGraph.GRAPHCLASS_PROPERTY_KEY, this.getClass().getName());
-		properties.setProperty("version", String.valueOf(BVGRAPH_VERSION));
+		if (outdegreeCoding == HUFFMAN) setHuffmanCoder(properties, "outdegree", outdegreeCoder);
+		if (residualCoding == HUFFMAN) setHuffmanCoder(properties, "residual", residualCoder);
+		// Graphs that do not use Huffman codes can be read by older versions
+		properties.setProperty("version", String.valueOf(outdegreeCoding == HUFFMAN || residualCoding == HUFFMAN ? BVGRAPH_VERSION : 0));
 		final FileOutputStream propertyFile = new FileOutputStream(basename + PROPERTIES_EXTENSION);
 		// Binned data
-		int l;
-		final long[] successorGapStats = aggregateStats(compressionThread,  "successorGapStats");
-		for(l = successorGapStats.length; l-- != 0;) if (successorGapStats[l] != 0) break;
-		final StringBuilder s = new StringBuilder();
-		BigInteger totGap = BigInteger.ZERO;
-		double totLogGap = 0;
-		long numGaps = 0;
-
-		long g = 1;
-		for(int i = 0; i <= l; i++) {
-			if (i != 0) s.append(',');
-			s.append(successorGapStats[i]);
-			numGaps += successorGapStats[i];
-			totGap = totGap.add(BigInteger.valueOf(g * 2 + g - 1).multiply(BigInteger.valueOf(successorGapStats[i])));
-			totLogGap += (Fast.log2(g * 2 + g + 1) - 1) * successorGapStats[i];
-			g *= 2;
-		}
+		final long[] successorGapStats = aggregateStats(compressionThread,  "successorGapStats", 32);
+		final long[] residualGapStats = aggregateStats(compressionThread,  "residualGapStats", 32);
+		setGapStats(properties, "successor", successorGapStats);
+		setGapStats(properties, "residual", residualGapStats);
 
-		properties.setProperty("successorexpstats", s.toString());
-		properties.setProperty("successoravggap", numGaps == 0 ? "0" : new BigDecimal(totGap).divide(BigDecimal.valueOf(numGaps * 2), 3, RoundingMode.HALF_EVEN).toString());
-		properties.setProperty("successoravgloggap", numGaps == 0 ? "0" : Double.toString(totLogGap / numGaps));
+		properties.store(propertyFile, "BVGraph properties");
 
-		s.setLength(0);
+		propertyFile.close();
 
-		final long[] residualGapStats = aggregateStats(compressionThread,  "residualGapStats");
-		for(l = residualGapStats.length; l-- != 0;) if (residualGapStats[l] != 0) break;
-		g = 1;
-		numGaps = 0;
-		totLogGap = 0;
-		totGap = BigInteger.ZERO;
-		for(int i = 0; i <= l; i++) {
-			if (i != 0) s.append(',');
-			s.append(residualGapStats[i]);
-			totGap = totGap.add(BigInteger.valueOf(g * 2 + g - 1).multiply(BigInteger.valueOf(residualGapStats[i])));
-			totLogGap += (Fast.log2(g * 2 + g + 1) - 1) * residualGapStats[i];
-			numGaps += residualGapStats[i];
-			g *= 2;
+		if (sketch) {
+			// The sketch must be written after the property file, or it will be considered stale
+			final GraphSketch graphSketch = sketchOutdegree != null
+					? new GraphSketch(n, x -> sketchOutdegree[x], sketchIndegree != null ? x -> sketchIndegree[0][x] : sharedSketchIndegree::get, successorGapStats, residualGapStats)
+					: GraphSketch.compute(BVGraph.loadOffline(basename), residualGapStats, pl);
+			graphSketch.store(basename);
 		}
 
-		properties.setProperty("residualexpstats", s.toString());
-		properties.setProperty("residualavggap", numGaps == 0 ? "0" : new BigDecimal(totGap).divide(BigDecimal.valueOf(numGaps * 2), 3, RoundingMode.HALF_EVEN).toString());
-		properties.setProperty("residualavgloggap", numGaps == 0 ? "0" : Double.toString(totLogGap / numGaps));
-
-		properties.store(propertyFile, "BVGraph properties");
+		if (outdegreeIndex) {
+			// Like the sketch, the index must be written after the property file, or it will be considered stale; we use the
+			// outdegrees recorded during compression, if any, and otherwise scan the compressed graph
+			if (sketchOutdegree != null) OutdegreeIndex.store(n, totLinks, IntIterators.wrap(sketchOutdegree), basename);
+			else OutdegreeIndex.store(BVGraph.loadOffline(basename), basename, pl);
+		}
 
-		propertyFile.close();
+		storeOffsetsEliasFano(basename, n);
 
 		if (STATS) {
 			offsetStats.close();
@@ -2303,6 +2761,277 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		return n * Math.log(n) - n + (1./2) * Math.log(2 * Math.PI * n) ;
 	}
 
+	/** Sets the properties describing exponentially binned gap statistics.
+	 *
+	 * @param properties the properties of a graph.
+	 * @param prefix the prefix of the property keys (<code>successor</code> or <code>residual</code>).
+	 * @param stats the exponentially binned gap statistics.
+	 */
+	private static void setGapStats(final Properties properties, final String prefix, final long[] stats) {
+		int l;
+		for(l = stats.length; l-- != 0;) if (stats[l] != 0) break;
+		final StringBuilder s = new StringBuilder();
+		BigInteger totGap = BigInteger.ZERO;
+		double totLogGap = 0;
+		long numGaps = 0;
+
+		long g = 1;
+		for(int i = 0; i <= l; i++) {
+			if (i != 0) s.append(',');
+			s.append(stats[i]);
+			numGaps += stats[i];
+			totGap = totGap.add(BigInteger.valueOf(g * 2 + g - 1).multiply(BigInteger.valueOf(stats[i])));
+			totLogGap += (Fast.log2(g * 2 + g + 1) - 1) * stats[i];
+			g *= 2;
+		}
+
+		properties.setProperty(prefix + "expstats", s.toString());
+		properties.setProperty(prefix + "avggap", numGaps == 0 ? "0" : new BigDecimal(totGap).divide(BigDecimal.valueOf(numGaps * 2), 3, RoundingMode.HALF_EVEN).toString());
+		properties.setProperty(prefix + "avgloggap", numGaps == 0 ? "0" : Double.toString(totLogGap / numGaps));
+	}
+
+	/** Sets the property describing the lengths of the codewords of a Huffman coder.
+	 *
+	 * @param properties the properties of a graph.
+	 * @param prefix the prefix of the property key (<code>outdegree</code> or <code>residual</code>).
+	 * @param coder a Huffman coder.
+	 */
+	private static void setHuffmanCoder(final Properties properties, final String prefix, final HuffmanCoder coder) {
+		final StringBuilder s = new StringBuilder();
+		for(final int l : coder.codeLengths()) {
+			if (s.length() != 0) s.append(',');
+			s.append(l);
+		}
+		properties.setProperty(prefix + "codelengths", s.toString());
+	}
+
+	/** Parses the property describing the lengths of the codewords of a Huffman coder.
+	 *
+	 * @param properties the properties of a graph.
+	 * @param prefix the prefix of the property key (<code>outdegree</code> or <code>residual</code>).
+	 * @return the Huffman coder described by the property.
+	 * @throws IOException if the property is missing or invalid.
+	 */
+	private static HuffmanCoder getHuffmanCoder(final Properties properties, final String prefix) throws IOException {
+		final String s = properties.getProperty(prefix + "codelengths");
+		if (s == null) throw new IOException("Missing codeword lengths for the Huffman code of " + prefix + "s");
+		final String[] length = s.split(",");
+		final int[] codeLength = new int[length.length];
+		for(int i = length.length; i-- != 0;) codeLength[i] = Integer.parseInt(length[i]);
+		try {
+			return new HuffmanCoder(codeLength);
+		}
+		catch(final IllegalArgumentException e) {
+			throw new IOException("Invalid codeword lengths for the Huffman code of " + prefix + "s", e);
+		}
+	}
+
+	/** Parses the property describing exponentially binned gap statistics.
+	 *
+	 * @param properties the properties of a graph.
+	 * @param prefix the prefix of the property key (<code>successor</code> or <code>residual</code>).
+	 * @return the exponentially binned gap statistics (all zeroes if the property is missing).
+	 */
+	private static long[] getGapStats(final Properties properties, final String prefix) {
+		final long[] stats = new long[32];
+		final String s = properties.getProperty(prefix + "expstats");
+		if (s != null && s.length() != 0) {
+			final String[] bin = s.split(",");
+			for(int i = bin.length; i-- != 0;) stats[i] = Long.parseLong(bin[i]);
+		}
+		return stats;
+	}
+
+	/** Returns an output bit stream that will append bits to a bit stream stored in a file.
+	 *
+	 * <p>The bits following the end of the stored bit stream in its last byte are overwritten; the file is never shortened.
+	 *
+	 * @param file a file containing a bit stream.
+	 * @param bitLength the length in bits of the bit stream.
+	 * @return an output bit stream positioned after the last bit of the stored bit stream.
+	 */
+	private static OutputBitStream appendingOutputBitStream(final File file, final long bitLength) throws IOException {
+		final RandomAccessFile randomAccessFile = new RandomAccessFile(file, "rw");
+		final int partial = (int)(bitLength % Byte.SIZE);
+		randomAccessFile.seek(bitLength / Byte.SIZE);
+		final int lastByte = partial == 0 ? 0 : randomAccessFile.read();
+		if (lastByte == -1) {
+			randomAccessFile.close();
+			throw new IOException("File " + file + " is shorter than " + bitLength + " bits");
+		}
+		randomAccessFile.seek(bitLength / Byte.SIZE);
+		final OutputBitStream obs = new OutputBitStream(new FileOutputStream(randomAccessFile.getFD()) {
+			@Override
+			public void close() throws IOException {
+				randomAccessFile.close();
+			}
+		}, STD_BUFFER_SIZE);
+		if (partial != 0) obs.writeInt(lastByte >>> Byte.SIZE - partial, partial);
+		return obs;
+	}
+
+	/** Appends to a stored {@link BVGraph} the nodes of a graph following those already stored.
+	 *
+	 * <p>This method makes it possible to grow a compressed graph (e.g., with newly discovered pages) in time proportional to the number
+	 * of new arcs, rather than to the size of the whole graph: the nodes of {@code graph} from <var>n</var> on, where <var>n</var> is the number
+	 * of nodes of the stored graph, are compressed using the compression parameters and flags of the stored graph, and the
+	 * resulting bits are appended to the graph and offsets files; the property file is then updated. Since the compression window
+	 * is seeded with the last successor lists of the stored graph (and their reference counts), the new nodes are compressed exactly
+	 * as a single-threaded compression would do after the stored nodes; thus, if the stored graph was compressed
+	 * using a single thread, the result is identical to that of a single-threaded compression of the whole graph. (Multithreaded
+	 * compression empties the compression window at the start of each thread, so in general it produces a different graph file.)
+	 *
+	 * <p>The end of the graph stream is read from the {@linkplain #OFFSETS_ELIAS_FANO_EXTENSION Elias&ndash;Fano list of offsets},
+	 * and the length of the offsets stream from the property file, so if both are available (as it happens for graphs compressed
+	 * by this version) no pass over the stored graph is necessary. The Elias&ndash;Fano list of offsets is then rebuilt by
+	 * reading the old list and the offsets of the new nodes; this operation is linear in the number of nodes, but it does not decode the offsets file.
+	 *
+	 * <p>The graph and offsets files are modified <em>in place</em>: the stored bits are not changed, and new bits are appended to the files,
+	 * whereas the Elias&ndash;Fano list of offsets is replaced by atomic renaming. Instances of the graph loaded before
+	 * appending (including the memory-mapped instance used internally by this method) will thus keep seeing the old graph, but they should be
+	 * reloaded before being used further. If this method is interrupted, the stored graph might be left in an inconsistent state
+	 * (the property file is updated last, though), and no concurrent appends to the same graph are allowed.
+	 *
+	 * <p>The successor lists of the first <var>n</var> nodes of {@code graph} are ignored: the remaining nodes are enumerated using
+	 * {@link ImmutableGraph#nodeIterator(int) graph.nodeIterator(}<var>n</var><code>)</code>, which is efficient only if
+	 * {@code graph} provides random access. Stale ancillary files (offset big lists, outdegree streams and sketches) are deleted.
+	 * The average reference chain length and the average reference distance in the property file are approximated, as their previous
+	 * values are known only with limited precision.
+	 *
+	 * @param basename the basename of a stored {@link BVGraph}, which must have offsets.
+	 * @param graph a graph whose number of nodes is at least as large as that of the stored graph.
+	 * @param pl a progress logger to log the state of compression, or <code>null</code> if no logging is required.
+	 */
+	public static void append(final CharSequence basename, final ImmutableGraph graph, final ProgressLogger pl) throws IOException {
+		BVGraph.loadMapped(basename).appendInternal(graph, pl);
+	}
+
+	/** Appends to this graph the nodes of a graph following those of this graph.
+	 *
+	 * @param graph a graph whose number of nodes is at least as large as that of this graph.
+	 * @param pl a progress logger to log the state of compression, or <code>null</code> if no logging is required.
+	 * @see #append(CharSequence, ImmutableGraph, ProgressLogger)
+	 */
+	private void appendInternal(final ImmutableGraph graph, final ProgressLogger pl) throws IOException {
+		if (graph.numNodes() < n) throw new IllegalArgumentException("The graph to append has " + graph.numNodes() + " nodes, but the stored graph has " + n + " nodes");
+
+		final Properties properties = new Properties();
+		final FileInputStream propertyInputStream = new FileInputStream(basename + PROPERTIES_EXTENSION);
+		properties.load(propertyInputStream);
+		propertyInputStream.close();
+
+		// The length in bits of the offsets stream is in the property file; the length of the graph stream is the last offset
+		final long offsetsBits;
+		if (properties.containsKey("offsetsbits")) offsetsBits = Long.parseLong(properties.getProperty("offsetsbits"));
+		else {
+			LOGGER.warn("The property file does not contain the length of the offsets stream: scanning offsets");
+			final InputBitStream offsetIbs = new InputBitStream(basename + OFFSETS_EXTENSION, STD_BUFFER_SIZE);
+			for(long i = n + 1L; i-- != 0;) readOffset(offsetIbs);
+			offsetsBits = offsetIbs.readBits();
+			offsetIbs.close();
+		}
+		final long graphBits = offsets.getLong(n);
+		// The appended arcs must be hashed with the key of the stored fingerprint
+		fingerprintKey = GraphFingerprint.key(properties);
+
+		// We seed the compression window with the last successor lists and their reference counts
+		final int seeds = Math.min(windowSize, n);
+		final int[][] seedList = new int[seeds][];
+		final int[] seedRefCount = new int[seeds];
+		final InputBitStream ibs = new InputBitStream(mappedGraphStream.copy(), 0);
+		for(int i = 0; i < seeds; i++) {
+			seedList[i] = successorArray(n - 1 - i);
+			for(int x = n - 1 - i, ref; readOutdegree(ibs, offsets.getLong(x)) != 0 && (ref = readReference(ibs)) != 0; x -= ref) seedRefCount[i]++;
+		}
+
+		final File tempFile = File.createTempFile(BVGraph.class.getSimpleName(), "-tmp.graph");
+		tempFile.deleteOnExit();
+		final CompressionThread compressionThread = new CompressionThread(0, graph.numNodes() - n, graph.nodeIterator(n), tempFile.toString(), STD_BUFFER_SIZE, (1 << 20) - 1, null, null, pl);
+		compressionThread.seed(n, seedList, seedRefCount);
+		try {
+			compressionThread.call();
+		}
+		catch(final Exception e) {
+			Throwables.throwIfInstanceOf(e, IOException.class);
+			Throwables.throwIfUnchecked(e);
+			throw new RuntimeException(e);
+		}
+		if (pl != null) pl.done();
+
+		if (pl != null) pl.logger().info("Appending streams...");
+		final File graphFile = new File(compressionThread.threadBasename + GRAPH_EXTENSION);
+		final File offsetFile = new File(compressionThread.threadBasename + OFFSETS_EXTENSION);
+		final OutputBitStream graphObs = appendingOutputBitStream(new File(basename + GRAPH_EXTENSION), graphBits);
+		final InputBitStream graphIbs = new InputBitStream(graphFile);
+		graphIbs.copyTo(graphObs, compressionThread.graphWrittenBits);
+		graphIbs.close();
+		graphObs.close();
+		final OutputBitStream offsetsObs = appendingOutputBitStream(new File(basename + OFFSETS_EXTENSION), offsetsBits);
+		final InputBitStream offsetsIbs = new InputBitStream(offsetFile);
+		readOffset(offsetsIbs); // Discard first zero
+		final long newOffsetsBits = offsetsBits + compressionThread.offsetsWrittenBits - offsetsIbs.position();
+		offsetsIbs.copyTo(offsetsObs, compressionThread.offsetsWrittenBits - offsetsIbs.position());
+		offsetsIbs.close();
+		offsetsObs.close();
+		graphFile.delete();
+
+		final int newN = graph.numNodes();
+		// We extend the Elias-Fano list of offsets with the offsets of the new nodes, without decoding the offsets file
+		final InputBitStream newOffsetsIbs = new InputBitStream(offsetFile);
+		readOffset(newOffsetsIbs); // Discard first zero
+		storeOffsetsEliasFano(basename, LongIterators.concat(offsets.iterator(), new OffsetsLongIterator(this, newOffsetsIbs, newN - n - 1, graphBits)), newN);
+		newOffsetsIbs.close();
+		offsetFile.delete();
+
+		final DecimalFormat format = ((DecimalFormat)NumberFormat.getInstance(Locale.US));
+		format.applyPattern("0.###");
+
+		// We update the property file
+		final CompressionThread[] t = { compressionThread };
+		final long totLinks = m + compressionThread.totLinks;
+		final long writtenBits = graphBits + compressionThread.graphWrittenBits;
+		properties.setProperty("nodes", String.valueOf(newN));
+		properties.setProperty("arcs", String.valueOf(totLinks));
+		properties.setProperty("offsetsbits", String.valueOf(newOffsetsBits));
+		properties.setProperty("avgref", format.format((Double.parseDouble(properties.getProperty("avgref")) * n + compressionThread.totRef) / newN));
+		properties.setProperty("avgdist", format.format((Double.parseDouble(properties.getProperty("avgdist")) * n + compressionThread.totDist) / newN));
+		for(final String field : new String[] { "copiedArcs", "intervalisedArcs", "residualArcs" }) {
+			final String key = field.toLowerCase(Locale.ROOT);
+			properties.setProperty(key, String.valueOf(Long.parseLong(properties.getProperty(key)) + aggregateLong(t, field)));
+		}
+		properties.setProperty("bitsperlink", format.format((double)writtenBits / totLinks));
+		properties.setProperty("compratio", format.format(writtenBits * Math.log(2) / (stirling((double)newN * newN) - stirling(totLinks) - stirling((double)newN * newN - totLinks))));
+		properties.setProperty("bitspernode", format.format((double)writtenBits / newN));
+		for(final String field : new String[] { "bitsForOutdegrees", "bitsForReferences", "bitsForBlocks", "bitsForResiduals", "bitsForIntervals" }) {
+			final String key = field.toLowerCase(Locale.ROOT);
+			final long bits = Long.parseLong(properties.getProperty(key)) + aggregateLong(t, field);
+			properties.setProperty(key, Long.toString(bits));
+			properties.setProperty("avg" + key, format.format((double)bits / newN));
+		}
+		final long[] successorGapStats = getGapStats(properties, "successor"), residualGapStats = getGapStats(properties, "residual");
+		for(int i = successorGapStats.length; i-- != 0;) successorGapStats[i] += compressionThread.successorGapStats[i];
+		for(int i = residualGapStats.length; i-- != 0;) residualGapStats[i] += compressionThread.residualGapStats[i];
+		setGapStats(properties, "successor", successorGapStats);
+		setGapStats(properties, "residual", residualGapStats);
+		final String fingerprint = properties.getProperty(GraphFingerprint.FINGERPRINT_PROPERTY_KEY);
+		if (fingerprint != null) {
+			final long[] sums = GraphFingerprint.sums(fingerprint, n);
+			GraphFingerprint.setProperties(properties, fingerprintKey, newN, sums[0] + compressionThread.fingerprint0, sums[1] + compressionThread.fingerprint1);
+		}
+
+		final FileOutputStream propertyFile = new FileOutputStream(basename + PROPERTIES_EXTENSION);
+		properties.store(propertyFile, "BVGraph properties");
+		propertyFile.close();
+
+		for(final String extension : new String[] { OFFSETS_BIG_LIST_EXTENSION, OUTDEGREES_EXTENSION, GraphSketch.SKETCH_EXTENSION, OutdegreeIndex.OUTDEGREE_INDEX_EXTENSION }) {
+			final File stale = new File(basename + extension);
+			if (stale.exists()) {
+				LOGGER.info("Deleting stale file " + stale);
+				stale.delete();
+			}
+		}
+	}
+
 	/** Write the offset file to a given bit stream.
 	 * @param obs the output bit stream to which offsets will be written.
 	 * @param pl a progress logger, or <code>null</code>.
@@ -2345,7 +3074,11 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 						new Switch("once", '1', "once", "Use the read-once load method to read a graph from standard input."),
 						new Switch("offsets", 'O', "offsets", "Generates offsets for the source graph."),
 						new Switch("list", 'L', "list", "Precomputes an Elias-Fano list of offsets for the source graph."),
+						new Switch("eliasFano", 'E', "elias-fano", "Stores a memory-mappable Elias-Fano list of offsets for the source graph."),
 						new Switch("degrees", 'd', "degrees", "Stores the outdegrees of all nodes using &gamma; coding."),
+						new Switch("sketch", 'S', "sketch", "Stores a sketch of the graph containing degree distributions and gap statistics."),
+						new Switch("degreeIndex", 'D', "degree-index", "Stores a memory-mappable index of the cumulative outdegrees of the graph."),
+						new Switch("append", 'a', "append", "Appends to the destination graph the nodes of the source graph following those of the destination graph, using the compression parameters of the destination graph."),
 						new UnflaggedOption("sourceBasename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The basename of the source graph, or a source spec if --spec was given; it is immaterial when --once is specified."),
 						new UnflaggedOption("destBasename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, JSAP.NOT_GREEDY, "The basename of the destination graph; if omitted, no recompression is performed. This is useful in conjunction with --offsets and --list."),
 		}
@@ -2361,6 +3094,12 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		catch (final Exception notFound) {
 			throw new JSAPException("Compression method " + compressionFlag + " unknown.");
 		}
+		try {
+			checkFlags(flags);
+		}
+		catch(final IllegalArgumentException e) {
+			throw new JSAPException(e.getMessage());
+		}
 
 		final int windowSize = jsapResult.getInt("windowSize");
 		final int zetaK = jsapResult.getInt("zetaK");
@@ -2368,10 +3107,15 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 		if (maxRefCount == -1) maxRefCount = Integer.MAX_VALUE;
 		final int minIntervalLength = jsapResult.getInt("minIntervalLength");
 		final boolean once = jsapResult.getBoolean("once");
+		if (once && ((flags & 0xF) == HUFFMAN || ((flags >>> 8) & 0xF) == HUFFMAN)) throw new JSAPException("Huffman codes require scanning the source graph twice, so they cannot be used with read-once graphs");
 		final boolean spec = jsapResult.getBoolean("spec");
 		final boolean writeOffsets = jsapResult.getBoolean("offsets");
 		final boolean list = jsapResult.getBoolean("list");
+		final boolean eliasFano = jsapResult.getBoolean("eliasFano");
 		final boolean degrees = jsapResult.getBoolean("degrees");
+		final boolean sketch = jsapResult.getBoolean("sketch");
+		final boolean degreeIndex = jsapResult.getBoolean("degreeIndex");
+		final boolean append = jsapResult.getBoolean("append");
 		final int numberOfThreads = jsapResult.getInt("threads");
 		graphClass = jsapResult.getClass("graphClass");
 		source = jsapResult.getString("sourceBasename");
@@ -2387,14 +3131,16 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 			}
 			if (once) graph = (ImmutableGraph)graphClass.getMethod(LoadMethod.ONCE.toMethod(), InputStream.class).invoke(null, System.in);
 			else graph = (ImmutableGraph)graphClass.getMethod(numberOfThreads == 1 ? LoadMethod.OFFLINE.toMethod() : LoadMethod.MAPPED.toMethod(), CharSequence.class).invoke(null, source);
-		} else if (!spec) graph = once ? ImmutableGraph.loadOnce(System.in) : numberOfThreads == 1 || dest == null ? ImmutableGraph.loadOffline(source, pl) : ImmutableGraph.loadMapped(source, pl);
+		} else if (!spec) graph = once ? ImmutableGraph.loadOnce(System.in) : ! append && (numberOfThreads == 1 || dest == null) ? ImmutableGraph.loadOffline(source, pl) : ImmutableGraph.loadMapped(source, pl);
 		else graph = ObjectParser.fromSpec(source, ImmutableGraph.class, GraphClassParser.PACKAGE);
 
 		if (dest != null)	{
-			if (writeOffsets || list || degrees) throw new IllegalArgumentException("You cannot specify a destination graph with these options");
-			BVGraph.store(graph, dest, windowSize, maxRefCount, minIntervalLength, zetaK, flags, numberOfThreads, pl);
+			if (writeOffsets || list || eliasFano || degrees) throw new IllegalArgumentException("You cannot specify a destination graph with these options");
+			if (append) BVGraph.append(dest, graph, pl);
+			else BVGraph.store(graph, dest, windowSize, maxRefCount, minIntervalLength, zetaK, flags, numberOfThreads, sketch, degreeIndex, pl);
 		}
 		else {
+			if (append) throw new IllegalArgumentException("You must specify a destination graph to append to");
 			if (! (graph instanceof BVGraph)) throw new IllegalArgumentException("The source graph is not a BVGraph");
 			final BVGraph bvGraph = (BVGraph)graph;
 			if (writeOffsets) {
@@ -2411,6 +3157,7 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 				BinIO.storeObject(new EliasFanoMonotoneLongBigList(graph.numNodes() + 1, new File(graph.basename() + GRAPH_EXTENSION).length() * Byte.SIZE + 1, new OffsetsLongIterator(bvGraph, offsets)), graph.basename() + OFFSETS_BIG_LIST_EXTENSION);
 				offsets.close();
 			}
+			if (eliasFano) bvGraph.storeOffsetsEliasFano(graph.basename(), graph.numNodes());
 			if (degrees) {
 				final OutputBitStream outdegrees = new OutputBitStream(graph.basename() + OUTDEGREES_EXTENSION, 64 * 1024);
 				final NodeIterator nodeIterator = graph.nodeIterator();
@@ -2421,13 +3168,15 @@ public class BVGraph extends ImmutableGraph implements CompressionFlags, Seriali
 
 				outdegrees.close();
 			}
+			if (sketch) GraphSketch.compute(graph, pl).store(graph.basename());
+			if (degreeIndex) OutdegreeIndex.store(graph, graph.basename(), pl);
 		}
 	}
 
 
 	private void readObject(final ObjectInputStream s) throws IOException, ClassNotFoundException {
 		s.defaultReadObject();
-		outdegreeIbs = new InputBitStream(graphMemory);
+		if (offsetType >= 0) initOutdegreeCache();
 	}
 
 
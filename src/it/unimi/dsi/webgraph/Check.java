@@ -45,6 +45,9 @@ public class Check {
 
 	private static final Logger LOGGER = LoggerFactory.getLogger(Check.class);
 
+	/** The default batch size for offline checks. */
+	public static final int DEFAULT_BATCH_SIZE = 1000000;
+
 	private Check() {}
 
 	/** Check whether a graph is symmetric using {@link Transform#transpose(ImmutableGraph, ProgressLogger)}.
@@ -99,6 +102,43 @@ public class Check {
 		return graph.equals(Transform.transposeOffline(graph, batchSize, tempDir, pl));
 	}
 
+	/** Check whether a graph is symmetric using arc fingerprints, using all available processors.
+	 *
+	 * @param graph a graph.
+	 * @return whether <code>graph</code> is symmetric (with one-sided error; see {@link #symmetryFingerprint(ImmutableGraph, int, boolean, int, File, ProgressLogger)}).
+	 */
+	public static boolean symmetryFingerprint(final ImmutableGraph graph) throws IOException {
+		return symmetryFingerprint(graph, 0, false, 0, null, null);
+	}
+
+	/** Check whether a graph is symmetric using arc fingerprints.
+	 *
+	 * <p>This method computes, in a single (parallel, if {@code graph} has {@linkplain ImmutableGraph#hasCopiableIterators() copiable iterators})
+	 * scan, two independent commutative fingerprints of the multiset of arcs of {@code graph}, and of the multiset
+	 * of arcs of its transpose. Each fingerprint is the sum modulo 2<sup>64</sup> of a 64-bit hash of each arc
+	 * (see {@link GraphFingerprint}), keyed by a random key chosen at each call.
+	 * No transpose is built, and no temporary disk space is used.
+	 *
+	 * <p>If the fingerprints differ, the graph is certainly not symmetric. If they match, the graph is symmetric
+	 * but for a negligible error probability; if {@code exact} is true, in this case (and only in this case)
+	 * the result is confirmed by {@link #symmetryOffline(ImmutableGraph, int, File, ProgressLogger)}, using
+	 * {@code batchSize} and {@code tempDir}.
+	 *
+	 * @param graph a graph.
+	 * @param numberOfThreads the number of threads to use; if 0 or negative, it will be replaced by {@link Runtime#availableProcessors()}.
+	 * @param exact whether to confirm positive outcomes with an exact check.
+	 * @param batchSize passed to {@link Transform#transposeOffline(ImmutableGraph, int, File, ProgressLogger)} if {@code exact} is true;
+	 * if 0 or negative, it will be replaced by {@link #DEFAULT_BATCH_SIZE}.
+	 * @param tempDir passed to {@link Transform#transposeOffline(ImmutableGraph, int, File, ProgressLogger)} if {@code exact} is true.
+	 * @param pl a progress logger, or {@code null}.
+	 * @return whether <code>graph</code> is symmetric.
+	 */
+	public static boolean symmetryFingerprint(final ImmutableGraph graph, final int numberOfThreads, final boolean exact, final int batchSize, final File tempDir, final ProgressLogger pl) throws IOException {
+		final long[] fingerprint = GraphFingerprint.sums(graph, GraphFingerprint.randomKey(), numberOfThreads, true, pl);
+		if (fingerprint[0] != fingerprint[2] || fingerprint[1] != fingerprint[3]) return false;
+		return ! exact || symmetryOffline(graph, batchSize > 0 ? batchSize : DEFAULT_BATCH_SIZE, tempDir, pl);
+	}
+
 
 	public static void main(final String args[]) throws IOException, IllegalArgumentException, SecurityException, IllegalAccessException, InvocationTargetException, NoSuchMethodException, JSAPException {
 		Class<?> graphClass = null;
@@ -110,6 +150,7 @@ public class Check {
 				"\n" +
 				"symmetry             sourceBasename\n" +
 				"symmetryOffline      sourceBasename [batchSize] [tempDir]\n" +
+				"symmetryFingerprint  sourceBasename [batchSize] [tempDir]\n" +
 				"\n" +
 				"Please consult the Javadoc documentation for more information on each check.",
 				new Parameter[] {
@@ -117,6 +158,8 @@ public class Check {
 						new FlaggedOption("logInterval", JSAP.LONG_PARSER, Long.toString(ProgressLogger.DEFAULT_LOG_INTERVAL), JSAP.NOT_REQUIRED, 'l', "log-interval", "The minimum time interval between activity logs in milliseconds."),
 						new Switch("offline", 'o', "offline", "Use the offline load method to reduce memory consumption."),
 						new Switch("sequential", 'S', "sequential", "Equivalent to offline."),
+						new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "0", JSAP.NOT_REQUIRED, 't', "threads", "The number of threads used by fingerprint-based checks (0 for the number of available processors)."),
+						new Switch("exact", 'e', "exact", "Confirm positive outcomes of fingerprint-based checks with an exact offline check (using the optional batch size and temporary directory)."),
 						new UnflaggedOption("check", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The check."),
 						new UnflaggedOption("param", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.GREEDY, "The remaining parameters."),
 					}
@@ -131,7 +174,7 @@ public class Check {
 		final String[] param = jsapResult.getStringArray("param");
 
 		String source[] = null;
-		int batchSize = 1000000;
+		int batchSize = DEFAULT_BATCH_SIZE;
 		File tempDir = null;
 
 		if (! ensureNumArgs(param, -1)) return;
@@ -140,7 +183,7 @@ public class Check {
 			if (! ensureNumArgs(param, 1)) return;
 			source = new String[] { param[0] };
 		}
-		else if (check.equals("symmetryOffline")) {
+		else if (check.equals("symmetryOffline") || check.equals("symmetryFingerprint")) {
 			source = new String[] { param[0] };
 			if (param.length >= 2) {
 				batchSize = ((Integer)JSAP.INTSIZE_PARSER.parse(param[1])).intValue();
@@ -167,5 +210,8 @@ public class Check {
 		else if (check.equals("symmetryOffline")) {
 			System.out.println(symmetryOffline(graph[0], batchSize, tempDir, pl));
 		}
+		else if (check.equals("symmetryFingerprint")) {
+			System.out.println(symmetryFingerprint(graph[0], jsapResult.getInt("threads"), jsapResult.getBoolean("exact"), batchSize, tempDir, pl));
+		}
 	}
 }
@@ -43,6 +43,9 @@ public interface CompressionFlags {
 	/** Variable-length nibble coding (see {@link it.unimi.dsi.io.OutputBitStream#writeNibble(int)}). */
 	public static final int NIBBLE = 7;
 
-	public static final String[] CODING_NAME = { "DEFAULT", "DELTA", "GAMMA", "GOLOMB", "SKEWED_GOLOMB", "UNARY", "ZETA", "NIBBLE" };
+	/** Canonical Huffman coding tailored on the data (see {@link it.unimi.dsi.webgraph.HuffmanCoder}). */
+	public static final int HUFFMAN = 8;
+
+	public static final String[] CODING_NAME = { "DEFAULT", "DELTA", "GAMMA", "GOLOMB", "SKEWED_GOLOMB", "UNARY", "ZETA", "NIBBLE", "HUFFMAN" };
 
 }
@@ -0,0 +1,445 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import java.util.Arrays;
+import java.util.concurrent.ExecutorCompletionService;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import com.google.common.base.Throwables;
+import com.google.common.util.concurrent.ThreadFactoryBuilder;
+
+import it.unimi.dsi.bits.Fast;
+import it.unimi.dsi.fastutil.ints.IntArrays;
+
+/** A mutable graph with a fixed number of nodes supporting concurrent arc additions, designed to build
+ * large graphs in parallel.
+ *
+ * <p>Differently from {@link ArrayListMutableGraph}, which uses an {@link it.unimi.dsi.fastutil.ints.IntArrayList} per node,
+ * successor lists are stored in chains of blocks of exponentially increasing size (up to {@value #MAX_BLOCK_SIZE} successors)
+ * allocated in large chunks of integers (arenas). Nodes are partitioned in
+ * <em>stripes</em> by their lower bits; each stripe has its own arena and its own lock, so
+ * several threads can {@linkplain #addArc(int, int) add arcs} at the same time with little contention.
+ * Besides the space used by successors, the overhead is 12 bytes per node, plus one integer per block.
+ *
+ * <p>Arcs can be added in any order, and duplicates are allowed: successor lists are sorted and
+ * duplicates are removed lazily, in parallel, when an {@linkplain #immutableView() immutable view} is requested.
+ * The view provides random access and copiable iterators, so it can be compressed directly and in parallel,
+ * e.g., by {@link BVGraph#store(ImmutableGraph, CharSequence, int, it.unimi.dsi.logging.ProgressLogger)}.
+ * The view is valid until this mutable graph is modified.
+ *
+ * <p><strong>Warning</strong>: no arc can be added while {@link #immutableView()} is running, or while the view is in use.
+ */
+
+public class ConcurrentMutableGraph {
+	/** The base-2 logarithm of the size of an arena chunk. */
+	private static final int LOG2_CHUNK_SIZE = 20;
+	private static final int CHUNK_MASK = (1 << LOG2_CHUNK_SIZE) - 1;
+	/** The base-2 logarithm of the size of the first block of a successor list. */
+	private static final int LOG2_MIN_BLOCK_SIZE = 2;
+	/** The base-2 logarithm of the maximum size of a block. */
+	private static final int LOG2_MAX_BLOCK_SIZE = 10;
+	/** The maximum size of a block. */
+	public static final int MAX_BLOCK_SIZE = 1 << LOG2_MAX_BLOCK_SIZE;
+	/** The number of successors contained in blocks of size smaller than {@link #MAX_BLOCK_SIZE}. */
+	private static final int SMALL_BLOCKS_SIZE = (1 << LOG2_MAX_BLOCK_SIZE) - (1 << LOG2_MIN_BLOCK_SIZE);
+
+	/** An arena: a list of chunks from which blocks are allocated, protected by its own lock. */
+	private static final class Stripe {
+		/** The chunks. */
+		private int[][] chunk = new int[0][];
+		/** The address of the first free integer. */
+		private int top;
+		/** Whether some arc has been added to a node of this stripe since the last sort. */
+		private boolean dirty;
+
+		/** Allocates a block with a given number of successors and an additional integer for the next-block pointer.
+		 *
+		 * @param size the number of successors in the block.
+		 * @return the address of the block.
+		 */
+		private int allocate(final int size) {
+			final int length = size + 1;
+			if ((top & CHUNK_MASK) + length > CHUNK_MASK + 1 || (top >>> LOG2_CHUNK_SIZE) == chunk.length) {
+				// We move to a new chunk
+				final int c = (top & CHUNK_MASK) == 0 ? top >>> LOG2_CHUNK_SIZE : (top >>> LOG2_CHUNK_SIZE) + 1;
+				if (c >= 1 << (31 - LOG2_CHUNK_SIZE)) throw new IllegalStateException("Stripe arena exhausted");
+				if (c == chunk.length) {
+					chunk = Arrays.copyOf(chunk, c + 1);
+					chunk[c] = new int[1 << LOG2_CHUNK_SIZE];
+				}
+				top = c << LOG2_CHUNK_SIZE;
+			}
+			final int address = top;
+			top += length;
+			return address;
+		}
+
+		private int get(final int address) {
+			return chunk[address >>> LOG2_CHUNK_SIZE][address & CHUNK_MASK];
+		}
+
+		private void set(final int address, final int value) {
+			chunk[address >>> LOG2_CHUNK_SIZE][address & CHUNK_MASK] = value;
+		}
+	}
+
+	/** The number of nodes. */
+	protected final int n;
+	/** The number of arcs, valid only after a call to {@link #immutableView()}. */
+	protected long m;
+	/** For each node, the address of the first block of its successor list. */
+	private final int[] head;
+	/** For each node, the address of the last block of its successor list. */
+	private final int[] tail;
+	/** For each node, the number of successors (possibly with duplicates, if the stripe of the node is dirty). */
+	private final int[] size;
+	/** The stripes. */
+	private final Stripe[] stripe;
+	/** The mask extracting from a node its stripe. */
+	private final int stripeMask;
+	/** The cached immutable view, or {@code null}. */
+	private ImmutableGraph immutableView;
+
+	/** Creates a new disconnected mutable graph with specified number of nodes and a default number of stripes (sixteen times the number of available processors).
+	 *
+	 * @param numNodes the number of nodes in the graph.
+	 */
+	public ConcurrentMutableGraph(final int numNodes) {
+		this(numNodes, 16 * Runtime.getRuntime().availableProcessors());
+	}
+
+	/** Creates a new disconnected mutable graph with specified number of nodes and stripes.
+	 *
+	 * @param numNodes the number of nodes in the graph.
+	 * @param numStripes the number of stripes (will be rounded up to a power of two).
+	 */
+	public ConcurrentMutableGraph(final int numNodes, final int numStripes) {
+		if (numNodes < 0) throw new IllegalArgumentException("Illegal number of nodes: " + numNodes);
+		if (numStripes <= 0) throw new IllegalArgumentException("Illegal number of stripes: " + numStripes);
+		n = numNodes;
+		head = new int[n];
+		tail = new int[n];
+		size = new int[n];
+		stripe = new Stripe[1 << Fast.ceilLog2(numStripes)];
+		for(int i = stripe.length; i-- != 0;) stripe[i] = new Stripe();
+		stripeMask = stripe.length - 1;
+	}
+
+	/** Returns the offset of the successor of given index within its block.
+	 *
+	 * @param index the index of a successor.
+	 * @return the offset of the successor within its block.
+	 */
+	private static int offset(final int index) {
+		if (index >= SMALL_BLOCKS_SIZE) return (index - SMALL_BLOCKS_SIZE) & MAX_BLOCK_SIZE - 1;
+		return index - ((1 << Fast.mostSignificantBit((index >>> LOG2_MIN_BLOCK_SIZE) + 1) + LOG2_MIN_BLOCK_SIZE) - (1 << LOG2_MIN_BLOCK_SIZE));
+	}
+
+	/** Returns the size of a block given its index in the chain of blocks of a node.
+	 *
+	 * @param block the index of a block.
+	 * @return its size.
+	 */
+	private static int blockSize(final int block) {
+		return 1 << Math.min(block + LOG2_MIN_BLOCK_SIZE, LOG2_MAX_BLOCK_SIZE);
+	}
+
+	/** Returns the size of the block containing the successor of given index.
+	 *
+	 * @param index the index of a successor.
+	 * @return the size of the block containing the successor.
+	 */
+	private static int blockSizeOf(final int index) {
+		if (index >= SMALL_BLOCKS_SIZE) return MAX_BLOCK_SIZE;
+		return 1 << Fast.mostSignificantBit((index >>> LOG2_MIN_BLOCK_SIZE) + 1) + LOG2_MIN_BLOCK_SIZE;
+	}
+
+	/** Guarantees that a node index is valid.
+	 *
+	 * @param x a node index.
+	 */
+	protected void ensureNode(final int x) {
+		if (x < 0) throw new IllegalArgumentException("Illegal node index " + x);
+		if (x >= n) throw new IllegalArgumentException("Node index " + x + " is larger than graph order (" + n + ")");
+	}
+
+	/** Appends a successor to the list of a node; the caller must hold the lock on the stripe of the node.
+	 *
+	 * @param s the stripe of {@code x}.
+	 * @param x a node.
+	 * @param y the new successor.
+	 */
+	private void append(final Stripe s, final int x, final int y) {
+		final int d = size[x];
+		final int offset = offset(d);
+		if (offset == 0) {
+			final int block = s.allocate(blockSizeOf(d));
+			if (d == 0) head[x] = block;
+			else s.set(tail[x], block);
+			tail[x] = block;
+		}
+		s.set(tail[x] + 1 + offset, y);
+		size[x] = d + 1;
+	}
+
+	/** Adds an arc. This method can be called concurrently by several threads.
+	 *
+	 * <p>Adding an arc already present has no effect on the immutable view.
+	 *
+	 * @param x the start of the arc.
+	 * @param y the end of the arc.
+	 */
+	public void addArc(final int x, final int y) {
+		ensureNode(x);
+		ensureNode(y);
+		final Stripe s = stripe[x & stripeMask];
+		synchronized(s) {
+			s.dirty = true;
+			append(s, x, y);
+		}
+	}
+
+	/** Adds a batch of arcs with the same source. This method can be called concurrently by several threads.
+	 *
+	 * @param x the start of the arcs.
+	 * @param y an array containing the ends of the arcs.
+	 * @param offset the first valid element of {@code y}.
+	 * @param length the number of valid elements of {@code y}.
+	 */
+	public void addArcs(final int x, final int[] y, final int offset, final int length) {
+		ensureNode(x);
+		IntArrays.ensureOffsetLength(y, offset, length);
+		for(int i = length; i-- != 0;) ensureNode(y[offset + i]);
+		final Stripe s = stripe[x & stripeMask];
+		synchronized(s) {
+			s.dirty = true;
+			for(int i = 0; i < length; i++) append(s, x, y[offset + i]);
+		}
+	}
+
+	/** Returns the number of nodes.
+	 *
+	 * @return the number of nodes.
+	 */
+	public int numNodes() {
+		return n;
+	}
+
+	/** Copies the successors of a node in an array.
+	 *
+	 * @param x a node.
+	 * @param a an array of length at least {@code size[x]}.
+	 */
+	private void copySuccessors(final int x, final int[] a) {
+		final Stripe s = stripe[x & stripeMask];
+		int address = head[x];
+		for(int d = size[x], b = 0, pos = 0; d != 0; b++) {
+			final int l = Math.min(d, blockSize(b));
+			final int[] chunk = s.chunk[address >>> LOG2_CHUNK_SIZE];
+			System.arraycopy(chunk, (address & CHUNK_MASK) + 1, a, pos, l);
+			pos += l;
+			d -= l;
+			if (d != 0) address = chunk[address & CHUNK_MASK];
+		}
+	}
+
+	/** Writes back the successors of a node from an array, overwriting the current ones.
+	 *
+	 * @param x a node.
+	 * @param a an array.
+	 * @param length the number of successors to write, which must be positive and not larger than the current number of successors.
+	 */
+	private void writeSuccessors(final int x, final int[] a, final int length) {
+		final Stripe s = stripe[x & stripeMask];
+		int address = head[x];
+		for(int d = length, b = 0, pos = 0; d != 0; b++) {
+			final int l = Math.min(d, blockSize(b));
+			final int[] chunk = s.chunk[address >>> LOG2_CHUNK_SIZE];
+			System.arraycopy(a, pos, chunk, (address & CHUNK_MASK) + 1, l);
+			pos += l;
+			d -= l;
+			if (d != 0) address = chunk[address & CHUNK_MASK];
+		}
+		// The blocks following the one containing the last successor are lost
+		tail[x] = address;
+		size[x] = length;
+	}
+
+	/** Returns an immutable view of this mutable graph, sorting and deduplicating successor lists using all available processors.
+	 *
+	 * @return an immutable view of this mutable graph.
+	 * @see #immutableView(int)
+	 */
+	public ImmutableGraph immutableView() {
+		return immutableView(0);
+	}
+
+	/** Returns an immutable view of this mutable graph.
+	 *
+	 * <p>Successor lists of nodes to which arcs have been added since the last call are sorted and deduplicated in parallel.
+	 * The view can be used until this mutable graph is modified; after modification, a new call to this method will
+	 * return a new immutable view.
+	 *
+	 * @param numberOfThreads the number of threads to use; if 0 or negative, it will be replaced by {@link Runtime#availableProcessors()}.
+	 * @return an immutable view of this mutable graph.
+	 */
+	public synchronized ImmutableGraph immutableView(int numberOfThreads) {
+		final boolean[] dirty = new boolean[stripe.length];
+		boolean modified = immutableView == null;
+		for(int i = stripe.length; i-- != 0;) synchronized(stripe[i]) {
+			dirty[i] = stripe[i].dirty;
+			stripe[i].dirty = false;
+			modified |= dirty[i];
+		}
+		if (! modified) return immutableView;
+
+		if (numberOfThreads <= 0) numberOfThreads = Runtime.getRuntime().availableProcessors();
+		final ExecutorService executorService = Executors.newFixedThreadPool(numberOfThreads, new ThreadFactoryBuilder().setNameFormat("ProcessingThread-%d").build());
+		final ExecutorCompletionService<Long> executorCompletionService = new ExecutorCompletionService<>(executorService);
+		final AtomicInteger nextNode = new AtomicInteger();
+		final int granularity = 1 << 16;
+
+		for(int t = numberOfThreads; t-- != 0;) executorCompletionService.submit(() -> {
+			int[] a = IntArrays.EMPTY_ARRAY;
+			long arcs = 0;
+			for(int from; (from = nextNode.getAndAdd(granularity)) < n;) {
+				final int to = (int)Math.min(n, (long)from + granularity);
+				for(int x = from; x < to; x++) {
+					if (dirty[x & stripeMask] && size[x] > 1) {
+						final int d = size[x];
+						a = IntArrays.grow(a, d, 0);
+						copySuccessors(x, a);
+						IntArrays.quickSort(a, 0, d);
+						int k = 1;
+						for(int i = 1; i < d; i++) if (a[i] != a[k - 1]) a[k++] = a[i];
+						if (k != d) writeSuccessors(x, a, k);
+					}
+					arcs += size[x];
+				}
+			}
+			return Long.valueOf(arcs);
+		});
+
+		long arcs = 0;
+		Throwable problem = null;
+		for(int t = numberOfThreads; t-- != 0;)
+			try {
+				arcs += executorCompletionService.take().get().longValue();
+			}
+		catch(final Exception e) {
+			problem = e.getCause(); // We keep only the last one. They will be logged anyway.
+		}
+
+		executorService.shutdown();
+		if (problem != null) {
+			Throwables.throwIfUnchecked(problem);
+			throw new RuntimeException(problem);
+		}
+
+		m = arcs;
+		return immutableView = new ImmutableView(this);
+	}
+
+	private static final class ImmutableView extends ImmutableGraph {
+		/** The exposed mutable graph. */
+		private final ConcurrentMutableGraph g;
+		/** Cached number of nodes. */
+		private final int n;
+		/** Cached number of arcs. */
+		private final long m;
+
+		public ImmutableView(final ConcurrentMutableGraph g) {
+			this.g = g;
+			this.n = g.n;
+			this.m = g.m;
+		}
+
+		@Override
+		public ImmutableView copy() {
+			return this;
+		}
+
+		@Override
+		public int numNodes() {
+			return n;
+		}
+
+		@Override
+		public long numArcs() {
+			return m;
+		}
+
+		@Override
+		public boolean randomAccess() {
+			return true;
+		}
+
+		@Override
+		public int outdegree(final int x) {
+			return g.size[x];
+		}
+
+		@Override
+		public int[] successorArray(final int x) {
+			final int[] a = new int[g.size[x]];
+			g.copySuccessors(x, a);
+			return a;
+		}
+
+		@Override
+		public LazyIntIterator successors(final int x) {
+			final Stripe s = g.stripe[x & g.stripeMask];
+			return new LazyIntIterator() {
+				/** The number of successors still to be returned. */
+				private int d = g.size[x];
+				/** The current block. */
+				private int[] chunk = d == 0 ? null : s.chunk[g.head[x] >>> LOG2_CHUNK_SIZE];
+				/** The position in {@link #chunk} of the next successor. */
+				private int pos = d == 0 ? 0 : (g.head[x] & CHUNK_MASK) + 1;
+				/** The number of successors still to be returned from the current block. */
+				private int left = Math.min(d, blockSize(0));
+				/** The index of the current block. */
+				private int block;
+
+				@Override
+				public int nextInt() {
+					if (d == 0) return -1;
+					if (left == 0) {
+						final int next = chunk[pos - blockSize(block) - 1];
+						chunk = s.chunk[next >>> LOG2_CHUNK_SIZE];
+						pos = (next & CHUNK_MASK) + 1;
+						left = Math.min(d, blockSize(++block));
+					}
+					d--;
+					left--;
+					return chunk[pos++];
+				}
+
+				@Override
+				public int skip(final int k) {
+					int i;
+					for(i = 0; i < k && nextInt() != -1; i++);
+					return i;
+				}
+			};
+		}
+	}
+}
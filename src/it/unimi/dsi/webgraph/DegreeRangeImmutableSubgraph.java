@@ -20,6 +20,7 @@ package it.unimi.dsi.webgraph;
 import java.io.IOException;
 
 import it.unimi.dsi.fastutil.ints.IntArrayList;
+import it.unimi.dsi.fastutil.ints.IntIterator;
 import it.unimi.dsi.lang.ObjectParser;
 
 /** A subclass of {@link ImmutableSubgraph} exposing the subgraph formed by nodes whose outdegree is in a given range.
@@ -32,10 +33,10 @@ public class DegreeRangeImmutableSubgraph extends ImmutableSubgraph {
 	protected static int[] createMap(final ImmutableGraph graph, final int minDegree, final int maxDegree) {
 		final IntArrayList map = new IntArrayList();
 		final int n = graph.numNodes();
-		final NodeIterator nodeIterator = graph.nodeIterator();
+		// Graphs with an outdegree index (e.g., BVGraph) do not need a scan
+		final IntIterator outdegrees = graph.outdegrees();
 		for(int i = 0; i < n; i++) {
-			nodeIterator.nextInt();
-			final int d = nodeIterator.outdegree();
+			final int d = outdegrees.nextInt();
 			if (d >= minDegree && d < maxDegree) map.add(i);
 		}
 		return map.toIntArray();
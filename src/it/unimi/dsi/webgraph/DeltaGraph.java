@@ -0,0 +1,498 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import java.io.File;
+import java.io.IOException;
+import java.nio.file.Files;
+import java.nio.file.StandardCopyOption;
+
+import it.unimi.dsi.bits.Fast;
+import it.unimi.dsi.fastutil.ints.IntArrayList;
+import it.unimi.dsi.fastutil.ints.IntArrays;
+import it.unimi.dsi.fastutil.longs.LongArrays;
+import it.unimi.dsi.logging.ProgressLogger;
+
+/** A dynamic graph made of an immutable random-access base graph (typically, a {@link BVGraph}) and of a
+ * delta layer recording arc insertions and deletions.
+ *
+ * <p>Arcs can be {@linkplain #addArc(int, int) added} and {@linkplain #removeArc(int, int) removed} at any time, also concurrently
+ * by several threads, and they are immediately visible to queries. For each node, insertions and deletions are first
+ * appended to a small unsorted buffer, which is compacted, when it becomes large or when the successors of the node are requested,
+ * into two sorted runs of inserted and deleted successors. {@link #successors(int)} merges lazily the successors
+ * of the base graph, minus the deleted ones, with the inserted successors, much like a {@link MergedIntIterator}. Nodes
+ * without modifications are served directly by the base graph.
+ *
+ * <p>When the delta layer becomes too large, {@link #compact(CharSequence, int, ProgressLogger)} writes a new {@link BVGraph}
+ * merging the base graph and the current delta layer, and then replaces the base graph with the new one. Compaction can
+ * run in a background thread: in the meanwhile, the delta layer is frozen and modifications are recorded in a new delta layer, so
+ * queries and modifications can continue undisturbed.
+ *
+ * <p>As usual, instances of this class are not thread-safe when it comes to queries; however, {@linkplain #copy() copies} share
+ * the same delta layer, so each querying thread can use its own copy. The number of arcs is not available.
+ *
+ * <p>Loops and duplicate insertions are allowed; inserting an arc that is already present has no effect.
+ */
+
+public class DeltaGraph extends ImmutableGraph {
+	/** The size of the buffer of pending modifications of a node that triggers its compaction into sorted runs. */
+	private static final int MAX_PENDING = 64;
+
+	/** A base graph and a frozen delta layer; replaced atomically by compaction. */
+	private static final class Generation {
+		/** The base graph. */
+		private final ImmutableGraph base;
+		/** The sorted successors inserted in the frozen delta layer, or {@code null}. */
+		private final int[][] inserted;
+		/** The sorted successors deleted in the frozen delta layer, or {@code null}. */
+		private final int[][] deleted;
+
+		private Generation(final ImmutableGraph base, final int[][] inserted, final int[][] deleted) {
+			this.base = base;
+			this.inserted = inserted;
+			this.deleted = deleted;
+		}
+	}
+
+	/** The state shared by all copies. */
+	private static final class State {
+		/** The number of nodes. */
+		private final int n;
+		/** The current generation; accessed under the lock of the stripe of a node when reading its frozen delta layer. */
+		private volatile Generation generation;
+		/** The locks guarding the delta layers of nodes, indexed by the lower bits of a node. */
+		private final Object[] lock;
+		/** The mask extracting from a node the index of its lock. */
+		private final int lockMask;
+		/** For each node, the sorted successors inserted in the current delta layer, or {@code null}. */
+		private final int[][] inserted;
+		/** For each node, the sorted successors deleted in the current delta layer, or {@code null}. */
+		private final int[][] deleted;
+		/** For each node, the modifications not yet compacted, or {@code null}: <var>y</var> is an insertion, and
+		 * <code>~</code><var>y</var> a deletion. */
+		private final IntArrayList[] pending;
+
+		private State(final ImmutableGraph base, final int n) {
+			this.n = n;
+			generation = new Generation(base, null, null);
+			lock = new Object[1 << Fast.ceilLog2(16 * Runtime.getRuntime().availableProcessors())];
+			for(int i = lock.length; i-- != 0;) lock[i] = new Object();
+			lockMask = lock.length - 1;
+			inserted = new int[n][];
+			deleted = new int[n][];
+			pending = new IntArrayList[n];
+		}
+
+		/** Compacts the pending modifications of a node into its sorted runs; the caller must hold the lock of the node.
+		 *
+		 * @param x a node.
+		 */
+		private void compactPending(final int x) {
+			final IntArrayList p = pending[x];
+			if (p == null) return;
+			pending[x] = null;
+			final int size = p.size();
+			final int[] a = p.elements();
+			// Sort by successor, then by time, so that the last modification of each successor comes last
+			final long[] key = new long[size];
+			for(int i = size; i-- != 0;) key[i] = (long)(a[i] < 0 ? ~a[i] : a[i]) << 32 | i;
+			LongArrays.quickSort(key);
+			final int[] add = new int[size], remove = new int[size];
+			int adds = 0, removes = 0;
+			for(int i = 0; i < size; i++) {
+				if (i < size - 1 && key[i] >>> 32 == key[i + 1] >>> 32) continue;
+				final int op = a[(int)key[i]];
+				if (op >= 0) add[adds++] = op;
+				else remove[removes++] = ~op;
+			}
+			inserted[x] = apply(inserted[x], remove, removes, add, adds);
+			deleted[x] = apply(deleted[x], add, adds, remove, removes);
+		}
+	}
+
+	/** The shared state. */
+	private final State state;
+	/** The generation {@link #base} refers to. */
+	private Generation generation;
+	/** A copy of the base graph of {@link #generation} local to this instance. */
+	private ImmutableGraph base;
+
+	/** Creates a new dynamic graph with no modifications and the same number of nodes of a base graph.
+	 *
+	 * @param base a random-access base graph.
+	 */
+	public DeltaGraph(final ImmutableGraph base) {
+		this(base, base.numNodes());
+	}
+
+	/** Creates a new dynamic graph with no modifications.
+	 *
+	 * @param base a random-access base graph.
+	 * @param numNodes the number of nodes, which must be at least as large as the number of nodes of {@code base};
+	 * additional nodes have no successors in the base graph.
+	 */
+	public DeltaGraph(final ImmutableGraph base, final int numNodes) {
+		if (! base.randomAccess()) throw new IllegalArgumentException("The base graph must provide random access");
+		if (numNodes < base.numNodes()) throw new IllegalArgumentException("The number of nodes (" + numNodes + ") is smaller than the number of nodes of the base graph (" + base.numNodes() + ")");
+		state = new State(base, numNodes);
+		generation = state.generation;
+		this.base = base;
+	}
+
+	private DeltaGraph(final DeltaGraph g) {
+		state = g.state;
+		generation = state.generation;
+		base = generation.base.copy();
+	}
+
+	/** Returns the union of a sorted run minus a sorted array fragment with another sorted array fragment.
+	 *
+	 * @param run a sorted run, or {@code null} (meaning an empty run).
+	 * @param remove a sorted array of elements to be removed from {@code run}.
+	 * @param removes the number of valid elements of {@code remove}.
+	 * @param add a sorted array of elements to be added to {@code run}, disjoint from {@code remove}.
+	 * @param adds the number of valid elements of {@code add}.
+	 * @return the resulting run, or {@code null} if it is empty.
+	 */
+	private static int[] apply(final int[] run, final int[] remove, final int removes, final int[] add, final int adds) {
+		final int length = run == null ? 0 : run.length;
+		final int[] result = new int[length + adds];
+		int i = 0, j = 0, k = 0, r = 0;
+		while(i < length || k < adds) {
+			if (k == adds || i < length && run[i] < add[k]) {
+				final int y = run[i++];
+				while(j < removes && remove[j] < y) j++;
+				if (j == removes || remove[j] != y) result[r++] = y;
+			}
+			else {
+				if (i < length && run[i] == add[k]) i++;
+				result[r++] = add[k++];
+			}
+		}
+		return r == 0 ? null : r == result.length ? result : IntArrays.trim(result, r);
+	}
+
+	/** Returns a lazy iterator over the successors returned by a lazy iterator, minus a sorted run, plus another sorted run.
+	 *
+	 * @param successors a lazy iterator returning successors in increasing order.
+	 * @param inserted a sorted run of inserted successors, or {@code null}.
+	 * @param deleted a sorted run of deleted successors, or {@code null}.
+	 * @return a lazy iterator over the modified successors.
+	 */
+	private static LazyIntIterator delta(final LazyIntIterator successors, final int[] inserted, final int[] deleted) {
+		if (inserted == null && deleted == null) return successors;
+		return new AbstractLazyIntIterator() {
+			/** The next element of {@code successors} not in {@code deleted}, or -1. */
+			private int next = advance();
+			/** The position of the next element of {@code inserted}. */
+			private int i;
+			/** The position of the next candidate element of {@code deleted}. */
+			private int j;
+
+			private int advance() {
+				for(;;) {
+					final int y = successors.nextInt();
+					if (y == -1 || deleted == null) return y;
+					while(j < deleted.length && deleted[j] < y) j++;
+					if (j == deleted.length || deleted[j] != y) return y;
+				}
+			}
+
+			@Override
+			public int nextInt() {
+				final int insertedNext = inserted == null || i == inserted.length ? -1 : inserted[i];
+				if (insertedNext == -1 || next != -1 && next < insertedNext) {
+					final int result = next;
+					if (result != -1) next = advance();
+					return result;
+				}
+				if (next == insertedNext) next = advance();
+				i++;
+				return insertedNext;
+			}
+		};
+	}
+
+	@Override
+	public int numNodes() {
+		return state.n;
+	}
+
+	@Override
+	public boolean randomAccess() {
+		return true;
+	}
+
+	@Override
+	public DeltaGraph copy() {
+		return new DeltaGraph(this);
+	}
+
+	/** Guarantees that a node index is valid.
+	 *
+	 * @param x a node index.
+	 */
+	protected void ensureNode(final int x) {
+		if (x < 0) throw new IllegalArgumentException("Illegal node index " + x);
+		if (x >= state.n) throw new IllegalArgumentException("Node index " + x + " is larger than graph order (" + state.n + ")");
+	}
+
+	/** Records a modification.
+	 *
+	 * @param x a node.
+	 * @param op the modification.
+	 */
+	private void modify(final int x, final int op) {
+		synchronized(state.lock[x & state.lockMask]) {
+			IntArrayList p = state.pending[x];
+			if (p == null) p = state.pending[x] = new IntArrayList(4);
+			p.add(op);
+			if (p.size() >= MAX_PENDING) state.compactPending(x);
+		}
+	}
+
+	/** Adds an arc. This method can be called concurrently by several threads.
+	 *
+	 * @param x the start of the arc.
+	 * @param y the end of the arc.
+	 */
+	public void addArc(final int x, final int y) {
+		ensureNode(x);
+		ensureNode(y);
+		modify(x, y);
+	}
+
+	/** Removes an arc. This method can be called concurrently by several threads.
+	 *
+	 * <p>Removing an arc that is not present has no effect.
+	 *
+	 * @param x the start of the arc.
+	 * @param y the end of the arc.
+	 */
+	public void removeArc(final int x, final int y) {
+		ensureNode(x);
+		ensureNode(y);
+		modify(x, ~y);
+	}
+
+	/** Updates, if necessary, the local copy of the base graph.
+	 *
+	 * @param g the current generation.
+	 */
+	private void refresh(final Generation g) {
+		if (g != generation) {
+			generation = g;
+			base = g.base.copy();
+		}
+	}
+
+	@Override
+	public LazyIntIterator successors(final int x) {
+		ensureNode(x);
+		final Generation g;
+		final int[] frozenInserted, frozenDeleted, inserted, deleted;
+		synchronized(state.lock[x & state.lockMask]) {
+			state.compactPending(x);
+			g = state.generation;
+			frozenInserted = g.inserted == null ? null : g.inserted[x];
+			frozenDeleted = g.deleted == null ? null : g.deleted[x];
+			inserted = state.inserted[x];
+			deleted = state.deleted[x];
+		}
+		refresh(g);
+		final LazyIntIterator s = x < base.numNodes() ? base.successors(x) : LazyIntIterators.EMPTY_ITERATOR;
+		return delta(delta(s, frozenInserted, frozenDeleted), inserted, deleted);
+	}
+
+	@Override
+	public int outdegree(final int x) {
+		ensureNode(x);
+		final Generation g;
+		final boolean modified;
+		synchronized(state.lock[x & state.lockMask]) {
+			g = state.generation;
+			modified = state.pending[x] != null || state.inserted[x] != null || state.deleted[x] != null
+					|| g.inserted != null && (g.inserted[x] != null || g.deleted[x] != null);
+		}
+		if (modified) {
+			final LazyIntIterator successors = successors(x);
+			int d = 0;
+			while(successors.nextInt() != -1) d++;
+			return d;
+		}
+		refresh(g);
+		return x < base.numNodes() ? base.outdegree(x) : 0;
+	}
+
+	@Override
+	public int[] successorArray(final int x) {
+		return LazyIntIterators.unwrap(successors(x));
+	}
+
+	/** A random-access view of a generation, that is, of a base graph modified by a frozen delta layer. */
+	private static final class GenerationGraph extends ImmutableGraph {
+		private final Generation generation;
+		private final ImmutableGraph base;
+		private final int n;
+
+		private GenerationGraph(final Generation generation, final int n) {
+			this.generation = generation;
+			this.base = generation.base;
+			this.n = n;
+		}
+
+		private GenerationGraph(final GenerationGraph g) {
+			generation = g.generation;
+			base = g.base.copy();
+			n = g.n;
+		}
+
+		@Override
+		public int numNodes() {
+			return n;
+		}
+
+		@Override
+		public boolean randomAccess() {
+			return true;
+		}
+
+		@Override
+		public GenerationGraph copy() {
+			return new GenerationGraph(this);
+		}
+
+		@Override
+		public LazyIntIterator successors(final int x) {
+			final LazyIntIterator s = x < base.numNodes() ? base.successors(x) : LazyIntIterators.EMPTY_ITERATOR;
+			return delta(s, generation.inserted[x], generation.deleted[x]);
+		}
+
+		@Override
+		public int outdegree(final int x) {
+			if (generation.inserted[x] == null && generation.deleted[x] == null) return x < base.numNodes() ? base.outdegree(x) : 0;
+			return LazyIntIterators.unwrap(successors(x)).length;
+		}
+	}
+
+	/** Compacts the current delta layer into a new {@link BVGraph}, which replaces the base graph.
+	 *
+	 * <p>This method freezes the current delta layer, stores (in parallel) the base graph modified by the frozen delta layer,
+	 * loads the result in {@linkplain ImmutableGraph#loadMapped(CharSequence) mapped} form and makes it the new base graph.
+	 * Queries and modifications can be performed during compaction; in particular, this method can be called in a background thread.
+	 * Compactions of the same graph are serialized. If the base graph is a {@link BVGraph}, all its compression parameters
+	 * (window size, maximum reference count, minimum interval length, &zeta; <var>k</var> and compression flags) are used for compression;
+	 * otherwise, the {@link BVGraph} defaults are used.
+	 *
+	 * <p>The new base graph cannot have the same basename as the current one, as the current base graph is read
+	 * while the new one is written; alternating two basenames is the standard way to compact repeatedly. Copies and iterators
+	 * might however still use an older base graph with the same basename (e.g., a copy on which no method has been called
+	 * since two compactions): to avoid modifying files that are still mapped, the new base graph is written under temporary names
+	 * in the same directory, and then its files are moved in place, replacing the old ones, which are thus deleted only when they are no longer
+	 * mapped. This approach requires an operating system in which files in use can be replaced (e.g., a POSIX system); otherwise,
+	 * this method will throw an exception, and all copies and iterators must be discarded before compacting again onto the same basename.
+	 *
+	 * @param basename the basename of the new base graph.
+	 * @param numberOfThreads the number of threads to use; if 0 or negative, it will be replaced by {@link Runtime#availableProcessors()}.
+	 * @param pl a progress logger, or {@code null}.
+	 * @throws IllegalArgumentException if {@code basename} is the basename of the current base graph.
+	 */
+	public void compact(final CharSequence basename, final int numberOfThreads, final ProgressLogger pl) throws IOException {
+		synchronized(state) {
+			final int n = state.n;
+			final Generation old = state.generation;
+			if (sameBasename(old.base, basename)) throw new IllegalArgumentException("Cannot compact onto the basename of the current base graph (" + basename + ")");
+			final Generation frozen = new Generation(old.base, new int[n][], new int[n][]);
+			state.generation = frozen;
+
+			// We move, node by node, the current delta layer into the frozen one
+			for(int l = 0; l < state.lock.length; l++) {
+				synchronized(state.lock[l]) {
+					for(int x = l; x < n; x += state.lock.length) {
+						state.compactPending(x);
+						frozen.inserted[x] = state.inserted[x];
+						frozen.deleted[x] = state.deleted[x];
+						state.inserted[x] = state.deleted[x] = null;
+					}
+				}
+			}
+
+			final File target = new File(basename.toString()).getAbsoluteFile();
+			final File temp = File.createTempFile(target.getName() + "-compaction", "-tmp", target.getParentFile());
+			try {
+				if (old.base instanceof BVGraph) {
+					final BVGraph bv = (BVGraph)old.base;
+					BVGraph.store(new GenerationGraph(frozen, n), temp.toString(), bv.windowSize(), bv.maxRefCount(), bv.minIntervalLength(), bv.zetaK(), bv.flags(), numberOfThreads, pl);
+				}
+				else BVGraph.store(new GenerationGraph(frozen, n), temp.toString(), -1, -1, -1, -1, 0, numberOfThreads, pl);
+				moveInPlace(temp, target);
+			}
+			finally {
+				for(final String extension : EXTENSIONS) new File(temp + extension).delete();
+				temp.delete();
+			}
+			state.generation = new Generation(ImmutableGraph.loadMapped(basename, pl), null, null);
+		}
+	}
+
+	/** The extensions of the files of a {@link BVGraph}, including ancillary files. */
+	private static final String[] EXTENSIONS = { BVGraph.GRAPH_EXTENSION, BVGraph.OFFSETS_EXTENSION, BVGraph.OFFSETS_ELIAS_FANO_EXTENSION, PROPERTIES_EXTENSION,
+			BVGraph.OFFSETS_BIG_LIST_EXTENSION, BVGraph.OUTDEGREES_EXTENSION, GraphSketch.SKETCH_EXTENSION, OutdegreeIndex.OUTDEGREE_INDEX_EXTENSION };
+
+	/** Moves the files of a graph to a new basename, replacing existing files and deleting files with the new basename
+	 * that do not correspond to a file of the graph (e.g., stale ancillary files).
+	 *
+	 * <p>Files are replaced by renaming, so graphs still mapping the old files (e.g., copies using an older base graph) can keep reading them.
+	 *
+	 * @param source the basename of the graph.
+	 * @param target the new basename.
+	 */
+	private static void moveInPlace(final File source, final File target) throws IOException {
+		for(final String extension : EXTENSIONS) {
+			final File from = new File(source + extension), to = new File(target + extension);
+			if (from.exists()) Files.move(from.toPath(), to.toPath(), StandardCopyOption.REPLACE_EXISTING, StandardCopyOption.ATOMIC_MOVE);
+			else to.delete();
+		}
+	}
+
+	/** Returns whether a graph has a given basename.
+	 *
+	 * @param graph a graph.
+	 * @param basename a basename.
+	 * @return whether the basename of {@code graph} denotes the same file as {@code basename}; false if {@code graph} has no basename.
+	 */
+	private static boolean sameBasename(final ImmutableGraph graph, final CharSequence basename) throws IOException {
+		final CharSequence graphBasename;
+		try {
+			graphBasename = graph.basename();
+		}
+		catch(final UnsupportedOperationException e) {
+			return false;
+		}
+		return graphBasename != null && new File(graphBasename.toString()).getCanonicalFile().equals(new File(basename.toString()).getCanonicalFile());
+	}
+
+	/** Compacts the current delta layer into a new {@link BVGraph} using all available processors.
+	 *
+	 * @param basename the basename of the new base graph.
+	 * @see #compact(CharSequence, int, ProgressLogger)
+	 */
+	public void compact(final CharSequence basename) throws IOException {
+		compact(basename, 0, null);
+	}
+}
@@ -820,6 +820,8 @@ public class EFGraph extends ImmutableGraph {
 		final OutputBitStream offsets = new OutputBitStream(basename + OFFSETS_EXTENSION);
 
 		long numberOfArcs = 0;
+		final long fingerprintKey = GraphFingerprint.storeKey();
+		long fingerprint0 = 0, fingerprint1 = 0;
 		long bitsForOutdegrees = 0;
 		long bitsForSuccessors = 0;
 		offsets.writeLongDelta(0);
@@ -834,7 +836,7 @@ public class EFGraph extends ImmutableGraph {
 		}
 
 		for (final NodeIterator nodeIterator = graph.nodeIterator(); nodeIterator.hasNext();) {
-			nodeIterator.nextInt();
+			final int x = nodeIterator.nextInt();
 			final long outdegree = nodeIterator.outdegree();
 			numberOfArcs += outdegree;
 			long lastSuccessor = 0;
@@ -844,6 +846,8 @@ public class EFGraph extends ImmutableGraph {
 			final LazyIntIterator successors = nodeIterator.successors();
 			for (long successor; (successor = successors.nextInt()) != -1;) {
 				successorsAccumulator.add(successor - lastSuccessor);
+				fingerprint0 += GraphFingerprint.hash0(fingerprintKey, x, (int)successor);
+				fingerprint1 += GraphFingerprint.hash1(fingerprintKey, x, (int)successor);
 				lastSuccessor = successor;
 			}
 
@@ -881,6 +885,7 @@ public class EFGraph extends ImmutableGraph {
 		properties.setProperty("avgbitsforoutdegrees", format.format((double)bitsForOutdegrees / n));
 		properties.setProperty("bitsforoutdegrees", Long.toString(bitsForOutdegrees));
 		properties.setProperty("bitsforsuccessors", Long.toString(bitsForSuccessors));
+		GraphFingerprint.setProperties(properties, fingerprintKey, n, fingerprint0, fingerprint1);
 		properties.setProperty(ImmutableGraph.GRAPHCLASS_PROPERTY_KEY, EFGraph.class.getName());
 		properties.setProperty("version", String.valueOf(EFGRAPH_VERSION));
 		final FileOutputStream propertyFile = new FileOutputStream(basename + PROPERTIES_EXTENSION);
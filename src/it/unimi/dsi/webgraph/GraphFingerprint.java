@@ -0,0 +1,357 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.IOException;
+import java.lang.reflect.InvocationTargetException;
+import java.util.Properties;
+import java.util.concurrent.ExecutorCompletionService;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import com.google.common.base.Throwables;
+import com.google.common.util.concurrent.ThreadFactoryBuilder;
+import com.martiansoftware.jsap.FlaggedOption;
+import com.martiansoftware.jsap.JSAP;
+import com.martiansoftware.jsap.JSAPException;
+import com.martiansoftware.jsap.JSAPResult;
+import com.martiansoftware.jsap.Parameter;
+import com.martiansoftware.jsap.SimpleJSAP;
+import com.martiansoftware.jsap.Switch;
+import com.martiansoftware.jsap.UnflaggedOption;
+
+import it.unimi.dsi.Util;
+import it.unimi.dsi.fastutil.HashCommon;
+import it.unimi.dsi.logging.ProgressLogger;
+
+/** Static methods computing an order-independent 128-bit fingerprint of a graph.
+ *
+ * <p>The fingerprint of a graph is computed from its number of nodes and from its arcs: each arc
+ * is hashed using two independent 64-bit hash functions ({@link #hash0(long, int, int)} and {@link #hash1(long, int, int)}),
+ * and the hashes are summed modulo 2<sup>64</sup>. Both hash functions depend on a 64-bit <em>key</em>: fingerprints
+ * are comparable only if they have been computed using the same key. The key is not secret,
+ * so the fingerprint is a protection against accidental corruption, not against tampering. Since the fingerprint depends only on the decoded arcs,
+ * different representations of the same graph (e.g., a {@link BVGraph}, an {@link EFGraph} and an {@link ArcListASCIIGraph})
+ * have the same fingerprint, and since sums are commutative the fingerprint can be computed in parallel
+ * using {@link ImmutableGraph#splitNodeIterators(int)}.
+ *
+ * <p>{@link BVGraph} and {@link EFGraph} store the fingerprint of a graph in the property file at compression time
+ * under the key {@value #FINGERPRINT_PROPERTY_KEY}, and its key, in hexadecimal, under the key {@value #FINGERPRINT_KEY_PROPERTY_KEY},
+ * so the integrity of a copy can be verified by a single parallel scan (see the {@linkplain #main(String[]) main method}).
+ * The cost at compression time is two hash evaluations per arc, which is small compared with the cost
+ * of compressing the arc.
+ *
+ * <p>By default, stored fingerprints use the key {@value #DEFAULT_KEY}, so property files are deterministic and the stored fingerprints
+ * of different representations of the same graph can be compared directly. Setting the system property {@value #KEY_PROPERTY}
+ * to a key in hexadecimal, or to <code>random</code>, makes it possible to use a different key, or a random key chosen at each compression;
+ * in the latter case, it is difficult to build on purpose a different graph with the same fingerprint.
+ */
+
+public class GraphFingerprint {
+	private static final Logger LOGGER = LoggerFactory.getLogger(GraphFingerprint.class);
+
+	/** The property key for the fingerprint of a graph. */
+	public static final String FINGERPRINT_PROPERTY_KEY = "fingerprint";
+	/** The property key for the key of the fingerprint of a graph. */
+	public static final String FINGERPRINT_KEY_PROPERTY_KEY = "fingerprintkey";
+	/** The key of stored fingerprints, unless the system property {@value #KEY_PROPERTY} is set. */
+	public static final long DEFAULT_KEY = 0;
+	/** The system property used to set the key of stored fingerprints, in hexadecimal, or <code>random</code> for a random key. */
+	public static final String KEY_PROPERTY = "it.unimi.dsi.webgraph.fingerprintkey";
+
+	/** The seeds of the two arc hashes. */
+	private static final long SEED0 = 0x9E3779B97F4A7C15L, SEED1 = 0xC2B2AE3D27D4EB4FL;
+
+	private GraphFingerprint() {}
+
+	/** Returns the first hash of an arc.
+	 *
+	 * @param key the key of the fingerprint.
+	 * @param x the source of the arc.
+	 * @param y the target of the arc.
+	 * @return the first hash of the arc from {@code x} to {@code y}.
+	 */
+	public static long hash0(final long key, final int x, final int y) {
+		return HashCommon.murmurHash3(((long)x << 32 | y) ^ key ^ SEED0);
+	}
+
+	/** Returns the second hash of an arc.
+	 *
+	 * @param key the key of the fingerprint.
+	 * @param x the source of the arc.
+	 * @param y the target of the arc.
+	 * @return the second hash of the arc from {@code x} to {@code y}.
+	 */
+	public static long hash1(final long key, final int x, final int y) {
+		return HashCommon.murmurHash3(((long)x << 32 | y) ^ key ^ SEED1);
+	}
+
+	/** Returns a new random key.
+	 *
+	 * @return a new random key.
+	 */
+	public static long randomKey() {
+		return Util.randomSeed();
+	}
+
+	/** Returns the key that should be used to store a fingerprint at compression time.
+	 *
+	 * @return {@link #DEFAULT_KEY}, or the key specified by the system property {@value #KEY_PROPERTY}, if set.
+	 */
+	static long storeKey() {
+		final String key = System.getProperty(KEY_PROPERTY);
+		if (key == null) return DEFAULT_KEY;
+		return "random".equals(key) ? randomKey() : Long.parseUnsignedLong(key, 16);
+	}
+
+	/** Returns the fingerprint of a graph given its number of nodes and the sums of the hashes of its arcs.
+	 *
+	 * @param numNodes the number of nodes.
+	 * @param sum0 the sum of {@link #hash0(long, int, int)} over all arcs.
+	 * @param sum1 the sum of {@link #hash1(long, int, int)} over all arcs.
+	 * @return the fingerprint, as a string of 32 hexadecimal digits.
+	 */
+	public static String toString(final long numNodes, final long sum0, final long sum1) {
+		return String.format("%016x%016x", Long.valueOf(sum0 + HashCommon.murmurHash3(numNodes ^ ~SEED0)), Long.valueOf(sum1 + HashCommon.murmurHash3(numNodes ^ ~SEED1)));
+	}
+
+	/** Returns the sums of the hashes of the arcs of a graph given its fingerprint and its number of nodes; this method
+	 * is the inverse of {@link #toString(long, long, long)}, and makes it possible to update a fingerprint incrementally.
+	 *
+	 * @param fingerprint a fingerprint, as a string of 32 hexadecimal digits.
+	 * @param numNodes the number of nodes.
+	 * @return an array containing the sum of {@link #hash0(long, int, int)} and {@link #hash1(long, int, int)} over all arcs.
+	 */
+	static long[] sums(final String fingerprint, final long numNodes) {
+		if (fingerprint.length() != 32) throw new IllegalArgumentException("Illegal fingerprint: " + fingerprint);
+		return new long[] {
+				Long.parseUnsignedLong(fingerprint.substring(0, 16), 16) - HashCommon.murmurHash3(numNodes ^ ~SEED0),
+				Long.parseUnsignedLong(fingerprint.substring(16), 16) - HashCommon.murmurHash3(numNodes ^ ~SEED1)
+		};
+	}
+
+	/** Computes the fingerprint of a graph using all available processors.
+	 *
+	 * @param graph a graph.
+	 * @param key the key of the fingerprint.
+	 * @return the fingerprint of {@code graph}, as a string of 32 hexadecimal digits.
+	 */
+	public static String compute(final ImmutableGraph graph, final long key) {
+		return compute(graph, key, 0, null);
+	}
+
+	/** Computes the fingerprint of a graph.
+	 *
+	 * @param graph a graph.
+	 * @param key the key of the fingerprint.
+	 * @param numberOfThreads the number of threads to use; if 0 or negative, it will be replaced by {@link Runtime#availableProcessors()}.
+	 * @param pl a progress logger, or {@code null}.
+	 * @return the fingerprint of {@code graph}, as a string of 32 hexadecimal digits.
+	 */
+	public static String compute(final ImmutableGraph graph, final long key, final int numberOfThreads, final ProgressLogger pl) {
+		final long[] sums = sums(graph, key, numberOfThreads, false, pl);
+		return toString(graph.numNodes(), sums[0], sums[1]);
+	}
+
+	/** Stores the fingerprint of a graph and its key in a property set.
+	 *
+	 * @param properties a property set.
+	 * @param key the key of the fingerprint.
+	 * @param numNodes the number of nodes.
+	 * @param sum0 the sum of {@link #hash0(long, int, int)} over all arcs.
+	 * @param sum1 the sum of {@link #hash1(long, int, int)} over all arcs.
+	 */
+	static void setProperties(final Properties properties, final long key, final long numNodes, final long sum0, final long sum1) {
+		properties.setProperty(FINGERPRINT_PROPERTY_KEY, toString(numNodes, sum0, sum1));
+		properties.setProperty(FINGERPRINT_KEY_PROPERTY_KEY, String.format("%016x", Long.valueOf(key)));
+	}
+
+	/** Returns the key of the fingerprint in a property set.
+	 *
+	 * @param properties a property set.
+	 * @return the key of the fingerprint in {@code properties}, or {@link #DEFAULT_KEY} if {@code properties} does not contain a key.
+	 */
+	static long key(final Properties properties) {
+		final String key = properties.getProperty(FINGERPRINT_KEY_PROPERTY_KEY);
+		return key == null ? DEFAULT_KEY : Long.parseUnsignedLong(key, 16);
+	}
+
+	/** Returns the fingerprint stored in the property file of a graph.
+	 *
+	 * @param basename the basename of a graph.
+	 * @return the fingerprint stored in the property file, or {@code null} if the property file does not exist or does
+	 * not contain a fingerprint.
+	 * @throws IOException if an exception is raised while reading the property file.
+	 */
+	public static String load(final CharSequence basename) throws IOException {
+		final Properties properties = loadProperties(basename);
+		return properties == null ? null : properties.getProperty(FINGERPRINT_PROPERTY_KEY);
+	}
+
+	/** Returns the key of the fingerprint stored in the property file of a graph.
+	 *
+	 * @param basename the basename of a graph.
+	 * @return the key of the fingerprint stored in the property file, or {@link #DEFAULT_KEY} if the property file does not exist or does
+	 * not contain a key.
+	 * @throws IOException if an exception is raised while reading the property file.
+	 */
+	public static long loadKey(final CharSequence basename) throws IOException {
+		final Properties properties = loadProperties(basename);
+		return properties == null ? DEFAULT_KEY : key(properties);
+	}
+
+	private static Properties loadProperties(final CharSequence basename) throws IOException {
+		final File propertyFile = new File(basename + ImmutableGraph.PROPERTIES_EXTENSION);
+		if (! propertyFile.exists()) return null;
+		final Properties properties = new Properties();
+		final FileInputStream propertyStream = new FileInputStream(propertyFile);
+		properties.load(propertyStream);
+		propertyStream.close();
+		return properties;
+	}
+
+	/** Sums two hashes of all arcs, and possibly of all reversed arcs, in parallel.
+	 *
+	 * @param graph a graph.
+	 * @param key the key of the hashes.
+	 * @param numberOfThreads the number of threads to use; if 0 or negative, it will be replaced by {@link Runtime#availableProcessors()}.
+	 * @param reversed whether to compute also the sums for reversed arcs.
+	 * @param pl a progress logger, or {@code null}.
+	 * @return an array containing the sums of {@link #hash0(long, int, int)} and {@link #hash1(long, int, int)} over all arcs
+	 * and, if {@code reversed} is true, over all reversed arcs.
+	 */
+	static long[] sums(final ImmutableGraph graph, final long key, int numberOfThreads, final boolean reversed, final ProgressLogger pl) {
+		if (numberOfThreads <= 0) numberOfThreads = Runtime.getRuntime().availableProcessors();
+		if (numberOfThreads > 1 && ! graph.hasCopiableIterators()) {
+			LOGGER.warn("The graph does not provide copiable iterators: using just one thread");
+			numberOfThreads = 1;
+		}
+
+		final NodeIterator[] nodeIterator = numberOfThreads == 1 ? new NodeIterator[] { graph.nodeIterator() } : graph.splitNodeIterators(numberOfThreads);
+		final ExecutorService executorService = Executors.newFixedThreadPool(numberOfThreads, new ThreadFactoryBuilder().setNameFormat("ProcessingThread-%d").build());
+		final ExecutorCompletionService<long[]> executorCompletionService = new ExecutorCompletionService<>(executorService);
+
+		if (pl != null) {
+			pl.itemsName = "nodes";
+			try {
+				pl.expectedUpdates = graph.numNodes();
+			}
+			catch(final UnsupportedOperationException ignore) {}
+			pl.start("Computing arc fingerprints...");
+		}
+
+		int tasks = 0;
+		for(final NodeIterator i : nodeIterator) {
+			if (i == null) continue;
+			tasks++;
+			executorCompletionService.submit(() -> {
+				final long[] f = new long[reversed ? 4 : 2];
+				int updates = 0;
+				while(i.hasNext()) {
+					final int x = i.nextInt();
+					final int[] successor = i.successorArray();
+					for(int d = i.outdegree(); d-- != 0;) {
+						final int y = successor[d];
+						f[0] += hash0(key, x, y);
+						f[1] += hash1(key, x, y);
+						if (reversed) {
+							f[2] += hash0(key, y, x);
+							f[3] += hash1(key, y, x);
+						}
+					}
+					if (pl != null && (++updates & 0xFFFF) == 0) {
+						synchronized (pl) { pl.update(updates); }
+						updates = 0;
+					}
+				}
+				if (pl != null) synchronized (pl) { pl.update(updates); }
+				return f;
+			});
+		}
+
+		final long[] sums = new long[reversed ? 4 : 2];
+		Throwable problem = null;
+		for(int i = tasks; i-- != 0;)
+			try {
+				final long[] f = executorCompletionService.take().get();
+				for(int j = sums.length; j-- != 0;) sums[j] += f[j];
+			}
+		catch(final Exception e) {
+			problem = e.getCause(); // We keep only the last one. They will be logged anyway.
+		}
+
+		executorService.shutdown();
+		if (problem != null) {
+			Throwables.throwIfUnchecked(problem);
+			throw new RuntimeException(problem);
+		}
+
+		if (pl != null) pl.done();
+		return sums;
+	}
+
+	public static void main(final String arg[]) throws IllegalArgumentException, SecurityException, IllegalAccessException, InvocationTargetException, NoSuchMethodException, JSAPException, IOException {
+		final SimpleJSAP jsap = new SimpleJSAP(GraphFingerprint.class.getName(), "Computes the fingerprint of a graph and prints it on standard output. If --verify is specified, the fingerprint is computed with the key stored in the property file of the graph and checked against the stored fingerprint, and the exit code is 1 if they do not match.",
+				new Parameter[] {
+						new FlaggedOption("graphClass", GraphClassParser.getParser(), null, JSAP.NOT_REQUIRED, 'g', "graph-class", "Forces a Java class for the source graph."),
+						new FlaggedOption("logInterval", JSAP.LONG_PARSER, Long.toString(ProgressLogger.DEFAULT_LOG_INTERVAL), JSAP.NOT_REQUIRED, 'l', "log-interval", "The minimum time interval between activity logs in milliseconds."),
+						new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "0", JSAP.NOT_REQUIRED, 't', "threads", "The number of threads (0 for the number of available processors)."),
+						new FlaggedOption("key", JSAP.STRING_PARSER, Long.toHexString(DEFAULT_KEY), JSAP.NOT_REQUIRED, 'k', "key", "The key of the fingerprint, in hexadecimal (ignored with --verify)."),
+						new Switch("verify", 'v', "verify", "Verify the fingerprint against the one stored in the property file."),
+						new UnflaggedOption("basename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The basename of the graph."),
+					}
+				);
+
+		final JSAPResult jsapResult = jsap.parse(arg);
+		if (jsap.messagePrinted()) System.exit(1);
+
+		final Class<?> graphClass = jsapResult.getClass("graphClass");
+		final String basename = jsapResult.getString("basename");
+		final int numberOfThreads = jsapResult.getInt("threads");
+
+		String stored = null;
+		long key = Long.parseUnsignedLong(jsapResult.getString("key"), 16);
+		if (jsapResult.getBoolean("verify")) {
+			stored = load(basename);
+			if (stored == null) {
+				System.err.println("No fingerprint stored for graph " + basename);
+				System.exit(1);
+			}
+			key = loadKey(basename);
+		}
+
+		final ProgressLogger pl = new ProgressLogger(LOGGER);
+		pl.logInterval = jsapResult.getLong("logInterval");
+		final ImmutableGraph graph;
+		if (graphClass != null) graph = (ImmutableGraph)graphClass.getMethod(numberOfThreads == 1 ? "loadOffline" : "loadMapped", CharSequence.class).invoke(null, basename);
+		else graph = numberOfThreads == 1 ? ImmutableGraph.loadOffline(basename, pl) : ImmutableGraph.loadMapped(basename, pl);
+
+		final String fingerprint = compute(graph, key, numberOfThreads, pl);
+		System.out.println(fingerprint);
+
+		if (stored != null && ! stored.equals(fingerprint)) {
+			System.err.println("Fingerprint mismatch: the property file contains " + stored);
+			System.exit(1);
+		}
+	}
+}
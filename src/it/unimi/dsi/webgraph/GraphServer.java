@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import java.io.Closeable;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.IOException;
+import java.net.InetAddress;
+import java.net.ServerSocket;
+import java.net.Socket;
+import java.net.SocketException;
+import java.util.Map;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.TimeUnit;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import com.google.common.util.concurrent.ThreadFactoryBuilder;
+import com.martiansoftware.jsap.FlaggedOption;
+import com.martiansoftware.jsap.JSAP;
+import com.martiansoftware.jsap.JSAPException;
+import com.martiansoftware.jsap.JSAPResult;
+import com.martiansoftware.jsap.Parameter;
+import com.martiansoftware.jsap.SimpleJSAP;
+import com.martiansoftware.jsap.UnflaggedOption;
+
+import it.unimi.dsi.fastutil.io.FastBufferedInputStream;
+import it.unimi.dsi.fastutil.io.FastBufferedOutputStream;
+import it.unimi.dsi.fastutil.objects.Object2ObjectLinkedOpenHashMap;
+import it.unimi.dsi.logging.ProgressLogger;
+
+/** A server keeping a set of graphs loaded and serving outdegrees, successor lists and arcs to
+ * {@link RemoteImmutableGraph} clients.
+ *
+ * <p>Loading a large graph is a costly operation that must be repeated by every process using the graph.
+ * A graph server loads a set of graphs once for all (by default, {@linkplain ImmutableGraph#loadMapped(CharSequence) memory-mapping them})
+ * and serves requests from any number of clients through a socket bound to the loopback interface. Clients open a
+ * {@link RemoteImmutableGraph}, which starts immediately, as it just needs to connect to the server, and does not use any
+ * memory for the graph.
+ *
+ * <p>Each connection is served by a separate thread using a {@linkplain ImmutableGraph#copy() copy} of the requested graph;
+ * graphs must thus provide random access. Requests are batched: a single request can ask
+ * for the outdegrees or the successor lists of an array of nodes, for the existence of an array of arcs, or for the successor lists of an interval of nodes;
+ * in the latter case, consecutive requests are served by the same {@linkplain ImmutableGraph#nodeIterator(int) node iterator},
+ * so sequential scans of a remote graph are as fast as sequential scans of the graph itself, modulo communication costs.
+ *
+ * <h2>Protocol</h2>
+ *
+ * <p>Data is exchanged in {@link java.io.DataOutput} format. The client sends the name of a graph
+ * (in {@linkplain java.io.DataOutput#writeUTF(String) modified UTF-8}), and the server replies with the
+ * number of nodes of the graph, as an integer (or &minus;1, if the graph is unknown), and with the number of arcs,
+ * as a long (or &minus;1, if the graph does not know its number of arcs). Then, the client sends requests,
+ * each starting with a byte:
+ * <ul>
+ * <li>{@link #OUTDEGREES}, followed by an integer <var>k</var> and by <var>k</var> nodes; the server replies with
+ * the <var>k</var> outdegrees;
+ * <li>{@link #SUCCESSORS}, followed by an integer <var>k</var> and by <var>k</var> nodes; the server replies with
+ * the <var>k</var> successor lists, each given by an outdegree followed by the successors;
+ * <li>{@link #ARCS}, followed by an integer <var>k</var> and by <var>k</var> pairs of nodes; the server replies with
+ * <var>k</var> booleans, telling whether each pair is an arc of the graph;
+ * <li>{@link #NODES}, followed by a node <var>x</var> and by an integer <var>k</var>; the server replies with
+ * the successor lists of the nodes from <var>x</var> (inclusive) to <var>x</var>&nbsp;+&nbsp;<var>k</var> (exclusive), as above;
+ * <li>{@link #CLOSE}, closing the connection.
+ * </ul>
+ *
+ * <p>The integer <var>k</var> must not be larger than {@link #MAX_REQUEST_SIZE}: clients must split larger requests. Invalid requests
+ * cause the server to close the connection.
+ *
+ * <p>The server performs no authentication, so by default it is bound to the loopback interface, and only processes
+ * running on the same host can connect to it.
+ */
+
+public class GraphServer implements Runnable, Closeable {
+	private static final Logger LOGGER = LoggerFactory.getLogger(GraphServer.class);
+
+	/** The default port. */
+	public static final int DEFAULT_PORT = 9797;
+	/** The request closing the connection. */
+	public static final byte CLOSE = 0;
+	/** The request for the outdegrees of an array of nodes. */
+	public static final byte OUTDEGREES = 1;
+	/** The request for the successor lists of an array of nodes. */
+	public static final byte SUCCESSORS = 2;
+	/** The request for the successor lists of an interval of nodes. */
+	public static final byte NODES = 3;
+	/** The request for the existence of an array of arcs. */
+	public static final byte ARCS = 4;
+	/** The maximum number of nodes (or arcs) in a request. */
+	public static final int MAX_REQUEST_SIZE = 1 << 20;
+
+	/** The served graphs, by name. */
+	private final Map<String, ? extends ImmutableGraph> graphs;
+	/** The server socket. */
+	private final ServerSocket serverSocket;
+	/** The service serving connections. */
+	private final ExecutorService executorService;
+
+	/** Creates a new graph server listening on the loopback interface.
+	 *
+	 * @param graphs a map from names to graphs providing random access.
+	 * @param port the port, or 0 to use an ephemeral port.
+	 */
+	public GraphServer(final Map<String, ? extends ImmutableGraph> graphs, final int port) throws IOException {
+		this(graphs, InetAddress.getLoopbackAddress(), port);
+	}
+
+	/** Creates a new graph server bound to a given address.
+	 *
+	 * <p><strong>Warning</strong>: the server performs no authentication, so binding it to an address other than
+	 * a loopback address makes the graphs available to anybody who can reach the address. This is
+	 * why the command-line tool always binds the server to the loopback interface.
+	 *
+	 * @param graphs a map from names to graphs providing random access.
+	 * @param address the address the server will be bound to.
+	 * @param port the port, or 0 to use an ephemeral port.
+	 */
+	public GraphServer(final Map<String, ? extends ImmutableGraph> graphs, final InetAddress address, final int port) throws IOException {
+		for(final Map.Entry<String, ? extends ImmutableGraph> e : graphs.entrySet())
+			if (! e.getValue().randomAccess()) throw new IllegalArgumentException("Graph " + e.getKey() + " does not provide random access");
+		this.graphs = graphs;
+		serverSocket = new ServerSocket(port, 0, address);
+		executorService = Executors.newCachedThreadPool(new ThreadFactoryBuilder().setNameFormat("GraphServer-%d").setDaemon(true).build());
+	}
+
+	/** Returns the port this server is listening on.
+	 *
+	 * @return the port this server is listening on.
+	 */
+	public int port() {
+		return serverSocket.getLocalPort();
+	}
+
+	/** Accepts connections until this server is {@linkplain #close() closed}. */
+	@Override
+	public void run() {
+		LOGGER.info("Serving " + graphs.keySet() + " on " + serverSocket.getLocalSocketAddress());
+		for(;;) {
+			try {
+				final Socket socket = serverSocket.accept();
+				executorService.execute(() -> serve(socket));
+			}
+			catch(final SocketException e) {
+				if (serverSocket.isClosed()) return;
+				LOGGER.warn("Cannot accept connection", e);
+			}
+			catch(final IOException e) {
+				LOGGER.warn("Cannot accept connection", e);
+			}
+		}
+	}
+
+	/** Stops accepting connections; open connections will be served until clients close them. */
+	@Override
+	public void close() throws IOException {
+		serverSocket.close();
+		executorService.shutdown();
+	}
+
+	private static int readSize(final DataInputStream dis) throws IOException {
+		final int k = dis.readInt();
+		// We check the size before allocating anything, as it comes from an untrusted client
+		if (k < 0 || k > MAX_REQUEST_SIZE) throw new IOException("Illegal request size: " + k);
+		return k;
+	}
+
+	private static int[] readNodes(final DataInputStream dis, final int n, final int k) throws IOException {
+		final int[] node = new int[k];
+		for(int i = 0; i < k; i++)
+			if ((node[i] = dis.readInt()) < 0 || node[i] >= n) throw new IOException("Node index out of range: " + node[i]);
+		return node;
+	}
+
+	private static boolean isArc(final ImmutableGraph graph, final int x, final int y) {
+		final LazyIntIterator successors = graph.successors(x);
+		for(int s; (s = successors.nextInt()) != -1;) if (s == y) return true;
+		return false;
+	}
+
+	private static void writeSuccessors(final DataOutputStream dos, final int[] successor, final int d) throws IOException {
+		dos.writeInt(d);
+		for(int j = 0; j < d; j++) dos.writeInt(successor[j]);
+	}
+
+	/** Serves a connection.
+	 *
+	 * @param socket a socket connected to a client.
+	 */
+	private void serve(final Socket socket) {
+		try (Socket s = socket) {
+			s.setTcpNoDelay(true);
+			final DataInputStream dis = new DataInputStream(new FastBufferedInputStream(s.getInputStream()));
+			final DataOutputStream dos = new DataOutputStream(new FastBufferedOutputStream(s.getOutputStream()));
+			final String name = dis.readUTF();
+			final ImmutableGraph root = graphs.get(name);
+			if (root == null) {
+				LOGGER.warn("Unknown graph " + name + " requested by " + s.getRemoteSocketAddress());
+				dos.writeInt(-1);
+				dos.flush();
+				return;
+			}
+
+			final ImmutableGraph graph = root.copy();
+			final int n = graph.numNodes();
+			long m;
+			try {
+				m = graph.numArcs();
+			}
+			catch(final UnsupportedOperationException e) {
+				m = -1;
+			}
+			dos.writeInt(n);
+			dos.writeLong(m);
+			dos.flush();
+
+			// The node iterator used by the last NODES request, and the next node it will return
+			NodeIterator nodeIterator = null;
+			int next = -1;
+
+			for(;;) {
+				final int request = dis.read();
+				if (request == -1 || request == CLOSE) return;
+
+				switch(request) {
+				case OUTDEGREES:
+					for(final int x : readNodes(dis, n, readSize(dis))) dos.writeInt(graph.outdegree(x));
+					break;
+				case SUCCESSORS:
+					for(final int x : readNodes(dis, n, readSize(dis))) writeSuccessors(dos, graph.successorArray(x), graph.outdegree(x));
+					break;
+				case ARCS:
+					final int[] pair = readNodes(dis, n, 2 * readSize(dis));
+					for(int i = 0; i < pair.length; i += 2) dos.writeBoolean(isArc(graph, pair[i], pair[i + 1]));
+					break;
+				case NODES:
+					final int from = dis.readInt(), k = readSize(dis);
+					if (from < 0 || (long)from + k > n) throw new IOException("Illegal node interval: [" + from + ".." + ((long)from + k) + ")");
+					if (nodeIterator == null || next != from) nodeIterator = graph.nodeIterator(from);
+					for(int i = 0; i < k; i++) {
+						nodeIterator.nextInt();
+						writeSuccessors(dos, nodeIterator.successorArray(), nodeIterator.outdegree());
+					}
+					next = from + k;
+					break;
+				default:
+					throw new IOException("Unknown request " + request);
+				}
+
+				dos.flush();
+			}
+		}
+		catch(final IOException e) {
+			LOGGER.warn("Closing connection", e);
+		}
+		catch(final RuntimeException e) {
+			LOGGER.error("Unexpected exception while serving a connection", e);
+		}
+	}
+
+	public static void main(final String[] arg) throws IOException, JSAPException {
+		final SimpleJSAP jsap = new SimpleJSAP(GraphServer.class.getName(), "Serves a set of graphs to RemoteImmutableGraph clients on the loopback interface. Each graph is served under its basename, as specified on the command line.",
+			new Parameter[] {
+			new FlaggedOption("logInterval", JSAP.LONG_PARSER, Long.toString(ProgressLogger.DEFAULT_LOG_INTERVAL), JSAP.NOT_REQUIRED, 'l', "log-interval", "The minimum time interval between activity logs in milliseconds."),
+			new FlaggedOption("port", JSAP.INTEGER_PARSER, Integer.toString(DEFAULT_PORT), JSAP.NOT_REQUIRED, 'p', "port", "The port the server will listen on."),
+			new UnflaggedOption("basename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.GREEDY, "The basenames of the graphs to serve; graphs will be memory-mapped."),
+		}
+		);
+
+		final JSAPResult jsapResult = jsap.parse(arg);
+		if (jsap.messagePrinted()) System.exit(1);
+
+		final ProgressLogger pl = new ProgressLogger(LOGGER, jsapResult.getLong("logInterval"), TimeUnit.MILLISECONDS);
+		final Object2ObjectLinkedOpenHashMap<String, ImmutableGraph> graphs = new Object2ObjectLinkedOpenHashMap<>();
+		for(final String basename : jsapResult.getStringArray("basename")) graphs.put(basename, ImmutableGraph.loadMapped(basename, pl));
+
+		final GraphServer graphServer = new GraphServer(graphs, jsapResult.getInt("port"));
+		graphServer.run();
+	}
+}
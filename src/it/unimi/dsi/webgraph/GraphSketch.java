@@ -0,0 +1,392 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import java.io.File;
+import java.io.IOException;
+import java.io.Serializable;
+import java.lang.reflect.InvocationTargetException;
+import java.util.NoSuchElementException;
+import java.util.function.IntUnaryOperator;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import com.martiansoftware.jsap.FlaggedOption;
+import com.martiansoftware.jsap.JSAP;
+import com.martiansoftware.jsap.JSAPException;
+import com.martiansoftware.jsap.JSAPResult;
+import com.martiansoftware.jsap.Parameter;
+import com.martiansoftware.jsap.SimpleJSAP;
+import com.martiansoftware.jsap.Switch;
+import com.martiansoftware.jsap.UnflaggedOption;
+
+import it.unimi.dsi.fastutil.ints.IntArrays;
+import it.unimi.dsi.fastutil.ints.IntIterator;
+import it.unimi.dsi.fastutil.io.BinIO;
+import it.unimi.dsi.fastutil.io.TextIO;
+import it.unimi.dsi.fastutil.longs.LongIterator;
+import it.unimi.dsi.logging.ProgressLogger;
+import it.unimi.dsi.sux4j.util.EliasFanoMonotoneLongBigList;
+
+/** A compact summary of the degree and gap statistics of a graph.
+ *
+ * <p>A sketch contains the outdegree and indegree distributions of a graph, the nodes attaining the minimum
+ * and maximum outdegree and indegree, the exponentially binned distribution of successor and residual gaps
+ * (as computed by {@link BVGraph}) and the cumulative function of outdegrees in Elias&ndash;Fano form,
+ * which makes it possible to retrieve quickly the outdegree of every node.
+ *
+ * <p>Sketches are computed at compression time, at almost no cost, by
+ * {@link BVGraph#store(ImmutableGraph, CharSequence, int, int, int, int, int, int, boolean, ProgressLogger)} (or by
+ * using the <code>--sketch</code> option of {@link BVGraph#main(String[])}), and serialized in a file with extension
+ * {@link #SKETCH_EXTENSION}; the {@linkplain #main(String[]) main method} of this class can be used to compute
+ * a sketch of any graph by a sequential scan. Tools needing degree information, such as
+ * {@link it.unimi.dsi.webgraph.algo.HyperBall} or {@link it.unimi.dsi.webgraph.examples.OutdegreeStats},
+ * use {@link #load(ImmutableGraph)} to look for a sketch, and avoid scanning the graph if they find one.
+ *
+ * <p>Ties in the computation of the nodes attaining minimum and maximum degrees are broken as in {@link Stats}.
+ */
+
+public class GraphSketch implements Serializable {
+	private static final long serialVersionUID = 0L;
+	private static final Logger LOGGER = LoggerFactory.getLogger(GraphSketch.class);
+
+	/** The standard extension for sketches. */
+	public static final String SKETCH_EXTENSION = ".sketch";
+
+	/** The number of nodes. */
+	public final int numNodes;
+	/** The number of arcs. */
+	public final long numArcs;
+	/** The outdegree distribution: entry <var>d</var> is the number of nodes with outdegree <var>d</var>. */
+	public final int[] outdegreeDistribution;
+	/** The indegree distribution: entry <var>d</var> is the number of nodes with indegree <var>d</var>. */
+	public final int[] indegreeDistribution;
+	/** A node of minimum outdegree. */
+	public final int minOutdegreeNode;
+	/** A node of maximum outdegree. */
+	public final int maxOutdegreeNode;
+	/** A node of minimum indegree. */
+	public final int minIndegreeNode;
+	/** A node of maximum indegree. */
+	public final int maxIndegreeNode;
+	/** Statistics for the gap width of successor lists (exponentially binned). */
+	public final long[] successorGapStats;
+	/** Statistics for the gap width of residuals (exponentially binned), or {@code null} if the sketch has not been computed at compression time. */
+	public final long[] residualGapStats;
+	/** The cumulative function of outdegrees (<var>n</var> + 1 values). */
+	private final EliasFanoMonotoneLongBigList cumulativeOutdegrees;
+
+	/** Creates a new sketch.
+	 *
+	 * @param n the number of nodes.
+	 * @param outdegree a function returning the outdegree of a node.
+	 * @param indegree a function returning the indegree of a node.
+	 * @param successorGapStats statistics for the gap width of successor lists.
+	 * @param residualGapStats statistics for the gap width of residuals, or {@code null}.
+	 */
+	protected GraphSketch(final int n, final IntUnaryOperator outdegree, final IntUnaryOperator indegree, final long[] successorGapStats, final long[] residualGapStats) {
+		numNodes = n;
+		this.successorGapStats = successorGapStats.clone();
+		this.residualGapStats = residualGapStats == null ? null : residualGapStats.clone();
+
+		int[] count = new int[1];
+		int maxd = 0, maxNode = 0, mind = Integer.MAX_VALUE, minNode = 0;
+		long m = 0;
+		for(int i = 0; i < n; i++) {
+			final int d = outdegree.applyAsInt(i);
+			if (d >= count.length) count = IntArrays.grow(count, d + 1);
+			if (d < mind) {
+				mind = d;
+				minNode = i;
+			}
+			if (d > maxd) {
+				maxd = d;
+				maxNode = i;
+			}
+			count[d]++;
+			m += d;
+		}
+
+		numArcs = m;
+		outdegreeDistribution = IntArrays.copy(count, 0, maxd + 1);
+		minOutdegreeNode = minNode;
+		maxOutdegreeNode = maxNode;
+
+		count = new int[1];
+		maxd = maxNode = minNode = 0;
+		mind = Integer.MAX_VALUE;
+		for(int i = n; i-- != 0;) {
+			final int d = indegree.applyAsInt(i);
+			if (d >= count.length) count = IntArrays.grow(count, d + 1);
+			if (d < mind) {
+				mind = d;
+				minNode = i;
+			}
+			if (d > maxd) {
+				maxd = d;
+				maxNode = i;
+			}
+			count[d]++;
+		}
+
+		indegreeDistribution = IntArrays.copy(count, 0, maxd + 1);
+		minIndegreeNode = minNode;
+		maxIndegreeNode = maxNode;
+
+		cumulativeOutdegrees = new EliasFanoMonotoneLongBigList(n + 1L, numArcs + 1, new LongIterator() {
+			private int i = 0;
+			private long c = 0;
+
+			@Override
+			public boolean hasNext() {
+				return i <= n;
+			}
+
+			@Override
+			public long nextLong() {
+				if (! hasNext()) throw new NoSuchElementException();
+				if (i++ == 0) return 0;
+				return c += outdegree.applyAsInt(i - 2);
+			}
+		});
+	}
+
+	/** Returns the outdegree of a node.
+	 *
+	 * @param x a node.
+	 * @return the outdegree of {@code x}.
+	 */
+	public int outdegree(final int x) {
+		if (x < 0 || x >= numNodes) throw new IllegalArgumentException("Node index out of range: " + x);
+		return (int)(cumulativeOutdegrees.getLong(x + 1) - cumulativeOutdegrees.getLong(x));
+	}
+
+	/** Returns the number of arcs whose source is smaller than a given node.
+	 *
+	 * @param x a node, or the number of nodes.
+	 * @return the sum of the outdegrees of the nodes smaller than {@code x}.
+	 */
+	public long cumulativeOutdegree(final int x) {
+		if (x < 0 || x > numNodes) throw new IllegalArgumentException("Node index out of range: " + x);
+		return cumulativeOutdegrees.getLong(x);
+	}
+
+	/** Returns an iterator enumerating the outdegrees of the nodes, in order.
+	 *
+	 * @return an iterator enumerating the outdegrees of the nodes, in order.
+	 */
+	public IntIterator outdegrees() {
+		return new IntIterator() {
+			private final LongIterator iterator = cumulativeOutdegrees.iterator();
+			private long prev = iterator.nextLong();
+
+			@Override
+			public boolean hasNext() {
+				return iterator.hasNext();
+			}
+
+			@Override
+			public int nextInt() {
+				if (! hasNext()) throw new NoSuchElementException();
+				final long next = iterator.nextLong();
+				final int d = (int)(next - prev);
+				prev = next;
+				return d;
+			}
+		};
+	}
+
+	/** Returns the minimum outdegree.
+	 *
+	 * @return the minimum outdegree.
+	 */
+	public int minOutdegree() {
+		for(int d = 0; d < outdegreeDistribution.length; d++) if (outdegreeDistribution[d] != 0) return d;
+		return 0;
+	}
+
+	/** Returns the maximum outdegree.
+	 *
+	 * @return the maximum outdegree.
+	 */
+	public int maxOutdegree() {
+		return outdegreeDistribution.length - 1;
+	}
+
+	/** Returns the minimum indegree.
+	 *
+	 * @return the minimum indegree.
+	 */
+	public int minIndegree() {
+		for(int d = 0; d < indegreeDistribution.length; d++) if (indegreeDistribution[d] != 0) return d;
+		return 0;
+	}
+
+	/** Returns the maximum indegree.
+	 *
+	 * @return the maximum indegree.
+	 */
+	public int maxIndegree() {
+		return indegreeDistribution.length - 1;
+	}
+
+	/** Computes a sketch using a sequential scan.
+	 *
+	 * @param graph a graph.
+	 * @param pl a progress logger, or {@code null}.
+	 * @return a sketch for {@code graph}; note that {@link #residualGapStats} will be {@code null}.
+	 */
+	public static GraphSketch compute(final ImmutableGraph graph, final ProgressLogger pl) {
+		return compute(graph, null, pl);
+	}
+
+	/** Computes a sketch using a sequential scan, using provided statistics for residual gaps.
+	 *
+	 * @param graph a graph.
+	 * @param residualGapStats statistics for the gap width of residuals, or {@code null}.
+	 * @param pl a progress logger, or {@code null}.
+	 * @return a sketch for {@code graph}.
+	 */
+	static GraphSketch compute(final ImmutableGraph graph, final long[] residualGapStats, final ProgressLogger pl) {
+		final int n = graph.numNodes();
+		final int[] outdegree = new int[n];
+		final int[] indegree = new int[n];
+		final long[] successorGapStats = new long[32];
+
+		if (pl != null) {
+			pl.itemsName = "nodes";
+			pl.expectedUpdates = n;
+			pl.start("Computing sketch...");
+		}
+
+		final NodeIterator nodeIterator = graph.nodeIterator();
+		for(int i = n; i-- != 0;) {
+			final int curr = nodeIterator.nextInt();
+			final int d = nodeIterator.outdegree();
+			final int[] successor = nodeIterator.successorArray();
+			outdegree[curr] = d;
+			for(int s = d; s-- != 0;) indegree[successor[s]]++;
+			if (d != 0) BVGraph.updateBins(curr, successor, d, successorGapStats);
+			if (pl != null) pl.lightUpdate();
+		}
+
+		if (pl != null) pl.done();
+		return new GraphSketch(n, x -> outdegree[x], x -> indegree[x], successorGapStats, residualGapStats);
+	}
+
+	/** Stores this sketch.
+	 *
+	 * @param basename the basename of the graph this sketch refers to.
+	 * @throws IOException if an exception is raised while writing the sketch.
+	 */
+	public void store(final CharSequence basename) throws IOException {
+		BinIO.storeObject(this, basename + SKETCH_EXTENSION);
+	}
+
+	/** Loads a sketch.
+	 *
+	 * @param basename the basename of the graph the sketch refers to.
+	 * @return the sketch.
+	 * @throws IOException if an exception is raised while reading the sketch.
+	 */
+	public static GraphSketch load(final CharSequence basename) throws IOException {
+		try {
+			return (GraphSketch)BinIO.loadObject(basename + SKETCH_EXTENSION);
+		}
+		catch (final ClassNotFoundException e) {
+			throw new RuntimeException(e);
+		}
+	}
+
+	/** Loads the sketch of a graph, if available and up to date.
+	 *
+	 * <p>The sketch is looked for using the {@linkplain ImmutableGraph#basename() basename} of the graph. It is
+	 * considered stale (and thus ignored) if it is older than the property file of the graph, or if its number
+	 * of nodes does not match that of the graph.
+	 *
+	 * @param graph a graph.
+	 * @return the sketch of {@code graph}, or {@code null} if no up-to-date sketch is available.
+	 */
+	public static GraphSketch load(final ImmutableGraph graph) {
+		final CharSequence basename;
+		try {
+			basename = graph.basename();
+		}
+		catch(final UnsupportedOperationException e) {
+			return null;
+		}
+		if (basename == null) return null;
+
+		final File sketchFile = new File(basename + SKETCH_EXTENSION);
+		if (! sketchFile.exists()) return null;
+		if (sketchFile.lastModified() < new File(basename + ImmutableGraph.PROPERTIES_EXTENSION).lastModified()) {
+			LOGGER.warn("Sketch file " + sketchFile + " is older than the property file: ignoring it");
+			return null;
+		}
+
+		try {
+			final GraphSketch sketch = load(basename);
+			if (sketch.numNodes != graph.numNodes()) {
+				LOGGER.warn("Sketch file " + sketchFile + " has " + sketch.numNodes + " nodes, but the graph has " + graph.numNodes() + ": ignoring it");
+				return null;
+			}
+			return sketch;
+		}
+		catch(final IOException e) {
+			LOGGER.warn("Cannot load sketch file " + sketchFile, e);
+			return null;
+		}
+	}
+
+	public static void main(final String arg[]) throws IllegalArgumentException, SecurityException, IllegalAccessException, InvocationTargetException, NoSuchMethodException, JSAPException, IOException {
+		final SimpleJSAP jsap = new SimpleJSAP(GraphSketch.class.getName(), "Computes and stores the sketch of a graph (if it is not available already), and optionally saves its degree distributions in the same format of " + Stats.class.getName() + ".",
+				new Parameter[] {
+						new FlaggedOption("graphClass", GraphClassParser.getParser(), null, JSAP.NOT_REQUIRED, 'g', "graph-class", "Forces a Java class for the source graph."),
+						new FlaggedOption("logInterval", JSAP.LONG_PARSER, Long.toString(ProgressLogger.DEFAULT_LOG_INTERVAL), JSAP.NOT_REQUIRED, 'l', "log-interval", "The minimum time interval between activity logs in milliseconds."),
+						new Switch("force", 'f', "force", "Recompute the sketch even if an up-to-date one is available."),
+						new FlaggedOption("distributions", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 'd', "distributions", "Save the outdegree and indegree distributions using this basename."),
+						new UnflaggedOption("basename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The basename of the graph."),
+					}
+				);
+
+		final JSAPResult jsapResult = jsap.parse(arg);
+		if (jsap.messagePrinted()) System.exit(1);
+
+		final Class<?> graphClass = jsapResult.getClass("graphClass");
+		final String basename = jsapResult.getString("basename");
+
+		final ProgressLogger pl = new ProgressLogger(LOGGER);
+		pl.logInterval = jsapResult.getLong("logInterval");
+		final ImmutableGraph graph;
+		if (graphClass != null) graph = (ImmutableGraph)graphClass.getMethod("loadOffline", CharSequence.class).invoke(null, basename);
+		else graph = ImmutableGraph.loadOffline(basename, pl);
+
+		GraphSketch sketch = jsapResult.getBoolean("force") ? null : load(graph);
+		if (sketch == null) {
+			sketch = compute(graph, pl);
+			sketch.store(basename);
+		}
+
+		if (jsapResult.userSpecified("distributions")) {
+			final String resultsBasename = jsapResult.getString("distributions");
+			TextIO.storeInts(sketch.outdegreeDistribution, 0, sketch.outdegreeDistribution.length, resultsBasename + ".outdegree");
+			TextIO.storeInts(sketch.indegreeDistribution, 0, sketch.indegreeDistribution.length, resultsBasename + ".indegree");
+		}
+	}
+}
@@ -0,0 +1,311 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import java.io.IOException;
+import java.io.Serializable;
+import java.util.Arrays;
+
+import it.unimi.dsi.bits.Fast;
+import it.unimi.dsi.fastutil.ints.IntArrays;
+import it.unimi.dsi.io.InputBitStream;
+import it.unimi.dsi.io.OutputBitStream;
+
+/** A coder for natural numbers based on a canonical Huffman code, tailored on a given distribution.
+ *
+ * <p>Natural numbers are mapped into {@link #NUMBER_OF_SYMBOLS} symbols: numbers smaller than {@link #DIRECT} are symbols
+ * by themselves, whereas each larger number <var>x</var> is mapped to the symbol determined by
+ * &lfloor;log&nbsp;<var>x</var>&rfloor; and by the bit of <var>x</var> following the most significant one; the remaining bits
+ * of <var>x</var> are written verbatim after the codeword of the symbol. Symbols are
+ * coded using a minimum-redundancy code whose codeword lengths are computed using the in-place algorithm
+ * described by Alistair Moffat and Jyrki Katajainen in &ldquo;In-place calculation of minimum-redundancy codes&rdquo;,
+ * <i>Proc. WADS 1995</i>, LNCS 955, pages 393&minus;402, Springer (see also <code>c/inplace.c</code>). To make it possible to
+ * code numbers that did not appear in the distribution, all symbols are given a codeword.
+ *
+ * <p>Since the code is canonical, it is entirely determined by the {@linkplain #codeLengths() lengths of its codewords}, which is
+ * all that must be stored to rebuild it. Since {@link InputBitStream} cannot peek bits, decoding never reads more bits than
+ * the shortest codeword that might follow: it reads as many bits as the shortest codeword, and then uses a table
+ * indexed by such bits to find the length of the shortest codeword they are a prefix of, reading the missing bits in
+ * a single call. Usually, this is the length of the codeword, so most symbols are decoded
+ * with two reads; otherwise, the search for the next possible length goes on using the
+ * {@linkplain #alignedLimit left-aligned limits} of the canonical code.
+ *
+ * <p>Instances of this class are immutable, and thus thread safe.
+ *
+ * @see BVGraph
+ */
+
+public class HuffmanCoder implements Serializable {
+	private static final long serialVersionUID = 0L;
+
+	/** The base-2 logarithm of {@link #DIRECT}. */
+	private static final int LOG2_DIRECT = 4;
+	/** Natural numbers smaller than this value are symbols by themselves. */
+	public static final int DIRECT = 1 << LOG2_DIRECT;
+	/** The number of symbols. */
+	public static final int NUMBER_OF_SYMBOLS = DIRECT + 2 * (Long.SIZE - 1 - LOG2_DIRECT);
+	/** The maximum length of a codeword. */
+	public static final int MAX_CODEWORD_LENGTH = 32;
+	/** The maximum number of bits indexing the decoding table. */
+	private static final int MAX_TABLE_BITS = 12;
+
+	/** The length of the codeword of each symbol. */
+	private final int[] length;
+	/** The codeword of each symbol. */
+	private final long[] codeword;
+	/** The distinct codeword lengths, in increasing order. */
+	private final int[] distinctLength;
+	/** For each distinct codeword length, the first codeword of that length. */
+	private final long[] firstCodeword;
+	/** For each distinct codeword length, the successor of the last codeword of that length. */
+	private final long[] limit;
+	/** For each distinct codeword length, the index in {@link #symbol} of the symbol of the first codeword of that length. */
+	private final int[] firstIndex;
+	/** The symbols, in codeword order. */
+	private final int[] symbol;
+	/** For each distinct codeword length, {@link #limit} left-aligned to {@link #MAX_CODEWORD_LENGTH} bits. */
+	private final long[] alignedLimit;
+	/** For each sequence of bits as long as the shortest codeword, the index in {@link #distinctLength} of the length of
+	 * the shortest codeword starting with the sequence, or {@code null} if the shortest codeword is longer than {@link #MAX_TABLE_BITS}. */
+	private final byte[] table;
+
+	/** Creates a canonical Huffman coder given the lengths of its codewords.
+	 *
+	 * @param codeLength the length of the codeword of each of the {@link #NUMBER_OF_SYMBOLS} symbols.
+	 */
+	public HuffmanCoder(final int[] codeLength) {
+		if (codeLength.length != NUMBER_OF_SYMBOLS) throw new IllegalArgumentException("Expected " + NUMBER_OF_SYMBOLS + " codeword lengths, found " + codeLength.length);
+		long kraft = 0;
+		for(final int l : codeLength) {
+			if (l < 1 || l > MAX_CODEWORD_LENGTH) throw new IllegalArgumentException("Illegal codeword length: " + l);
+			kraft += 1L << (MAX_CODEWORD_LENGTH - l);
+		}
+		if (kraft > 1L << MAX_CODEWORD_LENGTH) throw new IllegalArgumentException("The codeword lengths violate Kraft's inequality");
+
+		length = codeLength.clone();
+		codeword = new long[NUMBER_OF_SYMBOLS];
+		// Symbols are sorted by codeword length, and then by symbol
+		symbol = new int[NUMBER_OF_SYMBOLS];
+		for(int i = 0; i < NUMBER_OF_SYMBOLS; i++) symbol[i] = i;
+		IntArrays.mergeSort(symbol, (x, y) -> Integer.compare(length[x], length[y]));
+
+		final int numLengths = (int)Arrays.stream(length).distinct().count();
+		distinctLength = new int[numLengths];
+		firstCodeword = new long[numLengths];
+		limit = new long[numLengths];
+		firstIndex = new int[numLengths];
+
+		long c = 0;
+		int d = -1;
+		for(int i = 0; i < NUMBER_OF_SYMBOLS; i++) {
+			final int l = length[symbol[i]];
+			if (d == -1 || l != distinctLength[d]) {
+				if (d != -1) c <<= l - distinctLength[d];
+				distinctLength[++d] = l;
+				firstCodeword[d] = c;
+				firstIndex[d] = i;
+			}
+			codeword[symbol[i]] = c++;
+			limit[d] = c;
+		}
+
+		alignedLimit = new long[numLengths];
+		for(int i = 0; i < numLengths; i++) alignedLimit[i] = limit[i] << (MAX_CODEWORD_LENGTH - distinctLength[i]);
+
+		final int tableBits = distinctLength[0];
+		if (tableBits <= MAX_TABLE_BITS) {
+			table = new byte[1 << tableBits];
+			for(int p = 0; p < table.length; p++) table[p] = (byte)nextLength(p, tableBits, 0);
+		}
+		else table = null;
+	}
+
+	/** Returns the index of the length of the shortest codeword starting with a given sequence of bits.
+	 *
+	 * @param c a sequence of bits.
+	 * @param l the length of {@code c}.
+	 * @param from the index in {@link #distinctLength} the search starts from.
+	 * @return the smallest index in {@link #distinctLength} not smaller than {@code from} such that a codeword of that length starts with {@code c},
+	 * or {@link #distinctLength distinctLength.length} if no such codeword exists.
+	 */
+	private int nextLength(final long c, final int l, int from) {
+		// Left-aligned codewords of increasing length occupy consecutive intervals
+		final long aligned = c << (MAX_CODEWORD_LENGTH - l);
+		while(from < alignedLimit.length && alignedLimit[from] <= aligned) from++;
+		return from;
+	}
+
+	/** Returns the lengths of the codewords of this coder.
+	 *
+	 * @return the length of the codeword of each of the {@link #NUMBER_OF_SYMBOLS} symbols.
+	 */
+	public int[] codeLengths() {
+		return length.clone();
+	}
+
+	/** Returns the symbol associated with a natural number.
+	 *
+	 * @param x a natural number.
+	 * @return the symbol associated with {@code x}.
+	 */
+	public static int symbol(final long x) {
+		if (x < DIRECT) return (int)x;
+		final int msb = Fast.mostSignificantBit(x);
+		return DIRECT + ((msb - LOG2_DIRECT) << 1) + (int)((x >>> (msb - 1)) & 1);
+	}
+
+	/** Builds a coder that is optimal for a given distribution of symbols.
+	 *
+	 * <p>Every symbol gets a codeword, even if its frequency is zero. If necessary, frequencies are flattened
+	 * so that no codeword is longer than {@link #MAX_CODEWORD_LENGTH}.
+	 *
+	 * @param frequency the frequency of each of the {@link #NUMBER_OF_SYMBOLS} symbols (see {@link #symbol(long)}).
+	 * @return a coder minimising the number of bits used to write symbols with the given frequencies.
+	 */
+	public static HuffmanCoder build(final long[] frequency) {
+		if (frequency.length != NUMBER_OF_SYMBOLS) throw new IllegalArgumentException("Expected " + NUMBER_OF_SYMBOLS + " frequencies, found " + frequency.length);
+		final long[] f = new long[NUMBER_OF_SYMBOLS];
+		for(int i = 0; i < NUMBER_OF_SYMBOLS; i++) f[i] = frequency[i] + 1;
+
+		final int[] perm = new int[NUMBER_OF_SYMBOLS];
+		final long[] a = new long[NUMBER_OF_SYMBOLS];
+		final int[] codeLength = new int[NUMBER_OF_SYMBOLS];
+		for(;;) {
+			for(int i = 0; i < NUMBER_OF_SYMBOLS; i++) perm[i] = i;
+			IntArrays.quickSort(perm, (x, y) -> Long.compare(f[x], f[y]));
+			for(int i = 0; i < NUMBER_OF_SYMBOLS; i++) a[i] = f[perm[i]];
+			minimumRedundancy(a);
+			// The longest codeword is the one of the least frequent symbol
+			if (a[0] <= MAX_CODEWORD_LENGTH) break;
+			for(int i = 0; i < NUMBER_OF_SYMBOLS; i++) f[i] = (f[i] >>> 1) + 1;
+		}
+
+		for(int i = 0; i < NUMBER_OF_SYMBOLS; i++) codeLength[perm[i]] = (int)a[i];
+		return new HuffmanCoder(codeLength);
+	}
+
+	/** Computes in place the codeword lengths of a minimum-redundancy code, using the algorithm by Moffat and Katajainen.
+	 *
+	 * @param a a nondecreasing array of at least two positive frequencies; it will be replaced by the lengths of the corresponding
+	 * codewords (a nonincreasing sequence).
+	 */
+	private static void minimumRedundancy(final long[] a) {
+		final int n = a.length;
+		int root, leaf, next;
+
+		// First pass, left to right, setting parent pointers
+		a[0] += a[1];
+		root = 0;
+		leaf = 2;
+		for(next = 1; next < n - 1; next++) {
+			// Select first item for a pairing
+			if (leaf >= n || a[root] < a[leaf]) {
+				a[next] = a[root];
+				a[root++] = next;
+			}
+			else a[next] = a[leaf++];
+
+			// Add on the second item
+			if (leaf >= n || (root < next && a[root] < a[leaf])) {
+				a[next] += a[root];
+				a[root++] = next;
+			}
+			else a[next] += a[leaf++];
+		}
+
+		// Second pass, right to left, setting internal depths
+		a[n - 2] = 0;
+		for(next = n - 3; next >= 0; next--) a[next] = a[(int)a[next]] + 1;
+
+		// Third pass, right to left, setting leaf depths
+		int avbl = 1, used = 0, dpth = 0;
+		root = n - 2;
+		next = n - 1;
+		while(avbl > 0) {
+			while(root >= 0 && a[root] == dpth) {
+				used++;
+				root--;
+			}
+			while(avbl > used) {
+				a[next--] = dpth;
+				avbl--;
+			}
+			avbl = 2 * used;
+			dpth++;
+			used = 0;
+		}
+	}
+
+	/** Writes a natural number.
+	 *
+	 * @param obs an output bit stream.
+	 * @param x a natural number.
+	 * @return the number of bits written.
+	 */
+	public int write(final OutputBitStream obs, final long x) throws IOException {
+		if (x < 0) throw new IllegalArgumentException("The argument " + x + " is negative");
+		final int s = symbol(x);
+		final int bits = obs.writeLong(codeword[s], length[s]);
+		if (s < DIRECT) return bits;
+		final int extra = Fast.mostSignificantBit(x) - 1;
+		return bits + obs.writeLong(x & ((1L << extra) - 1), extra);
+	}
+
+	/** Reads a symbol.
+	 *
+	 * @param ibs an input bit stream.
+	 * @return the next symbol.
+	 */
+	private int readSymbol(final InputBitStream ibs) throws IOException {
+		int l = distinctLength[0];
+		long c = ibs.readLong(l);
+		int i = table != null ? table[(int)c] : nextLength(c, l, 0);
+		while(i < distinctLength.length) {
+			// No codeword starting with c is shorter than distinctLength[i], so we cannot read too many bits
+			final int nextLength = distinctLength[i];
+			if (nextLength != l) {
+				c = c << (nextLength - l) | ibs.readLong(nextLength - l);
+				l = nextLength;
+			}
+			if (c < limit[i]) return symbol[(int)(firstIndex[i] + c - firstCodeword[i])];
+			i = nextLength(c, l, i + 1);
+		}
+		throw new IllegalStateException("Invalid codeword");
+	}
+
+	/** Reads a natural number.
+	 *
+	 * @param ibs an input bit stream.
+	 * @return the next natural number.
+	 */
+	public long readLong(final InputBitStream ibs) throws IOException {
+		final int s = readSymbol(ibs);
+		if (s < DIRECT) return s;
+		final int msb = LOG2_DIRECT + ((s - DIRECT) >>> 1);
+		return 1L << msb | (long)((s - DIRECT) & 1) << (msb - 1) | ibs.readLong(msb - 1);
+	}
+
+	/** Reads a natural number that fits an integer.
+	 *
+	 * @param ibs an input bit stream.
+	 * @return the next natural number.
+	 */
+	public int readInt(final InputBitStream ibs) throws IOException {
+		return (int)readLong(ibs);
+	}
+}
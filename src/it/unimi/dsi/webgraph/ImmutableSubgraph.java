@@ -25,7 +25,6 @@ import java.io.IOException;
 import java.io.OutputStreamWriter;
 import java.io.PrintWriter;
 import java.io.UnsupportedEncodingException;
-import java.util.Arrays;
 import java.util.Properties;
 
 import com.martiansoftware.jsap.FlaggedOption;
@@ -36,11 +35,13 @@ import com.martiansoftware.jsap.Parameter;
 import com.martiansoftware.jsap.SimpleJSAP;
 import com.martiansoftware.jsap.UnflaggedOption;
 
+import it.unimi.dsi.bits.LongArrayBitVector;
 import it.unimi.dsi.fastutil.ints.IntArrays;
 import it.unimi.dsi.fastutil.ints.IntSet;
 import it.unimi.dsi.fastutil.io.BinIO;
 import it.unimi.dsi.lang.MutableString;
 import it.unimi.dsi.logging.ProgressLogger;
+import it.unimi.dsi.sux4j.bits.Rank9;
 
 /** An induced subgraph of a given immutable graph.
  *
@@ -51,6 +52,11 @@ import it.unimi.dsi.logging.ProgressLogger;
  *  a different index than the corresponding node in the supergraph. The two methods {@link #toSupergraphNode(int)} and {@link #fromSupergraphNode(int)}
  *  are used to translate indices back and forth.
  *
+ *  <P>Besides the array of subgraph nodes, an immutable subgraph uses a bit vector with a ranking structure
+ *  to translate supergraph nodes (about 1.25 bits per supergraph node). When the supergraph provides random access,
+ *  node iterators jump over large gaps between subgraph nodes by creating a new node iterator on the supergraph, instead of skipping
+ *  sequentially.
+ *
  *  <P>An immutable subgraph is stored as a property file (which follows the convention established
  *  in {@link it.unimi.dsi.webgraph.ImmutableGraph}), and as a node subset file. The latter must contain an
  *  (increasing) list of integers in {@link java.io.DataOutput} format representing
@@ -81,6 +87,8 @@ import it.unimi.dsi.logging.ProgressLogger;
  */
 public class ImmutableSubgraph extends ImmutableGraph {
 	private final static boolean DEBUG = false;
+	/** The minimum gap between consecutive subgraph nodes that causes node iterators to use random access on the supergraph, if available, instead of skipping. */
+	private final static int MIN_JUMP = 32;
 
 	/** The standard property key for the name of the file containing the subgraph nodes. */
 	public static final String SUBGRAPHNODES_PROPERTY_KEY = "subgraphnodes";
@@ -96,8 +104,11 @@ public class ImmutableSubgraph extends ImmutableGraph {
 	/** The nodes of the subgraph, in increasing order. */
 	protected final int subgraphNode[];
 
-	/** A mapping from nodes of the supergraph to nodes in the subgraph (-1 for missing nodes). */
-	protected final int supergraphNode[];
+	/** The characteristic bit vector of {@link #subgraphNode} in the supergraph. */
+	protected final LongArrayBitVector subgraphNodeSet;
+
+	/** A ranking structure on {@link #subgraphNodeSet} mapping nodes of the supergraph to nodes in the subgraph. */
+	protected final Rank9 subgraphNodeRank;
 
 	/** The number of nodes in the subgraph. */
 	protected final int subgraphSize;
@@ -137,13 +148,14 @@ public class ImmutableSubgraph extends ImmutableGraph {
 		this.subgraphNode = subgraphNode;
 		this.subgraphSize = subgraphNode.length;
 		this.supergraphNumNodes = supergraph.numNodes();
-		this.supergraphNode = new int[supergraphNumNodes];
-		Arrays.fill(supergraphNode, -1);
-		for(int i = subgraphSize; i-- != 0;) supergraphNode[subgraphNode[i]] = i;
 		for (int i = 1; i < subgraphSize; i++)
 			if (subgraphNode[i - 1] >= subgraphNode[i])
 				throw new IllegalArgumentException("The provided integer array is not strictly increasing: " + (i-1) + "-th element is " + subgraphNode[i - 1] + ", " + i + "-th element is " + subgraphNode[i]);
 		if (subgraphSize > 0 && subgraphNode[subgraphSize - 1] >= supergraphNumNodes) throw new IllegalArgumentException("Subnode index out of bounds: " + subgraphNode[subgraphSize - 1]);
+		if (subgraphSize > 0 && subgraphNode[0] < 0) throw new IllegalArgumentException("Subnode index out of bounds: " + subgraphNode[0]);
+		this.subgraphNodeSet = LongArrayBitVector.ofLength(supergraphNumNodes);
+		for(int i = subgraphSize; i-- != 0;) subgraphNodeSet.set(subgraphNode[i]);
+		this.subgraphNodeRank = new Rank9(subgraphNodeSet);
 	}
 
 	/** Creates a new immutable subgraph by copying an existing one.
@@ -156,7 +168,8 @@ public class ImmutableSubgraph extends ImmutableGraph {
 		this.supergraph = immutableSubgraph.supergraph.copy();
 		this.supergraphAsSubgraph = supergraph instanceof ImmutableSubgraph ? (ImmutableSubgraph)supergraph : null;
 		this.subgraphNode = immutableSubgraph.subgraphNode;
-		this.supergraphNode = immutableSubgraph.supergraphNode;
+		this.subgraphNodeSet = immutableSubgraph.subgraphNodeSet;
+		this.subgraphNodeRank = immutableSubgraph.subgraphNodeRank;
 	}
 
 	/** Creates a new immutable subgraph by wrapping an immutable graph.
@@ -167,7 +180,9 @@ public class ImmutableSubgraph extends ImmutableGraph {
 		this.subgraphSize = this.supergraphNumNodes = immutableGraph.numNodes();
 		this.supergraph = immutableGraph;
 		this.supergraphAsSubgraph = null;
-		this.subgraphNode = this.supergraphNode = null;
+		this.subgraphNode = null;
+		this.subgraphNodeSet = null;
+		this.subgraphNodeRank = null;
 	}
 
 	@Override
@@ -220,7 +235,7 @@ public class ImmutableSubgraph extends ImmutableGraph {
 	 * @return the index of node <code>x</code> in this graph, or a negative value if <code>x</code> does not belong to the subgraph.
 	 */
 	public int fromSupergraphNode(final int x) {
-		return supergraphNode[x];
+		return subgraphNodeSet.getBoolean(x) ? (int)subgraphNodeRank.rank(x) : -1;
 	}
 
 	/** Returns the index of a node of this graph in its root graph.
@@ -257,10 +272,7 @@ public class ImmutableSubgraph extends ImmutableGraph {
 		 * only when <code>node</code> &lt; <code>subgraphSize</code>. Moreover, if outdegree >= 0 then it is
 		 * the outdegree of <code>node</code>-1, and <code>successorsCache</code> contains the successors. */
 
-		// TODO: decide for a strategy. Note that super.nodeIterator is very dangerous, as it uses random access.
-		return supergraph.randomAccess() && subgraphSize < supergraphNumNodes / 8 ? super.nodeIterator(from) :
-
-		new ImmutableSubgraphNodeIterator(from, Integer.MAX_VALUE);
+		return new ImmutableSubgraphNodeIterator(from, Integer.MAX_VALUE, from < subgraphSize ? supergraph.nodeIterator(subgraphNode[from]) : null);
 	}
 
 	@Override
@@ -280,11 +292,9 @@ public class ImmutableSubgraph extends ImmutableGraph {
 
 			@Override
 			public int nextInt() {
-				int x, result;
-				while ((x = supergraphSuccessors.nextInt()) != -1) {
-					result = supergraphNode[x];
-					if (result >= 0) return result;
-				}
+				int x;
+				while ((x = supergraphSuccessors.nextInt()) != -1)
+					if (subgraphNodeSet.getBoolean(x)) return (int)subgraphNodeRank.rank(x);
 
 				return -1;
 			}
@@ -321,21 +331,27 @@ public class ImmutableSubgraph extends ImmutableGraph {
 		int[] successorsCache = IntArrays.EMPTY_ARRAY;
 		/** The outdegree of the node that was returned last (<code>node</code>-1). */
 		int outdegree = -1;
-		final NodeIterator supergraphNodeIterator;
+		/** A node iterator on the supergraph positioned on {@code subgraphNode[node - 1]}, or just before {@code subgraphNode[from]}. */
+		NodeIterator supergraphNodeIterator;
 		/** No node &ge; this will ever be returned. */
 		final int upperBound;
 
-		private ImmutableSubgraphNodeIterator(final int from, final int to) {
+		private ImmutableSubgraphNodeIterator(final int from, final int to, final NodeIterator supergraphNodeIterator) {
 			this.from = from;
 			node = from;
-			supergraphNodeIterator = supergraph.nodeIterator(subgraphNode[from]);
+			this.supergraphNodeIterator = supergraphNodeIterator;
 			upperBound = to;
 		}
 
 		@Override
 		public int nextInt() {
 			if (! hasNext()) throw new java.util.NoSuchElementException();
-			if (node != from) supergraphNodeIterator.skip(subgraphNode[node] - subgraphNode[node - 1]);
+			if (node != from) {
+				final int gap = subgraphNode[node] - subgraphNode[node - 1];
+				// On large gaps, we use random access to position a new supergraph iterator
+				if (gap >= MIN_JUMP && supergraph.randomAccess()) (supergraphNodeIterator = supergraph.nodeIterator(subgraphNode[node])).nextInt();
+				else supergraphNodeIterator.skip(gap);
+			}
 			else supergraphNodeIterator.nextInt();
 			outdegree = -1;
 			return node++;
@@ -380,9 +396,10 @@ public class ImmutableSubgraph extends ImmutableGraph {
 
 		@Override
 		public NodeIterator copy(final int upperBound) {
-			final ImmutableSubgraphNodeIterator result = new ImmutableSubgraphNodeIterator(from, upperBound);
+			final ImmutableSubgraphNodeIterator result = new ImmutableSubgraphNodeIterator(from, upperBound, supergraphNodeIterator == null ? null : supergraphNodeIterator.copy(Integer.MAX_VALUE));
 			result.node = node;
 			result.outdegree = outdegree;
+			result.successorsCache = successorsCache.clone();
 			return result;
 		}
 
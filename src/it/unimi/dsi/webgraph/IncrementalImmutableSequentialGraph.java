@@ -19,7 +19,8 @@ package it.unimi.dsi.webgraph;
 
 import java.util.Arrays;
 import java.util.NoSuchElementException;
-import java.util.concurrent.ArrayBlockingQueue;
+import java.util.concurrent.locks.Condition;
+import java.util.concurrent.locks.ReentrantLock;
 
 
 /** An adapter exposing an {@link ImmutableGraph} that can be filled incrementally using
@@ -49,20 +50,71 @@ import java.util.concurrent.ArrayBlockingQueue;
  *	future.get();
  *	executor.shutdown();
  *</pre>
+ *
+ * <h2>Multiple producers</h2>
+ *
+ * <p>Successor lists can also be computed by several producer threads, using the
+ * {@linkplain #add(int, int[], int, int) indexed addition methods}, which specify explicitly the node whose successors
+ * are being added. Lists can be added out of order: they are kept in a reorder buffer of bounded size (see
+ * {@link #IncrementalImmutableSequentialGraph(int)}) and released to the consumer in node order. A producer trying to add the successors of
+ * a node that is too far ahead of the first node not yet released will block until enough space is available.
+ * The end of the graph is signalled by adding {@link #END_OF_GRAPH} as the successor list of the node whose index
+ * is equal to the number of nodes.
+ *
+ * <p>Each producer must add its nodes in increasing order, and the node following the last released one must always be
+ * in charge of some producer. The simplest way to guarantee this condition, and good parallelism, is to have producers
+ * take small batches of consecutive nodes from a shared counter:
+ * <pre class= code>
+ *	final AtomicInteger nextNode = new AtomicInteger();
+ *	// In each producer
+ *	for(int from; (from = nextNode.getAndAdd(batchSize)) &lt; n;)
+ *		for(int x = from; x &lt; Math.min(n, from + batchSize); x++) g.add(x, computeSuccessors(x));
+ *	// When all producers have completed
+ *	g.add(n, IncrementalImmutableSequentialGraph.END_OF_GRAPH);
+ *</pre>
+ * The batch size should be significantly smaller than the size of the reorder buffer divided by the number of producers.
+ *
+ * <p>Indexed and non-indexed addition methods must not be mixed.
  */
 
 public class IncrementalImmutableSequentialGraph extends ImmutableSequentialGraph {
 	/** A marker for the end of the graph. */
 	public static int[] END_OF_GRAPH = new int[0];
+	/** The default size of the reorder buffer. */
+	public static final int DEFAULT_BUFFER_SIZE = 100;
 
 	/** The number of nodes (known after a traversal). */
 	private int n;
-	/** The queue connecting the add methods and node iterator successor mehotds. */
-	private final ArrayBlockingQueue<int[]> successorQueue;
+	/** The reorder buffer connecting the add methods and node iterator successor methods: the successors of node
+	 * <var>x</var> are stored in position <var>x</var> modulo the length of the buffer. */
+	private final int[][] buffer;
+	/** The first node whose successors have not been released yet. */
+	private long next;
+	/** The number of lists added by non-indexed addition methods. */
+	private int added;
+	/** The lock protecting {@link #buffer} and {@link #next}. */
+	private final ReentrantLock lock;
+	/** The condition upon which producers wait for space in the buffer. */
+	private final Condition notFull;
+	/** The condition upon which the consumer waits for the successors of {@link #next}. */
+	private final Condition notEmpty;
 
+	/** Creates a new incremental graph with a default reorder buffer. */
 	public IncrementalImmutableSequentialGraph() {
+		this(DEFAULT_BUFFER_SIZE);
+	}
+
+	/** Creates a new incremental graph with a reorder buffer of given size.
+	 *
+	 * @param bufferSize the maximum number of successor lists that can be added but not yet released to the consumer.
+	 */
+	public IncrementalImmutableSequentialGraph(final int bufferSize) {
+		if (bufferSize <= 0) throw new IllegalArgumentException("Illegal buffer size: " + bufferSize);
 		n = -1;
-		this.successorQueue = new ArrayBlockingQueue<>(100);
+		buffer = new int[bufferSize][];
+		lock = new ReentrantLock();
+		notFull = lock.newCondition();
+		notEmpty = lock.newCondition();
 	}
 
 	@Override
@@ -71,6 +123,26 @@ public class IncrementalImmutableSequentialGraph extends ImmutableSequentialGrap
 		return n;
 	}
 
+	/** Retrieves the successors of the next node, waiting if necessary until they are available.
+	 *
+	 * @return the successors of the next node.
+	 */
+	private int[] take() throws InterruptedException {
+		lock.lockInterruptibly();
+		try {
+			final int pos = (int)(next % buffer.length);
+			while (buffer[pos] == null) notEmpty.await();
+			final int[] successor = buffer[pos];
+			buffer[pos] = null;
+			next++;
+			notFull.signalAll();
+			return successor;
+		}
+		finally {
+			lock.unlock();
+		}
+	}
+
 	@Override
 	public NodeIterator nodeIterator() {
 		if (n != -1) throw new IllegalStateException();
@@ -84,7 +156,7 @@ public class IncrementalImmutableSequentialGraph extends ImmutableSequentialGrap
 				if (nextSuccessor != null) return true;
 
 				try {
-					nextSuccessor = successorQueue.take();
+					nextSuccessor = take();
 				}
 				catch (final InterruptedException e) {
 					throw new RuntimeException(e.getMessage(), e);
@@ -122,6 +194,27 @@ public class IncrementalImmutableSequentialGraph extends ImmutableSequentialGrap
 		};
 	}
 
+	/** Stores the successors of a node in the reorder buffer, waiting if necessary for space to become available.
+	 *
+	 * @param x a node, or -1 to use the next node following those added by non-indexed addition methods.
+	 * @param successor the successors of {@code x}.
+	 */
+	private void put(int x, final int[] successor) throws InterruptedException {
+		lock.lockInterruptibly();
+		try {
+			if (x == -1) x = added++;
+			if (x < next) throw new IllegalArgumentException("The successors of node " + x + " have been already released");
+			while (x >= next + buffer.length) notFull.await();
+			final int pos = (int)(x % buffer.length);
+			if (buffer[pos] != null) throw new IllegalArgumentException("The successors of node " + x + " have been already added");
+			buffer[pos] = successor;
+			if (x == next) notEmpty.signal();
+		}
+		finally {
+			lock.unlock();
+		}
+	}
+
 	/** Adds a new node having as successors contained in the specified array fragment.
 	 *
 	 *
@@ -132,7 +225,7 @@ public class IncrementalImmutableSequentialGraph extends ImmutableSequentialGrap
 	 * @param length the number of valid entries.
 	 */
 	public void add(final int[] successor, final int offset, final int length) throws InterruptedException {
-		successorQueue.put(Arrays.copyOfRange(successor, offset, offset + length));
+		put(-1, Arrays.copyOfRange(successor, offset, offset + length));
 	}
 
 	/** Adds a new node having as successors contained in the specified array.
@@ -142,6 +235,35 @@ public class IncrementalImmutableSequentialGraph extends ImmutableSequentialGrap
 	 * @param successor an array.
 	 */
 	public void add(final int[] successor) throws InterruptedException {
-		successorQueue.put(successor);
+		put(-1, successor);
+	}
+
+	/** Sets the successors of a given node to those contained in the specified array fragment.
+	 *
+	 * <p>This method can be called concurrently by several producers (see the {@linkplain IncrementalImmutableSequentialGraph class documentation}).
+	 * The array must be sorted in increasing order.
+	 *
+	 * @param x a node.
+	 * @param successor an array.
+	 * @param offset the first valid entry in <code>successor</code>.
+	 * @param length the number of valid entries.
+	 */
+	public void add(final int x, final int[] successor, final int offset, final int length) throws InterruptedException {
+		if (x < 0) throw new IllegalArgumentException("Illegal node index " + x);
+		put(x, Arrays.copyOfRange(successor, offset, offset + length));
+	}
+
+	/** Sets the successors of a given node to those contained in the specified array.
+	 *
+	 * <p>This method can be called concurrently by several producers (see the {@linkplain IncrementalImmutableSequentialGraph class documentation}).
+	 * The array must be sorted in increasing order. Adding {@link #END_OF_GRAPH} as the successor list of
+	 * node <var>n</var> signals that the graph has <var>n</var> nodes.
+	 *
+	 * @param x a node.
+	 * @param successor an array.
+	 */
+	public void add(final int x, final int[] successor) throws InterruptedException {
+		if (x < 0) throw new IllegalArgumentException("Illegal node index " + x);
+		put(x, successor);
 	}
 }
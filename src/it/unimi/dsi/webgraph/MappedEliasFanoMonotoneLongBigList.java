@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import java.io.DataOutputStream;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.LongBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.channels.FileChannel.MapMode;
+import java.util.NoSuchElementException;
+
+import it.unimi.dsi.bits.Fast;
+import it.unimi.dsi.bits.LongArrayBitVector;
+import it.unimi.dsi.fastutil.io.FastBufferedOutputStream;
+import it.unimi.dsi.fastutil.longs.AbstractLongBigList;
+import it.unimi.dsi.fastutil.longs.LongArrayList;
+import it.unimi.dsi.fastutil.longs.LongBigList;
+import it.unimi.dsi.fastutil.longs.LongIterator;
+import it.unimi.dsi.sux4j.util.EliasFanoMonotoneLongBigList;
+
+/** An Elias&ndash;Fano representation of a monotone sequence of longs stored in a flat file that
+ * can be {@linkplain #loadMapped(CharSequence) memory-mapped}.
+ *
+ * <p>Instances of this class are read-only views of a file written by {@link #store(LongIterator, long, long, CharSequence)}.
+ * Differently from {@link EliasFanoMonotoneLongBigList}, no deserialization is necessary: when the file is memory-mapped,
+ * loading takes constant time, and the pages of the file are shared through the page cache by all processes
+ * mapping it. Besides {@linkplain #getLong(long) access by index}, this class provides {@linkplain #weakPredecessorIndex(long) weak predecessor}
+ * search. All methods are thread safe.
+ *
+ * <p>The file is a sequence of little-endian longs. A header containing a magic number, the
+ * {@linkplain #VERSION version} of the format, the number of elements, an (exclusive) upper bound on the elements, the number of lower bits
+ * and the lengths of the following sections is followed by the lower bits, the upper bits,
+ * and two selection inventories for ones and zeros in the upper bits. An inventory records the position
+ * of one every {@value #INVENTORY_SPACING} ones (zeros); if the ones of a block span more than {@value #MAX_SPAN} bits, their positions
+ * are recorded explicitly in a spill list. As a result, selection requires scanning at most {@value #MAX_SPAN} bits, and
+ * just a few words on typical upper-bits arrays, whose density is approximately one half.
+ */
+
+public final class MappedEliasFanoMonotoneLongBigList extends AbstractLongBigList {
+	/** The magic number at the start of the file (the ASCII codes of <code>WGEFLIST</code>). */
+	public static final long MAGIC = 0x574745464C495354L;
+	/** The current version of the file format. */
+	public static final int VERSION = 0;
+	/** The number of longs in the header. */
+	private static final int HEADER_LONGS = 11;
+	/** The base-2 logarithm of the number of ones (zeros) between inventory entries. */
+	private static final int LOG2_INVENTORY_SPACING = 8;
+	/** The number of ones (zeros) between inventory entries. */
+	public static final int INVENTORY_SPACING = 1 << LOG2_INVENTORY_SPACING;
+	/** The maximum span in bits of an inventory block; the positions of the ones (zeros) of larger blocks are stored explicitly. */
+	public static final int MAX_SPAN = 1 << 16;
+	/** The base-2 logarithm of the number of longs in a chunk. */
+	private static final int LOG2_CHUNK_LONGS = 27;
+	/** The mask used to compute the index of a long in a chunk. */
+	private static final long CHUNK_MASK = (1L << LOG2_CHUNK_LONGS) - 1;
+
+	/** The chunks of the file, as long buffers. */
+	private final LongBuffer[] chunk;
+	/** The number of elements. */
+	private final long length;
+	/** An (exclusive) upper bound on the elements. */
+	private final long upperBound;
+	/** The number of lower bits. */
+	private final int l;
+	/** The mask for lower bits. */
+	private final long lowerBitsMask;
+	/** The number of zeros in the upper bits. */
+	private final long numZeros;
+	/** The index of the first long of the lower bits. */
+	private final long lowerBits;
+	/** The index of the first long of the upper bits. */
+	private final long upperBits;
+	/** The index of the first long of the inventory of ones. */
+	private final long onesInventory;
+	/** The index of the first long of the spill list of ones. */
+	private final long onesSpill;
+	/** The index of the first long of the inventory of zeros. */
+	private final long zerosInventory;
+	/** The index of the first long of the spill list of zeros. */
+	private final long zerosSpill;
+	/** The overall number of longs. */
+	private final long numLongs;
+
+	private MappedEliasFanoMonotoneLongBigList(final LongBuffer[] chunk, final CharSequence filename) throws IOException {
+		this.chunk = chunk;
+		long s = 0;
+		for(final LongBuffer b : chunk) s += b.capacity();
+		numLongs = s;
+		if (numLongs < HEADER_LONGS || word(0) != MAGIC) throw new IOException("File " + filename + " does not contain an Elias-Fano list");
+		if (word(1) > VERSION) throw new IOException("File " + filename + " uses format " + word(1) + ", but this class can understand only formats up to " + VERSION);
+		length = word(2);
+		upperBound = word(3);
+		l = (int)word(4);
+		lowerBitsMask = (1L << l) - 1;
+		lowerBits = HEADER_LONGS;
+		upperBits = lowerBits + word(5);
+		numZeros = word(6) - length;
+		onesInventory = upperBits + (word(6) + Long.SIZE - 1) / Long.SIZE;
+		onesSpill = onesInventory + word(7);
+		zerosInventory = onesSpill + word(8);
+		zerosSpill = zerosInventory + word(9);
+		if (zerosSpill + word(10) != numLongs) throw new IOException("File " + filename + " has length " + numLongs * Long.BYTES + ", but its header implies length " + (zerosSpill + word(10)) * Long.BYTES);
+	}
+
+	private long word(final long index) {
+		return chunk[(int)(index >>> LOG2_CHUNK_LONGS)].get((int)(index & CHUNK_MASK));
+	}
+
+	/** Returns the lower bits of an element.
+	 *
+	 * @param index the index of an element.
+	 * @return the lower bits of the element of given index.
+	 */
+	private long lower(final long index) {
+		if (l == 0) return 0;
+		final long position = index * l;
+		final long w = lowerBits + position / Long.SIZE;
+		final int bit = (int)(position % Long.SIZE);
+		if (bit + l <= Long.SIZE) return word(w) >>> bit & lowerBitsMask;
+		return (word(w) >>> bit | word(w + 1) << -bit) & lowerBitsMask;
+	}
+
+	/** Returns the position of a one or of a zero of given rank in the upper bits.
+	 *
+	 * @param rank the rank of a one (zero).
+	 * @param inventory the index of the first long of the inventory.
+	 * @param spill the index of the first long of the spill list.
+	 * @param zeros whether we are selecting zeros.
+	 * @return the position in the upper bits of the one (zero) of given rank.
+	 */
+	private long select(final long rank, final long inventory, final long spill, final boolean zeros) {
+		final long entry = word(inventory + (rank >>> LOG2_INVENTORY_SPACING));
+		if (entry < 0) return word(spill - entry - 1 + (rank & INVENTORY_SPACING - 1));
+		int residual = (int)(rank & INVENTORY_SPACING - 1);
+		long w = entry / Long.SIZE;
+		long window = (zeros ? ~word(upperBits + w) : word(upperBits + w)) & -1L << entry;
+		for(int bitCount; residual >= (bitCount = Long.bitCount(window)); residual -= bitCount) window = zeros ? ~word(upperBits + ++w) : word(upperBits + ++w);
+		return w * Long.SIZE + Fast.select(window, residual);
+	}
+
+	@Override
+	public long getLong(final long index) {
+		if (index < 0 || index >= length) throw new IndexOutOfBoundsException("Index (" + index + ") is not in the range [0.." + length + ")");
+		return select(index, onesInventory, onesSpill, false) - index << l | lower(index);
+	}
+
+	/** Returns the index of the last element smaller than or equal to a given value.
+	 *
+	 * @param value a value.
+	 * @return the index of the last element smaller than or equal to {@code value}, or -1 if
+	 * all elements are larger than {@code value}.
+	 */
+	public long weakPredecessorIndex(final long value) {
+		if (value < 0 || length == 0) return -1;
+		final long upper = value >>> l;
+		if (upper >= numZeros) return length - 1;
+		// The elements with upper bits equal to upper have indices in [from..to)
+		final long to = select(upper, zerosInventory, zerosSpill, true) - upper;
+		long from = upper == 0 ? 0 : select(upper - 1, zerosInventory, zerosSpill, true) - (upper - 1);
+		// Binary search for the first element of the bucket whose lower bits are larger than those of value
+		final long valueLower = value & lowerBitsMask;
+		for(long t = to; from < t;) {
+			final long mid = (from + t) >>> 1;
+			if (lower(mid) <= valueLower) from = mid + 1;
+			else t = mid;
+		}
+		return from - 1;
+	}
+
+	@Override
+	public long size64() {
+		return length;
+	}
+
+	/** Returns an (exclusive) upper bound on the elements of this list.
+	 *
+	 * @return the upper bound provided at construction time.
+	 */
+	public long upperBound() {
+		return upperBound;
+	}
+
+	/** Returns the number of bits used by this list (including the header and the inventories).
+	 *
+	 * @return the number of bits used by this list.
+	 */
+	public long numBits() {
+		return numLongs * Long.SIZE;
+	}
+
+	/** Loads a list in main memory.
+	 *
+	 * @param filename the name of a file written by {@link #store(LongIterator, long, long, CharSequence)}.
+	 * @return the list.
+	 */
+	public static MappedEliasFanoMonotoneLongBigList load(final CharSequence filename) throws IOException {
+		return load(filename, false);
+	}
+
+	/** Loads a list by memory-mapping its file.
+	 *
+	 * @param filename the name of a file written by {@link #store(LongIterator, long, long, CharSequence)}.
+	 * @return the list.
+	 */
+	public static MappedEliasFanoMonotoneLongBigList loadMapped(final CharSequence filename) throws IOException {
+		return load(filename, true);
+	}
+
+	private static MappedEliasFanoMonotoneLongBigList load(final CharSequence filename, final boolean mapped) throws IOException {
+		final FileInputStream fis = new FileInputStream(filename.toString());
+		final FileChannel channel = fis.getChannel();
+		final long size = channel.size();
+		if (size % Long.BYTES != 0) throw new IOException("The length of file " + filename + " is not a multiple of " + Long.BYTES);
+		final long chunkBytes = (CHUNK_MASK + 1) * Long.BYTES;
+		final LongBuffer[] chunk = new LongBuffer[(int)((size + chunkBytes - 1) / chunkBytes)];
+		for(int c = 0; c < chunk.length; c++) {
+			final long position = c * chunkBytes;
+			final int chunkSize = (int)Math.min(chunkBytes, size - position);
+			final ByteBuffer buffer;
+			if (mapped) buffer = channel.map(MapMode.READ_ONLY, position, chunkSize);
+			else {
+				buffer = ByteBuffer.allocate(chunkSize);
+				while(buffer.hasRemaining()) if (channel.read(buffer) == -1) throw new IOException("Unexpected end of file in " + filename);
+				buffer.flip();
+			}
+			chunk[c] = buffer.order(ByteOrder.LITTLE_ENDIAN).asLongBuffer();
+		}
+		fis.close();
+		return new MappedEliasFanoMonotoneLongBigList(chunk, filename);
+	}
+
+	/** Stores a monotone sequence of longs in a file that can be loaded by {@link #load(CharSequence)} or {@link #loadMapped(CharSequence)}.
+	 *
+	 * @param values an iterator returning a nondecreasing sequence of {@code length} nonnegative longs.
+	 * @param length the number of elements.
+	 * @param upperBound an (exclusive) upper bound on the elements.
+	 * @param filename the name of the file to be written.
+	 */
+	public static void store(final LongIterator values, final long length, final long upperBound, final CharSequence filename) throws IOException {
+		final int l = length == 0 ? 0 : Math.max(0, Fast.mostSignificantBit(upperBound / length));
+		final long lowerBitsMask = (1L << l) - 1;
+		final LongArrayBitVector lowerBits = LongArrayBitVector.getInstance(length * l);
+		final LongBigList lowerBitsList = l == 0 ? null : lowerBits.asLongBigList(l);
+		if (l != 0) lowerBitsList.size(length);
+		final LongArrayBitVector upperBits = LongArrayBitVector.getInstance().length(length + (upperBound >>> l) + 1);
+
+		long last = 0;
+		for(long i = 0; i < length; i++) {
+			if (! values.hasNext()) throw new NoSuchElementException("The iterator returned " + i + " elements, but " + length + " were expected");
+			final long v = values.nextLong();
+			if (v < last) throw new IllegalArgumentException("The values are not monotone: " + v + " < " + last);
+			if (v >= upperBound) throw new IllegalArgumentException("Too large value: " + v + " >= " + upperBound);
+			if (l != 0) lowerBitsList.set(i, v & lowerBitsMask);
+			upperBits.set((v >>> l) + i);
+			last = v;
+		}
+
+		final LongArrayList onesInventory = new LongArrayList(), onesSpill = new LongArrayList();
+		final LongArrayList zerosInventory = new LongArrayList(), zerosSpill = new LongArrayList();
+		inventory(upperBits, false, onesInventory, onesSpill);
+		inventory(upperBits, true, zerosInventory, zerosSpill);
+
+		final long lowerBitsWords = (length * l + Long.SIZE - 1) / Long.SIZE;
+		final long upperBitsWords = (upperBits.length() + Long.SIZE - 1) / Long.SIZE;
+		final DataOutputStream dos = new DataOutputStream(new FastBufferedOutputStream(new FileOutputStream(filename.toString())));
+		for(final long h : new long[] { MAGIC, VERSION, length, upperBound, l, lowerBitsWords, upperBits.length(), onesInventory.size(), onesSpill.size(), zerosInventory.size(), zerosSpill.size() }) writeLong(dos, h);
+		for(long i = 0; i < lowerBitsWords; i++) writeLong(dos, lowerBits.getLong(i * Long.SIZE, Math.min((i + 1) * Long.SIZE, length * l)));
+		for(long i = 0; i < upperBitsWords; i++) writeLong(dos, upperBits.getLong(i * Long.SIZE, Math.min((i + 1) * Long.SIZE, upperBits.length())));
+		for(final LongArrayList list : new LongArrayList[] { onesInventory, onesSpill, zerosInventory, zerosSpill })
+			for(int i = 0; i < list.size(); i++) writeLong(dos, list.getLong(i));
+		dos.close();
+	}
+
+	private static void writeLong(final DataOutputStream dos, final long x) throws IOException {
+		dos.writeLong(Long.reverseBytes(x));
+	}
+
+	/** Computes the inventory and the spill list for the ones or for the zeros of a bit vector.
+	 *
+	 * @param bits a bit vector.
+	 * @param zeros whether to index zeros instead of ones.
+	 * @param inventory a list that will be filled with the inventory.
+	 * @param spill a list that will be filled with the spilled positions.
+	 */
+	private static void inventory(final LongArrayBitVector bits, final boolean zeros, final LongArrayList inventory, final LongArrayList spill) {
+		final long[] block = new long[INVENTORY_SPACING];
+		int c = 0;
+		final long length = bits.length();
+		for(long p = 0; p < length; p += Long.SIZE) {
+			long w = bits.getLong(p, Math.min(p + Long.SIZE, length));
+			if (zeros) w = ~w & (p + Long.SIZE <= length ? -1L : (1L << length - p) - 1);
+			for(; w != 0; w &= w - 1) {
+				block[c++] = p + Long.numberOfTrailingZeros(w);
+				if (c == INVENTORY_SPACING) {
+					addBlock(block, c, inventory, spill);
+					c = 0;
+				}
+			}
+		}
+		if (c != 0) addBlock(block, c, inventory, spill);
+	}
+
+	private static void addBlock(final long[] block, final int c, final LongArrayList inventory, final LongArrayList spill) {
+		if (block[c - 1] - block[0] < MAX_SPAN) inventory.add(block[0]);
+		else {
+			inventory.add(-spill.size() - 1);
+			spill.addElements(spill.size(), block, 0, c);
+		}
+	}
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import java.io.File;
+import java.io.IOException;
+import java.util.NoSuchElementException;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import it.unimi.dsi.fastutil.ints.IntIterator;
+import it.unimi.dsi.fastutil.longs.LongIterator;
+import it.unimi.dsi.logging.ProgressLogger;
+
+/** An index on the outdegrees of a graph, answering outdegree queries and locating the node
+ * of an arc of given rank in constant time.
+ *
+ * <p>The index is the cumulative function of outdegrees (i.e., the sequence of the numbers of arcs
+ * whose source is smaller than <var>x</var>, for 0&nbsp;&le;&nbsp;<var>x</var>&nbsp;&le;&nbsp;<var>n</var>)
+ * stored as a {@link MappedEliasFanoMonotoneLongBigList} in a file with extension {@link #OUTDEGREE_INDEX_EXTENSION}. Thus,
+ * it occupies approximately 2&nbsp;+&nbsp;log(<var>m</var>&nbsp;/&nbsp;<var>n</var>) bits per node, and it can be memory-mapped. Besides
+ * outdegrees, the index provides {@linkplain #node(long) the node owning the arc of a given rank}, which makes it
+ * possible to split a graph into segments containing approximately the same number of arcs
+ * (see {@link #splitPoints(int)}).
+ *
+ * <p>The index can be written at compression time by
+ * {@link BVGraph#store(ImmutableGraph, CharSequence, int, int, int, int, int, int, boolean, boolean, ProgressLogger)} (or by
+ * using the <code>--degree-index</code> option of {@link BVGraph#main(String[])}), and it is then loaded
+ * and used automatically by {@link BVGraph} to compute {@linkplain BVGraph#outdegree(int) outdegrees}
+ * and {@linkplain BVGraph#splitNodeIterators(int) balanced node iterators}. All methods are thread safe.
+ */
+
+public class OutdegreeIndex {
+	private static final Logger LOGGER = LoggerFactory.getLogger(OutdegreeIndex.class);
+
+	/** The standard extension for outdegree indices. */
+	public static final String OUTDEGREE_INDEX_EXTENSION = ".dcf";
+
+	/** The number of nodes. */
+	public final int numNodes;
+	/** The number of arcs. */
+	public final long numArcs;
+	/** The cumulative function of outdegrees (<var>n</var> + 1 values). */
+	private final MappedEliasFanoMonotoneLongBigList cumulativeOutdegrees;
+
+	protected OutdegreeIndex(final MappedEliasFanoMonotoneLongBigList cumulativeOutdegrees) {
+		if (cumulativeOutdegrees.size64() - 1 > Integer.MAX_VALUE) throw new IllegalArgumentException("Too many nodes: " + (cumulativeOutdegrees.size64() - 1));
+		this.cumulativeOutdegrees = cumulativeOutdegrees;
+		numNodes = (int)(cumulativeOutdegrees.size64() - 1);
+		numArcs = cumulativeOutdegrees.getLong(numNodes);
+	}
+
+	/** Returns the outdegree of a node.
+	 *
+	 * @param x a node.
+	 * @return the outdegree of {@code x}.
+	 */
+	public int outdegree(final int x) {
+		if (x < 0 || x >= numNodes) throw new IllegalArgumentException("Node index out of range: " + x);
+		return (int)(cumulativeOutdegrees.getLong(x + 1) - cumulativeOutdegrees.getLong(x));
+	}
+
+	/** Returns the number of arcs whose source is smaller than a given node.
+	 *
+	 * @param x a node, or the number of nodes.
+	 * @return the sum of the outdegrees of the nodes smaller than {@code x}.
+	 */
+	public long cumulativeOutdegree(final int x) {
+		if (x < 0 || x > numNodes) throw new IllegalArgumentException("Node index out of range: " + x);
+		return cumulativeOutdegrees.getLong(x);
+	}
+
+	/** Returns the source of the arc of given rank, that is, the node <var>x</var> such that
+	 * {@link #cumulativeOutdegree(int) cumulativeOutdegree(<var>x</var>)}&nbsp;&le;&nbsp;<var>r</var>&nbsp;&lt;&nbsp;{@link #cumulativeOutdegree(int) cumulativeOutdegree(<var>x</var>&nbsp;+&nbsp;1)}.
+	 *
+	 * @param r the rank of an arc in the lexicographical order of arcs.
+	 * @return the source of the arc of rank {@code r}.
+	 */
+	public int node(final long r) {
+		if (r < 0 || r >= numArcs) throw new IllegalArgumentException("Arc rank out of range: " + r);
+		return (int)cumulativeOutdegrees.weakPredecessorIndex(r);
+	}
+
+	/** Returns split points dividing the nodes in segments containing approximately the same number of arcs.
+	 *
+	 * @param howMany the number of segments.
+	 * @return an array of {@code howMany} + 1 nondecreasing nodes, starting with zero and ending with the number of nodes;
+	 * segment <var>i</var> contains the nodes from element <var>i</var> (inclusive) to element <var>i</var> + 1 (exclusive).
+	 */
+	public int[] splitPoints(final int howMany) {
+		if (howMany < 1) throw new IllegalArgumentException();
+		final int[] split = new int[howMany + 1];
+		for(int i = 1; i < howMany; i++) {
+			final long r = numArcs / howMany * i + numArcs % howMany * i / howMany;
+			split[i] = Math.max(split[i - 1], r < numArcs ? node(r) : numNodes);
+		}
+		split[howMany] = numNodes;
+		return split;
+	}
+
+	/** Returns an iterator enumerating the outdegrees of the nodes, in order.
+	 *
+	 * @return an iterator enumerating the outdegrees of the nodes, in order.
+	 */
+	public IntIterator outdegrees() {
+		return new IntIterator() {
+			private int x = 0;
+			private long prev = 0;
+
+			@Override
+			public boolean hasNext() {
+				return x < numNodes;
+			}
+
+			@Override
+			public int nextInt() {
+				if (! hasNext()) throw new NoSuchElementException();
+				final long next = cumulativeOutdegrees.getLong(++x);
+				final int d = (int)(next - prev);
+				prev = next;
+				return d;
+			}
+		};
+	}
+
+	/** Stores the outdegree index of a graph.
+	 *
+	 * <p>Outdegrees are streamed from {@link ImmutableGraph#outdegrees()}, so no memory proportional to the number of nodes is
+	 * needed. If the graph does not know its {@linkplain ImmutableGraph#numArcs() number of arcs}, outdegrees are enumerated twice.
+	 *
+	 * @param graph a graph.
+	 * @param basename the basename of the graph.
+	 * @param pl a progress logger, or {@code null}.
+	 * @throws IOException if an exception is raised while writing the index.
+	 */
+	public static void store(final ImmutableGraph graph, final CharSequence basename, final ProgressLogger pl) throws IOException {
+		final int n = graph.numNodes();
+		long m;
+		try {
+			m = graph.numArcs();
+		}
+		catch(final UnsupportedOperationException e) {
+			// We need a first pass to compute the number of arcs, which is the upper bound of the cumulative function
+			m = 0;
+			final IntIterator outdegrees = graph.outdegrees();
+			for(int i = 0; i < n; i++) m += outdegrees.nextInt();
+		}
+		if (pl != null) {
+			pl.itemsName = "nodes";
+			pl.expectedUpdates = n;
+			pl.start("Computing outdegree index...");
+		}
+		final IntIterator outdegrees = graph.outdegrees();
+		store(n, m, new IntIterator() {
+			@Override
+			public boolean hasNext() {
+				return outdegrees.hasNext();
+			}
+
+			@Override
+			public int nextInt() {
+				if (pl != null) pl.lightUpdate();
+				return outdegrees.nextInt();
+			}
+		}, basename);
+		if (pl != null) pl.done();
+	}
+
+	/** Stores an outdegree index given the sequence of outdegrees.
+	 *
+	 * @param numNodes the number of nodes.
+	 * @param numArcs the number of arcs.
+	 * @param outdegrees an iterator returning (at least) {@code numNodes} outdegrees whose sum is {@code numArcs}.
+	 * @param basename the basename of the graph.
+	 * @throws IOException if an exception is raised while writing the index.
+	 */
+	public static void store(final int numNodes, final long numArcs, final IntIterator outdegrees, final CharSequence basename) throws IOException {
+		MappedEliasFanoMonotoneLongBigList.store(new LongIterator() {
+			private int i = 0;
+			private long c = 0;
+
+			@Override
+			public boolean hasNext() {
+				return i <= numNodes;
+			}
+
+			@Override
+			public long nextLong() {
+				if (! hasNext()) throw new NoSuchElementException();
+				if (i++ == 0) return 0;
+				return c += outdegrees.nextInt();
+			}
+		}, numNodes + 1L, numArcs + 1, basename + OUTDEGREE_INDEX_EXTENSION);
+	}
+
+	/** Loads an outdegree index in main memory.
+	 *
+	 * @param basename the basename of the graph the index refers to.
+	 * @return the index.
+	 * @throws IOException if an exception is raised while reading the index.
+	 */
+	public static OutdegreeIndex load(final CharSequence basename) throws IOException {
+		return new OutdegreeIndex(MappedEliasFanoMonotoneLongBigList.load(basename + OUTDEGREE_INDEX_EXTENSION));
+	}
+
+	/** Loads an outdegree index by memory-mapping it.
+	 *
+	 * @param basename the basename of the graph the index refers to.
+	 * @return the index.
+	 * @throws IOException if an exception is raised while mapping the index.
+	 */
+	public static OutdegreeIndex loadMapped(final CharSequence basename) throws IOException {
+		return new OutdegreeIndex(MappedEliasFanoMonotoneLongBigList.loadMapped(basename + OUTDEGREE_INDEX_EXTENSION));
+	}
+
+	/** Loads the outdegree index of a graph, if available and up to date.
+	 *
+	 * <p>The index is considered stale (and thus ignored) if it is older than the property file of the graph, or if
+	 * its number of nodes does not match {@code numNodes}.
+	 *
+	 * @param basename the basename of a graph.
+	 * @param numNodes the number of nodes of the graph.
+	 * @param mapped whether to memory-map the index.
+	 * @return the outdegree index of the graph, or {@code null} if no up-to-date index is available.
+	 */
+	public static OutdegreeIndex load(final CharSequence basename, final int numNodes, final boolean mapped) {
+		final File indexFile = new File(basename + OUTDEGREE_INDEX_EXTENSION);
+		if (! indexFile.exists()) return null;
+		if (indexFile.lastModified() < new File(basename + ImmutableGraph.PROPERTIES_EXTENSION).lastModified()) {
+			LOGGER.warn("Outdegree index " + indexFile + " is older than the property file: ignoring it");
+			return null;
+		}
+
+		try {
+			final OutdegreeIndex index = mapped ? loadMapped(basename) : load(basename);
+			if (index.numNodes != numNodes) {
+				LOGGER.warn("Outdegree index " + indexFile + " has " + index.numNodes + " nodes, but the graph has " + numNodes + ": ignoring it");
+				return null;
+			}
+			return index;
+		}
+		catch(final IOException e) {
+			LOGGER.warn("Cannot load outdegree index " + indexFile, e);
+			return null;
+		}
+	}
+}
@@ -0,0 +1,496 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import java.io.Closeable;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.FileInputStream;
+import java.io.FileNotFoundException;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.OutputStreamWriter;
+import java.io.PrintWriter;
+import java.io.UnsupportedEncodingException;
+import java.net.Socket;
+import java.util.NoSuchElementException;
+import java.util.Properties;
+
+import com.martiansoftware.jsap.FlaggedOption;
+import com.martiansoftware.jsap.JSAP;
+import com.martiansoftware.jsap.JSAPException;
+import com.martiansoftware.jsap.JSAPResult;
+import com.martiansoftware.jsap.Parameter;
+import com.martiansoftware.jsap.SimpleJSAP;
+import com.martiansoftware.jsap.UnflaggedOption;
+
+import it.unimi.dsi.fastutil.ints.IntArrays;
+import it.unimi.dsi.fastutil.ints.IntIterator;
+import it.unimi.dsi.fastutil.io.FastBufferedInputStream;
+import it.unimi.dsi.fastutil.io.FastBufferedOutputStream;
+import it.unimi.dsi.lang.MutableString;
+import it.unimi.dsi.logging.ProgressLogger;
+
+/** An immutable graph served by a {@link GraphServer}.
+ *
+ * <p>Instances of this class are connected to a graph server, and retrieve outdegrees and
+ * successor lists on demand. Opening a remote graph takes just the time needed to connect to the server, and
+ * uses no memory for the graph. {@linkplain #nodeIterator(int) Node iterators} and the {@linkplain #outdegrees() outdegree iterator}
+ * retrieve data in batches of {@link #BATCH_SIZE} nodes, and {@link #outdegrees(int[])}, {@link #successorArrays(int[])}
+ * and {@link #isArcs(int[], int[])} make it possible to perform batched random accesses, amortising the latency of communication.
+ *
+ * <p>Single random accesses are cached: {@link #outdegree(int)} retrieves the successor list of the node, so that a subsequent
+ * call to {@link #successorArray(int)} on the same node does not need a further request, and calls on consecutive nodes
+ * prefetch the outdegrees or the successor lists of the following {@link #BATCH_SIZE} nodes.
+ *
+ * <p>Since every instance owns a connection, instances are not thread safe: use {@link #copy()}, which opens a new connection,
+ * to access a remote graph from multiple threads. Instances should be {@linkplain #close() closed} when they are no longer
+ * necessary.
+ *
+ * <p>A remote graph can be stored as a property file (which follows the convention established
+ * in {@link ImmutableGraph}) containing the following entries:
+ * <ul>
+ * <li><code>host</code>: the host of the server (default: the loopback interface);
+ * <li><code>port</code>: the port of the server (default: {@link GraphServer#DEFAULT_PORT});
+ * <li><code>graph</code>: the name of the graph on the server.
+ * </ul>
+ * Then, all load methods of {@link ImmutableGraph} will connect to the server. The main method of this class writes such a property file.
+ */
+
+public class RemoteImmutableGraph extends ImmutableGraph implements Closeable {
+	/** The property key for the host of the server. */
+	public static final String HOST_PROPERTY_KEY = "host";
+	/** The property key for the port of the server. */
+	public static final String PORT_PROPERTY_KEY = "port";
+	/** The property key for the name of the graph on the server. */
+	public static final String GRAPH_PROPERTY_KEY = "graph";
+	/** The number of nodes retrieved by each request of iterators. */
+	public static final int BATCH_SIZE = 1024;
+
+	/** The host of the server, or {@code null} for the loopback interface. */
+	private final String host;
+	/** The port of the server. */
+	private final int port;
+	/** The name of the graph on the server. */
+	private final String graph;
+	/** The socket connected to the server. */
+	private final Socket socket;
+	/** The stream of replies from the server. */
+	private final DataInputStream dis;
+	/** The stream of requests to the server. */
+	private final DataOutputStream dos;
+	/** The number of nodes. */
+	private final int n;
+	/** The number of arcs, or &minus;1 if it is unknown. */
+	private final long m;
+	/** The basename of the property file describing this graph, if any. */
+	private CharSequence basename;
+	/** The first node whose outdegree is cached in {@link #outdegreeCache}. */
+	private int outdegreeBase;
+	/** The cached outdegrees of the nodes starting from {@link #outdegreeBase}. */
+	private int[] outdegreeCache = IntArrays.EMPTY_ARRAY;
+	/** The first node whose successor list is cached in {@link #successorCache}. */
+	private int successorBase;
+	/** The cached successor lists of the nodes starting from {@link #successorBase}. */
+	private int[][] successorCache = new int[0][];
+	/** The argument of the last call to {@link #outdegree(int)}, used to detect sequential accesses. */
+	private int lastOutdegree = -2;
+	/** The argument of the last call to {@link #successorArray(int)}, used to detect sequential accesses. */
+	private int lastSuccessorArray = -2;
+
+	/** Connects to a graph server.
+	 *
+	 * @param host the host of the server, or {@code null} for the loopback interface.
+	 * @param port the port of the server.
+	 * @param graph the name of the graph on the server.
+	 */
+	public RemoteImmutableGraph(final String host, final int port, final String graph) throws IOException {
+		this.host = host;
+		this.port = port;
+		this.graph = graph;
+		socket = new Socket(host, port);
+		socket.setTcpNoDelay(true);
+		dis = new DataInputStream(new FastBufferedInputStream(socket.getInputStream()));
+		dos = new DataOutputStream(new FastBufferedOutputStream(socket.getOutputStream()));
+		dos.writeUTF(graph);
+		dos.flush();
+		n = dis.readInt();
+		if (n < 0) {
+			socket.close();
+			throw new IOException("The server at " + socket.getRemoteSocketAddress() + " does not serve graph " + graph);
+		}
+		m = dis.readLong();
+	}
+
+	@Override
+	public int numNodes() {
+		return n;
+	}
+
+	@Override
+	public long numArcs() {
+		if (m < 0) throw new UnsupportedOperationException();
+		return m;
+	}
+
+	@Override
+	public boolean randomAccess() {
+		return true;
+	}
+
+	@Override
+	public CharSequence basename() {
+		return basename;
+	}
+
+	private void checkNode(final int x) {
+		if (x < 0 || x >= n) throw new IllegalArgumentException("Node index out of range: " + x);
+	}
+
+	private void writeNodes(final byte request, final int[] node, final int offset, final int length) throws IOException {
+		dos.writeByte(request);
+		dos.writeInt(length);
+		for(int i = offset; i < offset + length; i++) dos.writeInt(node[i]);
+		dos.flush();
+	}
+
+	private static int[] interval(final int from, final int length) {
+		final int[] node = new int[length];
+		for(int i = 0; i < length; i++) node[i] = from + i;
+		return node;
+	}
+
+	private int[] readSuccessors() throws IOException {
+		final int[] successor = new int[dis.readInt()];
+		for(int j = 0; j < successor.length; j++) successor[j] = dis.readInt();
+		return successor;
+	}
+
+	/** Returns the outdegrees of an array of nodes using a single request (or a request
+	 * for every {@link GraphServer#MAX_REQUEST_SIZE} nodes).
+	 *
+	 * @param node an array of nodes.
+	 * @return the array of outdegrees of the given nodes.
+	 */
+	public int[] outdegrees(final int[] node) {
+		for(final int x : node) checkNode(x);
+		try {
+			final int[] outdegree = new int[node.length];
+			for(int offset = 0; offset < node.length; offset += GraphServer.MAX_REQUEST_SIZE) {
+				final int length = Math.min(GraphServer.MAX_REQUEST_SIZE, node.length - offset);
+				writeNodes(GraphServer.OUTDEGREES, node, offset, length);
+				for(int i = offset; i < offset + length; i++) outdegree[i] = dis.readInt();
+			}
+			return outdegree;
+		}
+		catch(final IOException e) {
+			throw new RuntimeException(e);
+		}
+	}
+
+	/** Returns the successor lists of an array of nodes using a single request (or a request
+	 * for every {@link GraphServer#MAX_REQUEST_SIZE} nodes).
+	 *
+	 * @param node an array of nodes.
+	 * @return the array of successor lists of the given nodes; the length of each list is the outdegree of the corresponding node.
+	 */
+	public int[][] successorArrays(final int[] node) {
+		for(final int x : node) checkNode(x);
+		try {
+			final int[][] successor = new int[node.length][];
+			for(int offset = 0; offset < node.length; offset += GraphServer.MAX_REQUEST_SIZE) {
+				final int length = Math.min(GraphServer.MAX_REQUEST_SIZE, node.length - offset);
+				writeNodes(GraphServer.SUCCESSORS, node, offset, length);
+				for(int i = offset; i < offset + length; i++) successor[i] = readSuccessors();
+			}
+			return successor;
+		}
+		catch(final IOException e) {
+			throw new RuntimeException(e);
+		}
+	}
+
+	/** Returns whether the given pairs of nodes are arcs using a single request (or a request
+	 * for every {@link GraphServer#MAX_REQUEST_SIZE} pairs).
+	 *
+	 * @param source an array of sources.
+	 * @param target an array of targets, of the same length as {@code source}.
+	 * @return an array whose <var>i</var>-th element tells whether there is an arc from {@code source[i]} to {@code target[i]}.
+	 */
+	public boolean[] isArcs(final int[] source, final int[] target) {
+		if (source.length != target.length) throw new IllegalArgumentException("Arrays of different lengths: " + source.length + " != " + target.length);
+		for(final int x : source) checkNode(x);
+		for(final int y : target) checkNode(y);
+		try {
+			final boolean[] isArc = new boolean[source.length];
+			for(int offset = 0; offset < source.length; offset += GraphServer.MAX_REQUEST_SIZE) {
+				final int length = Math.min(GraphServer.MAX_REQUEST_SIZE, source.length - offset);
+				dos.writeByte(GraphServer.ARCS);
+				dos.writeInt(length);
+				for(int i = offset; i < offset + length; i++) {
+					dos.writeInt(source[i]);
+					dos.writeInt(target[i]);
+				}
+				dos.flush();
+				for(int i = offset; i < offset + length; i++) isArc[i] = dis.readBoolean();
+			}
+			return isArc;
+		}
+		catch(final IOException e) {
+			throw new RuntimeException(e);
+		}
+	}
+
+	/** Returns whether there is an arc between two nodes.
+	 *
+	 * <p>If the successor list of {@code x} is cached, no request is sent to the server.
+	 *
+	 * @param x a node.
+	 * @param y a node.
+	 * @return whether there is an arc from {@code x} to {@code y}.
+	 */
+	public boolean isArc(final int x, final int y) {
+		checkNode(y);
+		if (x >= successorBase && x < successorBase + successorCache.length) {
+			for(final int s : successorCache[x - successorBase]) if (s == y) return true;
+			return false;
+		}
+		return isArcs(new int[] { x }, new int[] { y })[0];
+	}
+
+	/** Returns the successor lists of an interval of nodes using a single request.
+	 *
+	 * @param from the first node.
+	 * @param length the number of nodes.
+	 * @return the array of successor lists of the nodes from {@code from} (inclusive) to {@code from + length} (exclusive).
+	 */
+	private int[][] successorArrays(final int from, final int length) {
+		try {
+			dos.writeByte(GraphServer.NODES);
+			dos.writeInt(from);
+			dos.writeInt(length);
+			dos.flush();
+			final int[][] successor = new int[length][];
+			for(int i = 0; i < length; i++) successor[i] = readSuccessors();
+			return successor;
+		}
+		catch(final IOException e) {
+			throw new RuntimeException(e);
+		}
+	}
+
+	@Override
+	public int outdegree(final int x) {
+		checkNode(x);
+		final boolean sequential = x == lastOutdegree + 1;
+		lastOutdegree = x;
+		if (x >= successorBase && x < successorBase + successorCache.length) return successorCache[x - successorBase].length;
+		if (x < outdegreeBase || x >= outdegreeBase + outdegreeCache.length) {
+			if (! sequential) return successorArray(x).length;
+			outdegreeBase = x;
+			outdegreeCache = outdegrees(interval(x, Math.min(BATCH_SIZE, n - x)));
+		}
+		return outdegreeCache[x - outdegreeBase];
+	}
+
+	@Override
+	public int[] successorArray(final int x) {
+		checkNode(x);
+		final boolean sequential = x == lastSuccessorArray + 1;
+		lastSuccessorArray = x;
+		if (x < successorBase || x >= successorBase + successorCache.length) {
+			successorBase = x;
+			successorCache = successorArrays(interval(x, sequential ? Math.min(BATCH_SIZE, n - x) : 1));
+		}
+		return successorCache[x - successorBase];
+	}
+
+	@Override
+	public LazyIntIterator successors(final int x) {
+		return LazyIntIterators.wrap(successorArray(x));
+	}
+
+	@Override
+	public NodeIterator nodeIterator(final int from) {
+		if (from < 0 || from > n) throw new IllegalArgumentException("Node index out of range: " + from);
+		return new NodeIterator() {
+			/** The successor lists of the current batch. */
+			private int[][] batch = new int[0][];
+			/** The first node of the current batch. */
+			private int base = from;
+			/** The current node, or {@code from} &minus; 1 before the first call to {@link #nextInt()}. */
+			private int curr = from - 1;
+
+			@Override
+			public boolean hasNext() {
+				return curr < n - 1;
+			}
+
+			@Override
+			public int nextInt() {
+				if (! hasNext()) throw new NoSuchElementException();
+				if (++curr - base == batch.length) {
+					base = curr;
+					batch = successorArrays(curr, Math.min(BATCH_SIZE, n - curr));
+				}
+				return curr;
+			}
+
+			@Override
+			public int outdegree() {
+				if (curr < from) throw new IllegalStateException();
+				return batch[curr - base].length;
+			}
+
+			@Override
+			public int[] successorArray() {
+				if (curr < from) throw new IllegalStateException();
+				return batch[curr - base];
+			}
+		};
+	}
+
+	@Override
+	public IntIterator outdegrees() {
+		return new IntIterator() {
+			/** The outdegrees of the current batch. */
+			private int[] batch = new int[0];
+			/** The position in the current batch. */
+			private int pos;
+			/** The next node. */
+			private int next;
+
+			@Override
+			public boolean hasNext() {
+				return next < n;
+			}
+
+			@Override
+			public int nextInt() {
+				if (! hasNext()) throw new NoSuchElementException();
+				if (pos == batch.length) {
+					batch = outdegrees(interval(next, Math.min(BATCH_SIZE, n - next)));
+					pos = 0;
+				}
+				next++;
+				return batch[pos++];
+			}
+		};
+	}
+
+	/** Returns a new connection to the same graph.
+	 *
+	 * @return a new connection to the same graph.
+	 */
+	@Override
+	public RemoteImmutableGraph copy() {
+		try {
+			final RemoteImmutableGraph copy = new RemoteImmutableGraph(host, port, graph);
+			copy.basename = basename;
+			return copy;
+		}
+		catch(final IOException e) {
+			throw new RuntimeException(e);
+		}
+	}
+
+	/** Closes the connection to the server. */
+	@Override
+	public void close() throws IOException {
+		if (socket.isClosed()) return;
+		try {
+			dos.writeByte(GraphServer.CLOSE);
+			dos.flush();
+		}
+		finally {
+			socket.close();
+		}
+	}
+
+	@Deprecated
+	public static ImmutableGraph loadSequential(final CharSequence basename) throws IOException {
+		return load(basename);
+	}
+
+	@Deprecated
+	public static ImmutableGraph loadSequential(final CharSequence basename, final ProgressLogger unused) throws IOException {
+		return load(basename);
+	}
+
+	public static ImmutableGraph loadOffline(final CharSequence basename) throws IOException {
+		return load(basename);
+	}
+
+	public static ImmutableGraph loadOffline(final CharSequence basename, final ProgressLogger unused) throws IOException {
+		return load(basename);
+	}
+
+	public static ImmutableGraph loadMapped(final CharSequence basename) throws IOException {
+		return load(basename);
+	}
+
+	public static ImmutableGraph loadMapped(final CharSequence basename, final ProgressLogger unused) throws IOException {
+		return load(basename);
+	}
+
+	public static ImmutableGraph load(final CharSequence basename, final ProgressLogger unused) throws IOException {
+		return load(basename);
+	}
+
+	/** Connects to the graph server specified by a property file.
+	 *
+	 * @param basename the basename of the property file.
+	 * @return a remote graph connected to the server specified by the property file.
+	 */
+	public static ImmutableGraph load(final CharSequence basename) throws IOException {
+		final FileInputStream propertyFile = new FileInputStream(basename + PROPERTIES_EXTENSION);
+		final Properties properties = new Properties();
+		properties.load(propertyFile);
+		propertyFile.close();
+
+		final String graphClassName = properties.getProperty(ImmutableGraph.GRAPHCLASS_PROPERTY_KEY);
+		if (! RemoteImmutableGraph.class.getName().equals(graphClassName)) throw new IOException("This class (" + RemoteImmutableGraph.class.getName() + ") cannot load a graph stored using " + graphClassName);
+		final String graph = properties.getProperty(GRAPH_PROPERTY_KEY);
+		if (graph == null) throw new IOException("This property file does not specify the required property " + GRAPH_PROPERTY_KEY);
+
+		final RemoteImmutableGraph remoteImmutableGraph = new RemoteImmutableGraph(properties.getProperty(HOST_PROPERTY_KEY), Integer.parseInt(properties.getProperty(PORT_PROPERTY_KEY, Integer.toString(GraphServer.DEFAULT_PORT))), graph);
+		remoteImmutableGraph.basename = new MutableString(basename);
+		return remoteImmutableGraph;
+	}
+
+	public static void main(final String args[]) throws JSAPException, UnsupportedEncodingException, FileNotFoundException {
+		final SimpleJSAP jsap = new SimpleJSAP(RemoteImmutableGraph.class.getName(), "Writes the property file of a graph served by a graph server.",
+				new Parameter[] {
+						new FlaggedOption("host", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 'H', "host", "The host of the server (default: the loopback interface)."),
+						new FlaggedOption("port", JSAP.INTEGER_PARSER, Integer.toString(GraphServer.DEFAULT_PORT), JSAP.NOT_REQUIRED, 'p', "port", "The port of the server."),
+						new UnflaggedOption("graph", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The name of the graph on the server."),
+						new UnflaggedOption("basename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The basename of the resulting property file."),
+					}
+				);
+
+		final JSAPResult jsapResult = jsap.parse(args);
+		if (jsap.messagePrinted()) System.exit(1);
+
+		final PrintWriter pw = new PrintWriter(new OutputStreamWriter(new FileOutputStream(jsapResult.getString("basename") + ImmutableGraph.PROPERTIES_EXTENSION), "UTF-8"));
+		pw.println(ImmutableGraph.GRAPHCLASS_PROPERTY_KEY + " = " + RemoteImmutableGraph.class.getName());
+		if (jsapResult.userSpecified("host")) pw.println(HOST_PROPERTY_KEY + " = " + jsapResult.getString("host"));
+		pw.println(PORT_PROPERTY_KEY + " = " + jsapResult.getInt("port"));
+		pw.println(GRAPH_PROPERTY_KEY + " = " + jsapResult.getString("graph"));
+		pw.close();
+	}
+}
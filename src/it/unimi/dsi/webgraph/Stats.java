@@ -27,6 +27,19 @@ import java.math.BigDecimal;
 import java.math.BigInteger;
 import java.math.RoundingMode;
 import java.util.Arrays;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorCompletionService;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicIntegerArray;
+import java.util.function.IntUnaryOperator;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import com.google.common.base.Throwables;
+import com.google.common.util.concurrent.ThreadFactoryBuilder;
 
 import com.martiansoftware.jsap.FlaggedOption;
 import com.martiansoftware.jsap.JSAP;
@@ -52,17 +65,27 @@ import it.unimi.dsi.webgraph.algo.StronglyConnectedComponents;
  * <li>an ASCII file containing the <em>outdegree distribution</em>; line <var>n</var> contains the number of nodes with outdegree <var>n</var> (starting from 0);
  * <li>an ASCII file containing the <em>indegree distribution</em>; line <var>n</var> contains the number of nodes with indegree <var>n</var> (starting from 0);
  * <li>a property file containing several self-descriptive data, such as the average indegree/outdegree (which should be identical), sample nodes with minimum
- * or maximum indegree/outdegree, and so on; additional data will be computed if files produced by {@link StronglyConnectedComponents} are present
- * with the same basename (in particular, buckets and component sizes);
+ * or maximum indegree/outdegree, and so on; additional data will be computed if files produced by {@link StronglyConnectedComponents}
+ * or {@link ConnectedComponents} are present with the same basename (in particular, buckets and component sizes);
  * <li>if files produced by {@link StronglyConnectedComponents} are present with the same basename, an ASCII file containing the <em>distribution
- * of strongly connected components</em>, specified as a sequence of lines each containing a pair of integer &lt;<var>size</var>, <var>count</var>&gt;.
+ * of strongly connected components</em>, specified as a sequence of lines each containing a pair of integer &lt;<var>size</var>, <var>count</var>&gt;;
+ * <li>if a file of component sizes produced by {@link ConnectedComponents} (e.g., using {@link ConnectedComponents#computeWeakly(ImmutableGraph, int, ProgressLogger)})
+ * is present with the same basename, an ASCII file containing the <em>distribution of weakly connected components</em>, in the same format.
  * </ol>
  *
- * <p>The graph is loaded {@linkplain ImmutableGraph#loadOffline(CharSequence) offline}: the only memory allocated is for indegree count (one integer
- * per node) and for storing the actual counts (one integer per indegree/outdegree value).
+ * <p>By default, the command-line tool uses all available processors: the graph is {@linkplain ImmutableGraph#loadMapped(CharSequence) memory-mapped}
+ * and it is scanned in parallel (see {@link #run(ImmutableGraph, LongArrayBitVector, int[], CharSequence, boolean, int, ProgressLogger)}),
+ * with results identical to those of a sequential scan. Each thread counts indegrees in a private array (one integer per node), unless
+ * the arrays would use more than half of the available memory.
+ *
+ * <p>If just one thread is requested, the graph is loaded {@linkplain ImmutableGraph#loadOffline(CharSequence) offline}: the only memory allocated
+ * is for indegree count (one integer per node) and for storing the actual counts (one integer per indegree/outdegree value).
  */
 
 public class Stats {
+	private static final Logger LOGGER = LoggerFactory.getLogger(Stats.class);
+	/** The number of segments per thread used when the graph provides random access. */
+	private static final int SEGMENTS_PER_THREAD = 8;
 
 	private Stats() {}
 
@@ -90,76 +113,285 @@ public class Stats {
 	 */
 
 	public static void run(final ImmutableGraph graph, final LongArrayBitVector buckets, final int[] sccsize, final CharSequence resultsBasename, final boolean saveDegrees, final ProgressLogger pl) throws IOException {
-		final NodeIterator nodeIterator = graph.nodeIterator();
-		int[] count = IntArrays.EMPTY_ARRAY;
-		final int[] indegree = new int[graph.numNodes()];
-		int[] successor;
-		int curr, maxd = 0, maxNode = 0, mind = Integer.MAX_VALUE, minNode = 0;
-		long dangling = 0, terminal = 0, loops = 0, numArcs = 0, numGaps = 0;
-		BigInteger totLoc = BigInteger.ZERO, totGap = BigInteger.ZERO;
+		run(graph, buckets, sccsize, resultsBasename, saveDegrees, 0, pl);
+	}
 
+	/** A 128-bit signed accumulator represented by two longs. */
+	private static final class LongLongAccumulator {
+		/** The upper 64 bits. */
+		private long high;
+		/** The lower 64 bits. */
+		private long low;
+
+		/** Adds a (possibly negative) value to this accumulator.
+		 *
+		 * @param v the value to be added.
+		 */
+		private void add(final long v) {
+			final long l = low + v;
+			high += (v >> 63) + (Long.compareUnsigned(l, low) < 0 ? 1 : 0);
+			low = l;
+		}
 
-		if (pl != null) {
-			pl.itemsName = "nodes";
-			pl.expectedUpdates = graph.numNodes();
-			pl.start("Scanning...");
+		/** Adds the content of another accumulator to this accumulator.
+		 *
+		 * @param a another accumulator.
+		 */
+		private void add(final LongLongAccumulator a) {
+			final long l = low + a.low;
+			high += a.high + (Long.compareUnsigned(l, low) < 0 ? 1 : 0);
+			low = l;
 		}
 
-		final PrintWriter outdegreesPrintWriter = saveDegrees ? new PrintWriter(new BufferedWriter(new FileWriter(resultsBasename + ".outdegrees"))) : null;
+		/** Returns the value of this accumulator as a big integer.
+		 *
+		 * @return the value of this accumulator.
+		 */
+		private BigInteger toBigInteger() {
+			return BigInteger.valueOf(high).shiftLeft(Long.SIZE).add(BigInteger.valueOf(low >>> 1).shiftLeft(1)).add(BigInteger.valueOf(low & 1));
+		}
+	}
 
+	/** The statistics gathered on a segment of contiguous nodes. */
+	private static final class SegmentStats {
+		/** The node iterator scanning the segment, or {@code null}. */
+		private final NodeIterator nodeIterator;
+		/** The outdegree distribution of the segment. */
+		private int[] count = IntArrays.EMPTY_ARRAY;
+		/** The sum of the locality of all arcs. */
+		private final LongLongAccumulator totLoc = new LongLongAccumulator();
+		/** The sum of the gaps of all successor lists of length at least two. */
+		private final LongLongAccumulator totGap = new LongLongAccumulator();
 		/** Statistics for the gap width of successor lists (exponentially binned). */
-		final long[] successorDeltaStats = new long[32];
+		private final long[] successorDeltaStats = new long[32];
+		private int maxd = 0, maxNode = 0, mind = Integer.MAX_VALUE, minNode = 0;
+		private long dangling = 0, terminal = 0, loops = 0, numArcs = 0, numGaps = 0;
 
-		for(int i = graph.numNodes(); i-- != 0;) {
-			curr = nodeIterator.nextInt();
-			final int d = nodeIterator.outdegree();
-			if (saveDegrees) outdegreesPrintWriter.println(d);
-			successor = nodeIterator.successorArray();
+		private SegmentStats(final NodeIterator nodeIterator) {
+			this.nodeIterator = nodeIterator;
+		}
 
-			if (d > 1) {
-				totGap = totGap.add(BigInteger.valueOf(successor[d - 1] - successor[0]));
-				totGap = totGap.add(BigInteger.valueOf(Fast.int2nat(successor[0] - curr)));
-				numGaps += d ;
-			}
-			for(int s = d; s-- != 0;) {
-				totLoc = totLoc.add(BigInteger.valueOf(Math.abs(successor[s] - curr)));
+		/** Scans the segment.
+		 *
+		 * @param indegree an array private to the current thread in which indegrees will be accumulated, or {@code null}.
+		 * @param sharedIndegree if {@code indegree} is {@code null}, an array shared by all threads in which indegrees will be accumulated.
+		 * @param outdegree an array that will be filled with the outdegrees, or {@code null}.
+		 * @param pl a progress logger, or {@code null}.
+		 */
+		private void scan(final int[] indegree, final AtomicIntegerArray sharedIndegree, final int[] outdegree, final ProgressLogger pl) {
+			final NodeIterator nodeIterator = this.nodeIterator;
+			final long[] successorDeltaStats = this.successorDeltaStats;
+			int[] successor;
+			int curr;
+			int updates = 0;
+
+			while(nodeIterator.hasNext()) {
+				curr = nodeIterator.nextInt();
+				final int d = nodeIterator.outdegree();
+				if (outdegree != null) outdegree[curr] = d;
+				successor = nodeIterator.successorArray();
+
+				if (d > 1) {
+					totGap.add(successor[d - 1] - successor[0]);
+					totGap.add(Fast.int2nat(successor[0] - curr));
+					numGaps += d;
+				}
+				for(int s = d; s-- != 0;) {
+					totLoc.add(Math.abs(successor[s] - curr));
 
-				if (successor[s] != curr) successorDeltaStats[Fast.mostSignificantBit(Math.abs(curr - successor[s]))]++;
-				else loops++;
+					if (successor[s] != curr) successorDeltaStats[Fast.mostSignificantBit(Math.abs(curr - successor[s]))]++;
+					else loops++;
 
-				indegree[successor[s]]++;
-			}
+					if (indegree != null) indegree[successor[s]]++;
+					else sharedIndegree.incrementAndGet(successor[s]);
+				}
 
-			if (d == 0) {
-				dangling++;
-				terminal++;
-			}
+				if (d == 0) {
+					dangling++;
+					terminal++;
+				}
 
-			if (d == 1 && successor[0] == curr) terminal++;
+				if (d == 1 && successor[0] == curr) terminal++;
 
-			if (d < mind) {
-				mind = d;
-				minNode = curr;
-			}
+				if (d < mind) {
+					mind = d;
+					minNode = curr;
+				}
 
-			if (d > maxd){
-				maxd = d;
-				maxNode = curr;
+				if (d > maxd){
+					maxd = d;
+					maxNode = curr;
+				}
+
+				numArcs += d;
+
+				if (d >= count.length) count = IntArrays.grow(count, d + 1);
+				count[d]++;
+
+				if (pl != null && (++updates & 0xFFFF) == 0) {
+					synchronized (pl) { pl.update(updates); }
+					updates = 0;
+				}
 			}
 
-			numArcs += d;
+			if (pl != null) synchronized (pl) { pl.update(updates); }
+		}
+	}
 
-			if (d >= count.length) count = IntArrays.grow(count, d + 1);
-			count[d]++;
+	/** Computes stats for the given graph using a single parallel traversal, storing the results in files with given basename.
+	 *
+	 * <p>The graph is split into segments of contiguous nodes using {@link ImmutableGraph#splitNodeIterators(int)}; each
+	 * segment accumulates privately its statistics (sums are kept in exact 128-bit accumulators), and each thread
+	 * accumulates indegrees in a private array, so no synchronization is necessary (if the private arrays would use more than half
+	 * of the available memory, indegrees are accumulated in a shared array of atomic integers instead). Partial results are finally combined in node order, so
+	 * the resulting files are identical to those produced by a sequential scan.
+	 *
+	 * @param graph the graph to be examined.
+	 * @param buckets the set of buckets of this graph, or <code>null</code> if this information is not available.
+	 * @param sccsize the sizes of strongly connected components, or <code>null</code> if this information is not available.
+	 * @param resultsBasename the basename for result files (see the {@linkplain Stats class description}).
+	 * @param saveDegrees if true, indegrees and outdegrees will be saved.
+	 * @param numberOfThreads the number of threads to use; if 0 or negative, it will be replaced by {@link Runtime#availableProcessors()}. Note that if
+	 * {@code graph} does not provide {@linkplain ImmutableGraph#hasCopiableIterators() copiable iterators}, just one thread will be used.
+	 * @param pl a progress logger.
+	 */
+
+	public static void run(final ImmutableGraph graph, final LongArrayBitVector buckets, final int[] sccsize, final CharSequence resultsBasename, final boolean saveDegrees, final int numberOfThreads, final ProgressLogger pl) throws IOException {
+		run(graph, buckets, sccsize, null, resultsBasename, saveDegrees, numberOfThreads, pl);
+	}
 
-			if (pl != null) pl.lightUpdate();
+	/** Computes stats for the given graph, possibly in parallel, storing the results in files with given basename.
+	 *
+	 * <p>This method is identical to {@link #run(ImmutableGraph, LongArrayBitVector, int[], CharSequence, boolean, int, ProgressLogger)},
+	 * but it accepts also the sizes of weakly connected components.
+	 *
+	 * @param graph the graph to be examined.
+	 * @param buckets the set of buckets of this graph, or <code>null</code> if this information is not available.
+	 * @param sccsize the sizes of strongly connected components, or <code>null</code> if this information is not available.
+	 * @param wccsize the sizes of weakly connected components, or <code>null</code> if this information is not available.
+	 * @param resultsBasename the basename for result files (see the {@linkplain Stats class description}).
+	 * @param saveDegrees if true, indegrees and outdegrees will be saved.
+	 * @param numberOfThreads the number of threads to use; if 0 or negative, it will be replaced by {@link Runtime#availableProcessors()}. Note that if
+	 * {@code graph} does not provide {@linkplain ImmutableGraph#hasCopiableIterators() copiable iterators}, just one thread will be used.
+	 * @param pl a progress logger.
+	 */
+
+	public static void run(final ImmutableGraph graph, final LongArrayBitVector buckets, final int[] sccsize, final int[] wccsize, final CharSequence resultsBasename, final boolean saveDegrees, int numberOfThreads, final ProgressLogger pl) throws IOException {
+		final int n = graph.numNodes();
+		if (numberOfThreads <= 0) numberOfThreads = Runtime.getRuntime().availableProcessors();
+		numberOfThreads = Integer.parseInt(System.getProperty(ImmutableGraph.NUMBER_OF_THREADS_PROPERTY, Integer.toString(numberOfThreads)));
+		if (numberOfThreads > 1 && ! graph.hasCopiableIterators()) {
+			LOGGER.warn("The graph does not provide copiable iterators: using just one thread");
+			numberOfThreads = 1;
+		}
+
+		/* With random access splitting is cheap, so we use more segments than threads to balance
+		   the load; otherwise, splitting requires a scan of the graph, and we use one segment per thread. */
+		final NodeIterator[] nodeIterator = numberOfThreads == 1 ? new NodeIterator[] { graph.nodeIterator() } : graph.splitNodeIterators(graph.randomAccess() ? numberOfThreads * SEGMENTS_PER_THREAD : numberOfThreads);
+		final SegmentStats[] segmentStats = new SegmentStats[nodeIterator.length];
+		for(int i = segmentStats.length; i-- != 0;) segmentStats[i] = new SegmentStats(nodeIterator[i]);
+
+		// Private arrays avoid contention on high-indegree nodes, but we do not want them to fill the memory
+		final boolean privateIndegrees = numberOfThreads == 1 || (long)numberOfThreads * n * Integer.BYTES <= Runtime.getRuntime().maxMemory() / 2;
+		if (! privateIndegrees) LOGGER.warn("Not enough memory for " + numberOfThreads + " arrays of indegrees: using a shared array");
+		final int[][] threadIndegree = new int[privateIndegrees ? numberOfThreads : 0][];
+		final AtomicIntegerArray sharedIndegree = privateIndegrees ? null : new AtomicIntegerArray(n);
+		final int[] outdegree = saveDegrees ? new int[n] : null;
+
+		if (pl != null) {
+			pl.itemsName = "nodes";
+			pl.expectedUpdates = n;
+			pl.start("Scanning using " + numberOfThreads + " threads...");
+		}
+
+		final AtomicInteger nextSegment = new AtomicInteger();
+		final ExecutorService executorService = Executors.newFixedThreadPool(numberOfThreads, new ThreadFactoryBuilder().setNameFormat("ProcessingThread-%d").build());
+		final ExecutorCompletionService<Void> executorCompletionService = new ExecutorCompletionService<>(executorService);
+
+		for(int i = numberOfThreads; i-- != 0;) {
+			final int index = i;
+			executorCompletionService.submit(() -> {
+				final int[] indegree = privateIndegrees ? new int[n] : null;
+				if (privateIndegrees) threadIndegree[index] = indegree;
+				for(int s; (s = nextSegment.getAndIncrement()) < segmentStats.length;)
+					if (segmentStats[s].nodeIterator != null) segmentStats[s].scan(indegree, sharedIndegree, outdegree, pl);
+				return null;
+			});
+		}
+
+		Throwable problem = waitFor(executorCompletionService, numberOfThreads);
+
+		// We sum in parallel the private arrays into the first one, each thread taking care of a slice of nodes
+		if (problem == null && privateIndegrees && numberOfThreads > 1) {
+			for(int i = numberOfThreads; i-- != 0;) {
+				final int from = (int)((long)n * i / numberOfThreads), to = (int)((long)n * (i + 1) / numberOfThreads);
+				executorCompletionService.submit(() -> {
+					final int[] indegree = threadIndegree[0];
+					for(int t = 1; t < threadIndegree.length; t++) {
+						final int[] other = threadIndegree[t];
+						for(int x = from; x < to; x++) indegree[x] += other[x];
+					}
+					return null;
+				});
+			}
+			problem = waitFor(executorCompletionService, numberOfThreads);
+		}
+
+		executorService.shutdown();
+		if (problem != null) {
+			Throwables.throwIfUnchecked(problem);
+			throw new RuntimeException(problem);
+		}
+
+		final IntUnaryOperator indegree;
+		if (privateIndegrees) {
+			final int[] a = threadIndegree[0];
+			Arrays.fill(threadIndegree, 1, threadIndegree.length, null);
+			indegree = x -> a[x];
 		}
+		else indegree = sharedIndegree::get;
 
 		if (pl != null) pl.done();
 
+		// We combine partial results following node order, so to break ties exactly as a sequential scan.
+		int[] count = IntArrays.EMPTY_ARRAY;
+		int maxd = 0, maxNode = 0, mind = Integer.MAX_VALUE, minNode = 0;
+		long dangling = 0, terminal = 0, loops = 0, numArcs = 0, numGaps = 0;
+		final LongLongAccumulator totLocAccumulator = new LongLongAccumulator(), totGapAccumulator = new LongLongAccumulator();
+		// Statistics for the gap width of successor lists (exponentially binned)
+		final long[] successorDeltaStats = new long[32];
+
+		for(final SegmentStats t : segmentStats) {
+			if (t.nodeIterator == null) continue;
+			totLocAccumulator.add(t.totLoc);
+			totGapAccumulator.add(t.totGap);
+			for(int i = successorDeltaStats.length; i-- != 0;) successorDeltaStats[i] += t.successorDeltaStats[i];
+			if (t.mind < mind) {
+				mind = t.mind;
+				minNode = t.minNode;
+			}
+			if (t.maxd > maxd) {
+				maxd = t.maxd;
+				maxNode = t.maxNode;
+			}
+			dangling += t.dangling;
+			terminal += t.terminal;
+			loops += t.loops;
+			numArcs += t.numArcs;
+			numGaps += t.numGaps;
+			if (t.count.length > count.length) count = IntArrays.grow(count, t.count.length);
+			for(int i = t.count.length; i-- != 0;) count[i] += t.count[i];
+		}
+
+		final BigInteger totLoc = totLocAccumulator.toBigInteger(), totGap = totGapAccumulator.toBigInteger();
+
 		if (saveDegrees) {
+			final PrintWriter outdegreesPrintWriter = new PrintWriter(new BufferedWriter(new FileWriter(resultsBasename + ".outdegrees")));
+			for(final int d : outdegree) outdegreesPrintWriter.println(d);
 			outdegreesPrintWriter.close();
-			TextIO.storeInts(indegree, resultsBasename + ".indegrees");
+			final PrintWriter indegreesPrintWriter = new PrintWriter(new BufferedWriter(new FileWriter(resultsBasename + ".indegrees")));
+			for(int i = 0; i < n; i++) indegreesPrintWriter.println(indegree.applyAsInt(i));
+			indegreesPrintWriter.close();
 		}
 
 		@SuppressWarnings("resource")
@@ -202,8 +434,8 @@ public class Stats {
 
 		maxd = maxNode = minNode = 0;
 		mind = Integer.MAX_VALUE;
-		for(int i = indegree.length; i-- != 0;) {
-			final int d = indegree[i];
+		for(int i = n; i-- != 0;) {
+			final int d = indegree.applyAsInt(i);
 			if (d >= count.length) count = IntArrays.grow(count, d + 1);
 			if (d < mind) {
 				mind = d;
@@ -232,36 +464,65 @@ public class Stats {
 			properties.println("percbuckets=" + 100.0 * numBuckets / graph.numNodes());
 		}
 
-		if (sccsize != null) {
-			IntArrays.parallelQuickSort(sccsize);
-			final int m = sccsize.length;
-			final int maxSize = sccsize[m - 1];
-			final int minSize = sccsize[0];
-
-			properties.println("sccs=" + m);
-			properties.println("maxsccsize=" + maxSize);
-			properties.println("percmaxscc=" + 100.0 * maxSize / graph.numNodes());
-			properties.println("minsccsize=" + minSize);
-			properties.println("percminscc=" + 100.0 * minSize / graph.numNodes());
-
-			final PrintWriter pw = new PrintWriter(resultsBasename + ".sccdistr");
-			int current = maxSize;
-			int c = 0;
-			for(int i = sccsize.length; i-- != 0;) {
-				if(sccsize[i] != current) {
-					pw.println(current + "\t" + c);
-					current = sccsize[i];
-					c = 0;
-				}
-				c++;
+		if (sccsize != null) componentStats(sccsize, "scc", graph.numNodes(), properties, resultsBasename);
+		if (wccsize != null) componentStats(wccsize, "wcc", graph.numNodes(), properties, resultsBasename);
+
+		properties.close();
+	}
+
+	/** Waits for the completion of a number of tasks.
+	 *
+	 * @param executorCompletionService the completion service the tasks have been submitted to.
+	 * @param tasks the number of tasks.
+	 * @return the exception thrown by the last failed task, or {@code null}.
+	 */
+	private static Throwable waitFor(final ExecutorCompletionService<Void> executorCompletionService, final int tasks) {
+		Throwable problem = null;
+		for(int i = tasks; i-- != 0;)
+			try {
+				executorCompletionService.take().get();
+			}
+			catch(final Exception e) {
+				problem = e instanceof ExecutionException ? e.getCause() : e; // We keep only the last one.
 			}
-			pw.println(current + "\t" + c);
+		return problem;
+	}
 
-			pw.flush();
-			pw.close();
+	/** Writes statistics about the sizes of a set of components.
+	 *
+	 * @param size the sizes of the components (they will be sorted).
+	 * @param prefix a prefix for the property keys and the extension of the distribution file (e.g., <code>scc</code>).
+	 * @param n the number of nodes of the graph.
+	 * @param properties the writer of the property file.
+	 * @param resultsBasename the basename for result files.
+	 */
+	private static void componentStats(final int[] size, final String prefix, final int n, final PrintWriter properties, final CharSequence resultsBasename) throws IOException {
+		IntArrays.parallelQuickSort(size);
+		final int m = size.length;
+		final int maxSize = size[m - 1];
+		final int minSize = size[0];
+
+		properties.println(prefix + "s=" + m);
+		properties.println("max" + prefix + "size=" + maxSize);
+		properties.println("percmax" + prefix + "=" + 100.0 * maxSize / n);
+		properties.println("min" + prefix + "size=" + minSize);
+		properties.println("percmin" + prefix + "=" + 100.0 * minSize / n);
+
+		final PrintWriter pw = new PrintWriter(resultsBasename + "." + prefix + "distr");
+		int current = maxSize;
+		int c = 0;
+		for(int i = size.length; i-- != 0;) {
+			if(size[i] != current) {
+				pw.println(current + "\t" + c);
+				current = size[i];
+				c = 0;
+			}
+			c++;
 		}
+		pw.println(current + "\t" + c);
 
-		properties.close();
+		pw.flush();
+		pw.close();
 	}
 
 	static public void main(final String arg[]) throws IllegalArgumentException, SecurityException, IllegalAccessException, InvocationTargetException, NoSuchMethodException, JSAPException, IOException, ClassNotFoundException {
@@ -270,6 +531,7 @@ public class Stats {
 						new FlaggedOption("graphClass", GraphClassParser.getParser(), null, JSAP.NOT_REQUIRED, 'g', "graph-class", "Forces a Java class for the source graph."),
 						new FlaggedOption("logInterval", JSAP.LONG_PARSER, Long.toString(ProgressLogger.DEFAULT_LOG_INTERVAL), JSAP.NOT_REQUIRED, 'l', "log-interval", "The minimum time interval between activity logs in milliseconds."),
 						new Switch("saveDegrees", 's', "save-degrees", "Save indegrees and outdegrees in text format."),
+						new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "0", JSAP.NOT_REQUIRED, 't', "threads", "The number of threads (0 for the number of available processors); if not 1, the graph will be memory-mapped."),
 						new UnflaggedOption("basename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The basename of the graph."),
 						new UnflaggedOption("resultsBasename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, JSAP.NOT_GREEDY, "The basename of the resulting files."),
 					}
@@ -285,14 +547,16 @@ public class Stats {
 		final ProgressLogger pl = new ProgressLogger();
 		pl.logInterval = jsapResult.getLong("logInterval");
 
+		final int numberOfThreads = jsapResult.getInt("threads");
 		final ImmutableGraph graph;
 
-		if (graphClass != null) graph = (ImmutableGraph)graphClass.getMethod("loadOffline", CharSequence.class).invoke(null, basename);
-		else graph = ImmutableGraph.loadOffline(basename, pl);
+		if (graphClass != null) graph = (ImmutableGraph)graphClass.getMethod(numberOfThreads == 1 ? "loadOffline" : "loadMapped", CharSequence.class).invoke(null, basename);
+		else graph = numberOfThreads == 1 ? ImmutableGraph.loadOffline(basename, pl) : ImmutableGraph.loadMapped(basename, pl);
 
 		final LongArrayBitVector buckets = (LongArrayBitVector)(new File(basename + ".buckets").exists() ? BinIO.loadObject(basename + ".buckets") : null);
 		final int[] sccsize = new File(basename + ".sccsizes").exists() ? BinIO.loadInts(basename + ".sccsizes") : null;
+		final int[] wccsize = new File(basename + ".wccsizes").exists() ? BinIO.loadInts(basename + ".wccsizes") : null;
 
-		run(graph, buckets, sccsize, resultsBasename, jsapResult.getBoolean("saveDegrees"), pl);
+		run(graph, buckets, sccsize, wccsize, resultsBasename, jsapResult.getBoolean("saveDegrees"), numberOfThreads, pl);
 	}
 }
@@ -0,0 +1,536 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph.algo;
+
+import java.io.IOException;
+import java.io.PrintStream;
+import java.math.BigDecimal;
+import java.math.MathContext;
+import java.math.RoundingMode;
+import java.nio.file.Files;
+import java.nio.file.Paths;
+import java.util.Arrays;
+import java.util.concurrent.ExecutorCompletionService;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.stream.Stream;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import com.google.common.base.Throwables;
+import com.google.common.util.concurrent.ThreadFactoryBuilder;
+import com.martiansoftware.jsap.FlaggedOption;
+import com.martiansoftware.jsap.JSAP;
+import com.martiansoftware.jsap.JSAPException;
+import com.martiansoftware.jsap.JSAPResult;
+import com.martiansoftware.jsap.Parameter;
+import com.martiansoftware.jsap.SimpleJSAP;
+import com.martiansoftware.jsap.UnflaggedOption;
+
+import it.unimi.dsi.fastutil.io.TextIO;
+import it.unimi.dsi.util.XoRoShiRo128PlusRandom;
+
+/** Computes jackknife and bootstrap estimates of distance statistics from several approximate neighbourhood functions
+ * of the same graph (e.g., the <code>.nf</code> files produced by multiple runs of {@link HyperBall}).
+ *
+ * <p>This class replaces the scripts <code>jackknife.rb</code> and <code>bootstrap.rb</code> in the <code>ruby</code>
+ * directory: it computes the same statistics (number of reachable pairs, {@linkplain NeighbourhoodFunction#averageDistance(double[]) average distance},
+ * {@linkplain NeighbourhoodFunction#harmonicDiameter(int, double[]) harmonic diameter} and {@linkplain NeighbourhoodFunction#spid(double[]) spid}),
+ * but in parallel. Estimates and standard errors of the {@linkplain #jackknife() jackknife} are computed performing
+ * the same double-precision floating-point operations, in the same order, of <code>jackknife.rb</code> (which, albeit requiring
+ * <code>bigdecimal</code>, uses Ruby floats), so the results are identical.
+ *
+ * <p>The approach is the same of {@link ApproximateNeighbourhoodFunctions#AVERAGE_DISTANCE} and related statistics: all statistics are computed on the
+ * average of the samples, so, for example, the average distance is the average of the sums of distances divided
+ * by the average number of reachable pairs. All statistics depend on a sample only through a few sums (sum of distances,
+ * of squared distances and of inverse distances, and number of reachable pairs),
+ * which are computed just once when an instance is built. Short samples are implicitly {@linkplain ApproximateNeighbourhoodFunctions#evenOut(Iterable) evened out}.
+ * Note that, as in the scripts, the harmonic diameter is computed using <var>n</var>(<var>n</var>&nbsp;&minus;&nbsp;1) as numerator,
+ * whereas {@link ApproximateNeighbourhoodFunctions#HARMONIC_DIAMETER} uses <var>n</var><sup>2</sup>.
+ *
+ * <p>The {@linkplain #bootstrap(int, long) bootstrap} uses the same sums, so the cost of a replicate is linear in the number of samples.
+ * It cannot reproduce the exact results of <code>bootstrap.rb</code>, as the pseudorandom number generator is different.
+ *
+ * <p>The main method prints its results in the same format of <code>jackknife.rb</code> (see {@link #printJackknife(double[], PrintStream)}),
+ * formatting numbers as Ruby does; it can also store the
+ * jackknifed distance cumulative distribution function, which replaces <code>anf2dcdf.rb</code>.
+ */
+
+public class ApproximateNeighbourhoodFunctionStatistics {
+	private static final Logger LOGGER = LoggerFactory.getLogger(ApproximateNeighbourhoodFunctionStatistics.class);
+
+	/** Estimates of distance statistics, with their standard errors. */
+	public static final class Estimates {
+		/** The estimated average distance. */
+		public final double averageDistance;
+		/** The standard error of {@link #averageDistance}. */
+		public final double averageDistanceStandardError;
+		/** The estimated harmonic diameter. */
+		public final double harmonicDiameter;
+		/** The standard error of {@link #harmonicDiameter}. */
+		public final double harmonicDiameterStandardError;
+		/** The estimated spid. */
+		public final double spid;
+		/** The standard error of {@link #spid}. */
+		public final double spidStandardError;
+
+		private Estimates(final double averageDistance, final double averageDistanceStandardError, final double harmonicDiameter, final double harmonicDiameterStandardError, final double spid, final double spidStandardError) {
+			this.averageDistance = averageDistance;
+			this.averageDistanceStandardError = averageDistanceStandardError;
+			this.harmonicDiameter = harmonicDiameter;
+			this.harmonicDiameterStandardError = harmonicDiameterStandardError;
+			this.spid = spid;
+			this.spidStandardError = spidStandardError;
+		}
+	}
+
+	/** The samples, evened out. */
+	private final double[][] sample;
+	/** The number of threads. */
+	private final int threads;
+	/** The number of samples. */
+	public final int n;
+	/** The number of nodes of the graph. */
+	public final double nodes;
+	/** The last value (i.e., the number of reachable pairs) of each sample. */
+	public final double[] last;
+	/** The sum of distances of each sample. */
+	public final double[] sumDist;
+	/** The sum of squared distances of each sample. */
+	public final double[] sumSquareDist;
+	/** The sum of inverse distances of each sample. */
+	public final double[] sumInverseDist;
+
+	/** Creates a new instance from a list of approximate neighbourhood functions.
+	 *
+	 * @param anf an array of approximate neighbourhood functions of the same graph; they will be evened out in place, if necessary.
+	 * @param nodes the number of nodes of the graph, or {@link Double#NaN} to use the first value of the first sample.
+	 * @param threads the requested number of threads (0 for {@link Runtime#availableProcessors()}).
+	 */
+	public ApproximateNeighbourhoodFunctionStatistics(final double[][] anf, final double nodes, final int threads) {
+		if (anf.length == 0) throw new IllegalArgumentException("No samples");
+		this.threads = threads == 0 ? Runtime.getRuntime().availableProcessors() : threads;
+		this.n = anf.length;
+		this.nodes = Double.isNaN(nodes) ? anf[0][0] : nodes;
+		last = new double[n];
+		sumDist = new double[n];
+		sumSquareDist = new double[n];
+		sumInverseDist = new double[n];
+
+		int max = 0;
+		for(final double[] a : anf) max = Math.max(max, a.length);
+		final int length = max;
+		sample = anf;
+
+		parallelFor(n, i -> {
+			final double[] a = anf[i];
+			if (a.length < length) {
+				final int l = a.length;
+				anf[i] = Arrays.copyOf(a, length);
+				for(int d = l; d < length; d++) anf[i][d] = a[l - 1];
+			}
+			final double[] v = anf[i];
+			double s = 0, ss = 0, si = 0;
+			for(int d = 1; d < length; d++) {
+				final double delta = v[d] - v[d - 1];
+				s += delta * d;
+				ss += delta * d * d;
+				si += delta / d;
+			}
+			sumDist[i] = s;
+			sumSquareDist[i] = ss;
+			sumInverseDist[i] = si;
+			last[i] = v[length - 1];
+		});
+	}
+
+	/** Loads approximate neighbourhood functions in text format (one value per line) and creates an instance.
+	 *
+	 * @param file the names of the files containing the approximate neighbourhood functions.
+	 * @param nodes the number of nodes of the graph, or {@link Double#NaN} to use the first value of the first sample.
+	 * @param threads the requested number of threads (0 for {@link Runtime#availableProcessors()}); files are parsed in parallel.
+	 * @return an instance built on the approximate neighbourhood functions contained in the given files.
+	 */
+	public static ApproximateNeighbourhoodFunctionStatistics load(final String[] file, final double nodes, final int threads) throws IOException {
+		final double[][] anf = new double[file.length][];
+		parallelFor(file.length, threads == 0 ? Runtime.getRuntime().availableProcessors() : threads, i -> anf[i] = loadText(file[i]));
+		return new ApproximateNeighbourhoodFunctionStatistics(anf, nodes, threads);
+	}
+
+	/** Loads a neighbourhood function in text format (one value per line). */
+	private static double[] loadText(final String file) throws IOException {
+		final double[] a;
+		try (Stream<String> lines = Files.lines(Paths.get(file))) {
+			a = lines.map(String::trim).filter(s -> ! s.isEmpty()).mapToDouble(Double::parseDouble).toArray();
+		}
+		if (a.length == 0) throw new IOException("File " + file + " is empty");
+		return a;
+	}
+
+	/** Returns the average number of reachable pairs.
+	 *
+	 * @return the average number of reachable pairs.
+	 */
+	public double reachablePairs() {
+		return mean(last);
+	}
+
+	/** Returns the standard error of {@link #reachablePairs()}.
+	 *
+	 * @return the standard error of {@link #reachablePairs()}.
+	 */
+	public double reachablePairsStandardError() {
+		return Math.sqrt(variance(last) / n);
+	}
+
+	/** Computes jackknife estimates of the average distance, of the harmonic diameter and of the spid.
+	 *
+	 * @return jackknife estimates of the average distance, of the harmonic diameter and of the spid.
+	 */
+	public Estimates jackknife() {
+		final double reachable = mean(last);
+		final double meanSumDist = mean(sumDist);
+		final double biasedDist = meanSumDist / reachable;
+		final double biasedHarmonicDiameter = nodes * (nodes - 1) / mean(sumInverseDist);
+		final double biasedSpid = mean(sumSquareDist) / meanSumDist - meanSumDist / reachable;
+
+		// Leave-one-out values
+		final double[] loDist = new double[n], loHarmonicDiameter = new double[n], loSpid = new double[n];
+		parallelFor(n, i -> {
+			final double sd = meanWithout(sumDist, i), l = meanWithout(last, i);
+			loDist[i] = sd / l;
+			loHarmonicDiameter[i] = nodes * (nodes - 1) / meanWithout(sumInverseDist, i);
+			loSpid[i] = meanWithout(sumSquareDist, i) / sd - sd / l;
+		});
+
+		return new Estimates(
+				n * biasedDist - (n - 1) * mean(loDist), Math.sqrt(jackknifeVariance(loDist)),
+				n * biasedHarmonicDiameter - (n - 1) * mean(loHarmonicDiameter), Math.sqrt(jackknifeVariance(loHarmonicDiameter)),
+				n * biasedSpid - (n - 1) * mean(loSpid), Math.sqrt(jackknifeVariance(loSpid)));
+	}
+
+	/** Computes bootstrap estimates of the average distance, of the harmonic diameter and of the spid.
+	 *
+	 * <p>Each replicate draws with replacement as many samples as the number of samples of this instance. The
+	 * estimate is the average of the statistic on the replicates, and the standard error is its standard deviation.
+	 * Replicates are generated in parallel, but each replicate uses a pseudorandom number generator
+	 * seeded deterministically, so the result depends only on <code>seed</code>.
+	 *
+	 * @param replicates the number of replicates; if zero, the maximum between 1000 and <var>n</var> ln<sup>2</sup> <var>n</var>, where <var>n</var>
+	 * is the number of samples, as in <code>bootstrap.rb</code>.
+	 * @param seed a seed for the pseudorandom number generator.
+	 * @return bootstrap estimates of the average distance, of the harmonic diameter and of the spid.
+	 */
+	public Estimates bootstrap(int replicates, final long seed) {
+		if (replicates == 0) replicates = Math.max(1000, (int)(n * Math.log(n) * Math.log(n)));
+		final double[] dist = new double[replicates], harmonicDiameter = new double[replicates], spid = new double[replicates];
+		parallelFor(replicates, r -> {
+			final XoRoShiRo128PlusRandom random = new XoRoShiRo128PlusRandom(seed + r);
+			double sd = 0, ssd = 0, sid = 0, l = 0, first = 0;
+			for(int i = n; i-- != 0;) {
+				final int s = random.nextInt(n);
+				sd += sumDist[s];
+				ssd += sumSquareDist[s];
+				sid += sumInverseDist[s];
+				l += last[s];
+				first += sample[s][0];
+			}
+			sd /= n;
+			ssd /= n;
+			sid /= n;
+			l /= n;
+			first /= n;
+			dist[r] = sd / l;
+			harmonicDiameter[r] = first * (first - 1) / sid;
+			spid[r] = ssd / sd - sd / l;
+		});
+
+		return new Estimates(
+				mean(dist), Math.sqrt(variance(dist)),
+				mean(harmonicDiameter), Math.sqrt(variance(harmonicDiameter)),
+				mean(spid), Math.sqrt(variance(spid)));
+	}
+
+	/** Computes a jackknife estimate of the distance cumulative distribution function.
+	 *
+	 * @param standardError if not {@code null}, an array as long as the samples that will be filled with the standard errors of the estimates.
+	 * @return a jackknife estimate of the distance cumulative distribution function.
+	 */
+	public double[] cdf(final double[] standardError) {
+		final int length = sample[0].length;
+		final double[] cdf = new double[length];
+		final double reachable = mean(last);
+		parallelFor(length, d -> {
+			final double[] v = new double[n];
+			for(int i = n; i-- != 0;) v[i] = sample[i][d];
+			final double[] lo = new double[n];
+			for(int i = n; i-- != 0;) lo[i] = meanWithout(v, i) / meanWithout(last, i);
+			cdf[d] = n * (mean(v) / reachable) - (n - 1) * mean(lo);
+			if (standardError != null) standardError[d] = Math.sqrt(jackknifeVariance(lo));
+		});
+		return cdf;
+	}
+
+	/** Returns the average distance of an exact neighbourhood function (as computed by <code>jackknife.rb</code>).
+	 *
+	 * @param nf a neighbourhood function.
+	 * @return the average distance.
+	 */
+	public static double averageDistance(final double[] nf) {
+		double s = 0;
+		for(final double v : nf) s += v;
+		return nf.length - s / nf[nf.length - 1];
+	}
+
+	/** Returns the harmonic diameter of an exact neighbourhood function (as computed by <code>jackknife.rb</code>).
+	 *
+	 * @param nf a neighbourhood function.
+	 * @return the harmonic diameter.
+	 */
+	public static double harmonicDiameter(final double[] nf) {
+		double s = 0;
+		for(int d = 1; d < nf.length; d++) s += (nf[d] - nf[d - 1]) / d;
+		return nf[0] * (nf[0] - 1) / s;
+	}
+
+	/** Returns the spid of an exact neighbourhood function (as computed by <code>jackknife.rb</code>).
+	 *
+	 * @param nf a neighbourhood function.
+	 * @return the spid.
+	 */
+	public static double spid(final double[] nf) {
+		double s = 0, ss = 0;
+		for(int d = 1; d < nf.length; d++) {
+			final double t = d * (nf[d] - nf[d - 1]);
+			s += t;
+			ss += d * t;
+		}
+		return ss / s - s / nf[nf.length - 1];
+	}
+
+	private static double mean(final double[] a) {
+		double s = 0;
+		for(final double v : a) s += v;
+		return s / a.length;
+	}
+
+	/** Returns the mean of all elements of an array but one, adding them in the same order of {@link #mean(double[])}. */
+	private static double meanWithout(final double[] a, final int k) {
+		double s = 0;
+		for(int i = 0; i < a.length; i++) if (i != k) s += a[i];
+		return s / (a.length - 1);
+	}
+
+	private static double variance(final double[] a) {
+		final double m = mean(a);
+		double c = 0;
+		for(final double v : a) c += (v - m) * (v - m);
+		return c / (a.length - 1);
+	}
+
+	private static double jackknifeVariance(final double[] a) {
+		final double m = mean(a);
+		double c = 0;
+		for(final double v : a) c += (v - m) * (v - m);
+		return (a.length - 1) * c / a.length;
+	}
+
+	/** A task on an index that might throw an exception. */
+	private interface IndexedTask {
+		void run(int i) throws IOException;
+	}
+
+	private void parallelFor(final int n, final IndexedTask task) {
+		try {
+			parallelFor(n, threads, task);
+		}
+		catch(final IOException e) {
+			throw new RuntimeException(e);
+		}
+	}
+
+	/** Runs a task on all indices from zero (inclusive) to <code>n</code> (exclusive) using a given number of threads. */
+	private static void parallelFor(final int n, final int threads, final IndexedTask task) throws IOException {
+		final ExecutorService executorService = Executors.newFixedThreadPool(threads, new ThreadFactoryBuilder().setNameFormat("ProcessingThread-%d").build());
+		final ExecutorCompletionService<Void> executorCompletionService = new ExecutorCompletionService<>(executorService);
+		final AtomicInteger next = new AtomicInteger();
+
+		for(int t = threads; t-- != 0;) executorCompletionService.submit(() -> {
+			for(int i; (i = next.getAndIncrement()) < n;) task.run(i);
+			return null;
+		});
+
+		Throwable problem = null;
+		for(int t = threads; t-- != 0;)
+			try {
+				executorCompletionService.take().get();
+			}
+			catch(final Exception e) {
+				problem = e.getCause(); // We keep only the last one. They will be logged anyway.
+			}
+
+		executorService.shutdown();
+		if (problem != null) {
+			Throwables.throwIfInstanceOf(problem, IOException.class);
+			Throwables.throwIfUnchecked(problem);
+			throw new RuntimeException(problem);
+		}
+	}
+
+	private static double relativeError(final double v, final double e) {
+		return (v - e) / e;
+	}
+
+	/** Returns the shortest decimal number that rounds to a given positive finite double; if there is more than one, the
+	 * closest to the double is returned. */
+	private static BigDecimal shortest(final double x) {
+		final BigDecimal exact = new BigDecimal(x);
+		for(int p = 1;; p++) {
+			BigDecimal best = null;
+			// Since the rounding interval of x might be asymmetric, the closest candidate might not round to x
+			for(final RoundingMode mode : new RoundingMode[] { RoundingMode.HALF_EVEN, RoundingMode.FLOOR, RoundingMode.CEILING }) {
+				final BigDecimal c = exact.round(new MathContext(p, mode));
+				if (c.doubleValue() == x && (best == null || c.subtract(exact).abs().compareTo(best.subtract(exact).abs()) < 0)) best = c;
+			}
+			if (best != null) return best;
+		}
+	}
+
+	private static void appendZeroes(final StringBuilder s, int k) {
+		while(k-- != 0) s.append('0');
+	}
+
+	/** Formats a double as Ruby's <code>Float#to_s</code>, which is used by <code>jackknife.rb</code>.
+	 *
+	 * <p>The shortest representation that rounds to {@code x} is printed in positional notation if its decimal exponent
+	 * is between &minus;4 (excluded) and 16 (excluded for integers), and in scientific notation otherwise; for example,
+	 * 12345678 is printed as <code>12345678.0</code> (whereas {@link Double#toString(double)} would print
+	 * <code>1.2345678E7</code>) and 10<sup>16</sup> as <code>1.0e+16</code>.
+	 *
+	 * @param x a double.
+	 * @return {@code x} formatted as Ruby does.
+	 */
+	static String format(final double x) {
+		if (Double.isNaN(x)) return "NaN";
+		if (Double.isInfinite(x)) return x > 0 ? "Infinity" : "-Infinity";
+		final StringBuilder s = new StringBuilder();
+		if (Double.doubleToRawLongBits(x) < 0) s.append('-');
+		if (x == 0) return s.append("0.0").toString();
+
+		final BigDecimal shortest = shortest(Math.abs(x)).stripTrailingZeros();
+		final String digits = shortest.unscaledValue().toString();
+		// The position of the decimal point with respect to the digits
+		final int l = digits.length(), point = l - shortest.scale();
+
+		if (point > 0 && point < l) return s.append(digits, 0, point).append('.').append(digits, point, l).toString();
+		if (point > 0 && point <= 15) {
+			s.append(digits);
+			appendZeroes(s, point - l);
+			return s.append(".0").toString();
+		}
+		if (point <= 0 && point > -4) {
+			s.append("0.");
+			appendZeroes(s, -point);
+			return s.append(digits).toString();
+		}
+		s.append(digits.charAt(0)).append('.').append(l > 1 ? digits.substring(1) : "0");
+		return s.append(String.format("e%+03d", Integer.valueOf(point - 1))).toString();
+	}
+
+	/** Prints a key/value pair in the format of <code>jackknife.rb</code>. */
+	private static void print(final PrintStream stream, final String key, final double value) {
+		// We use the same line separator of Ruby's puts on all platforms
+		stream.print(key + "=" + format(value) + "\n");
+	}
+
+	/** Prints the number of reachable pairs and jackknife estimates, with their standard errors, in the same format of <code>jackknife.rb</code>.
+	 *
+	 * <p>The output is identical to that of the script, except for two bugs of the script in the presence of an exact neighbourhood function:
+	 * this method prints as <code>reachablepairserr</code> the relative error of the number of reachable pairs (instead of that of
+	 * the average distance), and the relative error of the spid with key <code>spiderr</code> (instead of <code>spid</code>).
+	 *
+	 * @param exact an exact neighbourhood function, used to compute relative errors, or {@code null}.
+	 * @param stream a print stream.
+	 */
+	public void printJackknife(final double[] exact, final PrintStream stream) {
+		final double reachable = reachablePairs();
+		final double reachableStandardError = reachablePairsStandardError();
+		final Estimates jackknife = jackknife();
+		print(stream, "reachablepairs", reachable);
+		print(stream, "reachablepairsstderr", reachableStandardError);
+		if (exact != null) print(stream, "reachablepairserr", relativeError(reachable, exact[exact.length - 1]));
+		print(stream, "reachablepairsperc", 100 * reachable / (nodes * nodes));
+		print(stream, "reachablepairspercstderr", 100 * reachableStandardError / (nodes * nodes));
+		print(stream, "averagedistance", jackknife.averageDistance);
+		if (exact != null) print(stream, "averagedistanceerr", relativeError(jackknife.averageDistance, averageDistance(exact)));
+		print(stream, "averagedistancestderr", jackknife.averageDistanceStandardError);
+		print(stream, "harmonicdiameter", jackknife.harmonicDiameter);
+		if (exact != null) print(stream, "harmonicdiametererr", relativeError(jackknife.harmonicDiameter, harmonicDiameter(exact)));
+		print(stream, "harmonicdiameterstderr", jackknife.harmonicDiameterStandardError);
+		print(stream, "spid", jackknife.spid);
+		if (exact != null) print(stream, "spiderr", relativeError(jackknife.spid, spid(exact)));
+		print(stream, "spidstderr", jackknife.spidStandardError);
+	}
+
+	public static void main(final String arg[]) throws IOException, JSAPException {
+		final SimpleJSAP jsap = new SimpleJSAP(ApproximateNeighbourhoodFunctionStatistics.class.getName(),
+				"Computes jackknife (and optionally bootstrap) estimates of the number of reachable pairs, of the average distance, of the harmonic diameter and of the spid from several approximate neighbourhood functions in text format (e.g., the .nf files produced by several runs of HyperBall), and optionally their relative errors with respect to an exact neighbourhood function.",
+				new Parameter[] {
+					new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "0", JSAP.NOT_REQUIRED, 'T', "threads", "The number of threads to be used. If 0, the number will be estimated automatically."),
+					new FlaggedOption("exact", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 'e', "exact", "An exact neighbourhood function in text format, used to compute relative errors (and the number of nodes)."),
+					new FlaggedOption("bootstrap", JSAP.INTSIZE_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 'b', "bootstrap", "Compute also bootstrap estimates using the given number of replicates (0 for max(1000, n ln² n), where n is the number of samples)."),
+					new FlaggedOption("seed", JSAP.LONG_PARSER, "0", JSAP.NOT_REQUIRED, 's', "seed", "The seed for the bootstrap."),
+					new FlaggedOption("cdf", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 'c', "cdf", "Store the jackknifed distance cumulative distribution function in text format in this file."),
+					new UnflaggedOption("anf", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.GREEDY, "Approximate neighbourhood functions in text format."),
+				}
+		);
+
+		final JSAPResult jsapResult = jsap.parse(arg);
+		if (jsap.messagePrinted()) System.exit(1);
+
+		final String[] file = jsapResult.getStringArray("anf");
+		final double[] exact = jsapResult.userSpecified("exact") ? loadText(jsapResult.getString("exact")) : null;
+
+		LOGGER.info("Loading " + file.length + " samples...");
+		final ApproximateNeighbourhoodFunctionStatistics statistics = load(file, exact != null ? exact[0] : Double.NaN, jsapResult.getInt("threads"));
+		final int n = statistics.n;
+		statistics.printJackknife(exact, System.out);
+
+		if (jsapResult.userSpecified("bootstrap")) {
+			LOGGER.info("Computing bootstrap estimates on " + n + " samples...");
+			final Estimates bootstrap = statistics.bootstrap(jsapResult.getInt("bootstrap"), jsapResult.getLong("seed"));
+			print(System.out, "bootstrapaveragedistance", bootstrap.averageDistance);
+			if (exact != null) print(System.out, "bootstrapaveragedistanceerr", relativeError(bootstrap.averageDistance, averageDistance(exact)));
+			print(System.out, "bootstrapaveragedistancestderr", bootstrap.averageDistanceStandardError);
+			print(System.out, "bootstrapharmonicdiameter", bootstrap.harmonicDiameter);
+			if (exact != null) print(System.out, "bootstrapharmonicdiametererr", relativeError(bootstrap.harmonicDiameter, harmonicDiameter(exact)));
+			print(System.out, "bootstrapharmonicdiameterstderr", bootstrap.harmonicDiameterStandardError);
+			print(System.out, "bootstrapspid", bootstrap.spid);
+			if (exact != null) print(System.out, "bootstrapspiderr", relativeError(bootstrap.spid, spid(exact)));
+			print(System.out, "bootstrapspidstderr", bootstrap.spidStandardError);
+		}
+
+		if (jsapResult.userSpecified("cdf")) {
+			final PrintStream stream = new PrintStream(jsapResult.getString("cdf"));
+			TextIO.storeDoubles(statistics.cdf(null), stream);
+			stream.close();
+		}
+	}
+}
@@ -18,12 +18,17 @@
 package it.unimi.dsi.webgraph.algo;
 
 import java.io.IOException;
+import java.util.concurrent.ExecutorCompletionService;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
 import java.util.concurrent.TimeUnit;
 import java.util.concurrent.atomic.AtomicIntegerArray;
 
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
+import com.google.common.base.Throwables;
+import com.google.common.util.concurrent.ThreadFactoryBuilder;
 import com.martiansoftware.jsap.FlaggedOption;
 import com.martiansoftware.jsap.JSAP;
 import com.martiansoftware.jsap.JSAPException;
@@ -34,10 +39,13 @@ import com.martiansoftware.jsap.Switch;
 import com.martiansoftware.jsap.UnflaggedOption;
 
 import it.unimi.dsi.Util;
+import it.unimi.dsi.fastutil.ints.Int2IntOpenHashMap;
 import it.unimi.dsi.fastutil.ints.IntArrays;
 import it.unimi.dsi.fastutil.io.BinIO;
 import it.unimi.dsi.logging.ProgressLogger;
+import it.unimi.dsi.util.XoRoShiRo128PlusRandom;
 import it.unimi.dsi.webgraph.ImmutableGraph;
+import it.unimi.dsi.webgraph.NodeIterator;
 import it.unimi.dsi.webgraph.Transform;
 import it.unimi.dsi.webgraph.UnionImmutableGraph;
 
@@ -60,15 +68,39 @@ import it.unimi.dsi.webgraph.UnionImmutableGraph;
  * <p>Furthermore, it is possible to remove all components except the biggest one from a graph,
  * using the function {@link #getLargestComponent}.
  *
+ * <p>Alternatively, {@link #computeUnionFind(ImmutableGraph, int, ProgressLogger)} computes the same
+ * components (with the same numbering) using a lock-free union-find structure, following the
+ * <em>Afforest</em> strategy described by Michael Sutton, Tal Ben-Nun, and Amnon Barak in &ldquo;Optimizing parallel graph connectivity
+ * computation via subgraph sampling&rdquo;, <i>IPDPS 2018</i>: the first {@link #NEIGHBOUR_ROUNDS} successors of each node
+ * are linked during a first scan; then, the largest component is estimated by sampling,
+ * and a second pass links the remaining successors of nodes outside that component only.
+ * Scans are performed in parallel on segments of nodes containing approximately the same number of arcs.
+ *
+ * <p>The same strategy makes it possible to compute the <em>weakly</em> connected components of a directed graph
+ * (i.e., the connected components of its symmetrization) without building the transpose:
+ * {@link #computeWeakly(ImmutableGraph, int, ProgressLogger)} links in the second scan all remaining arcs, except for those whose
+ * endpoints are both in the largest component, so the graph is just scanned twice using {@linkplain ImmutableGraph#nodeIterator(int) node iterators}.
+ *
  * <h2>Performance issues</h2>
  *
  * <p>This class uses an instance of {@link ParallelBreadthFirstVisit} to ensure a high degree of
- * parallelism (see its documentation for memory requirements).
+ * parallelism (see its documentation for memory requirements). The visit proceeds
+ * one component at a time, so graphs with a very large number of small components, or with a giant component
+ * of large diameter, might be handled more efficiently by {@link #computeUnionFind(ImmutableGraph, int, ProgressLogger)},
+ * which needs just one integer per node, and scans sequentially the graph once using {@linkplain ImmutableGraph#nodeIterator(int) node iterators},
+ * and then accesses randomly the successors of nodes outside the largest component.
  */
 
 public class ConnectedComponents {
 	private static final Logger LOGGER = LoggerFactory.getLogger(ConnectedComponents.class);
 
+	/** The number of successors of each node linked in the first scan of {@link #computeUnionFind(ImmutableGraph, int, ProgressLogger)}. */
+	public static final int NEIGHBOUR_ROUNDS = 2;
+	/** The number of nodes sampled to estimate the largest component. */
+	private static final int SAMPLE_SIZE = 1024;
+	/** The number of arcs scanned by a thread before looking for more work. */
+	private static final long ARC_GRANULARITY = 1 << 20;
+
 	/** The number of connected components. */
 	public final int numberOfComponents;
 
@@ -100,6 +132,239 @@ public class ConnectedComponents {
 		return new ConnectedComponents(numberOfComponents, component);
 	}
 
+	/**
+	 * Computes the connected components of a symmetric graph using a parallel union-find structure.
+	 *
+	 * <p>Components are numbered exactly as in {@link #compute(ImmutableGraph, int, ProgressLogger)},
+	 * that is, in order of appearance of their first node.
+	 *
+	 * @param symGraph a symmetric graph supporting random access.
+	 * @param threads the requested number of threads (0 for {@link Runtime#availableProcessors()}).
+	 * @param pl a progress logger, or <code>null</code>.
+	 * @return an instance of this class containing the computed components.
+	 */
+	public static ConnectedComponents computeUnionFind(final ImmutableGraph symGraph, final int threads, final ProgressLogger pl) {
+		return unionFind(symGraph, true, threads, pl);
+	}
+
+	/**
+	 * Computes the weakly connected components of a graph (i.e., the connected components of its symmetrization) using a parallel
+	 * union-find structure.
+	 *
+	 * <p>Components are numbered exactly as in {@link #compute(ImmutableGraph, int, ProgressLogger)} applied to the symmetrized graph,
+	 * that is, in order of appearance of their first node.
+	 *
+	 * @param graph a graph with an efficient {@link ImmutableGraph#nodeIterator(int)} method.
+	 * @param threads the requested number of threads (0 for {@link Runtime#availableProcessors()}).
+	 * @param pl a progress logger, or <code>null</code>.
+	 * @return an instance of this class containing the computed components.
+	 */
+	public static ConnectedComponents computeWeakly(final ImmutableGraph graph, final int threads, final ProgressLogger pl) {
+		return unionFind(graph, false, threads, pl);
+	}
+
+	/**
+	 * Computes connected components using a parallel union-find structure.
+	 *
+	 * @param symGraph a graph.
+	 * @param symmetric whether {@code symGraph} is symmetric; if false, weakly connected components will be computed.
+	 * @param threads the requested number of threads (0 for {@link Runtime#availableProcessors()}).
+	 * @param pl a progress logger, or <code>null</code>.
+	 * @return an instance of this class containing the computed components.
+	 */
+	private static ConnectedComponents unionFind(final ImmutableGraph symGraph, final boolean symmetric, int threads, final ProgressLogger pl) {
+		if (threads == 0) threads = Runtime.getRuntime().availableProcessors();
+		final int n = symGraph.numNodes();
+		final AtomicIntegerArray parent = new AtomicIntegerArray(n);
+		for (int i = n; i-- != 0;) parent.set(i, i);
+
+		long m;
+		try {
+			m = symGraph.numArcs();
+		}
+		catch(final UnsupportedOperationException e) {
+			// No number of arcs. We have to enumerate.
+			m = 0;
+			final NodeIterator nodeIterator = symGraph.nodeIterator();
+			for(int i = n; i-- != 0;) {
+				nodeIterator.nextInt();
+				m += nodeIterator.outdegree();
+			}
+		}
+		final EliasFanoCumulativeOutdegreeList cumulativeOutdegrees = new EliasFanoCumulativeOutdegreeList(symGraph, m);
+		final ExecutorService executorService = Executors.newFixedThreadPool(threads, new ThreadFactoryBuilder().setNameFormat("ProcessingThread-%d").build());
+
+		if (pl != null) {
+			pl.itemsName = "nodes";
+			pl.expectedUpdates = -1;
+			pl.start("Linking the first " + NEIGHBOUR_ROUNDS + " successors of each node...");
+		}
+
+		parallelScan(symGraph, n, m, cumulativeOutdegrees, threads, executorService, (g, start, end) -> {
+			final NodeIterator nodeIterator = g.nodeIterator(start);
+			for (int x = start; x < end; x++) {
+				nodeIterator.nextInt();
+				final int[] s = nodeIterator.successorArray();
+				for (int j = Math.min(NEIGHBOUR_ROUNDS, nodeIterator.outdegree()); j-- != 0;) link(parent, x, s[j]);
+			}
+		}, pl);
+		parallelScan(symGraph, n, m, cumulativeOutdegrees, threads, executorService, (g, start, end) -> compress(parent, start, end), null);
+
+		// We estimate the largest component by sampling
+		int largest = -1;
+		if (n != 0) {
+			final XoRoShiRo128PlusRandom random = new XoRoShiRo128PlusRandom(0);
+			final Int2IntOpenHashMap count = new Int2IntOpenHashMap();
+			int max = 0;
+			for (int i = SAMPLE_SIZE; i-- != 0;) {
+				final int c = parent.get(random.nextInt(n));
+				final int k = count.addTo(c, 1) + 1;
+				if (k > max) {
+					max = k;
+					largest = c;
+				}
+			}
+			LOGGER.debug("Estimated fraction of nodes in the largest component: " + (double)max / SAMPLE_SIZE);
+		}
+
+		if (pl != null) {
+			pl.done();
+			pl.start(symmetric ? "Linking the remaining successors of nodes outside the largest component..." : "Linking the remaining arcs outside the largest component...");
+		}
+		final int skip = largest;
+		if (symmetric) parallelScan(symGraph, n, m, cumulativeOutdegrees, threads, executorService, (g, start, end) -> {
+			for (int x = start; x < end; x++) {
+				// Since the graph is symmetric, arcs from nodes of the largest component will be linked from the other endpoint
+				if (parent.get(x) == skip) continue;
+				final int d = g.outdegree(x);
+				if (d <= NEIGHBOUR_ROUNDS) continue;
+				final int[] s = g.successorArray(x);
+				for (int j = NEIGHBOUR_ROUNDS; j < d; j++) link(parent, x, s[j]);
+			}
+		}, pl);
+		else parallelScan(symGraph, n, m, cumulativeOutdegrees, threads, executorService, (g, start, end) -> {
+			final NodeIterator nodeIterator = g.nodeIterator(start);
+			for (int x = start; x < end; x++) {
+				nodeIterator.nextInt();
+				final int d = nodeIterator.outdegree();
+				if (d <= NEIGHBOUR_ROUNDS) continue;
+				final int[] s = nodeIterator.successorArray();
+				// Parents of nodes that are not roots do not change, so if both endpoints were in the largest component they still are
+				final boolean largestComponent = parent.get(x) == skip;
+				for (int j = NEIGHBOUR_ROUNDS; j < d; j++) if (! largestComponent || parent.get(s[j]) != skip) link(parent, x, s[j]);
+			}
+		}, pl);
+		parallelScan(symGraph, n, m, cumulativeOutdegrees, threads, executorService, (g, start, end) -> compress(parent, start, end), null);
+		executorService.shutdown();
+		if (pl != null) pl.done();
+
+		// Roots are the minimum nodes of their components, so numbering them in order gives the same numbering of a visit
+		final int[] component = new int[n];
+		int numberOfComponents = 0;
+		for (int x = 0; x < n; x++) {
+			final int p = parent.get(x);
+			component[x] = p == x ? numberOfComponents++ : component[p];
+		}
+		return new ConnectedComponents(numberOfComponents, component);
+	}
+
+	/** A task processing a segment of nodes. */
+	@FunctionalInterface
+	private interface Segment {
+		/** Processes a segment of nodes.
+		 *
+		 * @param g a copy of the graph reserved to the current thread.
+		 * @param start the first node of the segment.
+		 * @param end the node after the last node of the segment.
+		 */
+		void process(ImmutableGraph g, int start, int end);
+	}
+
+	/** Processes in parallel all nodes of a graph, dividing them in segments containing approximately the same number of arcs.
+	 *
+	 * @param graph a graph.
+	 * @param n the number of nodes of {@code graph}.
+	 * @param m the number of arcs of {@code graph}.
+	 * @param cumulativeOutdegrees the cumulative outdegree list of {@code graph}.
+	 * @param threads the number of threads.
+	 * @param executorService the executor service that will run the threads.
+	 * @param segment the task processing a segment.
+	 * @param pl a progress logger, or {@code null}.
+	 */
+	private static void parallelScan(final ImmutableGraph graph, final int n, final long m, final EliasFanoCumulativeOutdegreeList cumulativeOutdegrees, final int threads, final ExecutorService executorService, final Segment segment, final ProgressLogger pl) {
+		final ExecutorCompletionService<Void> executorCompletionService = new ExecutorCompletionService<>(executorService);
+		final long[] next = new long[2]; // The next node and the number of arcs preceding it
+
+		for(int t = threads; t-- != 0;) executorCompletionService.submit(() -> {
+			final ImmutableGraph g = graph.copy();
+			for(;;) {
+				final int start, end;
+				synchronized(next) {
+					if (next[0] == n) break;
+					start = (int)next[0];
+					final long target = next[1] + ARC_GRANULARITY;
+					if (target >= m) next[0] = n;
+					else {
+						next[1] = cumulativeOutdegrees.skipTo(target);
+						next[0] = cumulativeOutdegrees.currentIndex();
+					}
+					end = (int)next[0];
+				}
+				segment.process(g, start, end);
+				if (pl != null) synchronized(pl) {
+					pl.update(end - start);
+				}
+			}
+			return null;
+		});
+
+		Throwable problem = null;
+		for(int t = threads; t-- != 0;)
+			try {
+				executorCompletionService.take().get();
+			}
+			catch(final Exception e) {
+				problem = e.getCause(); // We keep only the last one. They will be logged anyway.
+			}
+
+		if (problem != null) {
+			executorService.shutdown();
+			Throwables.throwIfUnchecked(problem);
+			throw new RuntimeException(problem);
+		}
+	}
+
+	/** Links the sets of two nodes, making the root with the larger index point to the root with the smaller index.
+	 *
+	 * @param parent the parent array.
+	 * @param x a node.
+	 * @param y a node.
+	 */
+	private static void link(final AtomicIntegerArray parent, final int x, final int y) {
+		int p = parent.get(x), q = parent.get(y);
+		while (p != q) {
+			final int high = Math.max(p, q), low = Math.min(p, q);
+			final int parentOfHigh = parent.get(high);
+			if (parentOfHigh == low) return;
+			if (parentOfHigh == high && parent.compareAndSet(high, high, low)) return;
+			p = parent.get(parentOfHigh);
+			q = parent.get(low);
+		}
+	}
+
+	/** Makes each node in a segment point directly to its root.
+	 *
+	 * @param parent the parent array.
+	 * @param start the first node of the segment.
+	 * @param end the node after the last node of the segment.
+	 */
+	private static void compress(final AtomicIntegerArray parent, final int start, final int end) {
+		for (int x = start; x < end; x++) {
+			int p;
+			while ((p = parent.get(x)) != parent.get(p)) parent.set(x, parent.get(p));
+		}
+	}
+
 	/**
 	 * Returns the largest connected components of a symmetric graph.
 	 *
@@ -177,12 +442,15 @@ public class ConnectedComponents {
 				"Computes the connected components of a symmetric graph of given basename. The resulting data is saved " +
 				"in files stemmed from the given basename with extension .wcc (a list of binary integers specifying the " +
 				"component of each node) and .wccsizes (a list of binary integer specifying the size of each component). " +
-				"The symmetric graph can also be specified using a generic (non-symmetric) graph and its transpose.",
+				"The symmetric graph can also be specified using a generic (non-symmetric) graph and its transpose, or the weakly " +
+				"connected components of a generic graph can be computed directly using a union-find structure.",
 				new Parameter[] {
 					new Switch("sizes", 's', "sizes", "Compute component sizes."),
 					new Switch("renumber", 'r', "renumber", "Renumber components in decreasing-size order."),
 					new FlaggedOption("logInterval", JSAP.LONG_PARSER, Long.toString(ProgressLogger.DEFAULT_LOG_INTERVAL), JSAP.NOT_REQUIRED, 'l', "log-interval", "The minimum time interval between activity logs in milliseconds."),
 					new Switch("mapped", 'm', "mapped", "Do not load the graph in main memory, but rather memory-map it."),
+					new Switch("unionFind", 'u', "union-find", "Use a parallel union-find structure instead of breadth-first visits."),
+					new Switch("weak", 'w', "weak", "Compute the weakly connected components of a generic graph without its transpose (implies --union-find)."),
 					new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "0", JSAP.NOT_REQUIRED, 'T', "threads", "The number of threads to be used. If 0, the number will be estimated automatically."),
 					new FlaggedOption("basenamet", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 't', "transpose", "The basename of the transpose, in case the graph is not symmetric."),
 					new UnflaggedOption("basename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The basename of a symmetric graph (or of a generic graph, if the transpose is provided, too)."),
@@ -201,7 +469,10 @@ public class ConnectedComponents {
 
 		final ImmutableGraph graph = jsapResult.userSpecified("mapped") ? ImmutableGraph.loadMapped(basename) : ImmutableGraph.load(basename, pl);
 		final ImmutableGraph grapht = basenamet == null ? null : jsapResult.userSpecified("mapped") ? ImmutableGraph.loadMapped(basenamet) : ImmutableGraph.load(basenamet, pl);
-		final ConnectedComponents components = ConnectedComponents.compute(basenamet != null ? new UnionImmutableGraph(graph, grapht) : graph, threads, pl);
+		final ImmutableGraph symGraph = basenamet != null ? new UnionImmutableGraph(graph, grapht) : graph;
+		final ConnectedComponents components = jsapResult.userSpecified("weak") ? ConnectedComponents.computeWeakly(symGraph, threads, pl)
+				: jsapResult.userSpecified("unionFind") ? ConnectedComponents.computeUnionFind(symGraph, threads, pl)
+				: ConnectedComponents.compute(symGraph, threads, pl);
 
 		if (jsapResult.getBoolean("sizes") || jsapResult.getBoolean("renumber")) {
 			final int size[] = components.computeSizes();
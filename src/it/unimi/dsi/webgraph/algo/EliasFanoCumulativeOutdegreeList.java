@@ -22,10 +22,12 @@ import static it.unimi.dsi.bits.LongArrayBitVector.word;
 import it.unimi.dsi.bits.BitVector;
 import it.unimi.dsi.bits.Fast;
 import it.unimi.dsi.bits.LongArrayBitVector;
+import it.unimi.dsi.fastutil.ints.IntIterator;
 import it.unimi.dsi.fastutil.longs.LongBigList;
 import it.unimi.dsi.sux4j.bits.SimpleSelectZero;
 import it.unimi.dsi.sux4j.util.EliasFanoMonotoneLongBigList;
 import it.unimi.dsi.util.HyperLogLogCounterArray;
+import it.unimi.dsi.webgraph.GraphSketch;
 import it.unimi.dsi.webgraph.ImmutableGraph;
 
 /**<p>A content-addressable representation of the cumulative function of outdegrees that uses a stripped-down
@@ -90,9 +92,33 @@ public final class EliasFanoCumulativeOutdegreeList {
 	 * equal to the number of nodes in {@code graph}.
 	 */
 	public EliasFanoCumulativeOutdegreeList(final ImmutableGraph graph, final long numArcs, final int roundingMask) {
+		this(graph.numNodes(), numArcs, graph.outdegrees(), roundingMask);
+	}
+
+	/** Creates a cumulative outdegree list with specified rounding mask using the outdegrees stored in a {@linkplain GraphSketch sketch}.
+	 *
+	 * @param sketch a graph sketch.
+	 * @param roundingMask a number of the form 2<sup><var>k</var></sup> &minus; 1. After each call to {@link #skipTo(long)},
+	 * {@link #currentIndex()} is guaranteed to return a multiple of 2<sup><var>k</var></sup>, unless {@link #currentIndex()} is
+	 * equal to the number of nodes in the sketch.
+	 */
+	public EliasFanoCumulativeOutdegreeList(final GraphSketch sketch, final int roundingMask) {
+		this(sketch.numNodes, sketch.numArcs, sketch.outdegrees(), roundingMask);
+	}
+
+	/** Creates a cumulative outdegree list with specified rounding mask using a given sequence of outdegrees.
+	 *
+	 * @param numNodes the number of nodes.
+	 * @param numArcs the number of arcs.
+	 * @param outdegrees an iterator returning (at least) {@code numNodes} outdegrees.
+	 * @param roundingMask a number of the form 2<sup><var>k</var></sup> &minus; 1. After each call to {@link #skipTo(long)},
+	 * {@link #currentIndex()} is guaranteed to return a multiple of 2<sup><var>k</var></sup>, unless {@link #currentIndex()} is
+	 * equal to {@code numNodes}.
+	 */
+	public EliasFanoCumulativeOutdegreeList(final int numNodes, final long numArcs, final IntIterator outdegrees, final int roundingMask) {
 		if (roundingMask + 1 != Integer.highestOneBit(roundingMask + 1)) throw new IllegalArgumentException("Illegal rounding mask: " + roundingMask);
 		this.roundingMask = roundingMask;
-		final long length = numNodes = graph.numNodes();
+		final long length = this.numNodes = numNodes;
 		final long upperBound = numArcs;
 		l = length == 0 ? 0 : Math.max(0, Fast.mostSignificantBit(upperBound / length));
 		final long lowerBitsMask = (1L << l) - 1;
@@ -101,7 +127,7 @@ public final class EliasFanoCumulativeOutdegreeList {
 		final BitVector upperBitsVector = LongArrayBitVector.getInstance().length(length + (upperBound >>> l) + 1);
 		long v = 0;
 		for(int i = 0; i < length; i++) {
-			v += graph.outdegree(i);
+			v += outdegrees.nextInt();
 			if (v > upperBound) throw new IllegalArgumentException("Too large value: " + v + " > " + upperBound);
 			if (l != 0) lowerBitsList.set(i, v & lowerBitsMask);
 			upperBitsVector.set((v >>> l) + i);
@@ -20,15 +20,18 @@ package it.unimi.dsi.webgraph.algo;
 import java.io.IOException;
 import java.util.Arrays;
 import java.util.concurrent.Callable;
+import java.util.concurrent.CyclicBarrier;
 import java.util.concurrent.ExecutionException;
 import java.util.concurrent.ExecutorCompletionService;
 import java.util.concurrent.ExecutorService;
 import java.util.concurrent.Executors;
 import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicLongArray;
 
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
+import com.google.common.util.concurrent.ThreadFactoryBuilder;
 import com.martiansoftware.jsap.FlaggedOption;
 import com.martiansoftware.jsap.JSAP;
 import com.martiansoftware.jsap.JSAPException;
@@ -39,6 +42,8 @@ import com.martiansoftware.jsap.Switch;
 import com.martiansoftware.jsap.UnflaggedOption;
 
 import it.unimi.dsi.fastutil.ints.IntArrayFIFOQueue;
+import it.unimi.dsi.fastutil.ints.IntArrayList;
+import it.unimi.dsi.fastutil.ints.IntArrays;
 import it.unimi.dsi.fastutil.io.BinIO;
 import it.unimi.dsi.logging.ProgressLogger;
 import it.unimi.dsi.webgraph.ArrayListMutableGraph;
@@ -63,7 +68,10 @@ import it.unimi.dsi.webgraph.algo.TopKGeometricCentrality.Centrality;
  * that running on <var>k</var> cores requires approximately <var>k</var> times the memory of the
  * sequential algorithm, as only the graph and the betweenness array will be shared.
  *
- * <p>To use this class you first create an instance, and then invoke {@link #compute()}.
+ * <p>Alternatively, {@link #computeBitParallel()} visits the graph from 64 sources at a time, with all threads cooperating on the same visits.
+ * In this case, memory usage does not depend on the number of threads, and each successor list is decoded once for each batch of 64 sources.
+ *
+ * <p>To use this class you first create an instance, and then invoke {@link #compute()} or {@link #computeBitParallel()}.
  * After that, you can peek at the fields {@link #closeness}, {@link #lin}, {@link #harmonic}, {@link #exponential} and {@link #reachable}.
  */
 
@@ -238,6 +246,211 @@ public class GeometricCentralities {
 		if (pl != null) pl.done();
 	}
 
+	/** A bit-parallel visit from 64 sources at a time, shared by all threads. */
+	private final class BitParallelVisit {
+		/** For each node, the sources (represented as bits) that have reached it. */
+		private final long[] seen;
+		/** For each node, the sources (represented as bits) that have reached it at the current distance. */
+		private final long[] current;
+		/** For each node, the sources (represented as bits) that reach it at the next distance. */
+		private final AtomicLongArray next;
+		/** The per-thread lists of nodes in the next frontier. */
+		private final IntArrayList[] found;
+		/** The per-thread number of nodes reached by each source at the current distance. */
+		private final long[][] count;
+		/** The index of the next element of {@link #frontier} to process. */
+		private final AtomicInteger cursor = new AtomicInteger();
+		/** The nodes of the current frontier. */
+		private int[] frontier = new int[Long.SIZE];
+		/** The number of valid elements of {@link #frontier}. */
+		private int frontierSize;
+		/** The first source of the current batch. */
+		private int firstSource = -Long.SIZE;
+		/** The number of sources of the current batch. */
+		private int sources;
+		/** The distance of the nodes in the next frontier from the sources. */
+		private int distance;
+		/** Whether the threads must expand the current frontier (or otherwise settle the next one). */
+		private boolean expand;
+		/** Whether the computation is over. */
+		private boolean done;
+
+		private BitParallelVisit() {
+			final int n = graph.numNodes();
+			seen = new long[n];
+			current = new long[n];
+			next = new AtomicLongArray(n);
+			found = new IntArrayList[numberOfThreads];
+			count = new long[numberOfThreads][Long.SIZE];
+			for(int i = numberOfThreads; i-- != 0;) found[i] = new IntArrayList();
+		}
+
+		/** Executed by the last thread reaching the barrier; prepares the next phase. */
+		private void step() {
+			if (expand) {
+				// Gather the next frontier
+				int size = 0;
+				for(final IntArrayList f : found) size += f.size();
+				frontier = IntArrays.ensureCapacity(frontier, size);
+				frontierSize = 0;
+				for(final IntArrayList f : found) {
+					f.getElements(0, frontier, frontierSize, f.size());
+					frontierSize += f.size();
+					f.clear();
+				}
+				expand = false;
+				cursor.set(0);
+				return;
+			}
+
+			if (firstSource >= 0) {
+				// Accumulate the contributions of the nodes at the current distance
+				final double hd = 1. / distance, ed = Math.pow(alpha, distance);
+				for(final long[] c : count) {
+					for(int j = sources; j-- != 0;) {
+						if (c[j] == 0) continue;
+						final int source = firstSource + j;
+						closeness[source] += (double)distance * c[j];
+						harmonic[source] += hd * c[j];
+						exponential[source] += ed * c[j];
+						reachable[source] += c[j];
+					}
+					Arrays.fill(c, 0);
+				}
+				distance++;
+			}
+
+			if (frontierSize == 0) {
+				if (firstSource >= 0) {
+					for(int source = firstSource; source < firstSource + sources; source++) {
+						if (closeness[source] == 0) lin[source] = 1; // Terminal node
+						else {
+							closeness[source] = 1 / closeness[source];
+							lin[source] = (double)reachable[source] * reachable[source] * closeness[source];
+						}
+					}
+					if (pl != null) pl.update(sources);
+				}
+
+				// Start a new batch
+				firstSource += Long.SIZE;
+				if (stop || firstSource >= graph.numNodes()) {
+					done = true;
+					return;
+				}
+				sources = Math.min(Long.SIZE, graph.numNodes() - firstSource);
+				Arrays.fill(seen, 0);
+				for(int j = 0; j < sources; j++) {
+					final int source = firstSource + j;
+					seen[source] = current[source] = 1L << j;
+					frontier[j] = source;
+					reachable[source] = 1;
+				}
+				frontierSize = sources;
+				distance = 1;
+			}
+
+			expand = true;
+			cursor.set(0);
+		}
+
+		/** Expands the current frontier, computing the sources that reach each successor for the first time.
+		 *
+		 * @param graph the graph.
+		 * @param found the list where nodes of the next frontier will be added.
+		 */
+		private void expand(final ImmutableGraph graph, final IntArrayList found) {
+			final int granularity = 1024;
+			for(int from; (from = cursor.getAndAdd(granularity)) < frontierSize;) {
+				final int to = Math.min(frontierSize, from + granularity);
+				for(int i = from; i < to; i++) {
+					final int node = frontier[i];
+					final long bits = current[node];
+					current[node] = 0;
+					// The successor list is decoded once for all sources
+					final LazyIntIterator successors = graph.successors(node);
+					for(int s; (s = successors.nextInt()) != -1;) {
+						final long newBits = bits & ~seen[s];
+						if (newBits != 0 && (next.get(s) & newBits) != newBits && next.getAndAccumulate(s, newBits, (x, y) -> x | y) == 0) found.add(s);
+					}
+				}
+			}
+		}
+
+		/** Settles the next frontier, updating the per-thread counts of reached nodes.
+		 *
+		 * @param count the per-thread counts.
+		 */
+		private void settle(final long[] count) {
+			final int granularity = 1024;
+			for(int from; (from = cursor.getAndAdd(granularity)) < frontierSize;) {
+				final int to = Math.min(frontierSize, from + granularity);
+				for(int i = from; i < to; i++) {
+					final int node = frontier[i];
+					long bits = next.get(node);
+					next.set(node, 0);
+					seen[node] |= bits;
+					current[node] = bits;
+					while(bits != 0) {
+						count[Long.numberOfTrailingZeros(bits)]++;
+						bits &= bits - 1;
+					}
+				}
+			}
+		}
+	}
+
+	/** Computes geometric centralities and the number of reachable nodes using bit-parallel visits.
+	 *
+	 * <p>This method visits the graph from 64 sources at a time: for each node, a 64-bit word records which sources
+	 * have reached it, so each successor list is decoded once for all sources of a batch. All threads cooperate on the same visit, splitting the frontier,
+	 * and accumulate the number of nodes reached by each source in per-thread buffers. As a result, memory usage does not depend
+	 * on the number of threads, and the number of visits is reduced by a factor of 64, which usually makes this method significantly
+	 * faster than {@link #compute()}. Results can be found in {@link GeometricCentralities#closeness}, {@link GeometricCentralities#lin},
+	 * {@link GeometricCentralities#harmonic}, {@link GeometricCentralities#exponential} and {@link GeometricCentralities#reachable}.
+	 */
+	public void computeBitParallel() throws InterruptedException {
+		final BitParallelVisit visit = new BitParallelVisit();
+		final CyclicBarrier barrier = new CyclicBarrier(numberOfThreads, visit::step);
+
+		if (pl != null) {
+			pl.start("Starting bit-parallel visits...");
+			pl.expectedUpdates = graph.numNodes();
+			pl.itemsName = "sources";
+		}
+
+		final ExecutorService executorService = Executors.newFixedThreadPool(numberOfThreads, new ThreadFactoryBuilder().setNameFormat("ProcessingThread-%d").build());
+		final ExecutorCompletionService<Void> executorCompletionService = new ExecutorCompletionService<>(executorService);
+
+		for(int i = numberOfThreads; i-- != 0;) {
+			final int t = i;
+			executorCompletionService.submit(() -> {
+				final ImmutableGraph graph = GeometricCentralities.this.graph.copy();
+				for(;;) {
+					barrier.await();
+					if (visit.done) return null;
+					if (visit.expand) visit.expand(graph, visit.found[t]);
+					else visit.settle(visit.count[t]);
+				}
+			});
+		}
+
+		try {
+			for(int i = numberOfThreads; i-- != 0;) executorCompletionService.take().get();
+		}
+		catch(final ExecutionException e) {
+			stop = true;
+			executorService.shutdownNow();
+			final Throwable cause = e.getCause();
+			throw cause instanceof RuntimeException ? (RuntimeException)cause : new RuntimeException(cause.getMessage(), cause);
+		}
+		finally {
+			executorService.shutdown();
+		}
+
+		if (pl != null) pl.done();
+	}
+
 
 	public static void main(final String[] arg) throws IOException, JSAPException, InterruptedException {
 
@@ -245,6 +458,7 @@ public class GeometricCentralities {
 			new Parameter[] {
 			new Switch("expand", 'e', "expand", "Expand the graph to increase speed (no compression)."),
 			new Switch("mapped", 'm', "mapped", "Use loadMapped() to load the graph."),
+			new Switch("bitParallel", 'b', "bit-parallel", "Visit the graph from 64 sources at a time using bit-parallel visits."),
 			new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "0", JSAP.NOT_REQUIRED, 'T', "threads", "The number of threads to be used. If 0, the number will be estimated automatically."),
 			new UnflaggedOption("graphBasename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The basename of the graph."),
 			new UnflaggedOption("closenessFilename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The filename where closeness centrality scores (doubles in binary form) will be stored."),
@@ -269,7 +483,8 @@ public class GeometricCentralities {
 		if (jsapResult.userSpecified("expand")) graph = new ArrayListMutableGraph(graph).immutableView();
 
 		final GeometricCentralities centralities = new GeometricCentralities(graph, threads, progressLogger);
-		centralities.compute();
+		if (jsapResult.getBoolean("bitParallel")) centralities.computeBitParallel();
+		else centralities.compute();
 
 		BinIO.storeDoubles(centralities.closeness, jsapResult.getString("closenessFilename"));
 		BinIO.storeDoubles(centralities.lin, jsapResult.getString("linFilename"));
@@ -53,6 +53,7 @@ import it.unimi.dsi.Util;
 import it.unimi.dsi.bits.Fast;
 import it.unimi.dsi.bits.LongArrayBitVector;
 import it.unimi.dsi.fastutil.Hash;
+import it.unimi.dsi.fastutil.HashCommon;
 import it.unimi.dsi.fastutil.doubles.DoubleArrayList;
 import it.unimi.dsi.fastutil.doubles.DoubleIterator;
 import it.unimi.dsi.fastutil.ints.AbstractInt2DoubleFunction;
@@ -72,6 +73,7 @@ import it.unimi.dsi.util.KahanSummation;
 import it.unimi.dsi.util.XoRoShiRo128PlusRandomGenerator;
 import it.unimi.dsi.webgraph.BVGraph;
 import it.unimi.dsi.webgraph.GraphClassParser;
+import it.unimi.dsi.webgraph.GraphSketch;
 import it.unimi.dsi.webgraph.ImmutableGraph;
 import it.unimi.dsi.webgraph.LazyIntIterator;
 import it.unimi.dsi.webgraph.NodeIterator;
@@ -152,6 +154,18 @@ import it.unimi.dsi.webgraph.Transform;
  * weight, as weight are simulated by loading the counter of a node with multiple elements. Combining this feature
  * with discounts, one can compute <em>discounted-gain centralities</em> as defined in the HyperBall paper.
  *
+ * <h2>Multiple runs</h2>
+ *
+ * <p>To estimate the precision of the results (e.g., using {@link ApproximateNeighbourhoodFunctionStatistics}) one usually computes several
+ * approximate neighbourhood functions using different seeds. If you pass a number of <em>runs</em> larger than one
+ * to the {@linkplain #HyperBall(ImmutableGraph, ImmutableGraph, int, ProgressLogger, int, int, int, boolean, boolean, boolean, Int2DoubleFunction[], int[], int, long) constructor}
+ * (or on the command line), HyperBall will keep track of as many independent register sets, using different seeds, and
+ * will merge all of them after enumerating once the successors of each node, so the cost of decoding the graph is paid just once.
+ * The neighbourhood function computed by each run is available in {@link #neighbourhoodFunctions}.
+ * A node is considered modified if its counter has been modified in at least one run, so the final iterations
+ * of a multiple-run computation might be slightly slower than those of a single-run computation. Centralities
+ * are computed using the first run only, and external computations are not supported.
+ *
  * <h2>Configuring the JVM</h2>
  *
  * <p>HyperBall computations go against all basic assumptions of Java garbage collection. It is thus
@@ -269,6 +283,12 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 	protected boolean doSumOfInverseDistances;
 	/** The neighbourhood function, if requested. */
 	public final DoubleArrayList neighbourhoodFunction;
+	/** The neighbourhood function computed by each run (the first one is {@link #neighbourhoodFunction}). */
+	public final DoubleArrayList[] neighbourhoodFunctions;
+	/** The number of independent runs. */
+	protected final int runs;
+	/** The counter arrays of all runs except the first one, which uses this counter array. */
+	protected final Run[] run;
 	/** The sum of the distances from every given node, if requested. */
 	public final float[] sumOfDistances;
 	/** The sum of inverse distances from each given node, if requested. */
@@ -291,10 +311,10 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 	protected final int granularity;
 	/** The number of nodes per task (obtained by adapting {@link #granularity} to the current ratio of modified nodes). <strong>Must</strong> be a multiple of {@link Long#SIZE}. */
 	protected long adaptiveGranularity;
-	/** The value computed by the last iteration. */
-	protected double last;
-	/** The value computed by the current iteration. */
-	protected double current;
+	/** The value computed by the last iteration, for each run. */
+	protected final double[] last;
+	/** The value computed by the current iteration, for each run. */
+	protected final double[] current;
 	/** The current iteration. */
 	protected int iteration;
 	/** If {@link #external} is true, the name of the temporary file that will be used to write the update list. */
@@ -348,6 +368,10 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 	protected final long[][] resultBits;
 	/** If {@link #external} is false, a {@link #registerSize}-bit views of {@link #resultBits}. */
 	protected final LongBigList resultRegisters[];
+	/** The arrays where results are stored for all runs except the first one. */
+	protected final long[][][] runResultBits;
+	/** {@link #registerSize}-bit views of {@link #runResultBits}. */
+	protected final LongBigList[][] runResultRegisters;
 	/** For each counter, whether it has changed its value. We use an array of boolean (instead of a {@link LongArrayBitVector}) just for access speed. */
 	protected boolean[] modifiedCounter;
 	/** For each newly computed counter, whether it has changed its value. {@link #modifiedCounter}
@@ -365,6 +389,29 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 	/** One of the throwables thrown by some of the threads, if at least one thread has thrown a throwable. */
 	protected volatile Throwable threadThrowable;
 
+	/** The counter array of an additional run, whose bit vectors are accessed directly. */
+	protected static final class Run extends HyperLogLogCounterArray {
+		private static final long serialVersionUID = 1L;
+
+		private Run(final long arraySize, final long n, final int log2m, final long seed) {
+			super(arraySize, n, log2m, seed);
+		}
+
+		private long[][] bits() {
+			return bits;
+		}
+	}
+
+	/** Returns the seed used by a run.
+	 *
+	 * @param seed the seed of the first run.
+	 * @param run a run.
+	 * @return the seed used by the given run.
+	 */
+	protected static long seed(final long seed, final int run) {
+		return run == 0 ? seed : HashCommon.murmurHash3(seed + run);
+	}
+
 	protected final static int ensureRegisters(final int log2m) {
 		if (log2m < 4) throw new IllegalArgumentException("There must be at least 16 registers per counter");
 		if (log2m > 60) throw new IllegalArgumentException("There can be at most 2^60 registers per counter");
@@ -500,17 +547,49 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 	public HyperBall(final ImmutableGraph g, final ImmutableGraph gt, final int log2m, final ProgressLogger pl,
 			final int numberOfThreads, final int bufferSize, final int granularity, final boolean external,
 			final boolean doSumOfDistances, final boolean doSumOfInverseDistances, final Int2DoubleFunction[] discountFunction, final int[] weight, final long seed) throws IOException {
+		this(g, gt, log2m, pl, numberOfThreads, bufferSize, granularity, external, doSumOfDistances, doSumOfInverseDistances, discountFunction, weight, 1, seed);
+	}
+
+	/** Creates a new HyperBall instance performing several independent runs.
+	 *
+	 * @param g the graph whose neighbourhood function you want to compute.
+	 * @param gt the transpose of <code>g</code>, or <code>null</code>.
+	 * @param log2m the logarithm of the number of registers per counter.
+	 * @param pl a progress logger, or <code>null</code>.
+	 * @param numberOfThreads the number of threads to be used (0 for automatic sizing).
+	 * @param bufferSize the size of an I/O buffer in bytes (0 for {@link #DEFAULT_BUFFER_SIZE}).
+	 * @param granularity the number of node per task in a multicore environment (it will be rounded to the next multiple of 64), or 0 for {@link #DEFAULT_GRANULARITY}.
+	 * @param external if true, results of an iteration will be stored on disk (only if <code>runs</code> is one).
+	 * @param doSumOfDistances whether the sum of distances from each node should be computed (using the first run).
+	 * @param doSumOfInverseDistances whether the sum of inverse distances from each node should be computed (using the first run).
+	 * @param discountFunction an array (possibly <code>null</code>) of discount functions.
+	 * @param weight an array of nonnegative node weights.
+	 * @param runs the number of independent runs, each using its own set of registers.
+	 * @param seed the random seed passed to {@link HyperLogLogCounterArray#HyperLogLogCounterArray(long, long, int, long)} for the first run;
+	 * the other runs use seeds derived from this one.
+	 */
+	public HyperBall(final ImmutableGraph g, final ImmutableGraph gt, final int log2m, final ProgressLogger pl,
+			final int numberOfThreads, final int bufferSize, final int granularity, final boolean external,
+			final boolean doSumOfDistances, final boolean doSumOfInverseDistances, final Int2DoubleFunction[] discountFunction, final int[] weight, final int runs, final long seed) throws IOException {
 		super(g.numNodes(), totalWeight(g.numNodes(), weight), ensureRegisters(log2m), seed);
 
 		info("Seed : " + Long.toHexString(seed));
 
+		if (runs < 1) throw new IllegalArgumentException("The number of runs must be positive: " + runs);
+		if (runs > 1 && external) throw new IllegalArgumentException("External computations support a single run");
+		this.runs = runs;
+		run = new Run[runs - 1];
+		for(int r = 1; r < runs; r++) run[r - 1] = new Run(g.numNodes(), totalWeight(g.numNodes(), weight), log2m, seed(seed, r));
+
 		gotTranspose = gt != null;
 		localNextMustBeChecked = gotTranspose ? IntSets.synchronize(new IntOpenHashSet(Hash.DEFAULT_INITIAL_SIZE, Hash.VERY_FAST_LOAD_FACTOR)) : null;
 		this.weight = weight;
 
 		numNodes = g.numNodes();
+		// If a sketch is available, we avoid scanning the graph to compute the cumulative outdegree list
+		final GraphSketch sketch = GraphSketch.load(g);
 		try {
-			numArcs = g.numArcs();
+			numArcs = sketch != null ? sketch.numArcs : g.numArcs();
 		}
 		catch(final UnsupportedOperationException e) {
 			// No number of arcs. We have to enumerate.
@@ -524,7 +603,7 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 		}
 		squareNumNodes = (double)numNodes * numNodes;
 
-		cumulativeOutdegrees = new EliasFanoCumulativeOutdegreeList(g, numArcs, Math.max(0, 64 / m - 1));
+		cumulativeOutdegrees = sketch != null ? new EliasFanoCumulativeOutdegreeList(sketch, Math.max(0, 64 / m - 1)) : new EliasFanoCumulativeOutdegreeList(g, numArcs, Math.max(0, 64 / m - 1));
 
 		modifiedCounter = new boolean[numNodes];
 		modifiedResultCounter = external ? null : new boolean[numNodes];
@@ -547,6 +626,7 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 		info("Relative standard deviation: " + Util.format(100 * HyperLogLogCounterArray.relativeStandardDeviation(log2m)) + "% (" + m  + " registers/counter, " + registerSize + " bits/register, " + Util.format(m * registerSize / 8.) + " bytes/counter)");
 		if (external) info("Running " + this.numberOfThreads + " threads with a buffer of " + Util.formatSize(this.bufferSize) + " counters");
 		else info("Running " + this.numberOfThreads + " threads");
+		if (runs > 1) info("Performing " + runs + " independent runs");
 
 		thread = new IterationThread[this.numberOfThreads];
 
@@ -566,7 +646,11 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 		modified = new AtomicInteger();
 		unwritten = new AtomicInteger();
 
-		neighbourhoodFunction = new DoubleArrayList();
+		neighbourhoodFunctions = new DoubleArrayList[runs];
+		for(int r = 0; r < runs; r++) neighbourhoodFunctions[r] = new DoubleArrayList();
+		neighbourhoodFunction = neighbourhoodFunctions[0];
+		last = new double[runs];
+		current = new double[runs];
 		sumOfDistances = doSumOfDistances ? new float[numNodes] : null;
 		sumOfInverseDistances = doSumOfInverseDistances ? new float[numNodes] : null;
 		discountedCentrality = new float[this.discountFunction.length][];
@@ -586,6 +670,15 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 			resultRegisters = null;
 		}
 
+		runResultBits = new long[runs - 1][][];
+		runResultRegisters = new LongBigList[runs - 1][];
+		for(int r = 1; r < runs; r++) {
+			final long[][] bits = run[r - 1].bits();
+			runResultBits[r - 1] = new long[bits.length][];
+			runResultRegisters[r - 1] = new LongBigList[bits.length];
+			for(int i = bits.length; i-- != 0;) runResultRegisters[r - 1][i] = (LongArrayBitVector.wrap(runResultBits[r - 1][i] = new long[bits[i].length])).asLongBigList(registerSize);
+		}
+
 		lock = new ReentrantLock();
 		allWaiting = lock.newCondition();
 		start = lock.newCondition();
@@ -615,6 +708,7 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 		long bytes = 0;
 		for (final long[] a : bits) bytes += a.length * (long)Long.BYTES;
 		if (! external) bytes *= 2;
+		bytes *= runs;
 		if (sumOfDistances != null) bytes += sumOfDistances.length * (long)Float.BYTES;
 		if (sumOfInverseDistances != null) bytes += sumOfInverseDistances.length * (long)Float.BYTES;
 		for (int i = discountFunction.length; i-- != 0;) bytes += discountedCentrality[i].length * (long)Float.BYTES;
@@ -625,6 +719,32 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 		return bytes;
 	}
 
+	/** Returns the bit vectors of a run.
+	 *
+	 * @param r a run.
+	 * @return the bit vectors of the counters of run <code>r</code>.
+	 */
+	private long[][] bits(final int r) {
+		return r == 0 ? bits : run[r - 1].bits();
+	}
+
+	/** Returns the registers of a run.
+	 *
+	 * @param r a run.
+	 * @return the registers of run <code>r</code> (for the first run, the same as {@link #registers()}).
+	 */
+	public LongBigList[] registers(final int r) {
+		return r == 0 ? registers : run[r - 1].registers();
+	}
+
+	private long[][] resultBits(final int r) {
+		return r == 0 ? resultBits : runResultBits[r - 1];
+	}
+
+	private LongBigList[] resultRegisters(final int r) {
+		return r == 0 ? resultRegisters : runResultRegisters[r - 1];
+	}
+
 	private void ensureOpen() {
 		if (closed) throw new IllegalStateException("This " + HyperBall.class.getSimpleName() + " has been closed.");
 	}
@@ -649,30 +769,37 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 		ensureOpen();
 		info("Clearing all registers...");
 		clear(seed);
+		for(int r = 1; r < runs; r++) run[r - 1].clear(seed(seed, r));
 
 		if (weight == null) {
 			// We load the counter i with node i.
-			for(int i = numNodes; i-- != 0;) add(i, i);
+			for(int i = numNodes; i-- != 0;) {
+				add(i, i);
+				for(final Run r : run) r.add(i, i);
+			}
 		}
 		else {
 			final XoRoShiRo128PlusRandomGenerator random = new XoRoShiRo128PlusRandomGenerator(seed);
 			// We load the counter i with node weight[i] random values.
 			for(int i = numNodes; i-- != 0;)
-				for(int j = weight[i]; j-- != 0;)
-					add(i, random.nextLong());
+				for(int j = weight[i]; j-- != 0;) {
+					final long v = random.nextLong();
+					add(i, v);
+					for(final Run r : run) r.add(i, v);
+				}
 		}
 
 		iteration = -1;
 		completed = systolic = local = preLocal = false;
 
-		if (! external) for(final long[] a: resultBits) Arrays.fill(a, 0);
+		if (! external) for(int r = 0; r < runs; r++) for(final long[] a: resultBits(r)) Arrays.fill(a, 0);
 
 		if (sumOfDistances != null) Arrays.fill(sumOfDistances, 0);
 		if (sumOfInverseDistances != null) Arrays.fill(sumOfInverseDistances, 0);
 		for (int i = 0; i < discountFunction.length; i++) Arrays.fill(discountedCentrality[i], 0);
 
 		// The initial value (the iteration for this value does not actually happen).
-		neighbourhoodFunction.add(last = numNodes);
+		for(int r = 0; r < runs; r++) neighbourhoodFunctions[r].add(last[r] = numNodes);
 
 		Arrays.fill(modifiedCounter, true); // Initially, all counters are modified.
 
@@ -817,8 +944,13 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 					// These variables might change across executions of the loop body.
 					final long granularity = HyperBall.this.adaptiveGranularity;
 					final long arcGranularity = (long)Math.ceil((double)numArcs * granularity / numNodes);
-					final long bits[][] = HyperBall.this.bits;
-					final long resultBits[][] = HyperBall.this.resultBits;
+					final int runs = HyperBall.this.runs;
+					final long runBits[][][] = new long[runs][][];
+					final long runResultBits[][][] = new long[runs][][];
+					for(int r = runs; r-- != 0;) {
+						runBits[r] = bits(r);
+						runResultBits[r] = resultBits(r);
+					}
 					final boolean[] modifiedCounter = HyperBall.this.modifiedCounter;
 					final boolean[] modifiedResultCounter = HyperBall.this.modifiedResultCounter;
 					final boolean[] mustBeChecked = HyperBall.this.mustBeChecked;
@@ -841,7 +973,8 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 					/* During standard iterations, cumulates the neighbourhood function for the nodes scanned
 					 * by this thread. During systolic iterations, cumulates the *increase* of the
 					 * neighbourhood function for the nodes scanned by this thread. */
-					final KahanSummation neighbourhoodFunctionDelta = new KahanSummation();
+					final KahanSummation[] neighbourhoodFunctionDelta = new KahanSummation[runs];
+					for(int r = runs; r-- != 0;) neighbourhoodFunctionDelta[r] = new KahanSummation();
 
 					for(;;) {
 
@@ -889,7 +1022,9 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 
 								if (local || systolic) {
 									d = g.outdegree(node);
-									successors = g.successors(node);
+									// With several runs we decode the successors just once.
+									if (runs == 1) successors = g.successors(node);
+									else successor = g.successorArray(node);
 								}
 								else {
 									nodeIterator.nextInt();
@@ -898,94 +1033,111 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 								}
 
 								final int chunk = chunk(node);
-								getCounter(bits[chunk], node, t);
-								// Caches t's values into prevT
-								System.arraycopy(t, 0, prevT, 0, counterLongwords);
-
-								boolean counterModified = false;
-
-								for(int j = d; j-- != 0;) {
-									final int s = local || systolic ? successors.nextInt() : successor[j];
-									/* Neither self-loops nor unmodified counter do influence the computation. */
-									if (s != node && modifiedCounter[s]) {
-										counterModified = true; // This is just to mark that we entered the loop at least once.
-										getCounter(bits[chunk(s)], s, u);
-										max(t, u, accumulator, mask);
+								// Whether the counter was modified in at least one run.
+								boolean anyCounterModified = false;
+
+								for(int r = 0; r < runs; r++) {
+									final long[][] bits = runBits[r];
+									getCounter(bits[chunk], node, t);
+									// Caches t's values into prevT
+									System.arraycopy(t, 0, prevT, 0, counterLongwords);
+
+									boolean counterModified = false;
+
+									for(int j = d; j-- != 0;) {
+										final int s = successors != null ? successors.nextInt() : successor[j];
+										/* Neither self-loops nor unmodified counter do influence the computation. */
+										if (s != node && modifiedCounter[s]) {
+											counterModified = true; // This is just to mark that we entered the loop at least once.
+											getCounter(bits[chunk(s)], s, u);
+											max(t, u, accumulator, mask);
+										}
 									}
-								}
-
-								arcs += d;
 
-								if (ASSERTS)  {
-									final LongBigList test = LongArrayBitVector.wrap(t).asLongBigList(registerSize);
-									for(int rr = 0; rr < m; rr++) {
-										int max = (int)registers[chunk(node)].getLong(((long)node << log2m) + rr);
-										if (local || systolic) successors = g.successors(node);
-										for(int j = d; j-- != 0;) {
-											final int s = local || systolic ? successors.nextInt() : successor[j];
-											max = Math.max(max, (int)registers[chunk(s)].getLong(((long)s << log2m) + rr));
+									if (r == 0) arcs += d;
+
+									if (ASSERTS && r == 0)  {
+										final LongBigList test = LongArrayBitVector.wrap(t).asLongBigList(registerSize);
+										for(int rr = 0; rr < m; rr++) {
+											int max = (int)registers[chunk(node)].getLong(((long)node << log2m) + rr);
+											if (successors != null) successors = g.successors(node);
+											for(int j = d; j-- != 0;) {
+												final int s = successors != null ? successors.nextInt() : successor[j];
+												max = Math.max(max, (int)registers[chunk(s)].getLong(((long)s << log2m) + rr));
+											}
+											assert max == test.getLong(rr) : max + "!=" + test.getLong(rr) + " [" + rr + "]";
 										}
-										assert max == test.getLong(rr) : max + "!=" + test.getLong(rr) + " [" + rr + "]";
 									}
-								}
 
-								if (counterModified) {
-									/* If we enter this branch, we have maximised with at least one successor.
-									 * We must thus check explicitly whether we have modified the counter. */
-									counterModified = false;
-									for(int p = counterLongwords; p-- != 0;)
-										if (prevT[p] != t[p]) {
-											counterModified = true;
-											break;
-										}
-								}
+									if (counterModified) {
+										/* If we enter this branch, we have maximised with at least one successor.
+										 * We must thus check explicitly whether we have modified the counter. */
+										counterModified = false;
+										for(int p = counterLongwords; p-- != 0;)
+											if (prevT[p] != t[p]) {
+												counterModified = true;
+												break;
+											}
+									}
 
-								double post = Double.NaN;
-
-								/* We need the counter value only if the iteration is standard (as we're going to
-								 * compute the neighbourhood function cumulating actual values, and not deltas) or
-								 * if the counter was actually modified (as we're going to cumulate the neighbourhood
-								 * function delta, or at least some centrality). */
-								if (! systolic || counterModified) post = count(t, 0);
-								if (! systolic) neighbourhoodFunctionDelta.add(post);
-
-								if (counterModified) {
-									final long[] prevRegister = expand(prevT);
-									final long[] register = expand(t);
-									long s = 0, snz = 0;
-									int nonzero = 0;
-									for(int p = 0; p < m; p++) {
-										final long r = register[p], pr = prevRegister[p];
-										s += r;
-										if (r != pr) {
-											nonzero++;
-											snz += r;
+									double post = Double.NaN;
+
+									/* We need the counter value only if the iteration is standard (as we're going to
+									 * compute the neighbourhood function cumulating actual values, and not deltas) or
+									 * if the counter was actually modified (as we're going to cumulate the neighbourhood
+									 * function delta, or at least some centrality). */
+									if (! systolic || counterModified) post = count(t, 0);
+									if (! systolic) neighbourhoodFunctionDelta[r].add(post);
+
+									// Here counterModified is true only if the counter was *actually* modified.
+									if (counterModified && (systolic || doCentrality && r == 0)) {
+										final double pre = r == 0 ? count(node) : count(prevT, 0);
+										if (systolic) {
+											neighbourhoodFunctionDelta[r].add(-pre);
+											neighbourhoodFunctionDelta[r].add(post);
 										}
-									}
-									s = (s + m / 2) >>> log2m;
-									snz = nonzero == 0 ? 0 : (snz + nonzero / 2) / nonzero;
-								}
 
-								// Here counterModified is true only if the counter was *actually* modified.
-								if (counterModified && (systolic || doCentrality)) {
-									final double pre = count(node);
-									if (systolic) {
-										neighbourhoodFunctionDelta.add(-pre);
-										neighbourhoodFunctionDelta.add(post);
+										if (doCentrality && r == 0) {
+											final double delta = post - pre;
+											// Note that this code is executed only for distances > 0.
+											if (delta > 0) { // Force monotonicity
+												if (doSumOfDistances) sumOfDistances[node] += delta * (iteration + 1);
+												if (doSumOfInverseDistances) sumOfInverseDistances[node] += delta / (iteration + 1);
+												for (int j = numberOfDiscountFunctions; j-- != 0;) discountedCentrality[j][node] += delta * discountFunction[j].get(iteration + 1);
+											}
+										}
 									}
 
-									if (doCentrality) {
-										final double delta = post - pre;
-										// Note that this code is executed only for distances > 0.
-										if (delta > 0) { // Force monotonicity
-											if (doSumOfDistances) sumOfDistances[node] += delta * (iteration + 1);
-											if (doSumOfInverseDistances) sumOfInverseDistances[node] += delta / (iteration + 1);
-											for (int j = numberOfDiscountFunctions; j-- != 0;) discountedCentrality[j][node] += delta * discountFunction[j].get(iteration + 1);
+									if (external) {
+										// There is just one run
+										if (counterModified) {
+											byteBuffer.putLong(node);
+											for(int p = counterLongwords; p-- != 0;) byteBuffer.putLong(t[p]);
+
+											if (! byteBuffer.hasRemaining()) {
+												byteBuffer.flip();
+												long time = -System.currentTimeMillis();
+												fileChannel.write(byteBuffer);
+												time += System.currentTimeMillis();
+												totalIoMillis += time;
+												numberOfWrites++;
+												byteBuffer.clear();
+											}
 										}
+										else unwritten++;
 									}
+									else {
+										/* This is slightly subtle: if a counter is not modified, and
+										 * the present value was not a modified value in the first place,
+										 * then we can avoid updating the result altogether. */
+										if (counterModified || modifiedCounter[node]) setCounter(t, runResultBits[r][chunk], node);
+										else if (r == 0) unwritten++;
+									}
+
+									anyCounterModified |= counterModified;
 								}
 
-								if (counterModified) {
+								if (anyCounterModified) {
 									/* We keep track of modified counters in the result if we are
 									 * not in external mode (in external mode modified counters are
 									 * computed when the update list is reloaded). Note that we must
@@ -1009,31 +1161,6 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 
 									modified++;
 								}
-
-								if (external) {
-									if (counterModified) {
-										byteBuffer.putLong(node);
-										for(int p = counterLongwords; p-- != 0;) byteBuffer.putLong(t[p]);
-
-										if (! byteBuffer.hasRemaining()) {
-											byteBuffer.flip();
-											long time = -System.currentTimeMillis();
-											fileChannel.write(byteBuffer);
-											time += System.currentTimeMillis();
-											totalIoMillis += time;
-											numberOfWrites++;
-											byteBuffer.clear();
-										}
-									}
-									else unwritten++;
-								}
-								else {
-									/* This is slightly subtle: if a counter is not modified, and
-									 * the present value was not a modified value in the first place,
-									 * then we can avoid updating the result altogether. */
-									if (counterModified || modifiedCounter[node]) setCounter(t, resultBits[chunk], node);
-									else unwritten++;
-								}
 							}
 							else if (! external) {
 								/* Even if we cannot possibly have changed our value, still our copy
@@ -1041,7 +1168,7 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 								 * reflect our current value. */
 								if (modifiedCounter[node]) {
 									final int chunk = chunk(node);
-									transfer(bits[chunk], resultBits[chunk], node);
+									for(int r = runs; r-- != 0;) transfer(runBits[r][chunk], runResultBits[r][chunk], node);
 								}
 								else unwritten++;
 							}
@@ -1069,7 +1196,7 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 					HyperBall.this.unwritten.addAndGet(unwritten);
 
 					synchronized(HyperBall.this) {
-						current += neighbourhoodFunctionDelta.value();
+						for(int r = runs; r-- != 0;) current[r] += neighbourhoodFunctionDelta[r].value();
 					}
 
 					if (external) {
@@ -1088,7 +1215,7 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 							while(byteBuffer.hasRemaining()) {
 								final int node = (int)byteBuffer.getLong();
 								for(int p = counterLongwords; p-- != 0;) t[p] = byteBuffer.getLong();
-								setCounter(t, bits[chunk(node)], node);
+								setCounter(t, runBits[0][chunk(node)], node);
 								modifiedCounter[node] = true;
 							}
 						}
@@ -1131,7 +1258,7 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 
 			/* Non-systolic computations add up the value of all counter.
 			 * Systolic computations modify the last value by compensating for each modified counter. */
-			current = systolic ? last : 0;
+			for(int r = runs; r-- != 0;) current[r] = systolic ? last[r] : 0;
 
 			// If we completed the last iteration in pre-local mode, we MUST run in local mode.
 			local = preLocal;
@@ -1255,14 +1382,18 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 			}
 			else {
 				// Switch the bit vectors.
-				for(int i = 0; i < bits.length; i++) {
-					if (npl != null) npl.update(bits[i].length);
-					final LongBigList r = registers[i];
-					registers[i] = resultRegisters[i];
-					resultRegisters[i] = r;
-					final long[] b = bits[i];
-					bits[i] = resultBits[i];
-					resultBits[i] = b;
+				for(int k = 0; k < runs; k++) {
+					final long[][] bits = bits(k), resultBits = resultBits(k);
+					final LongBigList[] registers = registers(k), resultRegisters = resultRegisters(k);
+					for(int i = 0; i < bits.length; i++) {
+						if (npl != null) npl.update(bits[i].length);
+						final LongBigList r = registers[i];
+						registers[i] = resultRegisters[i];
+						resultRegisters[i] = r;
+						final long[] b = bits[i];
+						bits[i] = resultBits[i];
+						resultBits[i] = b;
+					}
 				}
 
 				// Switch modifiedCounters and modifiedResultCounters.
@@ -1278,20 +1409,26 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 				nextMustBeChecked = t;
 			}
 
-			last = current;
-			/* We enforce monotonicity. Non-monotonicity can only be caused
-			 * by approximation errors. */
-			final double lastOutput = neighbourhoodFunction.getDouble(neighbourhoodFunction.size() - 1);
-			if (current < lastOutput) current = lastOutput;
-			relativeIncrement = current / lastOutput;
-
-			if (pl != null) {
-				pl.logger().info("Pairs: " + current + " (" + current * 100.0 / squareNumNodes + "%)");
-				pl.logger().info("Absolute increment: " + (current - lastOutput));
-				pl.logger().info("Relative increment: " + relativeIncrement);
-			}
+			for(int r = runs; r-- != 0;) {
+				last[r] = current[r];
+				/* We enforce monotonicity. Non-monotonicity can only be caused
+				 * by approximation errors. */
+				final DoubleArrayList neighbourhoodFunction = neighbourhoodFunctions[r];
+				final double lastOutput = neighbourhoodFunction.getDouble(neighbourhoodFunction.size() - 1);
+				if (current[r] < lastOutput) current[r] = lastOutput;
+
+				if (r == 0) {
+					relativeIncrement = current[r] / lastOutput;
+
+					if (pl != null) {
+						pl.logger().info("Pairs: " + current[r] + " (" + current[r] * 100.0 / squareNumNodes + "%)");
+						pl.logger().info("Absolute increment: " + (current[r] - lastOutput));
+						pl.logger().info("Relative increment: " + relativeIncrement);
+					}
+				}
 
-			neighbourhoodFunction.add(current);
+				neighbourhoodFunction.add(current[r]);
+			}
 
 			if (pl != null) pl.updateAndDisplay();
 		}
@@ -1376,7 +1513,8 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 			new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "0", JSAP.NOT_REQUIRED, 'T', "threads", "The number of threads to be used. If 0, the number will be estimated automatically."),
 			new FlaggedOption("granularity", JSAP.INTSIZE_PARSER, Integer.toString(DEFAULT_GRANULARITY), JSAP.NOT_REQUIRED, 'g',  "granularity", "The number of node per task in a multicore environment."),
 			new FlaggedOption("bufferSize", JSAP.INTSIZE_PARSER, Util.formatBinarySize(DEFAULT_BUFFER_SIZE), JSAP.NOT_REQUIRED, 'b',  "buffer-size", "The size of an I/O buffer in bytes."),
-			new FlaggedOption("neighbourhoodFunction", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 'n',  "neighbourhood-function", "Store an approximation the neighbourhood function in text format."),
+			new FlaggedOption("neighbourhoodFunction", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 'n',  "neighbourhood-function", "Store an approximation the neighbourhood function in text format. If more than one run is performed, the neighbourhood function of run r will be stored in a file with the given name followed by a dash and r."),
+			new FlaggedOption("runs", JSAP.INTSIZE_PARSER, "1", JSAP.NOT_REQUIRED, 'R',  "runs", "The number of independent runs (with different seeds) sharing the same scans of the graph."),
 			new FlaggedOption("sumOfDistances", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 'd',  "sum-of-distances", "Store an approximation of the sum of distances from each node as a binary list of floats."),
 			new FlaggedOption("harmonicCentrality", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 'h',  "harmonic-centrality", "Store an approximation of the positive harmonic centrality (the sum of the reciprocals of distances from each node) as a binary list of floats."),
 			new FlaggedOption("discountedGainCentrality", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 'z',  "discounted-gain-centrality", "A positive discounted gain centrality to be approximated and stored; it is specified as O:F where O is the spec of an object of type Int2DoubleFunction and F is the name of the file where the binary list of floats will be stored. The spec can be either the name of a public field of HyperBall, or a constructor invocation of a class implementing Int2DoubleFunction.").setAllowMultipleDeclarations(true),
@@ -1459,14 +1597,17 @@ public class HyperBall extends HyperLogLogCounterArray implements SafelyCloseabl
 		final ImmutableGraph grapht = basenamet == null ? null : basenamet.equals(basename) ? graph : spec ? ObjectParser.fromSpec(basenamet, ImmutableGraph.class, GraphClassParser.PACKAGE) :
 			offline ? ImmutableGraph.loadMapped(basenamet, new ProgressLogger()) : ImmutableGraph.load(basenamet, new ProgressLogger());
 
-		final HyperBall hyperBall = new HyperBall(graph, grapht, log2m, pl, threads, bufferSize, granularity, external, sumOfDistances || closenessCentrality || linCentrality || nieminenCentrality, harmonicCentrality, discountFunction, weight, seed);
+		final int runs = jsapResult.getInt("runs");
+		final HyperBall hyperBall = new HyperBall(graph, grapht, log2m, pl, threads, bufferSize, granularity, external, sumOfDistances || closenessCentrality || linCentrality || nieminenCentrality, harmonicCentrality, discountFunction, weight, runs, seed);
 		hyperBall.run(jsapResult.getLong("upperBound"), jsapResult.getDouble("threshold"));
 		hyperBall.close();
 
 		if (neighbourhoodFunction) {
-			final PrintStream stream = new PrintStream(new FastBufferedOutputStream(new FileOutputStream(neighbourhoodFunctionFile)));
-			for(final DoubleIterator i = hyperBall.neighbourhoodFunction.iterator(); i.hasNext();) stream.println(BigDecimal.valueOf(i.nextDouble()).toPlainString());
-			stream.close();
+			for(int r = 0; r < runs; r++) {
+				final PrintStream stream = new PrintStream(new FastBufferedOutputStream(new FileOutputStream(runs == 1 ? neighbourhoodFunctionFile : neighbourhoodFunctionFile + "-" + r)));
+				for(final DoubleIterator i = hyperBall.neighbourhoodFunctions[r].iterator(); i.hasNext();) stream.println(BigDecimal.valueOf(i.nextDouble()).toPlainString());
+				stream.close();
+			}
 		}
 
 		if (sumOfDistances) BinIO.storeFloats(hyperBall.sumOfDistances, sumOfDistancesFile);
@@ -0,0 +1,481 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph.algo;
+
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.channels.FileChannel.MapMode;
+import java.util.Arrays;
+import java.util.concurrent.TimeUnit;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import com.martiansoftware.jsap.FlaggedOption;
+import com.martiansoftware.jsap.JSAP;
+import com.martiansoftware.jsap.JSAPException;
+import com.martiansoftware.jsap.JSAPResult;
+import com.martiansoftware.jsap.Parameter;
+import com.martiansoftware.jsap.SimpleJSAP;
+import com.martiansoftware.jsap.Switch;
+import com.martiansoftware.jsap.UnflaggedOption;
+
+import it.unimi.dsi.Util;
+import it.unimi.dsi.fastutil.ints.IntArrayList;
+import it.unimi.dsi.fastutil.ints.IntArrays;
+import it.unimi.dsi.fastutil.io.FastBufferedInputStream;
+import it.unimi.dsi.fastutil.io.FastBufferedOutputStream;
+import it.unimi.dsi.logging.ProgressLogger;
+import it.unimi.dsi.webgraph.ImmutableGraph;
+
+/** An index answering approximate distance and eccentricity queries using distances from and to a set of landmarks.
+ *
+ * <p>The {@link #compute(ImmutableGraph, ImmutableGraph, int, int, ProgressLogger)} method chooses as landmarks
+ * the nodes of highest degree, and performs a {@linkplain ParallelBreadthFirstVisit parallel breadth-first visit}
+ * from each landmark (and, for directed graphs, a visit of the transpose, which yields distances to the landmark).
+ * Distances are stored in a byte per node and landmark: values smaller than {@link #SATURATED} are exact, {@link #SATURATED}
+ * means a distance at least as large, and {@link #UNREACHABLE} means that there is no path. Bytes are laid
+ * out by node, so a query reads two blocks of contiguous bytes.
+ *
+ * <p>By the triangle inequality, for each landmark <var>l</var> we have
+ * <var>d</var>(<var>l</var>,<var>y</var>)&nbsp;&minus;&nbsp;<var>d</var>(<var>l</var>,<var>x</var>)&nbsp;&le;&nbsp;<var>d</var>(<var>x</var>,<var>y</var>)
+ * and <var>d</var>(<var>x</var>,<var>l</var>)&nbsp;&minus;&nbsp;<var>d</var>(<var>y</var>,<var>l</var>)&nbsp;&le;&nbsp;<var>d</var>(<var>x</var>,<var>y</var>)&nbsp;&le;&nbsp;<var>d</var>(<var>x</var>,<var>l</var>)&nbsp;+&nbsp;<var>d</var>(<var>l</var>,<var>y</var>):
+ * {@link #lowerBound(int, int)} and {@link #upperBound(int, int)} return the best such bounds, which require time linear
+ * in the number of landmarks. Similar bounds are available for {@linkplain #eccentricityLowerBound(int) eccentricities}.
+ *
+ * <p>An index can be {@linkplain #store(CharSequence) stored}, and then {@linkplain #load(CharSequence) loaded} or
+ * {@linkplain #loadMapped(CharSequence) memory-mapped}. All query methods are thread safe.
+ *
+ * <p>Note that the graph (and its transpose, if specified) must support random access.
+ */
+
+public class LandmarkIndex {
+	private static final Logger LOGGER = LoggerFactory.getLogger(LandmarkIndex.class);
+
+	/** The extension of the file containing the landmarks and their eccentricities. */
+	public static final String LANDMARKS_EXTENSION = ".landmarks";
+	/** The extension of the file containing distances from landmarks. */
+	public static final String DISTANCES_EXTENSION = ".ldist";
+	/** The extension of the file containing distances to landmarks (directed graphs only). */
+	public static final String TRANSPOSE_DISTANCES_EXTENSION = ".ltdist";
+	/** The default number of landmarks. */
+	public static final int DEFAULT_LANDMARKS = 256;
+	/** The stored distance representing distances larger than or equal to this value. */
+	public static final int SATURATED = 254;
+	/** The stored distance representing unreachable nodes. */
+	public static final int UNREACHABLE = 255;
+	/** The maximum size in bytes of a buffer of distances. */
+	private static final int CHUNK_SIZE = 1 << 30;
+
+	/** The number of nodes of the graph. */
+	public final int numNodes;
+	/** Whether the graph is symmetric (in which case distances from and to landmarks coincide). */
+	public final boolean symmetric;
+	/** The landmarks. */
+	public final int[] landmark;
+	/** The (forward) eccentricity of each landmark. */
+	public final int[] eccentricity;
+	/** The backward eccentricity of each landmark (the same array as {@link #eccentricity} if {@link #symmetric} is true). */
+	public final int[] transposeEccentricity;
+	/** The number of nodes whose distances are stored in a buffer. */
+	private final int rowsPerChunk;
+	/** Buffers containing, for each node <var>x</var> and landmark <var>l</var>, <var>d</var>(<var>l</var>,<var>x</var>). */
+	private final ByteBuffer[] distance;
+	/** Buffers containing, for each node <var>x</var> and landmark <var>l</var>, <var>d</var>(<var>x</var>,<var>l</var>). */
+	private final ByteBuffer[] transposeDistance;
+
+	protected LandmarkIndex(final int numNodes, final boolean symmetric, final int[] landmark, final int[] eccentricity, final int[] transposeEccentricity, final ByteBuffer[] distance, final ByteBuffer[] transposeDistance) {
+		this.numNodes = numNodes;
+		this.symmetric = symmetric;
+		this.landmark = landmark;
+		this.eccentricity = eccentricity;
+		this.transposeEccentricity = transposeEccentricity;
+		this.distance = distance;
+		this.transposeDistance = transposeDistance;
+		this.rowsPerChunk = rowsPerChunk(landmark.length);
+	}
+
+	private static int rowsPerChunk(final int k) {
+		return CHUNK_SIZE / Math.max(1, k);
+	}
+
+	/** Returns the number of bytes of each chunk of distances.
+	 *
+	 * @param n the number of nodes.
+	 * @param k the number of landmarks.
+	 * @return the number of bytes of each chunk of distances.
+	 */
+	private static int[] chunkSizes(final int n, final int k) {
+		final int rowsPerChunk = rowsPerChunk(k);
+		final int[] size = new int[(int)((n + (long)rowsPerChunk - 1) / rowsPerChunk)];
+		for(int c = 0; c < size.length; c++) size[c] = Math.min(rowsPerChunk, n - c * rowsPerChunk) * k;
+		return size;
+	}
+
+	/** Computes a landmark index.
+	 *
+	 * @param graph a graph.
+	 * @param transpose the transpose of {@code graph}, or {@code null} if {@code graph} is symmetric.
+	 * @param k the number of landmarks (it will be reduced to the number of nodes, if necessary).
+	 * @param threads the requested number of threads for each visit (0 for {@link Runtime#availableProcessors()}).
+	 * @param pl a progress logger, or {@code null}.
+	 * @return a landmark index for {@code graph}.
+	 */
+	public static LandmarkIndex compute(final ImmutableGraph graph, final ImmutableGraph transpose, int k, final int threads, final ProgressLogger pl) {
+		final int n = graph.numNodes();
+		k = Math.min(k, n);
+		final boolean symmetric = transpose == null;
+
+		// Landmarks are the nodes of highest degree
+		final int[] degree = new int[n];
+		for(int x = n; x-- != 0;) degree[x] = graph.outdegree(x) + (symmetric ? 0 : transpose.outdegree(x));
+		final int[] perm = Util.identity(n);
+		IntArrays.parallelQuickSort(perm, (x, y) -> degree[y] != degree[x] ? Integer.compare(degree[y], degree[x]) : Integer.compare(x, y));
+		final int[] landmark = Arrays.copyOf(perm, k);
+
+		if (pl != null) {
+			pl.itemsName = "visits";
+			pl.expectedUpdates = symmetric ? k : 2 * k;
+			pl.start("Visiting from " + k + " landmarks...");
+		}
+
+		final int[] eccentricity = new int[k];
+		final ByteBuffer[] distance = allocate(n, k);
+		final ParallelBreadthFirstVisit visit = new ParallelBreadthFirstVisit(graph, threads, false, null);
+		for(int i = 0; i < k; i++) {
+			eccentricity[i] = fill(visit, landmark[i], i, k, distance);
+			if (pl != null) pl.lightUpdate();
+		}
+
+		final int[] transposeEccentricity;
+		final ByteBuffer[] transposeDistance;
+		if (symmetric) {
+			transposeEccentricity = eccentricity;
+			transposeDistance = distance;
+		}
+		else {
+			transposeEccentricity = new int[k];
+			transposeDistance = allocate(n, k);
+			final ParallelBreadthFirstVisit transposeVisit = new ParallelBreadthFirstVisit(transpose, threads, false, null);
+			for(int i = 0; i < k; i++) {
+				transposeEccentricity[i] = fill(transposeVisit, landmark[i], i, k, transposeDistance);
+				if (pl != null) pl.lightUpdate();
+			}
+		}
+
+		if (pl != null) pl.done();
+		return new LandmarkIndex(n, symmetric, landmark, eccentricity, transposeEccentricity, distance, transposeDistance);
+	}
+
+	/** Allocates buffers of distances filled with {@link #UNREACHABLE}. */
+	private static ByteBuffer[] allocate(final int n, final int k) {
+		final int[] size = chunkSizes(n, k);
+		final ByteBuffer[] buffer = new ByteBuffer[size.length];
+		for(int c = 0; c < size.length; c++) {
+			buffer[c] = ByteBuffer.allocate(size[c]);
+			Arrays.fill(buffer[c].array(), (byte)UNREACHABLE);
+		}
+		return buffer;
+	}
+
+	/** Performs a visit from a landmark, storing distances in the given buffers.
+	 *
+	 * @param visit a parallel breadth-first visit.
+	 * @param l the landmark.
+	 * @param i the index of the landmark.
+	 * @param k the number of landmarks.
+	 * @param buffer the buffers of distances.
+	 * @return the eccentricity of {@code l}.
+	 */
+	private static int fill(final ParallelBreadthFirstVisit visit, final int l, final int i, final int k, final ByteBuffer[] buffer) {
+		visit.clear();
+		visit.visit(l);
+		final int rowsPerChunk = rowsPerChunk(k);
+		final IntArrayList queue = visit.queue, cutPoints = visit.cutPoints;
+		for(int d = 0; d < cutPoints.size() - 1; d++) {
+			final byte b = (byte)Math.min(d, SATURATED);
+			for(int pos = cutPoints.getInt(d); pos < cutPoints.getInt(d + 1); pos++) {
+				final int x = queue.getInt(pos);
+				buffer[x / rowsPerChunk].put((x % rowsPerChunk) * k + i, b);
+			}
+		}
+		return visit.maxDistance();
+	}
+
+	/** Returns the number of landmarks.
+	 *
+	 * @return the number of landmarks.
+	 */
+	public int numLandmarks() {
+		return landmark.length;
+	}
+
+	/** Returns the stored distance from the {@code i}-th landmark to a node.
+	 *
+	 * @param i the index of a landmark.
+	 * @param x a node.
+	 * @return the stored distance from the {@code i}-th landmark to {@code x} (see {@link #SATURATED} and {@link #UNREACHABLE}).
+	 */
+	public int distanceFrom(final int i, final int x) {
+		return distance[x / rowsPerChunk].get((x % rowsPerChunk) * landmark.length + i) & 0xFF;
+	}
+
+	/** Returns the stored distance from a node to the {@code i}-th landmark.
+	 *
+	 * @param i the index of a landmark.
+	 * @param x a node.
+	 * @return the stored distance from {@code x} to the {@code i}-th landmark (see {@link #SATURATED} and {@link #UNREACHABLE}).
+	 */
+	public int distanceTo(final int i, final int x) {
+		return transposeDistance[x / rowsPerChunk].get((x % rowsPerChunk) * landmark.length + i) & 0xFF;
+	}
+
+	/** Returns a lower bound on the distance between two nodes.
+	 *
+	 * @param x a node.
+	 * @param y a node.
+	 * @return a lower bound on the distance from {@code x} to {@code y}, or {@link Integer#MAX_VALUE}
+	 * if the landmarks prove that {@code y} is not reachable from {@code x}.
+	 */
+	public int lowerBound(final int x, final int y) {
+		if (x == y) return 0;
+		final int k = landmark.length;
+		final ByteBuffer fromX = distance[x / rowsPerChunk], fromY = distance[y / rowsPerChunk];
+		final ByteBuffer toX = transposeDistance[x / rowsPerChunk], toY = transposeDistance[y / rowsPerChunk];
+		final int offsetX = (x % rowsPerChunk) * k, offsetY = (y % rowsPerChunk) * k;
+		int lower = 1;
+		for(int i = 0; i < k; i++) {
+			// d(l, y) <= d(l, x) + d(x, y)
+			final int lx = fromX.get(offsetX + i) & 0xFF;
+			if (lx < SATURATED) {
+				final int ly = fromY.get(offsetY + i) & 0xFF;
+				if (ly == UNREACHABLE) return Integer.MAX_VALUE;
+				lower = Math.max(lower, ly - lx);
+			}
+			// d(x, l) <= d(x, y) + d(y, l)
+			final int yl = toY.get(offsetY + i) & 0xFF;
+			if (yl < SATURATED) {
+				final int xl = toX.get(offsetX + i) & 0xFF;
+				if (xl == UNREACHABLE) return Integer.MAX_VALUE;
+				lower = Math.max(lower, xl - yl);
+			}
+		}
+		return lower;
+	}
+
+	/** Returns an upper bound on the distance between two nodes.
+	 *
+	 * @param x a node.
+	 * @param y a node.
+	 * @return an upper bound on the distance from {@code x} to {@code y}, or {@link Integer#MAX_VALUE}
+	 * if no landmark provides a bound.
+	 */
+	public int upperBound(final int x, final int y) {
+		if (x == y) return 0;
+		final int k = landmark.length;
+		final ByteBuffer toX = transposeDistance[x / rowsPerChunk], fromY = distance[y / rowsPerChunk];
+		final int offsetX = (x % rowsPerChunk) * k, offsetY = (y % rowsPerChunk) * k;
+		int upper = Integer.MAX_VALUE;
+		for(int i = 0; i < k; i++) {
+			// d(x, y) <= d(x, l) + d(l, y)
+			final int xl = toX.get(offsetX + i) & 0xFF;
+			if (xl >= SATURATED) continue;
+			final int ly = fromY.get(offsetY + i) & 0xFF;
+			if (ly < SATURATED) upper = Math.min(upper, xl + ly);
+		}
+		return upper;
+	}
+
+	/** Returns a lower bound on the (forward) eccentricity of a node, that is, on the maximum distance
+	 * of a node reachable from the given one.
+	 *
+	 * @param x a node.
+	 * @return a lower bound on the eccentricity of {@code x}.
+	 */
+	public int eccentricityLowerBound(final int x) {
+		final int k = landmark.length;
+		final ByteBuffer fromX = distance[x / rowsPerChunk], toX = transposeDistance[x / rowsPerChunk];
+		final int offset = (x % rowsPerChunk) * k;
+		int lower = 0;
+		for(int i = 0; i < k; i++) {
+			final int xl = toX.get(offset + i) & 0xFF;
+			if (xl != UNREACHABLE) lower = Math.max(lower, xl);
+			if (symmetric) {
+				// In the symmetric case, ecc(l) <= d(l, x) + ecc(x)
+				final int lx = fromX.get(offset + i) & 0xFF;
+				if (lx < SATURATED) lower = Math.max(lower, eccentricity[i] - lx);
+			}
+		}
+		return lower;
+	}
+
+	/** Returns an upper bound on the eccentricity of a node of a symmetric graph.
+	 *
+	 * <p>For directed graphs, the nodes reachable from a landmark might not include
+	 * the nodes reachable from a node reaching the landmark, so no bound is available.
+	 *
+	 * @param x a node.
+	 * @return an upper bound on the eccentricity of {@code x}, or {@link Integer#MAX_VALUE}
+	 * if no landmark provides a bound or the graph is not symmetric.
+	 */
+	public int eccentricityUpperBound(final int x) {
+		if (! symmetric) return Integer.MAX_VALUE;
+		final int k = landmark.length;
+		final ByteBuffer fromX = distance[x / rowsPerChunk];
+		final int offset = (x % rowsPerChunk) * k;
+		int upper = Integer.MAX_VALUE;
+		for(int i = 0; i < k; i++) {
+			// ecc(x) <= d(x, l) + ecc(l)
+			final int xl = fromX.get(offset + i) & 0xFF;
+			if (xl < SATURATED) upper = Math.min(upper, xl + eccentricity[i]);
+		}
+		return upper;
+	}
+
+	/** Returns a lower bound on the diameter, that is, the maximum eccentricity of a landmark.
+	 *
+	 * @return a lower bound on the diameter.
+	 */
+	public int diameterLowerBound() {
+		int lower = 0;
+		for(int i = landmark.length; i-- != 0;) lower = Math.max(lower, Math.max(eccentricity[i], transposeEccentricity[i]));
+		return lower;
+	}
+
+	/** Stores this index.
+	 *
+	 * @param basename the basename of the index; {@link #LANDMARKS_EXTENSION}, {@link #DISTANCES_EXTENSION}, and,
+	 * for directed graphs, {@link #TRANSPOSE_DISTANCES_EXTENSION} will be appended to it.
+	 */
+	public void store(final CharSequence basename) throws IOException {
+		final DataOutputStream dos = new DataOutputStream(new FastBufferedOutputStream(new FileOutputStream(basename + LANDMARKS_EXTENSION)));
+		dos.writeInt(numNodes);
+		dos.writeInt(landmark.length);
+		dos.writeBoolean(symmetric);
+		for(final int l : landmark) dos.writeInt(l);
+		for(final int e : eccentricity) dos.writeInt(e);
+		if (! symmetric) for(final int e : transposeEccentricity) dos.writeInt(e);
+		dos.close();
+
+		store(distance, basename + DISTANCES_EXTENSION);
+		if (! symmetric) store(transposeDistance, basename + TRANSPOSE_DISTANCES_EXTENSION);
+	}
+
+	private static void store(final ByteBuffer[] buffer, final String filename) throws IOException {
+		final FileOutputStream fos = new FileOutputStream(filename);
+		final FileChannel channel = fos.getChannel();
+		for(final ByteBuffer b : buffer) {
+			final ByteBuffer duplicate = b.duplicate();
+			duplicate.clear();
+			while(duplicate.hasRemaining()) channel.write(duplicate);
+		}
+		fos.close();
+	}
+
+	/** Loads an index in main memory.
+	 *
+	 * @param basename the basename of the index.
+	 * @return the index.
+	 */
+	public static LandmarkIndex load(final CharSequence basename) throws IOException {
+		return load(basename, false);
+	}
+
+	/** Loads an index, memory-mapping the distances.
+	 *
+	 * @param basename the basename of the index.
+	 * @return the index.
+	 */
+	public static LandmarkIndex loadMapped(final CharSequence basename) throws IOException {
+		return load(basename, true);
+	}
+
+	private static LandmarkIndex load(final CharSequence basename, final boolean mapped) throws IOException {
+		final DataInputStream dis = new DataInputStream(new FastBufferedInputStream(new FileInputStream(basename + LANDMARKS_EXTENSION)));
+		final int n = dis.readInt();
+		final int k = dis.readInt();
+		final boolean symmetric = dis.readBoolean();
+		final int[] landmark = new int[k];
+		for(int i = 0; i < k; i++) landmark[i] = dis.readInt();
+		final int[] eccentricity = new int[k];
+		for(int i = 0; i < k; i++) eccentricity[i] = dis.readInt();
+		final int[] transposeEccentricity;
+		if (symmetric) transposeEccentricity = eccentricity;
+		else {
+			transposeEccentricity = new int[k];
+			for(int i = 0; i < k; i++) transposeEccentricity[i] = dis.readInt();
+		}
+		dis.close();
+
+		final ByteBuffer[] distance = load(basename + DISTANCES_EXTENSION, n, k, mapped);
+		final ByteBuffer[] transposeDistance = symmetric ? distance : load(basename + TRANSPOSE_DISTANCES_EXTENSION, n, k, mapped);
+		return new LandmarkIndex(n, symmetric, landmark, eccentricity, transposeEccentricity, distance, transposeDistance);
+	}
+
+	private static ByteBuffer[] load(final String filename, final int n, final int k, final boolean mapped) throws IOException {
+		final int[] size = chunkSizes(n, k);
+		final ByteBuffer[] buffer = new ByteBuffer[size.length];
+		final FileInputStream fis = new FileInputStream(filename);
+		final FileChannel channel = fis.getChannel();
+		long position = 0;
+		for(int c = 0; c < size.length; c++) {
+			if (mapped) buffer[c] = channel.map(MapMode.READ_ONLY, position, size[c]);
+			else {
+				buffer[c] = ByteBuffer.allocate(size[c]);
+				while(buffer[c].hasRemaining()) if (channel.read(buffer[c]) == -1) throw new IOException("Unexpected end of file in " + filename);
+			}
+			position += size[c];
+		}
+		fis.close();
+		return buffer;
+	}
+
+	public static void main(final String arg[]) throws IOException, JSAPException {
+		final SimpleJSAP jsap = new SimpleJSAP(LandmarkIndex.class.getName(),
+				"Computes a landmark index answering approximate distance and eccentricity queries, and stores it using the given basename. If a transpose is not specified, the graph is assumed to be symmetric.",
+				new Parameter[] {
+					new FlaggedOption("logInterval", JSAP.LONG_PARSER, Long.toString(ProgressLogger.DEFAULT_LOG_INTERVAL), JSAP.NOT_REQUIRED, 'l', "log-interval", "The minimum time interval between activity logs in milliseconds."),
+					new FlaggedOption("landmarks", JSAP.INTSIZE_PARSER, Integer.toString(DEFAULT_LANDMARKS), JSAP.NOT_REQUIRED, 'k', "landmarks", "The number of landmarks."),
+					new FlaggedOption("transpose", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 't', "transpose", "The basename of the transpose of the graph (if missing, the graph is assumed to be symmetric)."),
+					new Switch("mapped", 'm', "mapped", "Do not load the graph in main memory, but rather memory-map it."),
+					new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "0", JSAP.NOT_REQUIRED, 'T', "threads", "The number of threads to be used. If 0, the number will be estimated automatically."),
+					new UnflaggedOption("basename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The basename of the graph."),
+					new UnflaggedOption("indexBasename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The basename of the index."),
+				}
+		);
+
+		final JSAPResult jsapResult = jsap.parse(arg);
+		if (jsap.messagePrinted()) System.exit(1);
+
+		final boolean mapped = jsapResult.userSpecified("mapped");
+		final String basename = jsapResult.getString("basename");
+		final String transposeBasename = jsapResult.getString("transpose");
+		final ProgressLogger pl = new ProgressLogger(LOGGER, jsapResult.getLong("logInterval"), TimeUnit.MILLISECONDS);
+		final ImmutableGraph graph = mapped ? ImmutableGraph.loadMapped(basename, pl) : ImmutableGraph.load(basename, pl);
+		final ImmutableGraph transpose = transposeBasename == null ? null : mapped ? ImmutableGraph.loadMapped(transposeBasename, pl) : ImmutableGraph.load(transposeBasename, pl);
+
+		final LandmarkIndex landmarkIndex = LandmarkIndex.compute(graph, transpose, jsapResult.getInt("landmarks"), jsapResult.getInt("threads"), pl);
+		LOGGER.info("Diameter lower bound: " + landmarkIndex.diameterLowerBound());
+		landmarkIndex.store(jsapResult.getString("indexBasename"));
+	}
+}
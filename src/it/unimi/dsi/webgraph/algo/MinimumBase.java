@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph.algo;
+
+import java.io.IOException;
+import java.util.concurrent.ExecutorCompletionService;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.TimeUnit;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import com.google.common.base.Throwables;
+import com.google.common.util.concurrent.ThreadFactoryBuilder;
+import com.martiansoftware.jsap.FlaggedOption;
+import com.martiansoftware.jsap.JSAP;
+import com.martiansoftware.jsap.JSAPException;
+import com.martiansoftware.jsap.JSAPResult;
+import com.martiansoftware.jsap.Parameter;
+import com.martiansoftware.jsap.SimpleJSAP;
+import com.martiansoftware.jsap.Switch;
+import com.martiansoftware.jsap.UnflaggedOption;
+
+import it.unimi.dsi.fastutil.HashCommon;
+import it.unimi.dsi.fastutil.io.BinIO;
+import it.unimi.dsi.fastutil.longs.Long2IntOpenHashMap;
+import it.unimi.dsi.logging.ProgressLogger;
+import it.unimi.dsi.webgraph.ImmutableGraph;
+import it.unimi.dsi.webgraph.NodeIterator;
+
+/** Computes the minimum base of a graph, that is, its coarsest in-equitable partition.
+ *
+ * <p>A partition of the nodes of a graph is <em>in-equitable</em> if any two nodes in the same class have,
+ * for each class, the same number of in-neighbours in that class. The classes of the coarsest such partition
+ * are the fibres of the minimal fibration of the graph, and the quotient by the partition is its <em>minimum base</em>
+ * (see Paolo Boldi and Sebastiano Vigna, &ldquo;Fibrations of graphs&rdquo;, <i>Discrete Math.</i>, 243:21&minus;66, 2002).
+ *
+ * <p>The {@link #compute(ImmutableGraph, int, ProgressLogger)} method of this class starts from the trivial partition and refines it
+ * by rounds: at each round, the <em>signature</em> of a node is a hash of its class and of the multiset of the classes of its in-neighbours;
+ * nodes with the same signature end up in the same class of the next round. The process stops when the number of classes does not change.
+ * Signatures are computed in parallel by scanning the <em>transpose</em> of the graph, which must be passed to {@link #compute(ImmutableGraph, int, ProgressLogger)}:
+ * threads pick up segments containing approximately the same number of arcs, and enumerate successors using a {@linkplain ImmutableGraph#nodeIterator(int) node iterator}
+ * starting at the beginning of the segment, so the transpose needs not support random access, but {@link ImmutableGraph#nodeIterator(int)} should be efficient.
+ *
+ * <p>Signatures are 64-bit hashes, so there is a very small probability that two nodes are wrongly put in the same class.
+ *
+ * <p>Classes are numbered in order of appearance (i.e., the class of a node is either the class of a smaller node, or the number of classes of smaller nodes),
+ * so the result does not depend on the number of threads. The main method stores
+ * the class of each node as a list of binary integers, which is the format expected by {@code scratch.FibrationAnalysis}.
+ */
+
+public class MinimumBase {
+	private static final Logger LOGGER = LoggerFactory.getLogger(MinimumBase.class);
+
+	/** The number of arcs scanned by a thread before looking for more work. */
+	private static final long ARC_GRANULARITY = 1 << 20;
+
+	/** The number of classes (i.e., the number of nodes of the minimum base). */
+	public final int numberOfClasses;
+	/** The class of each node. */
+	public final int[] label;
+	/** The number of refinement rounds. */
+	public final int rounds;
+
+	protected MinimumBase(final int numberOfClasses, final int[] label, final int rounds) {
+		this.numberOfClasses = numberOfClasses;
+		this.label = label;
+		this.rounds = rounds;
+	}
+
+	/** Computes the minimum base of a graph.
+	 *
+	 * @param transpose the transpose of a graph.
+	 * @param threads the requested number of threads (0 for {@link Runtime#availableProcessors()}).
+	 * @param pl a progress logger, or {@code null}.
+	 * @return an instance of this class containing the classes of the coarsest in-equitable partition of the graph.
+	 */
+	public static MinimumBase compute(final ImmutableGraph transpose, int threads, final ProgressLogger pl) {
+		if (threads == 0) threads = Runtime.getRuntime().availableProcessors();
+		final int n = transpose.numNodes();
+		if (n == 0) return new MinimumBase(0, new int[0], 0);
+		final long m = transpose.numArcs();
+		final EliasFanoCumulativeOutdegreeList cumulativeOutdegrees = new EliasFanoCumulativeOutdegreeList(transpose, m);
+
+		int[] label = new int[n];
+		int[] newLabel = new int[n];
+		final long[] signature = new long[n];
+		int numberOfClasses = 1;
+		int rounds = 0;
+
+		final ExecutorService executorService = Executors.newFixedThreadPool(threads, new ThreadFactoryBuilder().setNameFormat("ProcessingThread-%d").build());
+		final ExecutorCompletionService<Void> executorCompletionService = new ExecutorCompletionService<>(executorService);
+		final long[] next = new long[2]; // The next node and the number of arcs preceding it
+
+		if (pl != null) {
+			pl.itemsName = "nodes";
+			pl.expectedUpdates = -1;
+			pl.start("Refining partitions...");
+		}
+
+		for(;;) {
+			rounds++;
+			next[0] = next[1] = 0;
+			final int[] currentLabel = label;
+			for(int t = threads; t-- != 0;) executorCompletionService.submit(() -> {
+				final ImmutableGraph g = transpose.copy();
+				for(;;) {
+					final int start, end;
+					synchronized(next) {
+						if (next[0] == n) break;
+						start = (int)next[0];
+						final long target = next[1] + ARC_GRANULARITY;
+						if (target >= m) next[0] = n;
+						else {
+							next[1] = cumulativeOutdegrees.skipTo(target);
+							next[0] = cumulativeOutdegrees.currentIndex();
+						}
+						end = (int)next[0];
+					}
+
+					final NodeIterator nodeIterator = g.nodeIterator(start);
+					for(int i = start; i < end; i++) {
+						final int x = nodeIterator.nextInt();
+						final int[] s = nodeIterator.successorArray();
+						long h = 0;
+						// A commutative combination of hashes is a hash of the multiset of classes of in-neighbours
+						for(int j = nodeIterator.outdegree(); j-- != 0;) h += HashCommon.murmurHash3(currentLabel[s[j]] + 0x9E3779B97F4A7C15L);
+						signature[x] = HashCommon.murmurHash3(h ^ HashCommon.murmurHash3(~(long)currentLabel[x]));
+					}
+					if (pl != null) synchronized(pl) {
+						pl.update(end - start);
+					}
+				}
+				return null;
+			});
+
+			Throwable problem = null;
+			for(int t = threads; t-- != 0;)
+				try {
+					executorCompletionService.take().get();
+				}
+				catch(final Exception e) {
+					problem = e.getCause(); // We keep only the last one. They will be logged anyway.
+				}
+
+			if (problem != null) {
+				executorService.shutdown();
+				Throwables.throwIfUnchecked(problem);
+				throw new RuntimeException(problem);
+			}
+
+			// Number new classes in order of appearance
+			final Long2IntOpenHashMap classes = new Long2IntOpenHashMap(numberOfClasses);
+			classes.defaultReturnValue(-1);
+			for(int x = 0; x < n; x++) {
+				final int c = classes.putIfAbsent(signature[x], classes.size());
+				newLabel[x] = c == -1 ? classes.size() - 1 : c;
+			}
+
+			final int newNumberOfClasses = classes.size();
+			LOGGER.info("Round " + rounds + ": " + newNumberOfClasses + " classes");
+			final int[] t = label;
+			label = newLabel;
+			newLabel = t;
+			// Refinements never merge classes, so the partition is stable if the number of classes did not change
+			if (newNumberOfClasses == numberOfClasses) break;
+			numberOfClasses = newNumberOfClasses;
+		}
+
+		executorService.shutdown();
+		if (pl != null) pl.done();
+		return new MinimumBase(numberOfClasses, label, rounds);
+	}
+
+	public static void main(final String arg[]) throws IOException, JSAPException {
+		final SimpleJSAP jsap = new SimpleJSAP(MinimumBase.class.getName(),
+				"Computes the minimum base (i.e., the coarsest in-equitable partition) of a graph, given its transpose, and stores the class of each node as a list of binary integers.",
+				new Parameter[] {
+					new FlaggedOption("logInterval", JSAP.LONG_PARSER, Long.toString(ProgressLogger.DEFAULT_LOG_INTERVAL), JSAP.NOT_REQUIRED, 'l', "log-interval", "The minimum time interval between activity logs in milliseconds."),
+					new Switch("mapped", 'm', "mapped", "Do not load the graph in main memory, but rather memory-map it."),
+					new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "0", JSAP.NOT_REQUIRED, 'T', "threads", "The number of threads to be used. If 0, the number will be estimated automatically."),
+					new UnflaggedOption("transpose", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The basename of the transpose of the graph."),
+					new UnflaggedOption("labelFile", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The file where the class of each node will be stored (int in binary form)."),
+				}
+		);
+
+		final JSAPResult jsapResult = jsap.parse(arg);
+		if (jsap.messagePrinted()) System.exit(1);
+
+		final String transposeBasename = jsapResult.getString("transpose");
+		final ProgressLogger pl = new ProgressLogger(LOGGER, jsapResult.getLong("logInterval"), TimeUnit.MILLISECONDS);
+		final ImmutableGraph transpose = jsapResult.userSpecified("mapped") ? ImmutableGraph.loadMapped(transposeBasename) : ImmutableGraph.load(transposeBasename, pl);
+
+		final MinimumBase minimumBase = MinimumBase.compute(transpose, jsapResult.getInt("threads"), pl);
+		LOGGER.info("Nodes: " + transpose.numNodes() + "; fibres: " + minimumBase.numberOfClasses + "; rounds: " + minimumBase.rounds);
+		BinIO.storeInts(minimumBase.label, jsapResult.getString("labelFile"));
+	}
+}
@@ -0,0 +1,508 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph.algo;
+
+import java.io.IOException;
+import java.util.Arrays;
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutorCompletionService;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicIntegerArray;
+import java.util.concurrent.atomic.AtomicLong;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import com.google.common.base.Throwables;
+import com.google.common.util.concurrent.ThreadFactoryBuilder;
+import com.martiansoftware.jsap.FlaggedOption;
+import com.martiansoftware.jsap.JSAP;
+import com.martiansoftware.jsap.JSAPException;
+import com.martiansoftware.jsap.JSAPResult;
+import com.martiansoftware.jsap.Parameter;
+import com.martiansoftware.jsap.SimpleJSAP;
+import com.martiansoftware.jsap.Switch;
+import com.martiansoftware.jsap.UnflaggedOption;
+
+import it.unimi.dsi.fastutil.HashCommon;
+import it.unimi.dsi.fastutil.ints.IntArrays;
+import it.unimi.dsi.fastutil.io.BinIO;
+import it.unimi.dsi.logging.ProgressLogger;
+import it.unimi.dsi.webgraph.ImmutableGraph;
+import it.unimi.dsi.webgraph.LazyIntIterator;
+
+/** Computes the size of the set of nodes reachable from each node of a graph, exactly or approximately.
+ *
+ * <p>The {@link #compute(ImmutableGraph, int, int, int, ProgressLogger)} method of this class
+ * computes the {@linkplain StronglyConnectedComponents strongly connected components} of a graph, so that
+ * all nodes of a component share the same reachable set, and then visits the component DAG starting from
+ * the terminal components: the reachable set of a component is the union of the reachable sets
+ * of its successors plus the component itself. Since components are numbered by Tarjan's algorithm
+ * in reverse topological order, all successors of a component have a smaller index. Each component is assigned a <em>level</em>,
+ * that is, the length of the longest path to a terminal component; components of the same level
+ * do not depend on each other, so levels are processed one after the other, each in parallel.
+ *
+ * <p>Reachable sets are represented as sorted arrays of components: the size of a set is the
+ * sum of the sizes of its components, so a set costs space proportional to the number of components, rather than
+ * of nodes, it contains. The set of a component is discarded as soon as all components having it as a successor have been processed.
+ * When the set of a component would contain more than a given number of components, its reachable set is approximated
+ * by a HyperLogLog counter, which is computed by maximizing the registers of the counters of its successors
+ * and adding the nodes of successors with exact sets. The results for such components, which
+ * are marked in {@link #exact}, have the relative standard deviation returned by
+ * {@link it.unimi.dsi.util.HyperLogLogCounterArray#relativeStandardDeviation(int)}.
+ *
+ * <p>Besides the per-set limit, there is a global limit on the overall number of components contained in the exact sets
+ * that are kept in memory at the same time: when storing a new exact set would exceed the limit, the set is approximated, too,
+ * so memory usage is bounded even when many mid-sized sets are alive. Note that when this happens the choice of the approximated
+ * sets depends on the scheduling of threads, so results (but not their precision guarantees) may vary between runs.
+ *
+ * <p>Note that the graph must support random access.
+ */
+
+public class Reachability {
+	private static final Logger LOGGER = LoggerFactory.getLogger(Reachability.class);
+
+	/** The default maximum number of components of a reachable set represented exactly. */
+	public static final int DEFAULT_MAX_EXACT_SIZE = 1 << 20;
+	/** The default maximum overall number of components of the reachable sets represented exactly kept in memory at the same time. */
+	public static final long DEFAULT_MAX_EXACT_TOTAL_SIZE = 1L << 28;
+	/** The default logarithm of the number of registers of approximated reachable sets. */
+	public static final int DEFAULT_LOG2M = 10;
+	/** Levels with fewer components are processed by the calling thread. */
+	private static final int PARALLEL_THRESHOLD = 1 << 10;
+
+	/** The strongly connected component of each node. */
+	public final int[] component;
+	/** The size of the reachable set of each strongly connected component (which includes the component itself). */
+	public final double[] reachable;
+	/** Whether the size of the reachable set of each strongly connected component is exact. */
+	public final boolean[] exact;
+
+	protected Reachability(final int[] component, final double[] reachable, final boolean[] exact) {
+		this.component = component;
+		this.reachable = reachable;
+		this.exact = exact;
+	}
+
+	/** Returns the size of the set of nodes reachable from a given node (including the node itself).
+	 *
+	 * @param x a node.
+	 * @return the (possibly approximated) number of nodes reachable from {@code x}.
+	 */
+	public double reachable(final int x) {
+		return reachable[component[x]];
+	}
+
+	/** HyperLogLog counters stored in byte arrays. */
+	private final static class Counters {
+		/** The logarithm of the number of registers. */
+		private final int log2m;
+		/** The number of registers. */
+		private final int m;
+		/** The correcting constant of the estimator, multiplied by the square of {@link #m}. */
+		private final double alphaMM;
+
+		private Counters(final int log2m) {
+			this.log2m = log2m;
+			this.m = 1 << log2m;
+			final double alpha = m == 16 ? .673 : m == 32 ? .697 : m == 64 ? .709 : .7213 / (1 + 1.079 / m);
+			alphaMM = alpha * m * m;
+		}
+
+		/** Adds a node to a counter.
+		 *
+		 * @param counter a counter.
+		 * @param x a node.
+		 */
+		private void add(final byte[] counter, final int x) {
+			final long h = HashCommon.murmurHash3(x + 0x9E3779B97F4A7C15L);
+			final int r = Math.min(Long.numberOfTrailingZeros(h >>> log2m), Long.SIZE - log2m) + 1;
+			final int i = (int)(h & m - 1);
+			if (counter[i] < r) counter[i] = (byte)r;
+		}
+
+		/** Maximizes a counter with another one.
+		 *
+		 * @param counter a counter.
+		 * @param other another counter.
+		 */
+		private void max(final byte[] counter, final byte[] other) {
+			for(int i = m; i-- != 0;) if (counter[i] < other[i]) counter[i] = other[i];
+		}
+
+		/** Estimates the cardinality of a counter.
+		 *
+		 * @param counter a counter.
+		 * @return the estimated cardinality of {@code counter}.
+		 */
+		private double count(final byte[] counter) {
+			double s = 0;
+			int zeroes = 0;
+			for(int i = m; i-- != 0;) {
+				if (counter[i] == 0) zeroes++;
+				s += 1. / (1L << counter[i]);
+			}
+			final double e = alphaMM / s;
+			if (zeroes != 0 && e < 2.5 * m) return m * Math.log((double)m / zeroes);
+			return e;
+		}
+	}
+
+	/** A thread processing the components of a level. */
+	private final static class Worker implements Callable<Void> {
+		private final ImmutableGraph graph;
+		private final int[] component, start, node, byLevel;
+		private final double[] reachable;
+		private final boolean[] exact;
+		private final Object[] set;
+		private final byte[][] sketch;
+		private final AtomicIntegerArray pending;
+		/** The overall number of components of the exact sets in {@link #set}. */
+		private final AtomicLong exactTotalSize;
+		private final Counters counters;
+		private final int maxExactSize;
+		private final long maxExactTotalSize;
+		private final ProgressLogger pl;
+		/** The next index of {@link #byLevel} to process. */
+		private AtomicInteger next;
+		/** The index of {@link #byLevel} after the last component of the current level. */
+		private int end;
+		/** A buffer for successor components. */
+		private int[] succ = IntArrays.EMPTY_ARRAY;
+		/** A buffer for unions of reachable sets. */
+		private int[] union = IntArrays.EMPTY_ARRAY;
+
+		private Worker(final ImmutableGraph graph, final int[] component, final int[] start, final int[] node, final int[] byLevel, final double[] reachable, final boolean[] exact, final Object[] set, final byte[][] sketch, final AtomicIntegerArray pending, final AtomicLong exactTotalSize, final Counters counters, final int maxExactSize, final long maxExactTotalSize, final ProgressLogger pl) {
+			this.graph = graph;
+			this.component = component;
+			this.start = start;
+			this.node = node;
+			this.byLevel = byLevel;
+			this.reachable = reachable;
+			this.exact = exact;
+			this.set = set;
+			this.sketch = sketch;
+			this.pending = pending;
+			this.exactTotalSize = exactTotalSize;
+			this.counters = counters;
+			this.maxExactSize = maxExactSize;
+			this.maxExactTotalSize = maxExactTotalSize;
+			this.pl = pl;
+		}
+
+		/** Prepares this worker for processing a range of {@link #byLevel}.
+		 *
+		 * @param next the shared index of the next component to process.
+		 * @param end the index after the last component to process.
+		 */
+		private void level(final AtomicInteger next, final int end) {
+			this.next = next;
+			this.end = end;
+		}
+
+		/** Adds the nodes of a component to a counter.
+		 *
+		 * @param counter a counter.
+		 * @param c a component.
+		 */
+		private void add(final byte[] counter, final int c) {
+			if (sketch[c] != null) counters.max(counter, sketch[c]);
+			else for(int i = start[c]; i < start[c + 1]; i++) counters.add(counter, node[i]);
+		}
+
+		/** Computes the reachable set of a component.
+		 *
+		 * @param c a component.
+		 */
+		private void process(final int c) {
+			// Compute the distinct successor components
+			int d = 0;
+			for(int i = start[c]; i < start[c + 1]; i++) {
+				final LazyIntIterator successors = graph.successors(node[i]);
+				for(int s; (s = successors.nextInt()) != -1;) {
+					final int t = component[s];
+					if (t != c) {
+						succ = IntArrays.grow(succ, d + 1);
+						succ[d++] = t;
+					}
+				}
+			}
+			if (d > 1) {
+				IntArrays.quickSort(succ, 0, d);
+				int k = 1;
+				for(int i = 1; i < d; i++) if (succ[i] != succ[k - 1]) succ[k++] = succ[i];
+				d = k;
+			}
+
+			// Try first an exact union
+			long length = 1;
+			for(int i = 0; i < d; i++) {
+				final Object s = set[succ[i]];
+				if (s instanceof int[]) length += ((int[])s).length;
+				else {
+					length = Long.MAX_VALUE;
+					break;
+				}
+			}
+
+			Object result = null;
+			if (length <= Math.min(2L * maxExactSize, Integer.MAX_VALUE - 8)) {
+				union = IntArrays.grow(union, (int)length);
+				int l = 0;
+				for(int i = 0; i < d; i++) {
+					final int[] s = (int[])set[succ[i]];
+					System.arraycopy(s, 0, union, l, s.length);
+					l += s.length;
+				}
+				union[l++] = c;
+				if (d > 1) {
+					IntArrays.radixSort(union, 0, l);
+					int k = 1;
+					for(int i = 1; i < l; i++) if (union[i] != union[k - 1]) union[k++] = union[i];
+					l = k;
+				}
+				// Components with no predecessors do not store their set, so they do not count towards the global limit
+				final boolean stored = pending.get(c) != 0;
+				if (l <= maxExactSize && (! stored || exactTotalSize.addAndGet(l) <= maxExactTotalSize)) {
+					final int[] a = IntArrays.copy(union, 0, l);
+					long size = 0;
+					for(final int t : a) size += start[t + 1] - start[t];
+					reachable[c] = size;
+					exact[c] = true;
+					result = a;
+				}
+				else if (l <= maxExactSize) exactTotalSize.addAndGet(-l); // We give back the space we reserved
+			}
+
+			if (result == null) {
+				final byte[] counter = new byte[counters.m];
+				for(int i = 0; i < d; i++) {
+					final Object s = set[succ[i]];
+					if (s instanceof byte[]) counters.max(counter, (byte[])s);
+					else for(final int t : (int[])s) add(counter, t);
+				}
+				add(counter, c);
+				reachable[c] = counters.count(counter);
+				result = counter;
+			}
+
+			// Components with no predecessors do not need to store their set
+			if (pending.get(c) != 0) set[c] = result;
+			for(int i = 0; i < d; i++) if (pending.decrementAndGet(succ[i]) == 0) {
+				if (set[succ[i]] instanceof int[]) exactTotalSize.addAndGet(-((int[])set[succ[i]]).length);
+				set[succ[i]] = null;
+			}
+		}
+
+		@Override
+		public Void call() {
+			final int granularity = 64;
+			int updates = 0;
+			for(int from; (from = next.getAndAdd(granularity)) < end;) {
+				final int to = Math.min(end, from + granularity);
+				for(int i = from; i < to; i++) process(byLevel[i]);
+				if (pl != null && (updates += to - from) >= 0xFFFF) {
+					synchronized(pl) {
+						pl.update(updates);
+					}
+					updates = 0;
+				}
+			}
+			if (pl != null && updates != 0) synchronized(pl) {
+				pl.update(updates);
+			}
+			return null;
+		}
+	}
+
+	/** Computes the size of the reachable set of each node of a graph, using the {@linkplain #DEFAULT_MAX_EXACT_TOTAL_SIZE default global limit}
+	 * on exact sets.
+	 *
+	 * @param graph a graph supporting random access.
+	 * @param maxExactSize the maximum number of components of a reachable set represented exactly; larger sets will be approximated.
+	 * @param log2m the logarithm of the number of registers of the HyperLogLog counters approximating large reachable sets.
+	 * @param threads the requested number of threads (0 for {@link Runtime#availableProcessors()}).
+	 * @param pl a progress logger, or {@code null}.
+	 * @return an instance of this class containing the computed sizes.
+	 */
+	public static Reachability compute(final ImmutableGraph graph, final int maxExactSize, final int log2m, final int threads, final ProgressLogger pl) {
+		return compute(graph, maxExactSize, DEFAULT_MAX_EXACT_TOTAL_SIZE, log2m, threads, pl);
+	}
+
+	/** Computes the size of the reachable set of each node of a graph.
+	 *
+	 * @param graph a graph supporting random access.
+	 * @param maxExactSize the maximum number of components of a reachable set represented exactly; larger sets will be approximated.
+	 * @param maxExactTotalSize the maximum overall number of components of the reachable sets represented exactly kept in memory at the same time;
+	 * sets that would exceed this limit will be approximated.
+	 * @param log2m the logarithm of the number of registers of the HyperLogLog counters approximating large reachable sets.
+	 * @param threads the requested number of threads (0 for {@link Runtime#availableProcessors()}).
+	 * @param pl a progress logger, or {@code null}.
+	 * @return an instance of this class containing the computed sizes.
+	 */
+	public static Reachability compute(final ImmutableGraph graph, final int maxExactSize, final long maxExactTotalSize, final int log2m, int threads, final ProgressLogger pl) {
+		if (! graph.randomAccess()) throw new IllegalArgumentException("The graph must support random access");
+		if (log2m < 4 || log2m > 30) throw new IllegalArgumentException("Illegal logarithm of the number of registers: " + log2m);
+		if (threads == 0) threads = Runtime.getRuntime().availableProcessors();
+		final int n = graph.numNodes();
+
+		final StronglyConnectedComponents scc = StronglyConnectedComponents.compute(graph, false, pl);
+		final int[] component = scc.component;
+		final int k = scc.numberOfComponents;
+
+		// Group nodes by component
+		final int[] start = new int[k + 1];
+		for(final int c : component) start[c + 1]++;
+		for(int c = 0; c < k; c++) start[c + 1] += start[c];
+		final int[] node = new int[n];
+		final int[] pos = IntArrays.copy(start, 0, k);
+		for(int x = 0; x < n; x++) node[pos[component[x]]++] = x;
+
+		// Compute levels and the number of distinct predecessors of each component
+		if (pl != null) {
+			pl.itemsName = "components";
+			pl.expectedUpdates = k;
+			pl.start("Computing the levels of the component DAG...");
+		}
+		final int[] level = new int[k];
+		final AtomicIntegerArray pending = new AtomicIntegerArray(k);
+		final int[] last = new int[k];
+		Arrays.fill(last, -1);
+		int levels = 0;
+		for(int c = 0; c < k; c++) {
+			int l = 0;
+			for(int i = start[c]; i < start[c + 1]; i++) {
+				final LazyIntIterator successors = graph.successors(node[i]);
+				for(int s; (s = successors.nextInt()) != -1;) {
+					final int t = component[s];
+					if (t != c && last[t] != c) {
+						last[t] = c;
+						l = Math.max(l, level[t] + 1);
+						pending.incrementAndGet(t);
+					}
+				}
+			}
+			level[c] = l;
+			levels = Math.max(levels, l + 1);
+			if (pl != null) pl.lightUpdate();
+		}
+		if (pl != null) pl.done();
+
+		// Group components by level
+		final int[] levelEnd = new int[levels + 1];
+		for(int c = 0; c < k; c++) levelEnd[level[c] + 1]++;
+		for(int l = 0; l < levels; l++) levelEnd[l + 1] += levelEnd[l];
+		final int[] byLevel = new int[k];
+		// After this loop, levelEnd[l] is the end of level l in byLevel
+		for(int c = 0; c < k; c++) byLevel[levelEnd[level[c]]++] = c;
+		LOGGER.debug(k + " components, " + levels + " levels");
+
+		final Counters counters = new Counters(log2m);
+		final byte[][] sketch = new byte[k][];
+		if (maxExactSize < k || maxExactTotalSize < (long)k * k) {
+			// Precompute counters for components larger than a counter, so that adding them costs as much as a maximization
+			for(int c = 0; c < k; c++) if (start[c + 1] - start[c] >= counters.m) {
+				sketch[c] = new byte[counters.m];
+				for(int i = start[c]; i < start[c + 1]; i++) counters.add(sketch[c], node[i]);
+			}
+		}
+
+		final double[] reachable = new double[k];
+		final boolean[] exact = new boolean[k];
+		final Object[] set = new Object[k];
+		final AtomicLong exactTotalSize = new AtomicLong();
+		final Worker[] worker = new Worker[threads];
+		for(int i = 0; i < threads; i++) worker[i] = new Worker(graph.copy(), component, start, node, byLevel, reachable, exact, set, sketch, pending, exactTotalSize, counters, maxExactSize, maxExactTotalSize, pl);
+
+		if (pl != null) {
+			pl.itemsName = "components";
+			pl.expectedUpdates = k;
+			pl.start("Computing reachable sets...");
+		}
+
+		final ExecutorService executorService = Executors.newFixedThreadPool(threads, new ThreadFactoryBuilder().setNameFormat("ProcessingThread-%d").build());
+		final ExecutorCompletionService<Void> executorCompletionService = new ExecutorCompletionService<>(executorService);
+		Throwable problem = null;
+
+		for(int l = 0; l < levels && problem == null; l++) {
+			final int from = l == 0 ? 0 : levelEnd[l - 1], to = levelEnd[l];
+			final AtomicInteger next = new AtomicInteger(from);
+			if (to - from < PARALLEL_THRESHOLD) {
+				worker[0].level(next, to);
+				worker[0].call();
+				continue;
+			}
+
+			for(int t = threads; t-- != 0;) {
+				worker[t].level(next, to);
+				executorCompletionService.submit(worker[t]);
+			}
+			for(int t = threads; t-- != 0;)
+				try {
+					executorCompletionService.take().get();
+				}
+				catch(final Exception e) {
+					problem = e.getCause(); // We keep only the last one. They will be logged anyway.
+				}
+		}
+
+		executorService.shutdown();
+		if (problem != null) {
+			Throwables.throwIfUnchecked(problem);
+			throw new RuntimeException(problem);
+		}
+		if (pl != null) pl.done();
+
+		return new Reachability(component, reachable, exact);
+	}
+
+	public static void main(final String arg[]) throws IOException, JSAPException {
+		final SimpleJSAP jsap = new SimpleJSAP(Reachability.class.getName(),
+				"Computes the size of the set of nodes reachable from each node of a graph, and stores it as a list of binary doubles. " +
+				"Reachable sets containing too many strongly connected components are approximated by HyperLogLog counters.",
+				new Parameter[] {
+					new FlaggedOption("maxExactSize", JSAP.INTSIZE_PARSER, Integer.toString(DEFAULT_MAX_EXACT_SIZE), JSAP.NOT_REQUIRED, 'e', "max-exact-size", "The maximum number of components of a reachable set represented exactly."),
+					new FlaggedOption("maxExactTotalSize", JSAP.LONGSIZE_PARSER, Long.toString(DEFAULT_MAX_EXACT_TOTAL_SIZE), JSAP.NOT_REQUIRED, 'E', "max-exact-total-size", "The maximum overall number of components of the reachable sets represented exactly kept in memory at the same time."),
+					new FlaggedOption("log2m", JSAP.INTEGER_PARSER, Integer.toString(DEFAULT_LOG2M), JSAP.NOT_REQUIRED, 'r', "log2m", "The logarithm of the number of registers of approximated reachable sets."),
+					new FlaggedOption("logInterval", JSAP.LONG_PARSER, Long.toString(ProgressLogger.DEFAULT_LOG_INTERVAL), JSAP.NOT_REQUIRED, 'l', "log-interval", "The minimum time interval between activity logs in milliseconds."),
+					new Switch("mapped", 'm', "mapped", "Do not load the graph in main memory, but rather memory-map it."),
+					new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "0", JSAP.NOT_REQUIRED, 'T', "threads", "The number of threads to be used. If 0, the number will be estimated automatically."),
+					new UnflaggedOption("basename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The basename of the graph."),
+					new UnflaggedOption("output", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The file where reachable-set sizes will be stored."),
+				}
+		);
+
+		final JSAPResult jsapResult = jsap.parse(arg);
+		if (jsap.messagePrinted()) System.exit(1);
+
+		final String basename = jsapResult.getString("basename");
+		final ProgressLogger pl = new ProgressLogger(LOGGER, jsapResult.getLong("logInterval"), TimeUnit.MILLISECONDS);
+		final ImmutableGraph graph = jsapResult.userSpecified("mapped") ? ImmutableGraph.loadMapped(basename) : ImmutableGraph.load(basename, pl);
+
+		final Reachability reachability = Reachability.compute(graph, jsapResult.getInt("maxExactSize"), jsapResult.getLong("maxExactTotalSize"), jsapResult.getInt("log2m"), jsapResult.getInt("threads"), pl);
+		final double[] reachable = new double[graph.numNodes()];
+		for(int x = reachable.length; x-- != 0;) reachable[x] = reachability.reachable(x);
+		int approximated = 0;
+		for(final boolean e : reachability.exact) if (! e) approximated++;
+		LOGGER.info(approximated + " components out of " + reachability.exact.length + " have an approximated reachable set");
+		BinIO.storeDoubles(reachable, jsapResult.getString("output"));
+	}
+}
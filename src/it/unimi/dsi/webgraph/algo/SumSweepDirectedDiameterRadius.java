@@ -19,10 +19,15 @@ package it.unimi.dsi.webgraph.algo;
 
 import java.io.IOException;
 import java.util.Arrays;
+import java.util.concurrent.ExecutorCompletionService;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
 
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
+import com.google.common.base.Throwables;
+import com.google.common.util.concurrent.ThreadFactoryBuilder;
 import com.martiansoftware.jsap.FlaggedOption;
 import com.martiansoftware.jsap.JSAP;
 import com.martiansoftware.jsap.JSAPException;
@@ -293,13 +298,8 @@ public class SumSweepDirectedDiameterRadius {
 	private final boolean[] toCompleteB;
 	/** The set of vertices that can be radial vertices. */
 	private final boolean[] accRadial;
-	/** The queue used for each BFS (it is recycled to save some time). */
-	private final int[] queue;
-	/**
-	 * The array of distances, used in each BFS (it is recycled to save some
-	 * time).
-	 */
-	private final int[] dist;
+	/** The state of sequential BFSs (it is recycled to save some time). */
+	private final Sweep sweep;
 	/** Upper bound on the radius of the graph. */
 	private int dL;
 	/** Upper bound on the radius of the graph. */
@@ -351,6 +351,48 @@ public class SumSweepDirectedDiameterRadius {
 	 * tie-break for the choice of the next vertex to process).
 	 */
 	private final int totDistB[];
+	/** Nanoseconds spent choosing the starting vertices of BFSs. */
+	private long selectionTime;
+	/** Nanoseconds spent performing BFSs (wall-clock time, if BFSs are concurrent). */
+	private long visitTime;
+	/**
+	 * Nanoseconds spent updating bounds, including the time spent by
+	 * {@link #allCCUpperBound(int[])}.
+	 */
+	private long updateTime;
+
+	/**
+	 * The state of a (forward or backward) BFS: the scratch arrays used during
+	 * the visit, and the data needed to update the bounds afterwards.
+	 * Concurrent BFSs use distinct instances, each with its own copy of the
+	 * graph and of its transpose.
+	 */
+	private static final class Sweep {
+		/** The graph (or a copy of the graph) used by forward BFSs. */
+		private final ImmutableGraph graph;
+		/** The reversed graph (or a copy of the reversed graph) used by backward BFSs. */
+		private final ImmutableGraph revgraph;
+		/** The queue used by the BFS. */
+		private final int[] queue;
+		/** The array of distances from the starting vertex. */
+		private final int[] dist;
+		/** The starting vertex of the BFS. */
+		private int start;
+		/** Whether the BFS follows the direction of edges. */
+		private boolean forward;
+		/** The heuristic that chose the starting vertex (used by {@link SumSweepDirectedDiameterRadius#compute(int)}). */
+		private int step;
+		/** The eccentricity of the starting vertex. */
+		private int eccStart;
+
+		private Sweep(final ImmutableGraph graph, final ImmutableGraph revgraph) {
+			this.graph = graph;
+			this.revgraph = revgraph;
+			final int n = graph.numNodes();
+			queue = new int[n];
+			dist = new int[n];
+		}
+	}
 
 	/**
 	 * Creates a new class for computing diameter and/or radius and/or all
@@ -385,8 +427,7 @@ public class SumSweepDirectedDiameterRadius {
 		uB = new int[nn];
 		toCompleteF = new boolean[nn];
 		toCompleteB = new boolean[nn];
-		queue = new int[nn];
-		dist = new int[nn];
+		sweep = new Sweep(graph, revgraph);
 		scc = StronglyConnectedComponents.compute(graph, false, null);
 		startBridges = new int[scc.numberOfComponents][];
 		endBridges = new int[scc.numberOfComponents][];
@@ -554,6 +595,37 @@ public class SumSweepDirectedDiameterRadius {
 		return iterAll;
 	}
 
+	/**
+	 * Returns the time spent choosing the starting vertices of BFSs.
+	 *
+	 * @return the time spent choosing the starting vertices of BFSs, in
+	 *         nanoseconds
+	 */
+	public long getSelectionTime() {
+		return selectionTime;
+	}
+
+	/**
+	 * Returns the time spent performing BFSs. When BFSs are performed
+	 * concurrently, this is the wall-clock time of each batch, minus the time
+	 * spent updating bounds while waiting for the batch to complete.
+	 *
+	 * @return the time spent performing BFSs, in nanoseconds
+	 */
+	public long getVisitTime() {
+		return visitTime;
+	}
+
+	/**
+	 * Returns the time spent updating bounds, including the time spent
+	 * computing upper bounds through the strongly connected components.
+	 *
+	 * @return the time spent updating bounds, in nanoseconds
+	 */
+	public long getUpdateTime() {
+		return updateTime;
+	}
+
 	/**
 	 * Uses a heuristic to decide which is the best pivot to choose in each
 	 * strongly connected component, in order to perform the
@@ -635,16 +707,67 @@ public class SumSweepDirectedDiameterRadius {
 		if (start == -1) {
 			return;
 		}
-		final int queue[] = this.queue;
-		final int dist[] = this.dist;
+		final long time = System.nanoTime();
+		sweep.start = start;
+		sweep.forward = forward;
+		visit(sweep);
+		final long visited = System.nanoTime();
+		visitTime += visited - time;
+		update(sweep);
+		updateTime += System.nanoTime() - visited;
+	}
+
+	/**
+	 * Performs a (forward or backward) BFS from the starting vertex of a
+	 * sweep, storing in the sweep the data needed by {@link #update(Sweep)}.
+	 * This method does not modify the state of this class, so it can be called
+	 * concurrently on distinct sweeps.
+	 *
+	 * @param sweep
+	 *            a sweep whose starting vertex and direction have been set
+	 */
+	private static void visit(final Sweep sweep) {
+		final int queue[] = sweep.queue;
+		final int dist[] = sweep.dist;
+		final int start = sweep.start;
+		final ImmutableGraph g = sweep.forward ? sweep.graph : sweep.revgraph;
 		int startQ = 0, endQ = 0;
-		int v, w, eccStart;
-		int[] l, lOther, u, uOther, totDistOther, ecc, eccOther;
-		boolean[] toComplete, toCompleteOther;
+		int v, w;
+		LazyIntIterator iter;
 
 		Arrays.fill(dist, -1);
 
-		ImmutableGraph g;
+		queue[endQ++] = start;
+		dist[start] = 0;
+
+		while (startQ < endQ) {
+			v = queue[startQ++];
+			iter = g.successors(v);
+
+			while ((w = iter.nextInt()) != -1) {
+				if (dist[w] == -1) {
+					dist[w] = dist[v] + 1;
+					queue[endQ++] = w;
+				}
+			}
+		}
+
+		sweep.eccStart = dist[queue[endQ - 1]];
+	}
+
+	/**
+	 * Updates lower bounds on the eccentricities of all vertices visited by a
+	 * sweep.
+	 *
+	 * @param sweep
+	 *            a sweep on which {@link #visit(Sweep)} has been called
+	 */
+	private void update(final Sweep sweep) {
+		final int dist[] = sweep.dist;
+		final int start = sweep.start, eccStart = sweep.eccStart;
+		final boolean forward = sweep.forward;
+		int[] l, lOther, u, uOther, totDistOther, ecc, eccOther;
+		boolean[] toComplete, toCompleteOther;
 
 		if (forward) {
 			l = lF;
@@ -652,7 +775,6 @@ public class SumSweepDirectedDiameterRadius {
 			u = uF;
 			uOther = uB;
 			totDistOther = totDistB;
-			g = graph;
 			ecc = eccF;
 			eccOther = eccB;
 			toComplete = toCompleteF;
@@ -663,32 +785,12 @@ public class SumSweepDirectedDiameterRadius {
 			u = uB;
 			uOther = uF;
 			totDistOther = totDistF;
-			g = revgraph;
 			ecc = eccB;
 			eccOther = eccF;
 			toComplete = toCompleteB;
 			toCompleteOther = toCompleteF;
 		}
 
-		LazyIntIterator iter;
-
-		queue[endQ++] = start;
-		dist[start] = 0;
-
-		while (startQ < endQ) {
-			v = queue[startQ++];
-			iter = g.successors(v);
-
-			while ((w = iter.nextInt()) != -1) {
-				if (dist[w] == -1) {
-					dist[w] = dist[v] + 1;
-					queue[endQ++] = w;
-				}
-			}
-		}
-
-		eccStart = dist[queue[endQ - 1]];
-
 		l[start] = eccStart;
 		u[start] = eccStart;
 		ecc[start] = eccStart;
@@ -705,7 +807,7 @@ public class SumSweepDirectedDiameterRadius {
 			}
 		}
 
-		for (v = nn - 1; v >= 0; v--) {
+		for (int v = nn - 1; v >= 0; v--) {
 
 			if (dist[v] == -1)
 				continue;
@@ -850,7 +952,7 @@ public class SumSweepDirectedDiameterRadius {
 		final int nn = this.nn;
 		final int scc[] = this.scc.component;
 		final int eccPivot[] = new int[this.scc.numberOfComponents];
-		final int queue[] = this.queue;
+		final int queue[] = sweep.queue;
 		int startQ, endQ, v, w;
 		LazyIntIterator iter;
 
@@ -1035,6 +1137,108 @@ public class SumSweepDirectedDiameterRadius {
 	 * {@link #getEccentricity(int, boolean)}.
 	 */
 	public void compute() {
+		compute(1);
+	}
+
+	/** The direction of the BFS performed by each heuristic of {@link #source(int)}. */
+	private static final boolean[] FORWARD = { true, true, true, false, false, false };
+
+	/**
+	 * Returns the starting vertex of the next BFS according to a heuristic;
+	 * the direction of the BFS is given by {@link #FORWARD}.
+	 *
+	 * @param step
+	 *            the heuristic, between 1 and 5 (0 is
+	 *            {@link #allCCUpperBound(int[])}, which is not a BFS)
+	 * @return the starting vertex of the next BFS, or -1 if no vertex is
+	 *         available
+	 */
+	private int source(final int step) {
+		switch (step) {
+		case 1:
+			if (DEBUG)
+				LOGGER.debug("Performing a forward BFS, from a vertex maximizing the upper bound.");
+			return argMax(uF, totDistF, toCompleteF);
+		case 2:
+			if (DEBUG)
+				LOGGER.debug("Performing a forward BFS, from a vertex minimizing the lower bound.");
+			return argMin(lF, totDistF, accRadial);
+		case 3:
+			if (DEBUG)
+				LOGGER.debug("Performing a backward BFS, from a vertex maximizing the upper bound.");
+			return argMax(uB, totDistB, toCompleteB);
+		case 4:
+			if (DEBUG)
+				LOGGER.debug("Performing a backward BFS, from a vertex maximizing the distance sum.");
+			return argMax(totDistB, uB, toCompleteB);
+		default:
+			if (DEBUG)
+				LOGGER.debug("Performing a forward BFS, from a vertex maximizing the distance sum.");
+			return argMax(totDistF, uF, toCompleteF);
+		}
+	}
+
+	/**
+	 * Updates the scores of the heuristics after a step.
+	 *
+	 * @param points
+	 *            the scores of the heuristics
+	 * @param stepToPerform
+	 *            the heuristic that has been applied
+	 * @param missingNodes
+	 *            the number of missing nodes before the step
+	 * @return the number of missing nodes after the step
+	 */
+	private int score(final double[] points, final int stepToPerform, final int missingNodes) {
+		final int newMissingNodes = this.findMissingNodes();
+		points[stepToPerform] = missingNodes - newMissingNodes;
+
+		for (int j = 0; j < points.length; j++) {
+			if (j != stepToPerform && points[j] >= 0) {
+				points[j] = points[j] + 2.0 / iter;
+			}
+		}
+		if (DEBUG)
+			LOGGER.debug("    Missing nodes: " + newMissingNodes + "/" + 2 * nn + ".");
+		return newMissingNodes;
+	}
+
+	/**
+	 * Computes diameter, radius, and/or all eccentricities, performing several
+	 * BFSs concurrently. Results can be accessed by methods such as
+	 * {@link #getDiameter()}, {@link #getRadialVertex()} and
+	 * {@link #getEccentricity(int, boolean)}.
+	 *
+	 * <p>
+	 * After the initial SumSweep heuristic, this method proceeds by rounds. At
+	 * each round, if the heuristic with the best score is
+	 * {@link #allCCUpperBound(int[])} it is performed alone; otherwise, the
+	 * starting vertices of up to <var>threads</var> BFSs are chosen using the
+	 * same heuristics of {@link #compute()}: the score of a heuristic is halved
+	 * each time it chooses a vertex, so that the most effective heuristics
+	 * choose more vertices, and vertices chosen in the same round are
+	 * distinct. The BFSs are then performed concurrently, each on a
+	 * {@linkplain ImmutableGraph#copy() copy} of the graph (or of its
+	 * transpose), and bounds are updated as soon as each BFS completes. If a
+	 * heuristic has no available vertex and no vertex has been chosen yet in
+	 * the current round, the heuristic spends a round as in {@link #compute()};
+	 * otherwise, it is just skipped for the rest of the round. Thus, with one
+	 * thread this method performs exactly the same steps as {@link #compute()}.
+	 *
+	 * <p>
+	 * Each thread uses two arrays of integers as large as the graph. The time
+	 * spent in each phase is available from {@link #getSelectionTime()},
+	 * {@link #getVisitTime()} and {@link #getUpdateTime()}.
+	 *
+	 * @param threads
+	 *            the maximum number of concurrent BFSs (0 for
+	 *            {@link Runtime#availableProcessors()}).
+	 */
+	public void compute(int threads) {
+		if (threads < 0)
+			throw new IllegalArgumentException("The number of threads must be nonnegative: " + threads);
+		if (threads == 0)
+			threads = Runtime.getRuntime().availableProcessors();
 		if (pl != null) {
 			pl.start("Starting visits...");
 			pl.itemsName = "nodes";
@@ -1051,63 +1255,133 @@ public class SumSweepDirectedDiameterRadius {
 		sumSweepHeuristic(maxDegVert, 6);
 
 		final double points[] = new double[6];
-		int missingNodes = findMissingNodes(), oldMissingNodes = missingNodes;
+		final double score[] = new double[points.length];
+		int missingNodes = findMissingNodes();
 
 		Arrays.fill(points, graph.numNodes());
 
-		while (missingNodes > 0) {
+		final Sweep[] sweeps = new Sweep[threads];
+		// The flags toCompleteF, toCompleteB and accRadial of chosen vertices, which are temporarily cleared
+		final boolean[][] flags = new boolean[threads][3];
+		sweeps[0] = sweep;
+		for (int i = 1; i < threads; i++)
+			sweeps[i] = new Sweep(graph.copy(), revgraph.copy());
+		final ExecutorService executorService = threads == 1 ? null
+				: Executors.newFixedThreadPool(threads,
+						new ThreadFactoryBuilder().setNameFormat("ProcessingThread-%d").build());
+		final ExecutorCompletionService<Sweep> executorCompletionService = threads == 1 ? null
+				: new ExecutorCompletionService<>(executorService);
+		Throwable problem = null;
 
-			final int stepToPerform = argMax(points);
+		while (missingNodes > 0) {
+			final long time = System.nanoTime();
+			System.arraycopy(points, 0, score, 0, points.length);
+			int batch = 0;
+			boolean upperBound = false;
+			int spent = 0;
+			while (batch < threads) {
+				final int stepToPerform = argMax(score);
+				if (stepToPerform == -1)
+					break;
+				if (stepToPerform == 0) {
+					// AllCCUpperBound is not a BFS, so it is performed alone
+					if (batch == 0) {
+						upperBound = true;
+						break;
+					}
+					score[0] = Double.NEGATIVE_INFINITY;
+					continue;
+				}
+				final int v = source(stepToPerform);
+				if (v == -1) {
+					if (batch == 0) {
+						// As in compute(), a heuristic with no available vertex spends a round
+						if (++spent > points.length)
+							break;
+						missingNodes = score(points, stepToPerform, missingNodes);
+						System.arraycopy(points, 0, score, 0, points.length);
+					} else score[stepToPerform] = Double.NEGATIVE_INFINITY;
+					continue;
+				}
+				// We exclude temporarily the chosen vertex, so that it is not
+				// chosen again in this round.
+				flags[batch][0] = toCompleteF[v];
+				flags[batch][1] = toCompleteB[v];
+				flags[batch][2] = accRadial[v];
+				toCompleteF[v] = toCompleteB[v] = accRadial[v] = false;
+				sweeps[batch].start = v;
+				sweeps[batch].forward = FORWARD[stepToPerform];
+				sweeps[batch++].step = stepToPerform;
+				score[stepToPerform] /= 2;
+			}
+			for (int i = batch; i-- != 0;) {
+				final int v = sweeps[i].start;
+				toCompleteF[v] = flags[i][0];
+				toCompleteB[v] = flags[i][1];
+				accRadial[v] = flags[i][2];
+			}
+			final long selected = System.nanoTime();
+			selectionTime += selected - time;
 
-			switch (stepToPerform) {
-			case 0:
+			if (upperBound) {
 				if (DEBUG)
 					LOGGER.debug("Performing AllCCUpperBound.");
 				this.allCCUpperBound(findBestPivot());
+				missingNodes = score(points, 0, missingNodes);
+				updateTime += System.nanoTime() - selected;
+				continue;
+			}
+			if (batch == 0)
 				break;
-			case 1:
-				if (DEBUG)
-					LOGGER.debug("Performing a forward BFS, from a vertex maximizing the upper bound.");
-				this.stepSumSweep(argMax(uF, totDistF, toCompleteF), true);
-				break;
-			case 2:
-				if (DEBUG)
-					LOGGER.debug("Performing a forward BFS, from a vertex minimizing the lower bound.");
-				this.stepSumSweep(argMin(lF, totDistF, accRadial), true);
-				break;
-			case 3:
-				if (DEBUG)
-					LOGGER.debug("Performing a backward BFS, from a vertex maximizing the upper bound.");
-				this.stepSumSweep(argMax(uB, totDistB, toCompleteB), false);
-				break;
-			case 4:
-				if (DEBUG)
-					LOGGER.debug("Performing a backward BFS, from a vertex maximizing the distance sum.");
-				this.stepSumSweep(argMax(totDistB, uB, toCompleteB), false);
-				break;
-			case 5:
-				if (DEBUG)
-					LOGGER.debug("Performing a forward BFS, from a vertex maximizing the distance sum.");
-				this.stepSumSweep(argMax(totDistF, uF, toCompleteF), false);
-				break;
+
+			for (int i = 0; i < batch; i++) {
+				final Sweep s = sweeps[i];
+				if (executorCompletionService == null)
+					visit(s);
+				else
+					executorCompletionService.submit(() -> {
+						visit(s);
+						return s;
+					});
 			}
-			oldMissingNodes = missingNodes;
-			missingNodes = this.findMissingNodes();
-			points[stepToPerform] = oldMissingNodes - missingNodes;
 
-			for (int j = 0; j < points.length; j++) {
-				if (j != stepToPerform && points[j] >= 0) {
-					points[j] = points[j] + 2.0 / iter;
-				}
+			long updates = 0;
+			for (int i = 0; i < batch; i++) {
+				final Sweep s;
+				if (executorCompletionService == null)
+					s = sweeps[i];
+				else
+					try {
+						s = executorCompletionService.take().get();
+					} catch (final Exception e) {
+						problem = e.getCause(); // We keep only the last one. They will be logged anyway.
+						continue;
+					}
+				if (problem != null)
+					continue;
+				final long t = System.nanoTime();
+				update(s);
+				missingNodes = score(points, s.step, missingNodes);
+				updates += System.nanoTime() - t;
+			}
+			updateTime += updates;
+			visitTime += System.nanoTime() - selected - updates;
+
+			if (problem != null) {
+				executorService.shutdown();
+				Throwables.throwIfUnchecked(problem);
+				throw new RuntimeException(problem);
 			}
-			if (DEBUG)
-				LOGGER.debug("    Missing nodes: " + missingNodes + "/" + 2 * nn + ".");
 		}
+		if (executorService != null)
+			executorService.shutdown();
 		if (DEBUG) {
 			if (this.output == OutputLevel.RADIUS || this.output == OutputLevel.RADIUS_DIAMETER)
 				LOGGER.debug("Radius: " + rU + " (" + iterR + " iterations).");
 			if (this.output == OutputLevel.DIAMETER || this.output == OutputLevel.RADIUS_DIAMETER)
 				LOGGER.debug("Diameter: " + dL + " (" + iterD + " iterations).");
+			LOGGER.debug("Selection time: " + selectionTime / 1E9 + "s; visit time: " + visitTime / 1E9
+					+ "s; update time: " + updateTime / 1E9 + "s.");
 		}
 		if (pl != null)
 			pl.done();
@@ -1130,7 +1404,9 @@ public class SumSweepDirectedDiameterRadius {
 								"The filename where the resulting backward eccentricities (integers in binary form) are stored. If not available, the output file is not produced."),
 						new FlaggedOption("level", EnumStringParser.getParser(OutputLevel.class),
 								OutputLevel.ALL.name(), JSAP.REQUIRED, 'l', "level",
-								Arrays.toString(OutputLevel.values())) });
+								Arrays.toString(OutputLevel.values())),
+						new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "1", JSAP.NOT_REQUIRED, 'T', "threads",
+								"The maximum number of BFSs performed concurrently. If 0, the number of available processors will be used.") });
 
 		final JSAPResult jsapResult = jsap.parse(arg);
 		if (jsap.messagePrinted())
@@ -1153,11 +1429,13 @@ public class SumSweepDirectedDiameterRadius {
 			graph = new ArrayListMutableGraph(graph).immutableView();
 
 		final SumSweepDirectedDiameterRadius ss = new SumSweepDirectedDiameterRadius(graph, level, null, progressLogger);
-		ss.compute();
+		ss.compute(jsapResult.getInt("threads"));
 		if (level != OutputLevel.DIAMETER)
 			System.out.println("Radius: " + ss.rU + " (" + ss.iterR + " iterations).");
 		if (level != OutputLevel.RADIUS)
 			System.out.println("Diameter: " + ss.dL + " (" + ss.iterD + " iterations).");
+		System.out.println("Selection time: " + ss.selectionTime / 1E9 + "s; visit time: " + ss.visitTime / 1E9
+				+ "s; update time: " + ss.updateTime / 1E9 + "s.");
 
 		if (forwardOutputFilename != null && (level == OutputLevel.ALL || level == OutputLevel.ALL_FORWARD)) {
 			BinIO.storeInts(ss.eccF, forwardOutputFilename);
@@ -19,10 +19,15 @@ package it.unimi.dsi.webgraph.algo;
 
 import java.io.IOException;
 import java.util.Arrays;
+import java.util.concurrent.ExecutorCompletionService;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
 
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
+import com.google.common.base.Throwables;
+import com.google.common.util.concurrent.ThreadFactoryBuilder;
 import com.martiansoftware.jsap.FlaggedOption;
 import com.martiansoftware.jsap.JSAP;
 import com.martiansoftware.jsap.JSAPException;
@@ -154,15 +159,8 @@ public class SumSweepUndirectedDiameterRadius {
 	 * eccentricity of <var>v</var> has not been exactly computed, yet.
 	 */
 	private final boolean[] toComplete;
-	/** Saves which vertices are in the first branch of a BFS. */
-	private final boolean[] firstBranch;
-	/** The queue used for each BFS (it is recycled to save some time). */
-	private final int[] queue;
-	/**
-	 * The array of distances, used in each BFS (it is recycled to save some
-	 * time).
-	 */
-	private final int[] dist;
+	/** The state of sequential BFSs (it is recycled to save some time). */
+	private final Sweep sweep;
 	/** Lower bound on the diameter of the graph. */
 	private int dL;
 	/** Lower bound on the radius of the graph. */
@@ -188,6 +186,48 @@ public class SumSweepUndirectedDiameterRadius {
 	 * for the choice of the next vertex to process).
 	 */
 	private final int totDist[];
+	/** Nanoseconds spent choosing the starting vertices of BFSs. */
+	private long selectionTime;
+	/** Nanoseconds spent performing BFSs (wall-clock time, if BFSs are concurrent). */
+	private long visitTime;
+	/** Nanoseconds spent updating bounds using the results of BFSs. */
+	private long updateTime;
+
+	/**
+	 * The state of a BFS: the scratch arrays used during the visit, and the
+	 * data needed to update the bounds afterwards. Concurrent BFSs use
+	 * distinct instances, each with its own copy of the graph.
+	 */
+	private static final class Sweep {
+		/** The graph (or a copy of the graph) used by the BFS. */
+		private final ImmutableGraph graph;
+		/** The queue used by the BFS. */
+		private final int[] queue;
+		/** The array of distances from the starting vertex. */
+		private final int[] dist;
+		/** Saves which vertices are in the first branch of the BFS. */
+		private final boolean[] firstBranch;
+		/** The starting vertex of the BFS. */
+		private int start;
+		/** The heuristic that chose the starting vertex (used by {@link SumSweepUndirectedDiameterRadius#compute(int)}). */
+		private int step;
+		/** The eccentricity of the starting vertex. */
+		private int eccStart;
+		/** The maximum distance of a vertex that is not in the first branch. */
+		private int eccNotFirstBranch;
+		/** The length of the path the BFS tree starts with. */
+		private int startingPathL;
+		/** Whether the starting vertex is isolated (in which case the BFS is not performed). */
+		private boolean isolated;
+
+		private Sweep(final ImmutableGraph graph) {
+			this.graph = graph;
+			final int n = graph.numNodes();
+			queue = new int[n];
+			dist = new int[n];
+			firstBranch = new boolean[n];
+		}
+	}
 
 	/**
 	 * Creates a new class for computing diameter and/or radius and/or all
@@ -214,9 +254,7 @@ public class SumSweepUndirectedDiameterRadius {
 		l = new int[nn];
 		u = new int[nn];
 		toComplete = new boolean[nn];
-		queue = new int[nn];
-		dist = new int[nn];
-		firstBranch = new boolean[nn];
+		sweep = new Sweep(graph);
 
 		Arrays.fill(ecc, -1);
 		Arrays.fill(u, nn + 1);
@@ -344,8 +382,38 @@ public class SumSweepUndirectedDiameterRadius {
 	}
 
 	/**
-	 * Performs a (forward or backward) BFS, updating upper and lower bounds on
-	 * the eccentricities of all visited vertices.
+	 * Returns the time spent choosing the starting vertices of BFSs.
+	 *
+	 * @return the time spent choosing the starting vertices of BFSs, in
+	 *         nanoseconds
+	 */
+	public long getSelectionTime() {
+		return selectionTime;
+	}
+
+	/**
+	 * Returns the time spent performing BFSs. When BFSs are performed
+	 * concurrently, this is the wall-clock time of each batch, minus the time
+	 * spent updating bounds while waiting for the batch to complete.
+	 *
+	 * @return the time spent performing BFSs, in nanoseconds
+	 */
+	public long getVisitTime() {
+		return visitTime;
+	}
+
+	/**
+	 * Returns the time spent updating bounds using the results of BFSs.
+	 *
+	 * @return the time spent updating bounds, in nanoseconds
+	 */
+	public long getUpdateTime() {
+		return updateTime;
+	}
+
+	/**
+	 * Performs a BFS, updating upper and lower bounds on the eccentricities of
+	 * all visited vertices.
 	 *
 	 * @param start
 	 *            the starting vertex of the BFS
@@ -354,20 +422,35 @@ public class SumSweepUndirectedDiameterRadius {
 		if (start == -1) {
 			return;
 		}
-		if (graph.outdegree(start) == 0) {
-			rU = 0;
-			rV = start;
-			ecc[start] = 0;
-			toComplete[start] = false;
+		final long time = System.nanoTime();
+		sweep.start = start;
+		visit(sweep);
+		final long visited = System.nanoTime();
+		visitTime += visited - time;
+		update(sweep);
+		updateTime += System.nanoTime() - visited;
+	}
+
+	/**
+	 * Performs a BFS from the starting vertex of a sweep, storing in the sweep
+	 * the data needed by {@link #update(Sweep)}. This method does not modify
+	 * the state of this class, so it can be called concurrently on distinct
+	 * sweeps.
+	 *
+	 * @param sweep
+	 *            a sweep whose starting vertex has been set
+	 */
+	private static void visit(final Sweep sweep) {
+		final ImmutableGraph g = sweep.graph;
+		final int start = sweep.start;
+		if (sweep.isolated = g.outdegree(start) == 0) {
 			return;
 		}
-		final ImmutableGraph g = graph;
-		final int queue[] = this.queue;
-		final int dist[] = this.dist;
+		final int queue[] = sweep.queue;
+		final int dist[] = sweep.dist;
+		final boolean[] firstBranch = sweep.firstBranch;
 		int startQ = 0, endQ = 0;
-		int v = start, w, eccStart, eccNotFirstBranch = 0;
-		final int[] l = this.l, u = this.u, totDist = this.totDist, ecc = this.ecc;
-		final boolean[] firstBranch = this.firstBranch, toComplete = this.toComplete;
+		int v = start, w, eccNotFirstBranch = 0;
 		int startingPathL = 0;
 
 		Arrays.fill(dist, -1);
@@ -428,10 +511,36 @@ public class SumSweepUndirectedDiameterRadius {
 			}
 		}
 
-		eccStart = dist[queue[endQ - 1]];
+		sweep.eccStart = dist[queue[endQ - 1]];
+		sweep.eccNotFirstBranch = eccNotFirstBranch;
+		sweep.startingPathL = startingPathL;
+	}
+
+	/**
+	 * Updates upper and lower bounds on the eccentricities of all vertices
+	 * visited by a sweep.
+	 *
+	 * @param sweep
+	 *            a sweep on which {@link #visit(Sweep)} has been called
+	 */
+	private void update(final Sweep sweep) {
+		final int start = sweep.start;
+		// We do not access the graph, as it might be in use by a concurrent visit
+		if (sweep.isolated) {
+			rU = 0;
+			rV = start;
+			ecc[start] = 0;
+			toComplete[start] = false;
+			return;
+		}
+		final int dist[] = sweep.dist;
+		final int eccStart = sweep.eccStart, eccNotFirstBranch = sweep.eccNotFirstBranch,
+				startingPathL = sweep.startingPathL;
+		final int[] l = this.l, u = this.u, totDist = this.totDist, ecc = this.ecc;
+		final boolean[] firstBranch = sweep.firstBranch, toComplete = this.toComplete;
 
 		// We update all bounds.
-		for (v = nn; v-- > 0;) {
+		for (int v = nn; v-- > 0;) {
 			if (dist[v] == -1) {
 				continue;
 			}
@@ -543,6 +652,95 @@ public class SumSweepUndirectedDiameterRadius {
 	 * {@link #getEccentricity(int)}.
 	 */
 	public void compute() {
+		compute(1);
+	}
+
+	/**
+	 * Updates the scores of the heuristics after a step.
+	 *
+	 * @param points
+	 *            the scores of the heuristics
+	 * @param stepToPerform
+	 *            the heuristic that has been applied
+	 * @param missingNodes
+	 *            the number of missing nodes before the step
+	 * @return the number of missing nodes after the step
+	 */
+	private int spendRound(final double[] points, final int stepToPerform, final int missingNodes) {
+		final int newMissingNodes = this.findMissingNodes();
+		points[stepToPerform] = missingNodes - newMissingNodes;
+
+		for (int j = 0; j < points.length; j++) {
+			if (j != stepToPerform) {
+				points[j] = points[j] + 2.0 / iter;
+			}
+		}
+		if (DEBUG)
+			LOGGER.debug("    Missing nodes: " + newMissingNodes + "/" + 2 * nn + ".");
+		return newMissingNodes;
+	}
+
+	/**
+	 * Returns the starting vertex of the next BFS according to a heuristic.
+	 *
+	 * @param step
+	 *            the heuristic: 0 maximizes the upper bound, 1 minimizes the
+	 *            lower bound, and 2 maximizes the distance sum
+	 * @return the starting vertex of the next BFS, or -1 if no vertex is
+	 *         available
+	 */
+	private int source(final int step) {
+		switch (step) {
+		case 0:
+			if (DEBUG)
+				LOGGER.debug("Performing a BFS from a vertex maximizing the upper bound.");
+			return SumSweepDirectedDiameterRadius.argMax(u, totDist, toComplete);
+		case 1:
+			if (DEBUG)
+				LOGGER.debug("Performing a BFS from a vertex minimizing the lower bound.");
+			return SumSweepDirectedDiameterRadius.argMin(l, totDist, toComplete);
+		default:
+			if (DEBUG)
+				LOGGER.debug("Performing a BFS from a vertex maximizing the distance sum.");
+			return SumSweepDirectedDiameterRadius.argMax(totDist, u, toComplete);
+		}
+	}
+
+	/**
+	 * Computes diameter, radius, and/or all eccentricities, performing several
+	 * BFSs concurrently. Results can be accessed by methods such as
+	 * {@link #getDiameter()}, {@link #getRadialVertex()} and
+	 * {@link #getEccentricity(int)}.
+	 *
+	 * <p>
+	 * After the initial SumSweep heuristic, this method proceeds by rounds. At
+	 * each round, the starting vertices of up to <var>threads</var> BFSs are
+	 * chosen using the same heuristics of {@link #compute()}: the score of a
+	 * heuristic is halved each time it chooses a vertex, so that the most
+	 * effective heuristics choose more vertices, and vertices chosen in the
+	 * same round are distinct. The BFSs are then performed concurrently, each
+	 * on a {@linkplain ImmutableGraph#copy() copy} of the graph, and bounds
+	 * are updated as soon as each BFS completes. If a heuristic has no
+	 * available vertex and no vertex has been chosen yet in the current round,
+	 * the heuristic spends a round as in {@link #compute()}; otherwise, it is
+	 * just skipped for the rest of the round. Thus, with one thread this
+	 * method performs exactly the same BFSs as {@link #compute()}.
+	 *
+	 * <p>
+	 * Each thread uses two arrays of integers and an array of booleans as large
+	 * as the graph. The time spent in each phase is available from
+	 * {@link #getSelectionTime()}, {@link #getVisitTime()} and
+	 * {@link #getUpdateTime()}.
+	 *
+	 * @param threads
+	 *            the maximum number of concurrent BFSs (0 for
+	 *            {@link Runtime#availableProcessors()}).
+	 */
+	public void compute(int threads) {
+		if (threads < 0)
+			throw new IllegalArgumentException("The number of threads must be nonnegative: " + threads);
+		if (threads == 0)
+			threads = Runtime.getRuntime().availableProcessors();
 		if (pl != null) {
 			pl.start("Starting visits...");
 			pl.itemsName = "nodes";
@@ -558,48 +756,104 @@ public class SumSweepUndirectedDiameterRadius {
 		sumSweepHeuristic(maxDegVert, 3);
 
 		final double points[] = new double[3];
-		int missingNodes = findMissingNodes(), oldMissingNodes = missingNodes;
+		final double score[] = new double[points.length];
+		int missingNodes = findMissingNodes();
 
 		Arrays.fill(points, graph.numNodes());
 
+		final Sweep[] sweeps = new Sweep[threads];
+		sweeps[0] = sweep;
+		for (int i = 1; i < threads; i++)
+			sweeps[i] = new Sweep(graph.copy());
+		final ExecutorService executorService = threads == 1 ? null
+				: Executors.newFixedThreadPool(threads,
+						new ThreadFactoryBuilder().setNameFormat("ProcessingThread-%d").build());
+		final ExecutorCompletionService<Sweep> executorCompletionService = threads == 1 ? null
+				: new ExecutorCompletionService<>(executorService);
+		Throwable problem = null;
+
 		while (missingNodes > 0) {
+			final long time = System.nanoTime();
+			System.arraycopy(points, 0, score, 0, points.length);
+			int batch = 0;
+			int spent = 0;
+			while (batch < threads) {
+				final int stepToPerform = SumSweepDirectedDiameterRadius.argMax(score);
+				if (stepToPerform == -1)
+					break;
+				final int v = source(stepToPerform);
+				if (v == -1) {
+					if (batch == 0) {
+						// As in compute(), a heuristic with no available vertex spends a round
+						if (++spent > points.length)
+							break;
+						missingNodes = spendRound(points, stepToPerform, missingNodes);
+						System.arraycopy(points, 0, score, 0, points.length);
+					} else score[stepToPerform] = Double.NEGATIVE_INFINITY;
+					continue;
+				}
+				// We exclude temporarily the chosen vertex, so that it is not
+				// chosen again in this round.
+				toComplete[v] = false;
+				sweeps[batch].start = v;
+				sweeps[batch++].step = stepToPerform;
+				score[stepToPerform] /= 2;
+			}
+			for (int i = 0; i < batch; i++)
+				toComplete[sweeps[i].start] = true;
+			final long selected = System.nanoTime();
+			selectionTime += selected - time;
+			if (batch == 0)
+				break;
 
-			final int stepToPerform = SumSweepDirectedDiameterRadius.argMax(points);
+			for (int i = 0; i < batch; i++) {
+				final Sweep s = sweeps[i];
+				if (executorCompletionService == null)
+					visit(s);
+				else
+					executorCompletionService.submit(() -> {
+						visit(s);
+						return s;
+					});
+			}
 
-			switch (stepToPerform) {
-			case 0:
-				if (DEBUG)
-					LOGGER.debug("Performing a BFS from a vertex maximizing the upper bound.");
-				this.stepSumSweep(SumSweepDirectedDiameterRadius.argMax(u, totDist, toComplete));
-				break;
-			case 1:
-				if (DEBUG)
-					LOGGER.debug("Performing a BFS from a vertex minimizing the lower bound.");
-				this.stepSumSweep(SumSweepDirectedDiameterRadius.argMin(l, totDist, toComplete));
-				break;
-			case 2:
-				if (DEBUG)
-					LOGGER.debug("Performing a BFS from a vertex maximizing the distance sum.");
-				this.stepSumSweep(SumSweepDirectedDiameterRadius.argMax(totDist, u, toComplete));
-				break;
+			long updates = 0;
+			for (int i = 0; i < batch; i++) {
+				final Sweep s;
+				if (executorCompletionService == null)
+					s = sweeps[i];
+				else
+					try {
+						s = executorCompletionService.take().get();
+					} catch (final Exception e) {
+						problem = e.getCause(); // We keep only the last one. They will be logged anyway.
+						continue;
+					}
+				if (problem != null)
+					continue;
+				final long t = System.nanoTime();
+				update(s);
+				missingNodes = spendRound(points, s.step, missingNodes);
+				updates += System.nanoTime() - t;
 			}
-			oldMissingNodes = missingNodes;
-			missingNodes = this.findMissingNodes();
-			points[stepToPerform] = oldMissingNodes - missingNodes;
+			updateTime += updates;
+			visitTime += System.nanoTime() - selected - updates;
 
-			for (int j = 0; j < points.length; j++) {
-				if (j != stepToPerform) {
-					points[j] = points[j] + 2.0 / iter;
-				}
+			if (problem != null) {
+				executorService.shutdown();
+				Throwables.throwIfUnchecked(problem);
+				throw new RuntimeException(problem);
 			}
-			if (DEBUG)
-				LOGGER.debug("    Missing nodes: " + missingNodes + "/" + 2 * nn + ".");
 		}
+		if (executorService != null)
+			executorService.shutdown();
 		if (DEBUG) {
 			if (this.output == OutputLevel.RADIUS || this.output == OutputLevel.RADIUSDIAMETER)
 				LOGGER.debug("Radius: " + rU + " (" + iterR + " iterations).");
 			if (this.output == OutputLevel.DIAMETER || this.output == OutputLevel.RADIUSDIAMETER)
 				LOGGER.debug("Diameter: " + dL + " (" + iterD + " iterations).");
+			LOGGER.debug("Selection time: " + selectionTime / 1E9 + "s; visit time: " + visitTime / 1E9
+					+ "s; update time: " + updateTime / 1E9 + "s.");
 		}
 		if (pl != null)
 			pl.done();
@@ -623,7 +877,9 @@ public class SumSweepUndirectedDiameterRadius {
 								"The filename where the resulting backward eccentricities (integers in binary form) are stored. If not available, the output file is not produced."),
 						new FlaggedOption("level", EnumStringParser.getParser(OutputLevel.class, true),
 								OutputLevel.ALL.name(), JSAP.NOT_REQUIRED, 'l', "level",
-								Arrays.toString(OutputLevel.values())), });
+								Arrays.toString(OutputLevel.values())),
+						new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "1", JSAP.NOT_REQUIRED, 'T', "threads",
+								"The maximum number of BFSs performed concurrently. If 0, the number of available processors will be used."), });
 
 		final JSAPResult jsapResult = jsap.parse(arg);
 		if (jsap.messagePrinted())
@@ -651,12 +907,14 @@ public class SumSweepUndirectedDiameterRadius {
 			graph = ConnectedComponents.getLargestComponent(graph, 0, null);
 
 		final SumSweepUndirectedDiameterRadius ss = new SumSweepUndirectedDiameterRadius(graph, level, progressLogger);
-		ss.compute();
+		ss.compute(jsapResult.getInt("threads"));
 		if (level != OutputLevel.DIAMETER)
 			System.out.println("Radius: " + ss.rU + " (" + ss.iterR + " iterations).");
 		if (level != OutputLevel.RADIUS)
 			System.out.println("Diameter: " + ss.dL + " (" + ss.iterD + " iterations).");
 		System.out.println("Total number of iterations: " + ss.iter + ".");
+		System.out.println("Selection time: " + ss.selectionTime / 1E9 + "s; visit time: " + ss.visitTime / 1E9
+				+ "s; update time: " + ss.updateTime / 1E9 + "s.");
 
 		if (forwardOutputFilename != null && (level == OutputLevel.ALL)) {
 			BinIO.storeInts(ss.ecc, forwardOutputFilename);
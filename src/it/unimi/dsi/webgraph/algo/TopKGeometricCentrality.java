@@ -23,6 +23,7 @@ import java.io.IOException;
 import java.io.PrintStream;
 import java.util.Arrays;
 import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
 
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
@@ -36,7 +37,10 @@ import com.martiansoftware.jsap.SimpleJSAP;
 import com.martiansoftware.jsap.Switch;
 import com.martiansoftware.jsap.UnflaggedOption;
 
+import it.unimi.dsi.Util;
+import it.unimi.dsi.fastutil.ints.Int2DoubleFunction;
 import it.unimi.dsi.fastutil.ints.IntArrayList;
+import it.unimi.dsi.fastutil.ints.IntArrays;
 import it.unimi.dsi.fastutil.ints.IntHeapPriorityQueue;
 import it.unimi.dsi.lang.EnumStringParser;
 import it.unimi.dsi.logging.ProgressLogger;
@@ -66,6 +70,17 @@ import it.unimi.dsi.webgraph.LazyIntIterator;
  * <i>CoRR</i>, abs/1507.01490, 2015.
  * The implementation performs a number of parallel breadth-first visits.
  *
+ * <p>The current <var>k</var>-th best centrality is shared by all threads without locking, and visits
+ * check it again at each new level, so a visit can be cut as soon as another thread improves the bound.
+ * For harmonic and exponential centrality, before starting a visit we compute an upper bound using the outdegree of the source,
+ * the sum of the outdegrees of its successors (which bounds the number of nodes at distance two) and the upper bound on the number of reachable nodes
+ * obtained from the strongly connected components, so many sources can be discarded without a visit.
+ *
+ * <p>Sources are visited by decreasing outdegree. Since visiting first the most central nodes makes the bound
+ * grow faster, you can {@linkplain #orderBy(double[]) provide estimates} of the centralities, for example
+ * {@linkplain #estimate(ImmutableGraph, Centrality, double, int, int, ProgressLogger) computed} by a quick run of {@link HyperBall}
+ * with few registers per counter.
+ *
  * <p>If <var>k</var> is small, the algorithm is much faster than the standard algorithm
  * which {@linkplain GeometricCentralities computes all centralities}. For example, if <var>k</var> is 1
  * the difference can
@@ -128,11 +143,21 @@ public class TopKGeometricCentrality {
 			final int[] dist = this.dist;
 			final int[] degs = TopKGeometricCentrality.this.degs;
 			final Centrality centrality = this.centralityType;
-			final double kth = TopKGeometricCentrality.this.kth;
+			double kth = TopKGeometricCentrality.this.kth;
 			final double alpha = TopKGeometricCentrality.this.alpha;
 
 			LazyIntIterator iter;
 
+			if (centrality != Centrality.LIN) {
+				// Nodes at distance two are at most as many as the sum of the outdegrees of the successors
+				long s2 = 0;
+				iter = this.graph.successors(v);
+				while ((y = iter.nextInt()) != -1) s2 += degs[y];
+				final double r = reachU - 1, n1 = Math.min(gamma, r), n2 = Math.min(s2, r - n1), n3 = r - n1 - n2;
+				final double bound = centrality == Centrality.HARMONIC ? n1 + n2 / 2 + n3 / 3 : n1 * alpha + n2 * alpha * alpha + n3 * alpha * alpha * alpha;
+				if (kth > 0 && bound <= kth) return -1;
+			}
+
 			// We reset variables that were modified in previous BFSes.
 			for (int i = 0; i < nnVis; i++) dist[queue[i]] = -1;
 			nnVis = 0;
@@ -145,6 +170,8 @@ public class TopKGeometricCentrality {
 				iter = this.graph.successors(x);
 				if (dist[x] > d) {
 					d++;
+					// Other threads might have improved the bound in the meantime
+					kth = TopKGeometricCentrality.this.kth;
 					if (centrality == Centrality.LIN) {
 						tildefL = ((sumDist - gamma + (d + 2) * (reachL - nnVis))) / (reachL * reachL);
 						tildefU = ((sumDist - gamma + (d + 2) * (reachU - nnVis))) / (reachU * reachU);
@@ -266,14 +293,14 @@ public class TopKGeometricCentrality {
 	private final int reachL[], reachU[];
 	/** The degree of all vertices. */
 	private final int degs[];
-	/** List of all vertices sorted by degree. */
-	private final int sortedVertDeg[];
+	/** The vertices in the order in which they will be processed (by default, by decreasing degree). */
+	private int order[];
 	/** Number of vertices already processed. */
 	private int finishedVisits;
-	/** Vertex which is currently processed. */
-	private int currentV;
-	/** K-th biggest centrality found until now. */
-	private double kth;
+	/** The index in {@link #order} of the next vertex to be processed. */
+	private final AtomicInteger nextIndex;
+	/** K-th biggest centrality found until now; it is read without locking by all threads. */
+	private volatile double kth;
 	/** The number of visited edges. */
 	private long neVis;
 	/**
@@ -387,8 +414,78 @@ public class TopKGeometricCentrality {
 		for (int v = 0; v < nn; v++)
 			degs[v] = graph.outdegree(v);
 
-		sortedVertDeg = countingSort(degs);
-		currentV = nn - 1;
+		order = countingSort(degs);
+		IntArrays.reverse(order);
+		nextIndex = new AtomicInteger();
+	}
+
+	/**
+	 * Sets the order in which vertices are processed using estimates of their centrality.
+	 *
+	 * <p>Vertices are processed by decreasing estimated centrality. Since the bound used to cut visits is the <var>k</var>-th
+	 * largest centrality found so far, good estimates can reduce significantly the computation time. This method
+	 * must be called before {@link #compute()}.
+	 *
+	 * @param estimate an array containing an estimate of the centrality of each vertex.
+	 * @see #estimate(ImmutableGraph, Centrality, double, int, int, ProgressLogger)
+	 */
+	public void orderBy(final double[] estimate) {
+		if (estimate.length != nn) throw new IllegalArgumentException("The number of estimates (" + estimate.length + ") is not equal to the number of nodes (" + nn + ")");
+		final int[] order = new int[nn];
+		for (int i = nn; i-- != 0;) order[i] = i;
+		IntArrays.parallelQuickSort(order, (x, y) -> Double.compare(estimate[y], estimate[x]));
+		this.order = order;
+	}
+
+	/**
+	 * Estimates a positive geometric centrality using {@link HyperBall}.
+	 *
+	 * <p>The results of this method can be passed to {@link #orderBy(double[])}. A small number of registers per counter
+	 * (e.g., 16 or 32) is usually sufficient to order vertices effectively.
+	 *
+	 * @param g
+	 *            the input graph.
+	 * @param centralityType
+	 *            the type of centrality.
+	 * @param alpha
+	 *            the exponent (used only if {@code centrality} is {@link Centrality#EXPONENTIAL}).
+	 * @param log2m
+	 *            the logarithm of the number of registers per counter.
+	 * @param threads
+	 *            the number of threads, or 0 for {@link Runtime#availableProcessors()}.
+	 * @param pl
+	 *            a progress logger, or {@code null}.
+	 * @return an estimate of the centrality of each vertex.
+	 */
+	public static double[] estimate(final ImmutableGraph g, final Centrality centralityType, final double alpha, final int log2m, final int threads, final ProgressLogger pl) throws IOException {
+		final Int2DoubleFunction[] discountFunction = centralityType != Centrality.EXPONENTIAL ? null : new Int2DoubleFunction[] {
+			new HyperBall.AbstractDiscountFunction() {
+				@Override
+				public double get(final int distance) {
+					return Math.pow(alpha, distance);
+				}
+			}
+		};
+		final HyperBall hyperBall = new HyperBall(g, null, log2m, pl, threads, 0, 0, false, centralityType == Centrality.LIN, centralityType == Centrality.HARMONIC, discountFunction, Util.randomSeed());
+		hyperBall.init();
+		do hyperBall.iterate(); while (hyperBall.modified() != 0);
+
+		final int n = g.numNodes();
+		final double[] estimate = new double[n];
+		for (int i = n; i-- != 0;) {
+			switch(centralityType) {
+			case LIN:
+				estimate[i] = hyperBall.sumOfDistances[i] == 0 ? 1 : hyperBall.count(i) * hyperBall.count(i) / hyperBall.sumOfDistances[i];
+				break;
+			case HARMONIC:
+				estimate[i] = hyperBall.sumOfInverseDistances[i];
+				break;
+			default:
+				estimate[i] = hyperBall.discountedCentrality[0][i];
+			}
+		}
+		hyperBall.close();
+		return estimate;
 	}
 
 	/**
@@ -540,11 +637,9 @@ public class TopKGeometricCentrality {
 	 *
 	 * @return a vertex
 	 */
-	private synchronized int nextVert() {
-		if (currentV >= 0) {
-			return this.sortedVertDeg[currentV--];
-		}
-		return -1;
+	private int nextVert() {
+		final int i = nextIndex.getAndIncrement();
+		return i < nn ? order[i] : -1;
 	}
 
 	/**
@@ -619,6 +714,7 @@ public class TopKGeometricCentrality {
 			new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "0", JSAP.NOT_REQUIRED, 'T', "threads", "The number of threads to be used. If 0, the number will be estimated automatically."),
 			new FlaggedOption("logInterval", JSAP.LONG_PARSER, Long.toString(ProgressLogger.DEFAULT_LOG_INTERVAL), JSAP.NOT_REQUIRED, 'l', "log-interval", "The minimum time interval between activity logs in milliseconds."),
  			new FlaggedOption("alpha", JSAP.DOUBLE_PARSER, "0.5", JSAP.NOT_REQUIRED, 'a', "alpha", "The value of alpha for exponential centrality (ignored, otherwise)."),
+			new FlaggedOption("log2m", JSAP.INTEGER_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 'H', "hyperball", "If specified, vertices will be processed in the order of centralities estimated by HyperBall with this logarithm of the number of registers per counter."),
 			new UnflaggedOption("graphBasename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The basename of the graph."),
 			new UnflaggedOption("outputBasename", JSAP.STRING_PARSER, JSAP.NO_DEFAULT, JSAP.REQUIRED, JSAP.NOT_GREEDY, "The output basename."),
 		});
@@ -646,6 +742,7 @@ public class TopKGeometricCentrality {
 		final ProgressLogger pl = new ProgressLogger(LOGGER, logInterval, TimeUnit.MILLISECONDS, "nodes");
 
 		c = new TopKGeometricCentrality(g, k, centrality, threads, alpha, pl);
+		if (jsapResult.userSpecified("log2m")) c.orderBy(estimate(g, centrality, alpha, jsapResult.getInt("log2m"), threads, pl));
 		c.compute();
 
 		if (jsapResult.getBoolean("text")) {
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph.examples;
+
+import java.io.IOException;
+
+import org.apache.commons.math3.distribution.PoissonDistribution;
+import org.apache.commons.math3.distribution.ZipfDistribution;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import com.martiansoftware.jsap.FlaggedOption;
+import com.martiansoftware.jsap.JSAP;
+import com.martiansoftware.jsap.JSAPException;
+import com.martiansoftware.jsap.JSAPResult;
+import com.martiansoftware.jsap.Parameter;
+import com.martiansoftware.jsap.SimpleJSAP;
+import com.martiansoftware.jsap.Switch;
+import com.martiansoftware.jsap.UnflaggedOption;
+
+import it.unimi.dsi.Util;
+import it.unimi.dsi.fastutil.ints.IntOpenHashSet;
+import it.unimi.dsi.lang.ObjectParser;
+import it.unimi.dsi.logging.ProgressLogger;
+import it.unimi.dsi.util.XoRoShiRo128PlusRandomGenerator;
+import it.unimi.dsi.webgraph.BVGraph;
+
+/** A directed Chung&ndash;Lu random graph with Zipfian expected degrees.
+ *
+ * <p>In the Chung&ndash;Lu model each node has an expected outdegree and an expected indegree, and the
+ * number of arcs from <var>x</var> to <var>y</var> is proportional to the product of the expected outdegree of <var>x</var>
+ * and of the expected indegree of <var>y</var>. Here, as in the Zipfian counts generated by {@code genzipf.c},
+ * the expected degrees of node <var>x</var> are proportional to (<var>x</var> + 1)<sup>&minus;<var>s</var></sup>, where <var>s</var>
+ * is the exponent of the distribution; thus, node 0 has the largest degrees. Note that the resulting degree distribution is a power law with exponent
+ * 1 + 1 / <var>s</var>.
+ *
+ * <p>To make generation {@linkplain SeededRandomGraph parallel}, the outdegree of each node is a Poisson variable with mean
+ * its expected outdegree, and targets are chosen independently with probability proportional to their expected indegree
+ * using the rejection-inversion sampler of {@link ZipfDistribution}, so no table depending on the number of nodes is ever built.
+ * Duplicate arcs are generated only once, so the actual number of arcs will be smaller than <var>m</var>.
+ */
+public class ChungLuGraph extends SeededRandomGraph {
+	private final static Logger LOGGER = LoggerFactory.getLogger(ChungLuGraph.class);
+
+	/** The number of terms of a generalized harmonic number computed exactly. */
+	private static final int EXACT_TERMS = 1 << 16;
+
+	/** The expected number of arcs. */
+	private final long m;
+	/** The exponent of the Zipfian distribution of expected degrees. */
+	private final double exponent;
+	/** The generalized harmonic number of order {@link #exponent} of {@link SeededRandomGraph#n}. */
+	private final double harmonic;
+	/** Whether loops are allowed. */
+	private final boolean loops;
+
+	/** Creates a Chung&ndash;Lu graph with given parameters.
+	 *
+	 * @param n the number of nodes.
+	 * @param m the expected number of arcs (including duplicates).
+	 * @param exponent the (positive) exponent of the Zipfian distribution of expected degrees.
+	 * @param seed a seed for pseudorandom number generation.
+	 * @param loops whether loops are allowed or not.
+	 */
+	public ChungLuGraph(final int n, final long m, final double exponent, final long seed, final boolean loops) {
+		super(n, seed);
+		if (m < 0) throw new IllegalArgumentException("Illegal number of arcs: " + m);
+		if (exponent <= 0) throw new IllegalArgumentException("Illegal exponent: " + exponent);
+		if (n == 1 && ! loops && m > 0) throw new IllegalArgumentException("A graph with one node and no loops cannot have arcs");
+		this.m = m;
+		this.exponent = exponent;
+		this.loops = loops;
+		this.harmonic = harmonic(n, exponent);
+		LOGGER.debug("Generalized harmonic number: " + harmonic);
+	}
+
+	/** Creates a Chung&ndash;Lu graph with given parameters and random seed.
+	 *
+	 * @param n the number of nodes.
+	 * @param m the expected number of arcs (including duplicates).
+	 * @param exponent the (positive) exponent of the Zipfian distribution of expected degrees.
+	 */
+	public ChungLuGraph(final int n, final long m, final double exponent) {
+		this(n, m, exponent, Util.randomSeed(), false);
+	}
+
+	/** Creates a Chung&ndash;Lu graph with given parameters.
+	 *
+	 * <p>This constructor can be used with an {@link ObjectParser}.
+	 *
+	 * @param n the number of nodes.
+	 * @param m the expected number of arcs (including duplicates).
+	 * @param exponent the (positive) exponent of the Zipfian distribution of expected degrees.
+	 * @param seed a seed for pseudorandom number generation.
+	 * @param loops whether loops are allowed or not.
+	 */
+	public ChungLuGraph(final String n, final String m, final String exponent, final String seed, final String loops) {
+		this(Integer.parseInt(n), Long.parseLong(m), Double.parseDouble(exponent), Long.parseLong(seed), Boolean.parseBoolean(loops));
+	}
+
+	/** Computes the generalized harmonic number &Sigma;<sub>1&le;<var>r</var>&le;<var>n</var></sub> <var>r</var><sup>&minus;<var>s</var></sup>:
+	 * the first terms are summed exactly, and the remaining ones are approximated by the Euler&ndash;Maclaurin formula.
+	 *
+	 * @param n the number of terms.
+	 * @param s the exponent.
+	 * @return the generalized harmonic number of order {@code s} of {@code n}.
+	 */
+	private static double harmonic(final int n, final double s) {
+		final int k = Math.min(n, EXACT_TERMS);
+		double result = 0;
+		for(int r = k; r >= 1; r--) result += Math.pow(r, -s);
+		if (n == k) return result;
+		final double integral = s == 1 ? Math.log((double)n / k) : (Math.pow(n, 1 - s) - Math.pow(k, 1 - s)) / (1 - s);
+		return result + integral + (Math.pow(n, -s) - Math.pow(k, -s)) / 2 - s * (Math.pow(n, -s - 1) - Math.pow(k, -s - 1)) / 12;
+	}
+
+	@Override
+	protected void generate(final int x, final XoRoShiRo128PlusRandomGenerator random, final IntOpenHashSet successors) {
+		final double mean = m * Math.pow(x + 1, -exponent) / harmonic;
+		if (mean == 0) return;
+		final int outdegree = new PoissonDistribution(random, mean, PoissonDistribution.DEFAULT_EPSILON, PoissonDistribution.DEFAULT_MAX_ITERATIONS).sample();
+		if (outdegree == 0) return;
+		final ZipfDistribution zipf = new ZipfDistribution(random, n, exponent);
+		for(int k = 0; k < outdegree; k++) {
+			int y;
+			do y = zipf.sample() - 1; while(! loops && y == x);
+			successors.add(y);
+		}
+	}
+
+	public static void main(final String arg[]) throws IOException, JSAPException {
+		final SimpleJSAP jsap = new SimpleJSAP(ChungLuGraph.class.getName(), "Generates in parallel a Chung-Lu random graph with Zipfian expected degrees and stores it as a BVGraph.",
+				new Parameter[] {
+			new Switch("loops", 'l', "loops", "Whether the graph should include self-loops."),
+			new FlaggedOption("exponent", JSAP.DOUBLE_PARSER, "1", JSAP.NOT_REQUIRED, 'e', "exponent", "The exponent of the Zipfian distribution of expected degrees."),
+			new FlaggedOption("seed", JSAP.LONG_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 's', "seed", "The random seed."),
+			new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "0", JSAP.NOT_REQUIRED, 't', "threads", "The number of threads (0 for the number of available processors)."),
+			new UnflaggedOption("basename", JSAP.STRING_PARSER, JSAP.REQUIRED, "The basename of the output graph file."),
+			new UnflaggedOption("n", JSAP.INTEGER_PARSER, JSAP.REQUIRED, "The number of nodes."),
+			new UnflaggedOption("m", JSAP.LONGSIZE_PARSER, JSAP.REQUIRED, "The expected number of arcs (including duplicates)."),
+		});
+		final JSAPResult jsapResult = jsap.parse(arg);
+		if (jsap.messagePrinted()) System.exit(1);
+
+		final long seed = jsapResult.userSpecified("seed") ? jsapResult.getLong("seed") : Util.randomSeed();
+		BVGraph.store(new ChungLuGraph(jsapResult.getInt("n"), jsapResult.getLong("m"), jsapResult.getDouble("exponent"), seed, jsapResult.getBoolean("loops")),
+				jsapResult.getString("basename"), jsapResult.getInt("threads"), new ProgressLogger(LOGGER));
+	}
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph.examples;
+
+import java.io.IOException;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import com.martiansoftware.jsap.FlaggedOption;
+import com.martiansoftware.jsap.JSAP;
+import com.martiansoftware.jsap.JSAPException;
+import com.martiansoftware.jsap.JSAPResult;
+import com.martiansoftware.jsap.Parameter;
+import com.martiansoftware.jsap.SimpleJSAP;
+import com.martiansoftware.jsap.UnflaggedOption;
+
+import it.unimi.dsi.Util;
+import it.unimi.dsi.fastutil.ints.IntOpenHashSet;
+import it.unimi.dsi.lang.ObjectParser;
+import it.unimi.dsi.logging.ProgressLogger;
+import it.unimi.dsi.util.XoRoShiRo128PlusRandomGenerator;
+import it.unimi.dsi.webgraph.BVGraph;
+
+/** A random graph generated by the (linear) copying model.
+ *
+ * <p>In the copying model (Ravi Kumar, Prabhakar Raghavan, Sridhar Rajagopalan, D. Sivakumar, Andrew Tomkins, and Eli Upfal,
+ * &ldquo;Stochastic models for the web graph&rdquo;, <i>Proc. FOCS 2000</i>), nodes are added one at a time, and each new node <var>x</var>
+ * chooses uniformly a <em>prototype</em> among the previous nodes. Then, each of the <var>d</var> arcs of <var>x</var> points,
+ * with probability &alpha;, to a node chosen uniformly among the previous nodes, and otherwise it copies the corresponding
+ * arc of the prototype. Node 0 has no successors, so arcs copied from node 0 are chosen uniformly, too. The resulting indegree
+ * distribution is a power law with exponent (2 &minus; &alpha;) / (1 &minus; &alpha;), and successor lists show the similarity
+ * that makes web graphs compressible.
+ *
+ * <p>Albeit the model is inherently sequential, all choices are computed by {@linkplain SeededRandomGraph#hash(long) hashing}
+ * the seed of the graph with a node and an arc index, so the target of an arc can be recomputed by following the chain of
+ * prototypes, whose expected length is 1 / &alpha;. Thus, successor lists can be {@linkplain SeededRandomGraph generated in parallel}.
+ * Duplicate arcs are generated only once, so outdegrees can be smaller than <var>d</var>.
+ */
+public class CopyingModelGraph extends SeededRandomGraph {
+	private final static Logger LOGGER = LoggerFactory.getLogger(CopyingModelGraph.class);
+
+	/** The default probability of choosing a uniform target instead of copying. */
+	public static final double DEFAULT_ALPHA = .5;
+
+	/** The number of arcs generated for each node. */
+	private final int d;
+	/** The probability of choosing a uniform target instead of copying. */
+	private final double alpha;
+
+	/** Creates a copying-model graph with given parameters.
+	 *
+	 * @param n the number of nodes.
+	 * @param d the number of arcs generated for each node (except for node 0).
+	 * @param alpha the probability of choosing a uniform target instead of copying.
+	 * @param seed a seed for pseudorandom number generation.
+	 */
+	public CopyingModelGraph(final int n, final int d, final double alpha, final long seed) {
+		super(n, seed);
+		if (d < 0) throw new IllegalArgumentException("Illegal number of arcs per node: " + d);
+		if (alpha <= 0 || alpha > 1) throw new IllegalArgumentException("Illegal probability: " + alpha);
+		this.d = d;
+		this.alpha = alpha;
+	}
+
+	/** Creates a copying-model graph with given parameters, default probability of uniform choice and random seed.
+	 *
+	 * @param n the number of nodes.
+	 * @param d the number of arcs generated for each node (except for node 0).
+	 */
+	public CopyingModelGraph(final int n, final int d) {
+		this(n, d, DEFAULT_ALPHA, Util.randomSeed());
+	}
+
+	/** Creates a copying-model graph with given parameters.
+	 *
+	 * <p>This constructor can be used with an {@link ObjectParser}.
+	 *
+	 * @param n the number of nodes.
+	 * @param d the number of arcs generated for each node (except for node 0).
+	 * @param alpha the probability of choosing a uniform target instead of copying.
+	 * @param seed a seed for pseudorandom number generation.
+	 */
+	public CopyingModelGraph(final String n, final String d, final String alpha, final String seed) {
+		this(Integer.parseInt(n), Integer.parseInt(d), Double.parseDouble(alpha), Long.parseLong(seed));
+	}
+
+	/** Maps a 64-bit hash to a uniformly chosen node smaller than a given bound.
+	 *
+	 * @param hash a 64-bit hash.
+	 * @param bound a positive bound.
+	 * @return a node in [0..{@code bound}).
+	 */
+	private static int uniform(final long hash, final int bound) {
+		return (int)((hash >>> 33) * bound >>> 31);
+	}
+
+	/** Returns the prototype of a node.
+	 *
+	 * @param x a positive node.
+	 * @return the prototype of {@code x}.
+	 */
+	private int prototype(final int x) {
+		return uniform(hash((long)x << 32 | 0xFFFFFFFFL), x);
+	}
+
+	@Override
+	protected void generate(final int x, final XoRoShiRo128PlusRandomGenerator random, final IntOpenHashSet successors) {
+		if (x == 0) return;
+		for(int i = 0; i < d; i++) {
+			// We follow the chain of prototypes until we find a node that chooses the i-th arc uniformly
+			for(int z = x;;) {
+				final long h = hash((long)z << 32 | i);
+				final int p;
+				if ((h >>> 11) * 0x1.0p-53 < alpha || (p = prototype(z)) == 0) {
+					successors.add(uniform(hash(~((long)z << 32 | i)), z));
+					break;
+				}
+				z = p;
+			}
+		}
+	}
+
+	public static void main(final String arg[]) throws IOException, JSAPException {
+		final SimpleJSAP jsap = new SimpleJSAP(CopyingModelGraph.class.getName(), "Generates in parallel a random graph using the copying model and stores it as a BVGraph.",
+				new Parameter[] {
+			new FlaggedOption("alpha", JSAP.DOUBLE_PARSER, Double.toString(DEFAULT_ALPHA), JSAP.NOT_REQUIRED, 'a', "alpha", "The probability of choosing a uniform target instead of copying."),
+			new FlaggedOption("seed", JSAP.LONG_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 's', "seed", "The random seed."),
+			new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "0", JSAP.NOT_REQUIRED, 't', "threads", "The number of threads (0 for the number of available processors)."),
+			new UnflaggedOption("basename", JSAP.STRING_PARSER, JSAP.REQUIRED, "The basename of the output graph file."),
+			new UnflaggedOption("n", JSAP.INTEGER_PARSER, JSAP.REQUIRED, "The number of nodes."),
+			new UnflaggedOption("d", JSAP.INTEGER_PARSER, JSAP.REQUIRED, "The number of arcs generated for each node."),
+		});
+		final JSAPResult jsapResult = jsap.parse(arg);
+		if (jsap.messagePrinted()) System.exit(1);
+
+		final long seed = jsapResult.userSpecified("seed") ? jsapResult.getLong("seed") : Util.randomSeed();
+		BVGraph.store(new CopyingModelGraph(jsapResult.getInt("n"), jsapResult.getInt("d"), jsapResult.getDouble("alpha"), seed),
+				jsapResult.getString("basename"), jsapResult.getInt("threads"), new ProgressLogger(LOGGER));
+	}
+}
@@ -32,11 +32,14 @@ import it.unimi.dsi.fastutil.ints.IntArrays;
 import it.unimi.dsi.fastutil.io.TextIO;
 import it.unimi.dsi.logging.ProgressLogger;
 import it.unimi.dsi.webgraph.GraphClassParser;
+import it.unimi.dsi.webgraph.GraphSketch;
 import it.unimi.dsi.webgraph.ImmutableGraph;
 import it.unimi.dsi.webgraph.NodeIterator;
 
 /** The main method of this class loads an arbitrary {@link it.unimi.dsi.webgraph.ImmutableGraph}
  * and performs a sequential scan to establish the minimum, maximum and average outdegree.
+ *
+ * <p>If an up-to-date {@linkplain GraphSketch sketch} of the graph is available, the scan is skipped.
  */
 
 public class OutdegreeStats {
@@ -65,6 +68,17 @@ public class OutdegreeStats {
 		if (graphClass != null) graph = (ImmutableGraph)graphClass.getMethod("loadOffline", CharSequence.class).invoke(null, basename);
 		else graph = ImmutableGraph.loadOffline(basename, pl);
 
+		final GraphSketch sketch = GraphSketch.load(graph);
+		if (sketch != null) {
+			// A sketch is available: no need to scan the graph
+			System.err.println("The minimum outdegree is " + sketch.minOutdegree() + ", attained by node " + sketch.minOutdegreeNode);
+			System.err.println("The maximum outdegree is " + sketch.maxOutdegree() + ", attained by node " + sketch.maxOutdegreeNode);
+			System.err.println("The average outdegree is " + (double)sketch.numArcs / sketch.numNodes);
+
+			TextIO.storeInts(sketch.outdegreeDistribution, 0, sketch.outdegreeDistribution.length, System.out);
+			return;
+		}
+
 		final NodeIterator nodeIterator = graph.nodeIterator();
 		int count[] = IntArrays.EMPTY_ARRAY;
 		int curr, d, maxd = 0, maxNode = 0, mind = Integer.MAX_VALUE, minNode = 0;
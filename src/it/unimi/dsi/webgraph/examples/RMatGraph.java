@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph.examples;
+
+import java.io.IOException;
+
+import org.apache.commons.math3.distribution.PoissonDistribution;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import com.martiansoftware.jsap.FlaggedOption;
+import com.martiansoftware.jsap.JSAP;
+import com.martiansoftware.jsap.JSAPException;
+import com.martiansoftware.jsap.JSAPResult;
+import com.martiansoftware.jsap.Parameter;
+import com.martiansoftware.jsap.SimpleJSAP;
+import com.martiansoftware.jsap.Switch;
+import com.martiansoftware.jsap.UnflaggedOption;
+
+import it.unimi.dsi.Util;
+import it.unimi.dsi.bits.Fast;
+import it.unimi.dsi.fastutil.ints.IntOpenHashSet;
+import it.unimi.dsi.lang.ObjectParser;
+import it.unimi.dsi.logging.ProgressLogger;
+import it.unimi.dsi.util.XoRoShiRo128PlusRandomGenerator;
+import it.unimi.dsi.webgraph.BVGraph;
+
+/** An R-MAT (recursive matrix, or stochastic Kronecker) random graph.
+ *
+ * <p>In the R-MAT model (Deepayan Chakrabarti, Yiping Zhan, and Christos Faloutsos, &ldquo;R-MAT: A Recursive Model for Graph Mining&rdquo;,
+ * <i>Proc. SDM 2004</i>), the adjacency matrix of a graph with 2<sup><var>k</var></sup> nodes is recursively divided into four quadrants,
+ * and each arc is placed by choosing, at each of the <var>k</var> levels, the upper-left, upper-right, lower-left or lower-right quadrant
+ * with probability <var>a</var>, <var>b</var>, <var>c</var> and <var>d</var> = 1 &minus; <var>a</var> &minus; <var>b</var> &minus; <var>c</var>, respectively.
+ *
+ * <p>To make generation {@linkplain SeededRandomGraph parallel}, this class generates arcs node by node: the number of arcs
+ * leaving node <var>x</var> is a Poisson variable with mean <var>m</var> times the probability that an R-MAT arc has source <var>x</var>,
+ * and the bits of the target of each arc are chosen using the conditional probabilities given the bits of <var>x</var>
+ * (<var>b</var> / (<var>a</var> + <var>b</var>) or <var>d</var> / (<var>c</var> + <var>d</var>)).
+ * This is equivalent to the standard model, in which the number of arcs would be exactly <var>m</var> rather than Poisson distributed.
+ * If the number of nodes is not a power of two, the probabilities are conditioned on the source and the target being smaller than the number of nodes.
+ * Duplicate arcs are generated only once, so the actual number of arcs will be smaller than <var>m</var>.
+ *
+ * <p>With some parameters a node might be able to generate only invalid targets (e.g., if <var>b</var> = 0 and loops are not allowed,
+ * node 0 can generate only loops): arcs whose target is still invalid after {@link #MAX_ATTEMPTS} attempts are discarded.
+ */
+public class RMatGraph extends SeededRandomGraph {
+	private final static Logger LOGGER = LoggerFactory.getLogger(RMatGraph.class);
+
+	/** The default probability of the upper-left quadrant. */
+	public static final double DEFAULT_A = .57;
+	/** The default probability of the upper-right quadrant. */
+	public static final double DEFAULT_B = .19;
+	/** The default probability of the lower-left quadrant. */
+	public static final double DEFAULT_C = .19;
+
+	/** The maximum number of attempts at generating a valid target for an arc. */
+	public static final int MAX_ATTEMPTS = 1000;
+
+	/** The expected number of arcs. */
+	private final long m;
+	/** The probabilities of the four quadrants. */
+	private final double a, b, c, d;
+	/** The number of levels of recursion. */
+	private final int levels;
+	/** The probability that an R-MAT arc has source smaller than {@link SeededRandomGraph#n}. */
+	private final double sourceProbability;
+	/** Whether loops are allowed. */
+	private final boolean loops;
+
+	/** Creates an R-MAT graph with given parameters.
+	 *
+	 * @param n the number of nodes.
+	 * @param m the expected number of arcs (including duplicates).
+	 * @param a the probability of the upper-left quadrant.
+	 * @param b the probability of the upper-right quadrant.
+	 * @param c the probability of the lower-left quadrant.
+	 * @param seed a seed for pseudorandom number generation.
+	 * @param loops whether loops are allowed or not.
+	 */
+	public RMatGraph(final int n, final long m, final double a, final double b, final double c, final long seed, final boolean loops) {
+		super(n, seed);
+		if (m < 0) throw new IllegalArgumentException("Illegal number of arcs: " + m);
+		if (a <= 0 || b < 0 || c < 0 || a + b + c > 1) throw new IllegalArgumentException("Illegal quadrant probabilities: " + a + ", " + b + ", " + c);
+		if (n == 1 && ! loops && m > 0) throw new IllegalArgumentException("A graph with one node and no loops cannot have arcs");
+		this.m = m;
+		this.a = a;
+		this.b = b;
+		this.c = c;
+		this.d = 1 - a - b - c;
+		this.loops = loops;
+		levels = n <= 1 ? 0 : Fast.ceilLog2(n);
+		sourceProbability = prefixProbability(n, a + b, c + this.d);
+		LOGGER.debug("Probability of a valid source: " + sourceProbability);
+	}
+
+	/** Creates an R-MAT graph with given parameters and default quadrant probabilities.
+	 *
+	 * @param n the number of nodes.
+	 * @param m the expected number of arcs (including duplicates).
+	 * @param seed a seed for pseudorandom number generation.
+	 * @param loops whether loops are allowed or not.
+	 */
+	public RMatGraph(final int n, final long m, final long seed, final boolean loops) {
+		this(n, m, DEFAULT_A, DEFAULT_B, DEFAULT_C, seed, loops);
+	}
+
+	/** Creates an R-MAT graph with given parameters, default quadrant probabilities and random seed.
+	 *
+	 * @param n the number of nodes.
+	 * @param m the expected number of arcs (including duplicates).
+	 */
+	public RMatGraph(final int n, final long m) {
+		this(n, m, Util.randomSeed(), false);
+	}
+
+	/** Creates an R-MAT graph with given parameters and default quadrant probabilities.
+	 *
+	 * <p>This constructor can be used with an {@link ObjectParser}.
+	 *
+	 * @param n the number of nodes.
+	 * @param m the expected number of arcs (including duplicates).
+	 * @param seed a seed for pseudorandom number generation.
+	 * @param loops whether loops are allowed or not.
+	 */
+	public RMatGraph(final String n, final String m, final String seed, final String loops) {
+		this(Integer.parseInt(n), Long.parseLong(m), Long.parseLong(seed), Boolean.parseBoolean(loops));
+	}
+
+	/** Returns the probability that a node chosen bit by bit, from the most significant one, with probability
+	 * <var>p0</var> of a zero and <var>p1</var> of a one is smaller than a given bound.
+	 *
+	 * @param bound a bound.
+	 * @param p0 the probability of a zero.
+	 * @param p1 the probability of a one.
+	 * @return the probability that the chosen node is smaller than {@code bound}.
+	 */
+	private double prefixProbability(final int bound, final double p0, final double p1) {
+		if (bound == 1 << levels) return 1;
+		double result = 0, prefix = 1;
+		for(int i = levels; i-- != 0;) {
+			if ((bound & 1 << i) != 0) {
+				result += prefix * p0;
+				prefix *= p1;
+			}
+			else prefix *= p0;
+		}
+		return result;
+	}
+
+	@Override
+	protected void generate(final int x, final XoRoShiRo128PlusRandomGenerator random, final IntOpenHashSet successors) {
+		// The probability that an R-MAT arc has source x, conditioned on the source being valid
+		double p = 1 / sourceProbability;
+		for(int i = levels; i-- != 0;) p *= (x & 1 << i) == 0 ? a + b : c + d;
+		final double mean = m * p;
+		if (mean == 0) return;
+		final int outdegree = new PoissonDistribution(random, mean, PoissonDistribution.DEFAULT_EPSILON, PoissonDistribution.DEFAULT_MAX_ITERATIONS).sample();
+
+		final double q0 = b / (a + b), q1 = d / (c + d);
+		for(int k = 0; k < outdegree; k++) {
+			int y, attempts = 0;
+			do {
+				y = 0;
+				for(int i = levels; i-- != 0;) if (random.nextDouble() < ((x & 1 << i) == 0 ? q0 : q1)) y |= 1 << i;
+			} while((y >= n || ! loops && y == x) && ++attempts < MAX_ATTEMPTS);
+			// If all attempts failed, we discard the arc
+			if (attempts < MAX_ATTEMPTS) successors.add(y);
+		}
+	}
+
+	public static void main(final String arg[]) throws IOException, JSAPException {
+		final SimpleJSAP jsap = new SimpleJSAP(RMatGraph.class.getName(), "Generates in parallel an R-MAT random graph and stores it as a BVGraph.",
+				new Parameter[] {
+			new Switch("loops", 'l', "loops", "Whether the graph should include self-loops."),
+			new FlaggedOption("a", JSAP.DOUBLE_PARSER, Double.toString(DEFAULT_A), JSAP.NOT_REQUIRED, 'a', "a", "The probability of the upper-left quadrant."),
+			new FlaggedOption("b", JSAP.DOUBLE_PARSER, Double.toString(DEFAULT_B), JSAP.NOT_REQUIRED, 'b', "b", "The probability of the upper-right quadrant."),
+			new FlaggedOption("c", JSAP.DOUBLE_PARSER, Double.toString(DEFAULT_C), JSAP.NOT_REQUIRED, 'c', "c", "The probability of the lower-left quadrant."),
+			new FlaggedOption("seed", JSAP.LONG_PARSER, JSAP.NO_DEFAULT, JSAP.NOT_REQUIRED, 's', "seed", "The random seed."),
+			new FlaggedOption("threads", JSAP.INTSIZE_PARSER, "0", JSAP.NOT_REQUIRED, 't', "threads", "The number of threads (0 for the number of available processors)."),
+			new UnflaggedOption("basename", JSAP.STRING_PARSER, JSAP.REQUIRED, "The basename of the output graph file."),
+			new UnflaggedOption("n", JSAP.INTEGER_PARSER, JSAP.REQUIRED, "The number of nodes."),
+			new UnflaggedOption("m", JSAP.LONGSIZE_PARSER, JSAP.REQUIRED, "The expected number of arcs (including duplicates)."),
+		});
+		final JSAPResult jsapResult = jsap.parse(arg);
+		if (jsap.messagePrinted()) System.exit(1);
+
+		final long seed = jsapResult.userSpecified("seed") ? jsapResult.getLong("seed") : Util.randomSeed();
+		BVGraph.store(new RMatGraph(jsapResult.getInt("n"), jsapResult.getLong("m"), jsapResult.getDouble("a"), jsapResult.getDouble("b"), jsapResult.getDouble("c"), seed, jsapResult.getBoolean("loops")),
+				jsapResult.getString("basename"), jsapResult.getInt("threads"), new ProgressLogger(LOGGER));
+	}
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph.examples;
+
+import java.util.Arrays;
+import java.util.NoSuchElementException;
+
+import it.unimi.dsi.fastutil.HashCommon;
+import it.unimi.dsi.fastutil.ints.IntArrays;
+import it.unimi.dsi.fastutil.ints.IntOpenHashSet;
+import it.unimi.dsi.util.XoRoShiRo128PlusRandomGenerator;
+import it.unimi.dsi.webgraph.ImmutableSequentialGraph;
+import it.unimi.dsi.webgraph.NodeIterator;
+
+/** An abstract random graph whose successor lists are generated independently for each node.
+ *
+ * <p>Before generating the successors of a node, the pseudorandom number generator passed to
+ * {@link #generate(int, XoRoShiRo128PlusRandomGenerator, IntOpenHashSet)} is reseeded using the seed
+ * of the graph and the node. As a consequence, the successors of a node depend only on the seed and on the node,
+ * node iterators can start from any node in constant time, and they are {@linkplain #hasCopiableIterators() copiable}:
+ * {@link #splitNodeIterators(int)} returns iterators on disjoint segments of nodes, so that, for example,
+ * {@link it.unimi.dsi.webgraph.BVGraph#store(it.unimi.dsi.webgraph.ImmutableGraph, CharSequence, int, it.unimi.dsi.logging.ProgressLogger)}
+ * will generate and compress the graph in parallel, without ever materializing a list of arcs. The graph generated is the same
+ * irrespective of the number of threads.
+ */
+
+public abstract class SeededRandomGraph extends ImmutableSequentialGraph {
+	/** The number of nodes. */
+	protected final int n;
+	/** The seed of the graph. */
+	protected final long seed;
+
+	/** Creates a new random graph.
+	 *
+	 * @param n the number of nodes.
+	 * @param seed the seed of the graph.
+	 */
+	protected SeededRandomGraph(final int n, final long seed) {
+		if (n < 0) throw new IllegalArgumentException("Illegal number of nodes: " + n);
+		this.n = n;
+		this.seed = seed;
+	}
+
+	/** Generates the successors of a node.
+	 *
+	 * <p>Implementations must be thread safe, and must use only {@code random} as a source of randomness.
+	 *
+	 * @param x a node.
+	 * @param random a pseudorandom number generator that has been reseeded for {@code x}.
+	 * @param successors an empty set that must be filled with the successors of {@code x}.
+	 */
+	protected abstract void generate(int x, XoRoShiRo128PlusRandomGenerator random, IntOpenHashSet successors);
+
+	/** Returns a 64-bit hash of the seed of this graph and of a given key, which can be used in place of a pseudorandom
+	 * number generator when a random choice must be recomputed independently of the order of generation.
+	 *
+	 * @param key a key.
+	 * @return a 64-bit hash of the seed of this graph and of {@code key}.
+	 */
+	protected long hash(final long key) {
+		return HashCommon.murmurHash3(seed + HashCommon.murmurHash3(key + 0x9E3779B97F4A7C15L));
+	}
+
+	@Override
+	public int numNodes() {
+		return n;
+	}
+
+	@Override
+	public SeededRandomGraph copy() {
+		return this;
+	}
+
+	@Override
+	public boolean hasCopiableIterators() {
+		return true;
+	}
+
+	@Override
+	public NodeIterator nodeIterator() {
+		return nodeIterator(0);
+	}
+
+	@Override
+	public NodeIterator nodeIterator(final int from) {
+		return new SeededRandomGraphNodeIterator(from - 1, n, IntArrays.EMPTY_ARRAY, 0);
+	}
+
+	@Override
+	public NodeIterator[] splitNodeIterators(final int howMany) {
+		if (howMany < 1) throw new IllegalArgumentException();
+		final NodeIterator[] result = new NodeIterator[howMany];
+		final int m = (int)Math.ceil((double)n / howMany);
+		int i = 0;
+		for(long from = 0; from < n; from += m) result[i++] = new SeededRandomGraphNodeIterator((int)from - 1, (int)Math.min(n, from + m), IntArrays.EMPTY_ARRAY, 0);
+		Arrays.fill(result, i, result.length, NodeIterator.EMPTY);
+		return result;
+	}
+
+	private final class SeededRandomGraphNodeIterator extends NodeIterator {
+		/** The pseudorandom number generator, reseeded at each node. */
+		private final XoRoShiRo128PlusRandomGenerator random = new XoRoShiRo128PlusRandomGenerator(0);
+		/** The set used to deduplicate successors. */
+		private final IntOpenHashSet successors = new IntOpenHashSet();
+		/** The node following the last node to be returned. */
+		private final int to;
+		/** The current node. */
+		private int curr;
+		/** The successors of {@link #curr}. */
+		private int[] successorArray;
+		/** The outdegree of {@link #curr}. */
+		private int outdegree;
+
+		private SeededRandomGraphNodeIterator(final int curr, final int to, final int[] successorArray, final int outdegree) {
+			this.curr = curr;
+			this.to = to;
+			this.successorArray = successorArray;
+			this.outdegree = outdegree;
+		}
+
+		@Override
+		public boolean hasNext() {
+			return curr < to - 1;
+		}
+
+		@Override
+		public int nextInt() {
+			if (! hasNext()) throw new NoSuchElementException();
+			curr++;
+			random.setSeed(hash(curr));
+			successors.clear();
+			// Clearing costs as much as the capacity of the set, so we shrink it after large successor lists
+			if (outdegree > 1 << 10) successors.trim();
+			generate(curr, random, successors);
+			outdegree = successors.size();
+			successorArray = IntArrays.grow(successorArray, outdegree);
+			successors.toArray(successorArray);
+			IntArrays.quickSort(successorArray, 0, outdegree);
+			return curr;
+		}
+
+		@Override
+		public int outdegree() {
+			return outdegree;
+		}
+
+		@Override
+		public int[] successorArray() {
+			return successorArray;
+		}
+
+		@Override
+		public NodeIterator copy(final int upperBound) {
+			return new SeededRandomGraphNodeIterator(curr, Math.min(to, upperBound), Arrays.copyOf(successorArray, outdegree), outdegree);
+		}
+	}
+}
@@ -17,11 +17,16 @@
 
 package it.unimi.dsi.webgraph;
 
+import static org.junit.Assert.assertArrayEquals;
 import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
 
 import java.io.File;
 import java.io.FileInputStream;
 import java.io.IOException;
+import java.io.RandomAccessFile;
+import java.nio.file.Files;
 import java.util.Arrays;
 import java.util.Properties;
 import java.util.zip.GZIPInputStream;
@@ -29,9 +34,14 @@ import java.util.zip.GZIPInputStream;
 import org.junit.Test;
 
 import it.unimi.dsi.bits.Fast;
+import it.unimi.dsi.fastutil.ints.IntIterator;
+import it.unimi.dsi.fastutil.ints.IntOpenHashSet;
 import it.unimi.dsi.fastutil.io.BinIO;
 import it.unimi.dsi.fastutil.io.FastByteArrayInputStream;
 import it.unimi.dsi.fastutil.io.FastByteArrayOutputStream;
+import it.unimi.dsi.io.InputBitStream;
+import it.unimi.dsi.util.XoRoShiRo128PlusRandom;
+import it.unimi.dsi.webgraph.examples.ErdosRenyiGraph;
 
 public class BVGraphTest extends WebGraphTestCase {
 
@@ -226,4 +236,261 @@ public class BVGraphTest extends WebGraphTestCase {
 		assertEquals(d, g.outdegree(0));
 		assertEquals(g, h);
 	}
+
+	@Test
+	public void testAppend() throws IOException {
+		final int n = 1000;
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(n, .01, 0, false)).immutableView();
+		for(final int k : new int[] { 0, 1, 10, 500, 999, 1000 }) {
+			// The first k nodes of g, restricted to arcs among them
+			final ArrayListMutableGraph prefix = new ArrayListMutableGraph(k);
+			// The first k nodes of prefix, followed by the remaining nodes of g
+			final ArrayListMutableGraph extended = new ArrayListMutableGraph(n);
+			for(int x = 0; x < n; x++)
+				for(final int y : g.successorArray(x)) {
+					if (x >= k) extended.addArc(x, y);
+					else if (y < k) {
+						prefix.addArc(x, y);
+						extended.addArc(x, y);
+					}
+				}
+
+			for(final int w : new int[] { 0, 1, 3, 7 })
+				for(final int r : new int[] { 1, 3 }) {
+					System.err.println("Testing k=" + k + ", w=" + w + ", r=" + r + "...");
+					final File basename = storeTempGraph(prefix.immutableView(), w, r, 2, 0);
+					BVGraph.append(basename.toString(), extended.immutableView(), null);
+					assertEquals(extended.immutableView(), BVGraph.load(basename.toString()));
+					final BVGraph mapped = BVGraph.loadMapped(basename.toString());
+					assertTrue(mapped.offsets instanceof MappedEliasFanoMonotoneLongBigList);
+					assertEquals(extended.immutableView(), mapped);
+					assertEquals(GraphFingerprint.compute(extended.immutableView(), GraphFingerprint.loadKey(basename.toString())), GraphFingerprint.load(basename.toString()));
+
+					// The result must be identical to a single-threaded compression
+					final File reference = File.createTempFile(BVGraphTest.class.getSimpleName(), "test");
+					BVGraph.store(extended.immutableView(), reference.toString(), w, r, 2, 3, 0, 1);
+					assertArrayEquals(Files.readAllBytes(new File(reference + BVGraph.GRAPH_EXTENSION).toPath()), Files.readAllBytes(new File(basename + BVGraph.GRAPH_EXTENSION).toPath()));
+					assertArrayEquals(Files.readAllBytes(new File(reference + BVGraph.OFFSETS_EXTENSION).toPath()), Files.readAllBytes(new File(basename + BVGraph.OFFSETS_EXTENSION).toPath()));
+					// The length of the offsets stream is updated without scanning
+					final Properties properties = new Properties(), referenceProperties = new Properties();
+					try (FileInputStream propertyFile = new FileInputStream(basename + BVGraph.PROPERTIES_EXTENSION)) { properties.load(propertyFile); }
+					try (FileInputStream propertyFile = new FileInputStream(reference + BVGraph.PROPERTIES_EXTENSION)) { referenceProperties.load(propertyFile); }
+					assertEquals(referenceProperties.getProperty("offsetsbits"), properties.getProperty("offsetsbits"));
+					deleteGraph(basename);
+					deleteGraph(reference);
+				}
+		}
+	}
+
+	@Test
+	public void testConcurrentRandomAccess() throws IOException, InterruptedException {
+		final int n = 2000;
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(n, .01, 0, false)).immutableView();
+		final int[][] successors = new int[n][];
+		for(int x = 0; x < n; x++) successors[x] = Arrays.copyOf(g.successorArray(x), g.outdegree(x));
+		final File basename = storeTempGraph(g, 7, 3, 2, 0);
+		for(final BVGraph h : new BVGraph[] { BVGraph.load(basename.toString()), BVGraph.loadMapped(basename.toString()) }) {
+			// All threads share the same instance, without copies
+			final Thread[] thread = new Thread[16];
+			final Throwable[] problem = new Throwable[thread.length];
+			for(int t = 0; t < thread.length; t++) {
+				final int index = t;
+				thread[t] = new Thread(() -> {
+					try {
+						final XoRoShiRo128PlusRandom random = new XoRoShiRo128PlusRandom(index);
+						for(int i = 0; i < 20000; i++) {
+							final int x = random.nextInt(n);
+							assertEquals(successors[x].length, h.outdegree(x));
+							assertArrayEquals(successors[x], LazyIntIterators.unwrap(h.successors(x)));
+							if ((i & 1) != 0) assertArrayEquals(successors[x], Arrays.copyOf(h.successorArray(x), successors[x].length));
+						}
+					}
+					catch(final Throwable e) {
+						problem[index] = e;
+					}
+				});
+				thread[t].start();
+			}
+			for(final Thread t : thread) t.join();
+			for(final Throwable e : problem) if (e != null) throw new AssertionError(e);
+		}
+		deleteGraph(basename);
+	}
+
+	@Test
+	public void testOutdegreeIndex() throws IOException {
+		final int n = 1000;
+		final ArrayListMutableGraph mutable = new ArrayListMutableGraph(new ErdosRenyiGraph(n, .01, 0, false));
+		// A hub, so that balanced splits differ from uniform ones
+		final IntOpenHashSet hubSuccessors = new IntOpenHashSet(mutable.immutableView().successorArray(10), 0, mutable.immutableView().outdegree(10));
+		for(int y = 0; y < n; y++) if (y != 10 && ! hubSuccessors.contains(y)) mutable.addArc(10, y);
+		final ImmutableGraph g = mutable.immutableView();
+		final File basename = File.createTempFile(BVGraphTest.class.getSimpleName(), "test");
+		BVGraph.store(g, basename.toString(), -1, -1, -1, -1, 0, 2, false, true, null);
+
+		final OutdegreeIndex index = OutdegreeIndex.load(basename.toString());
+		assertEquals(n, index.numNodes);
+		assertEquals(g.numArcs(), index.numArcs);
+		long arcs = 0;
+		for(int x = 0; x < n; x++) {
+			assertEquals(g.outdegree(x), index.outdegree(x));
+			assertEquals(arcs, index.cumulativeOutdegree(x));
+			for(int d = g.outdegree(x); d-- != 0;) assertEquals(x, index.node(arcs++));
+		}
+
+		for(final BVGraph h : new BVGraph[] { BVGraph.load(basename.toString()), BVGraph.loadMapped(basename.toString()) }) {
+			assertEquals(g, h);
+			for(int x = 0; x < n; x++) assertEquals(g.outdegree(x), h.outdegree(x));
+			final IntIterator outdegrees = h.outdegrees();
+			for(int x = 0; x < n; x++) assertEquals(g.outdegree(x), outdegrees.nextInt());
+			for(final int howMany : new int[] { 1, 3, 16, 2000 }) {
+				final NodeIterator[] nodeIterator = h.splitNodeIterators(howMany);
+				assertEquals(howMany, nodeIterator.length);
+				int next = 0;
+				for(final NodeIterator i : nodeIterator)
+					while(i.hasNext()) {
+						assertEquals(next, i.nextInt());
+						assertArrayEquals(Arrays.copyOf(g.successorArray(next), g.outdegree(next)), Arrays.copyOf(i.successorArray(), i.outdegree()));
+						next++;
+					}
+				assertEquals(n, next);
+			}
+		}
+		// The hub has more arcs than a segment, so it starts a segment
+		final int[] split = index.splitPoints(16);
+		for(int i = 0; i < 16; i++) if (split[i] <= 10 && 10 < split[i + 1]) assertEquals(10, split[i]);
+
+		// A graph that does not know its number of arcs
+		final ImmutableGraph f = Transform.filterArcs(g, (x, y) -> x != y + 1);
+		OutdegreeIndex.store(f, basename.toString(), null);
+		final OutdegreeIndex filteredIndex = OutdegreeIndex.load(basename.toString());
+		final IntIterator filteredOutdegrees = f.outdegrees();
+		for(int x = 0; x < n; x++) assertEquals(filteredOutdegrees.nextInt(), filteredIndex.outdegree(x));
+
+		deleteGraph(basename);
+	}
+
+	@Test
+	public void testOffsetsEliasFano() throws IOException {
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(1000, .01, 0, false)).immutableView();
+		final File basename = File.createTempFile(BVGraphTest.class.getSimpleName(), "test");
+		BVGraph.store(g, basename.toString());
+		assertTrue(new File(basename + BVGraph.OFFSETS_ELIAS_FANO_EXTENSION).exists());
+
+		final BVGraph h = BVGraph.loadMapped(basename.toString());
+		assertTrue(h.offsets instanceof MappedEliasFanoMonotoneLongBigList);
+		final InputBitStream offsets = new InputBitStream(basename + BVGraph.OFFSETS_EXTENSION);
+		long offset = 0;
+		for(int x = 0; x <= g.numNodes(); x++) assertEquals(offset += offsets.readLongGamma(), h.offsets.getLong(x));
+		offsets.close();
+		assertEquals(g, h);
+		assertEquals(g, h.copy());
+
+		// A stale list must be ignored
+		new File(basename + BVGraph.OFFSETS_ELIAS_FANO_EXTENSION).setLastModified(new File(basename + BVGraph.OFFSETS_EXTENSION).lastModified() - 10000);
+		final BVGraph k = BVGraph.loadMapped(basename.toString());
+		assertFalse(k.offsets instanceof MappedEliasFanoMonotoneLongBigList);
+		assertEquals(g, k);
+
+		// A truncated or corrupted list must be ignored, too
+		final File eliasFano = new File(basename + BVGraph.OFFSETS_ELIAS_FANO_EXTENSION);
+		for(final long length : new long[] { eliasFano.length() - Long.BYTES, eliasFano.length() / 2 + 1, 3 * Long.BYTES }) {
+			try (RandomAccessFile raf = new RandomAccessFile(eliasFano, "rw")) { raf.setLength(length); }
+			final BVGraph c = BVGraph.loadMapped(basename.toString());
+			assertFalse(c.offsets instanceof MappedEliasFanoMonotoneLongBigList);
+			assertEquals(g, c);
+		}
+
+		deleteGraph(basename);
+	}
+
+	@Test
+	public void testHuffman() throws IOException {
+		final int n = 3000, k = 2000;
+		final ImmutableGraph h = new ArrayListMutableGraph(new ErdosRenyiGraph(n, .01, 0, false)).immutableView();
+		// The first k nodes of h, restricted to arcs among them, and its extension with the remaining nodes of h
+		final ArrayListMutableGraph prefix = new ArrayListMutableGraph(k);
+		final ArrayListMutableGraph extended = new ArrayListMutableGraph(n);
+		for(int x = 0; x < n; x++)
+			for(final int y : h.successorArray(x)) {
+				if (x >= k) extended.addArc(x, y);
+				else if (y < k) {
+					prefix.addArc(x, y);
+					extended.addArc(x, y);
+				}
+			}
+		final ImmutableGraph g = prefix.immutableView();
+
+		for(final int flags : new int[] { BVGraph.OUTDEGREES_HUFFMAN, BVGraph.RESIDUALS_HUFFMAN, BVGraph.OUTDEGREES_HUFFMAN | BVGraph.RESIDUALS_HUFFMAN })
+			for(final int threads : new int[] { 1, 2 }) {
+				final File basename = File.createTempFile(BVGraphTest.class.getSimpleName(), "test");
+				BVGraph.store(g, basename.toString(), -1, -1, -1, -1, flags, threads);
+				final Properties properties = new Properties();
+				final FileInputStream propertyFile = new FileInputStream(basename + BVGraph.PROPERTIES_EXTENSION);
+				properties.load(propertyFile);
+				propertyFile.close();
+				assertEquals("1", properties.getProperty("version"));
+				assertEquals((flags & BVGraph.OUTDEGREES_HUFFMAN) != 0, properties.containsKey("outdegreecodelengths"));
+				assertEquals((flags & BVGraph.RESIDUALS_HUFFMAN) != 0, properties.containsKey("residualcodelengths"));
+
+				assertEquals(g, BVGraph.load(basename.toString()));
+				assertEquals(g, BVGraph.loadMapped(basename.toString()));
+				assertEquals(g, BVGraph.loadOffline(basename.toString()));
+				assertGraph(BVGraph.load(basename.toString()));
+				assertEquals(GraphFingerprint.compute(g, GraphFingerprint.loadKey(basename.toString())), GraphFingerprint.load(basename.toString()));
+
+				// Appended nodes are coded using the same codes
+				BVGraph.append(basename.toString(), extended.immutableView(), null);
+				assertEquals(extended.immutableView(), BVGraph.load(basename.toString()));
+				deleteGraph(basename);
+			}
+
+		// Graphs without Huffman codes can be read by older versions
+		final File basename = storeTempGraph(g);
+		final Properties properties = new Properties();
+		final FileInputStream propertyFile = new FileInputStream(basename + BVGraph.PROPERTIES_EXTENSION);
+		properties.load(propertyFile);
+		propertyFile.close();
+		assertEquals("0", properties.getProperty("version"));
+		deleteGraph(basename);
+	}
+
+	@Test(expected = IllegalArgumentException.class)
+	public void testHuffmanBlocks() throws IOException {
+		final File basename = File.createTempFile(BVGraphTest.class.getSimpleName(), "test");
+		try {
+			BVGraph.store(ArrayListMutableGraph.newCompleteGraph(10, false).immutableView(), basename.toString(), -1, -1, -1, -1, CompressionFlags.HUFFMAN << 4, 1);
+		}
+		finally {
+			deleteGraph(basename);
+		}
+	}
+
+	@Test(expected = IllegalStateException.class)
+	public void testHuffmanReadOnce() throws IOException {
+		final ImmutableGraph g = ArrayListMutableGraph.newCompleteGraph(10, false).immutableView();
+		// A graph that can be scanned just once
+		final ImmutableGraph once = new ImmutableSequentialGraph() {
+			private boolean scanned;
+
+			@Override
+			public int numNodes() {
+				return g.numNodes();
+			}
+
+			@Override
+			public NodeIterator nodeIterator() {
+				if (scanned) return NodeIterator.EMPTY;
+				scanned = true;
+				return g.nodeIterator();
+			}
+		};
+		final File basename = File.createTempFile(BVGraphTest.class.getSimpleName(), "test");
+		try {
+			BVGraph.store(once, basename.toString(), -1, -1, -1, -1, BVGraph.RESIDUALS_HUFFMAN, 1);
+		}
+		finally {
+			deleteGraph(basename);
+		}
+	}
 }
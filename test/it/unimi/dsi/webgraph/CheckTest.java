@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+
+import java.io.File;
+import java.io.IOException;
+
+import org.junit.Test;
+
+import it.unimi.dsi.webgraph.examples.ErdosRenyiGraph;
+
+public class CheckTest extends WebGraphTestCase {
+
+	@Test
+	public void testSymmetryFingerprint() throws IOException {
+		assertTrue(Check.symmetryFingerprint(ArrayListMutableGraph.newBidirectionalCycle(40).immutableView()));
+		assertTrue(Check.symmetryFingerprint(ArrayListMutableGraph.newCompleteGraph(20, true).immutableView()));
+		assertFalse(Check.symmetryFingerprint(ArrayListMutableGraph.newDirectedCycle(40).immutableView()));
+		assertFalse(Check.symmetryFingerprint(ArrayListMutableGraph.newCompleteBinaryIntree(8).immutableView()));
+
+		for(final int size: new int[] { 10, 100, 1000 }) {
+			final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(size, .05, 0, true)).immutableView();
+			for(final int threads: new int[] { 1, 2, 4 }) {
+				assertEquals(Check.symmetry(g), Check.symmetryFingerprint(g, threads, false, 0, null, null));
+				final ImmutableGraph s = Transform.symmetrize(g);
+				assertTrue(Check.symmetryFingerprint(s, threads, false, 0, null, null));
+				assertTrue(Check.symmetryFingerprint(s, threads, true, 0, null, null));
+				// A small batch size forces several batches in the exact check
+				assertTrue(Check.symmetryFingerprint(s, threads, true, 10, new File(System.getProperty("java.io.tmpdir")), null));
+			}
+		}
+	}
+
+	@Test
+	public void testSymmetryFingerprintBVGraph() throws IOException {
+		final ImmutableGraph g = Transform.symmetrize(new ArrayListMutableGraph(new ErdosRenyiGraph(1000, .01, 0, false)).immutableView());
+		final File basename = BVGraphTest.storeTempGraph(g);
+		assertTrue(Check.symmetryFingerprint(BVGraph.loadOffline(basename.toString()), 4, false, 0, null, null));
+		assertTrue(Check.symmetryFingerprint(BVGraph.load(basename.toString()), 4, false, 0, null, null));
+		deleteGraph(basename);
+		basename.delete();
+	}
+}
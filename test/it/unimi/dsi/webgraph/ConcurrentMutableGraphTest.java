@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertSame;
+
+import java.io.File;
+import java.io.IOException;
+
+import org.junit.Test;
+
+import it.unimi.dsi.webgraph.examples.ErdosRenyiGraph;
+
+public class ConcurrentMutableGraphTest extends WebGraphTestCase {
+
+	private static ConcurrentMutableGraph fill(final ImmutableGraph g, final int threads, final int stripes) throws InterruptedException {
+		final ConcurrentMutableGraph c = new ConcurrentMutableGraph(g.numNodes(), stripes);
+		final Thread[] thread = new Thread[threads];
+		for(int t = 0; t < threads; t++) {
+			final int k = t;
+			// Each thread adds, in reverse order, the arcs whose target is congruent to k modulo the number of threads; arcs are added twice.
+			thread[t] = new Thread(() -> {
+				for(int x = g.numNodes(); x-- != 0;) {
+					final int[] s = g.successorArray(x);
+					for(int i = g.outdegree(x); i-- != 0;) if (s[i] % threads == k) c.addArc(x, s[i]);
+					for(int i = g.outdegree(x); i-- != 0;) if (s[i] % threads == k) c.addArc(x, s[i]);
+				}
+			});
+			thread[t].start();
+		}
+		for(final Thread t : thread) t.join();
+		return c;
+	}
+
+	@Test
+	public void testConcurrent() throws InterruptedException {
+		for(final int n : new int[] { 1, 10, 100, 3000 }) {
+			final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(n, Math.min(1, 20. / n), 0, true)).immutableView();
+			for(final int stripes : new int[] { 1, 7, 64 }) {
+				final ImmutableGraph view = fill(g, 4, stripes).immutableView(3);
+				assertEquals(g, view);
+				assertEquals(g.numArcs(), view.numArcs());
+				assertGraph(view);
+			}
+		}
+	}
+
+	@Test
+	public void testLargeDegree() {
+		// A complete graph exercises blocks of maximum size
+		final int n = 3000;
+		final ConcurrentMutableGraph c = new ConcurrentMutableGraph(n, 2);
+		for(int x = 0; x < n; x++) for(int y = n; y-- != 0;) c.addArc(x, y);
+		final ImmutableGraph g = ArrayListMutableGraph.newCompleteGraph(n, true).immutableView();
+		assertEquals(g, c.immutableView());
+
+		// Deduplication must leave the graph in a consistent state for further additions
+		final ConcurrentMutableGraph d = new ConcurrentMutableGraph(2, 1);
+		for(int i = 0; i < 5000; i++) d.addArc(0, 0);
+		assertEquals(1, d.immutableView().outdegree(0));
+		for(int y = 1; y >= 0; y--) d.addArcs(1, new int[] { y, y }, 0, 2);
+		for(int i = 0; i < 5000; i++) d.addArc(0, 1);
+		final ImmutableGraph view = d.immutableView();
+		assertEquals(2, view.outdegree(0));
+		assertEquals(2, view.outdegree(1));
+		assertEquals(4, view.numArcs());
+		assertSame(view, d.immutableView());
+	}
+
+	@Test
+	public void testStore() throws InterruptedException, IOException {
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(10000, .001, 0, false)).immutableView();
+		final File basename = BVGraphTest.storeTempGraph(fill(g, 3, 16).immutableView());
+		assertEquals(g, BVGraph.load(basename.toString()));
+		deleteGraph(basename);
+	}
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+
+import java.io.File;
+import java.io.IOException;
+import java.util.Arrays;
+
+import org.junit.Test;
+
+import it.unimi.dsi.fastutil.longs.LongOpenHashSet;
+import it.unimi.dsi.util.XoRoShiRo128PlusRandom;
+import it.unimi.dsi.webgraph.examples.ErdosRenyiGraph;
+
+public class DeltaGraphTest extends WebGraphTestCase {
+
+	private static ImmutableGraph toGraph(final int n, final LongOpenHashSet arcs) {
+		final int[][] arc = new int[arcs.size()][];
+		int i = 0;
+		for(final long a : arcs) arc[i++] = new int[] { (int)(a >>> 32), (int)a };
+		return new ArrayListMutableGraph(n, arc).immutableView();
+	}
+
+	private static void modify(final DeltaGraph g, final LongOpenHashSet arcs, final int baseNodes, final int modifications, final XoRoShiRo128PlusRandom r) {
+		final int n = g.numNodes();
+		for(int i = 0; i < modifications; i++) {
+			// We concentrate modifications on a few nodes to exercise compaction of pending modifications
+			final int x = r.nextInt(4) == 0 ? r.nextInt(4) : r.nextInt(n);
+			final int y = r.nextInt(i % 2 == 0 ? n : Math.max(1, baseNodes / 10));
+			if (r.nextBoolean()) {
+				g.addArc(x, y);
+				arcs.add((long)x << 32 | y);
+			}
+			else {
+				g.removeArc(x, y);
+				arcs.remove((long)x << 32 | y);
+			}
+		}
+	}
+
+	@Test
+	public void testModifications() throws IOException {
+		final XoRoShiRo128PlusRandom r = new XoRoShiRo128PlusRandom(0);
+		for(final int n : new int[] { 1, 10, 100, 1000 }) {
+			final ImmutableGraph base = new ArrayListMutableGraph(new ErdosRenyiGraph(n, Math.min(1, 10. / n), 0, true)).immutableView();
+			final File basename = BVGraphTest.storeTempGraph(base);
+			final LongOpenHashSet arcs = new LongOpenHashSet();
+			for(int x = 0; x < n; x++) for(final int y : base.successorArray(x)) arcs.add((long)x << 32 | y);
+
+			final DeltaGraph g = new DeltaGraph(BVGraph.load(basename.toString()), n + 5);
+			assertEquals(toGraph(n + 5, arcs), g);
+
+			modify(g, arcs, n, 10 * n, r);
+			assertEquals(toGraph(n + 5, arcs), g);
+			assertGraph(g);
+
+			final File newBasename = File.createTempFile(DeltaGraphTest.class.getSimpleName(), "test");
+			g.compact(newBasename.toString());
+			assertEquals(toGraph(n + 5, arcs), g);
+			assertEquals(toGraph(n + 5, arcs), ImmutableGraph.load(newBasename.toString()));
+
+			// Modifications after compaction, and a second compaction
+			modify(g, arcs, n, 10 * n, r);
+			assertEquals(toGraph(n + 5, arcs), g.copy());
+			g.compact(basename.toString(), 2, null);
+			assertEquals(toGraph(n + 5, arcs), g);
+
+			deleteGraph(basename);
+			deleteGraph(newBasename);
+		}
+	}
+
+	@Test
+	public void testCompactionParameters() throws IOException {
+		final ImmutableGraph base = new ArrayListMutableGraph(new ErdosRenyiGraph(100, .1, 0, false)).immutableView();
+		final File basename = File.createTempFile(DeltaGraphTest.class.getSimpleName(), "test");
+		final int flags = BVGraph.OUTDEGREES_DELTA | BVGraph.RESIDUALS_ZETA;
+		BVGraph.store(base, basename.toString(), 2, 1, 3, 5, flags);
+
+		final DeltaGraph g = new DeltaGraph(BVGraph.loadMapped(basename.toString()), 100);
+		g.addArc(0, 99);
+
+		final File newBasename = File.createTempFile(DeltaGraphTest.class.getSimpleName(), "test");
+		g.compact(newBasename.toString());
+		final BVGraph compacted = BVGraph.load(newBasename.toString());
+		assertEquals(2, compacted.windowSize());
+		assertEquals(1, compacted.maxRefCount());
+		assertEquals(3, compacted.minIntervalLength());
+		assertEquals(5, compacted.zetaK());
+		assertEquals(flags, compacted.flags());
+		assertEquals(g, compacted);
+
+		deleteGraph(basename);
+		deleteGraph(newBasename);
+	}
+
+	@Test
+	public void testCompactionWhileMapped() throws IOException {
+		final ImmutableGraph base = new ArrayListMutableGraph(new ErdosRenyiGraph(1000, .01, 0, false)).immutableView();
+		final File basename = BVGraphTest.storeTempGraph(base);
+		final ImmutableGraph mapped = BVGraph.loadMapped(basename.toString());
+		final DeltaGraph g = new DeltaGraph(mapped);
+		// This iterator reads the files of the original base graph, which are replaced by the second compaction
+		final NodeIterator nodeIterator = mapped.copy().nodeIterator();
+		for(int x = 0; x < 1000; x++) for(final int y : base.successorArray(x)) g.removeArc(x, y);
+
+		final File newBasename = File.createTempFile(DeltaGraphTest.class.getSimpleName(), "test");
+		g.compact(newBasename.toString());
+		g.compact(basename.toString());
+		final ImmutableGraph empty = new ArrayListMutableGraph(1000).immutableView();
+		assertEquals(empty, g);
+		assertEquals(empty, ImmutableGraph.load(basename.toString()));
+
+		for(int x = 0; x < 1000; x++) {
+			assertEquals(x, nodeIterator.nextInt());
+			assertArrayEquals(base.successorArray(x), Arrays.copyOf(nodeIterator.successorArray(), nodeIterator.outdegree()));
+		}
+
+		deleteGraph(basename);
+		deleteGraph(newBasename);
+	}
+
+	@Test(expected = IllegalArgumentException.class)
+	public void testCompactionOntoBase() throws IOException {
+		final File basename = BVGraphTest.storeTempGraph(ArrayListMutableGraph.newDirectedCycle(10).immutableView());
+		basename.deleteOnExit();
+		final DeltaGraph g = new DeltaGraph(BVGraph.loadMapped(basename.toString()), 10);
+		g.addArc(0, 5);
+		g.compact(basename.toString());
+	}
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNotEquals;
+
+import java.io.File;
+import java.io.IOException;
+
+import org.junit.Test;
+
+import it.unimi.dsi.fastutil.io.FastByteArrayInputStream;
+import it.unimi.dsi.webgraph.examples.ErdosRenyiGraph;
+
+public class GraphFingerprintTest extends WebGraphTestCase {
+
+	@Test
+	public void testThreads() {
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(1000, .01, 0, false)).immutableView();
+		final String fingerprint = GraphFingerprint.compute(g, 0, 1, null);
+		assertEquals(32, fingerprint.length());
+		for(final int threads: new int[] { 2, 3, 8 }) assertEquals(fingerprint, GraphFingerprint.compute(g, 0, threads, null));
+	}
+
+	@Test
+	public void testKey() {
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(1000, .01, 0, false)).immutableView();
+		assertEquals(GraphFingerprint.compute(g, 42), GraphFingerprint.compute(g, 42, 4, null));
+		assertNotEquals(GraphFingerprint.compute(g, 0), GraphFingerprint.compute(g, 42));
+	}
+
+	@Test
+	public void testDifferent() {
+		assertNotEquals(GraphFingerprint.compute(ArrayListMutableGraph.newDirectedCycle(40).immutableView(), 0), GraphFingerprint.compute(Transform.transpose(ArrayListMutableGraph.newDirectedCycle(40).immutableView()), 0));
+		assertNotEquals(GraphFingerprint.compute(ArrayListMutableGraph.newDirectedCycle(40).immutableView(), 0), GraphFingerprint.compute(ArrayListMutableGraph.newDirectedCycle(41).immutableView(), 0));
+		// Same arcs, different number of nodes
+		final ArrayListMutableGraph g = new ArrayListMutableGraph(3);
+		g.addArc(0, 1);
+		final ArrayListMutableGraph h = new ArrayListMutableGraph(4);
+		h.addArc(0, 1);
+		assertNotEquals(GraphFingerprint.compute(g.immutableView(), 0), GraphFingerprint.compute(h.immutableView(), 0));
+	}
+
+	@Test
+	public void testRepresentations() throws IOException {
+		assertEquals(GraphFingerprint.compute(ArrayListMutableGraph.newCompleteGraph(3, false).immutableView(), 42),
+				GraphFingerprint.compute(ArcListASCIIGraph.loadOnce(new FastByteArrayInputStream("0 2\n0 1\n1 0\n1 2\n2 0\n2 1".getBytes("ASCII"))), 42));
+
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(1000, .01, 0, false)).immutableView();
+
+		// By default, all representations store the same fingerprint
+		final String fingerprint = GraphFingerprint.compute(g, GraphFingerprint.DEFAULT_KEY);
+		final File basename = File.createTempFile(GraphFingerprintTest.class.getSimpleName(), "test");
+		for(final int threads: new int[] { 1, 4 }) {
+			BVGraph.store(g, basename.toString(), threads, null);
+			assertEquals(GraphFingerprint.DEFAULT_KEY, GraphFingerprint.loadKey(basename.toString()));
+			assertEquals(fingerprint, GraphFingerprint.load(basename.toString()));
+			assertEquals(fingerprint, GraphFingerprint.compute(BVGraph.loadOffline(basename.toString()), GraphFingerprint.DEFAULT_KEY, threads, null));
+			deleteGraph(basename);
+		}
+
+		EFGraph.store(g, basename.toString());
+		assertEquals(GraphFingerprint.DEFAULT_KEY, GraphFingerprint.loadKey(basename.toString()));
+		assertEquals(fingerprint, GraphFingerprint.load(basename.toString()));
+		assertEquals(fingerprint, GraphFingerprint.compute(EFGraph.load(basename.toString()), GraphFingerprint.DEFAULT_KEY, 4, null));
+		deleteGraph(basename);
+		basename.delete();
+	}
+
+	@Test
+	public void testKeyProperty() throws IOException {
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(1000, .01, 0, false)).immutableView();
+		final File basename = File.createTempFile(GraphFingerprintTest.class.getSimpleName(), "test");
+		try {
+			System.setProperty(GraphFingerprint.KEY_PROPERTY, "2a");
+			BVGraph.store(g, basename.toString());
+			assertEquals(42, GraphFingerprint.loadKey(basename.toString()));
+			assertEquals(GraphFingerprint.compute(g, 42), GraphFingerprint.load(basename.toString()));
+			deleteGraph(basename);
+
+			System.setProperty(GraphFingerprint.KEY_PROPERTY, "random");
+			EFGraph.store(g, basename.toString());
+			final long key = GraphFingerprint.loadKey(basename.toString());
+			assertEquals(GraphFingerprint.compute(g, key), GraphFingerprint.load(basename.toString()));
+			deleteGraph(basename);
+		}
+		finally {
+			System.clearProperty(GraphFingerprint.KEY_PROPERTY);
+		}
+		basename.delete();
+	}
+}
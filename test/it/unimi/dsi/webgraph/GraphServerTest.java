@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.File;
+import java.io.IOException;
+import java.net.Socket;
+import java.util.Arrays;
+
+import org.junit.Test;
+
+import com.martiansoftware.jsap.JSAPException;
+
+import it.unimi.dsi.fastutil.ints.IntIterator;
+import it.unimi.dsi.fastutil.objects.Object2ObjectOpenHashMap;
+import it.unimi.dsi.util.XoRoShiRo128PlusRandom;
+import it.unimi.dsi.webgraph.examples.ErdosRenyiGraph;
+
+public class GraphServerTest extends WebGraphTestCase {
+
+	@Test
+	public void testServer() throws IOException, JSAPException {
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(3000, .005, 0, false)).immutableView();
+		final File basename = File.createTempFile(GraphServerTest.class.getSimpleName(), "test");
+		BVGraph.store(g, basename.toString());
+		final Object2ObjectOpenHashMap<String, ImmutableGraph> graphs = new Object2ObjectOpenHashMap<>();
+		graphs.put("g", BVGraph.loadMapped(basename.toString()));
+
+		final GraphServer server = new GraphServer(graphs, 0);
+		new Thread(server).start();
+
+		final RemoteImmutableGraph remote = new RemoteImmutableGraph(null, server.port(), "g");
+		assertEquals(g.numNodes(), remote.numNodes());
+		assertEquals(g.numArcs(), remote.numArcs());
+		assertEquals(g, remote);
+		assertGraph(remote);
+
+		final IntIterator outdegrees = remote.outdegrees();
+		for(int x = 0; x < g.numNodes(); x++) assertEquals(g.outdegree(x), outdegrees.nextInt());
+
+		final XoRoShiRo128PlusRandom random = new XoRoShiRo128PlusRandom(0);
+		final int[] node = new int[1000];
+		for(int i = 0; i < node.length; i++) node[i] = random.nextInt(g.numNodes());
+		final int[] outdegree = remote.outdegrees(node);
+		final int[][] successor = remote.successorArrays(node);
+		for(int i = 0; i < node.length; i++) {
+			assertEquals(g.outdegree(node[i]), outdegree[i]);
+			assertArrayEquals(Arrays.copyOf(g.successorArray(node[i]), g.outdegree(node[i])), successor[i]);
+		}
+
+		final int[] source = new int[1000], target = new int[1000];
+		for(int i = 0; i < source.length; i++) {
+			source[i] = random.nextInt(g.numNodes());
+			// Half of the pairs are arcs
+			target[i] = g.outdegree(source[i]) != 0 && random.nextBoolean() ? g.successorArray(source[i])[random.nextInt(g.outdegree(source[i]))] : random.nextInt(g.numNodes());
+		}
+		final boolean[] isArc = remote.isArcs(source, target);
+		for(int i = 0; i < source.length; i++) {
+			final int t = target[i];
+			final boolean expected = Arrays.stream(Arrays.copyOf(g.successorArray(source[i]), g.outdegree(source[i]))).anyMatch(y -> y == t);
+			assertEquals(expected, isArc[i]);
+			assertEquals(expected, remote.isArc(source[i], target[i]));
+			remote.successorArray(source[i]);
+			// Now from the cache
+			assertEquals(expected, remote.isArc(source[i], target[i]));
+		}
+
+		// Interleaving random accesses and iteration
+		final NodeIterator nodeIterator = remote.nodeIterator(1500);
+		for(int x = 1500; x < g.numNodes(); x++) {
+			assertEquals(x, nodeIterator.nextInt());
+			assertEquals(g.outdegree(x / 2), remote.outdegree(x / 2));
+			assertArrayEquals(Arrays.copyOf(g.successorArray(x), g.outdegree(x)), Arrays.copyOf(nodeIterator.successorArray(), nodeIterator.outdegree()));
+		}
+
+		final RemoteImmutableGraph copy = remote.copy();
+		remote.close();
+		assertEquals(g, copy);
+		copy.close();
+
+		// Loading through a property file
+		final File remoteBasename = File.createTempFile(GraphServerTest.class.getSimpleName(), "remote");
+		RemoteImmutableGraph.main(new String[] { "-p", Integer.toString(server.port()), "g", remoteBasename.toString() });
+		final ImmutableGraph loaded = ImmutableGraph.load(remoteBasename.toString());
+		assertEquals(g, loaded);
+		((RemoteImmutableGraph)loaded).close();
+		new File(remoteBasename + ImmutableGraph.PROPERTIES_EXTENSION).delete();
+		remoteBasename.delete();
+
+		server.close();
+		deleteGraph(basename);
+	}
+
+	@Test
+	public void testOversizedRequest() throws IOException {
+		final ImmutableGraph g = ArrayListMutableGraph.newCompleteGraph(10, false).immutableView();
+		final Object2ObjectOpenHashMap<String, ImmutableGraph> graphs = new Object2ObjectOpenHashMap<>();
+		graphs.put("g", g);
+		final GraphServer server = new GraphServer(graphs, 0);
+		new Thread(server).start();
+
+		try (Socket socket = new Socket((String)null, server.port())) {
+			final DataOutputStream dos = new DataOutputStream(socket.getOutputStream());
+			final DataInputStream dis = new DataInputStream(socket.getInputStream());
+			dos.writeUTF("g");
+			assertEquals(10, dis.readInt());
+			dis.readLong();
+			dos.writeByte(GraphServer.SUCCESSORS);
+			dos.writeInt(Integer.MAX_VALUE);
+			dos.flush();
+			// The server closes the connection without allocating anything
+			assertEquals(-1, dis.read());
+		}
+
+		// The server is still working
+		final RemoteImmutableGraph remote = new RemoteImmutableGraph(null, server.port(), "g");
+		assertEquals(g, remote);
+		assertTrue(remote.isArc(0, 1));
+		assertFalse(remote.isArc(0, 0));
+		remote.close();
+		server.close();
+	}
+
+	@Test(expected = IOException.class)
+	public void testUnknownGraph() throws IOException {
+		final GraphServer server = new GraphServer(new Object2ObjectOpenHashMap<String, ImmutableGraph>(), 0);
+		new Thread(server).start();
+		try {
+			new RemoteImmutableGraph(null, server.port(), "unknown");
+		}
+		finally {
+			server.close();
+		}
+	}
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNotNull;
+import static org.junit.Assert.assertNull;
+
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.IOException;
+import java.util.Properties;
+
+import org.junit.Test;
+
+import it.unimi.dsi.fastutil.ints.IntIterator;
+import it.unimi.dsi.fastutil.ints.IntIterators;
+import it.unimi.dsi.fastutil.io.TextIO;
+import it.unimi.dsi.webgraph.examples.ErdosRenyiGraph;
+
+public class GraphSketchTest extends WebGraphTestCase {
+
+	private static void assertSketch(final ImmutableGraph g, final GraphSketch sketch) throws IOException {
+		assertEquals(g.numNodes(), sketch.numNodes);
+		assertEquals(g.numArcs(), sketch.numArcs);
+		final IntIterator outdegrees = sketch.outdegrees();
+		long c = 0;
+		for(int x = 0; x < g.numNodes(); x++) {
+			assertEquals(c, sketch.cumulativeOutdegree(x));
+			assertEquals(g.outdegree(x), sketch.outdegree(x));
+			assertEquals(g.outdegree(x), outdegrees.nextInt());
+			c += g.outdegree(x);
+		}
+
+		final File stats = File.createTempFile(GraphSketchTest.class.getSimpleName(), "stats");
+		Stats.run(g, null, null, stats.toString(), false, 1, null);
+		final Properties properties = new Properties();
+		final FileInputStream propertyStream = new FileInputStream(stats + ".stats");
+		properties.load(propertyStream);
+		propertyStream.close();
+		assertEquals(Integer.parseInt(properties.getProperty("minoutdegree")), sketch.minOutdegree());
+		assertEquals(Integer.parseInt(properties.getProperty("maxoutdegree")), sketch.maxOutdegree());
+		assertEquals(Integer.parseInt(properties.getProperty("minoutdegreenode")), sketch.minOutdegreeNode);
+		assertEquals(Integer.parseInt(properties.getProperty("maxoutdegreenode")), sketch.maxOutdegreeNode);
+		assertEquals(Integer.parseInt(properties.getProperty("minindegree")), sketch.minIndegree());
+		assertEquals(Integer.parseInt(properties.getProperty("maxindegree")), sketch.maxIndegree());
+		assertEquals(Integer.parseInt(properties.getProperty("minindegreenode")), sketch.minIndegreeNode);
+		assertEquals(Integer.parseInt(properties.getProperty("maxindegreenode")), sketch.maxIndegreeNode);
+		assertArrayEquals(IntIterators.unwrap(TextIO.asIntIterator(stats + ".outdegree")), sketch.outdegreeDistribution);
+		assertArrayEquals(IntIterators.unwrap(TextIO.asIntIterator(stats + ".indegree")), sketch.indegreeDistribution);
+		new File(stats + ".stats").delete();
+		new File(stats + ".outdegree").delete();
+		new File(stats + ".indegree").delete();
+		stats.delete();
+	}
+
+	@Test
+	public void testCompute() throws IOException {
+		assertSketch(ArrayListMutableGraph.newBidirectionalCycle(40).immutableView(), GraphSketch.compute(ArrayListMutableGraph.newBidirectionalCycle(40).immutableView(), null));
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(1000, .01, 0, false)).immutableView();
+		assertSketch(g, GraphSketch.compute(g, null));
+	}
+
+	@Test
+	public void testStore() throws IOException {
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(1000, .01, 0, false)).immutableView();
+		final GraphSketch computed = GraphSketch.compute(g, null);
+		for(final int threads: new int[] { 1, 4 }) {
+			final File basename = File.createTempFile(GraphSketchTest.class.getSimpleName(), "test");
+			BVGraph.store(g, basename.toString(), -1, -1, -1, -1, 0, threads, true, null);
+			final ImmutableGraph bvGraph = BVGraph.load(basename.toString());
+			final GraphSketch sketch = GraphSketch.load(bvGraph);
+			assertNotNull(sketch);
+			assertSketch(bvGraph, sketch);
+			assertArrayEquals(computed.successorGapStats, sketch.successorGapStats);
+			assertNotNull(sketch.residualGapStats);
+			deleteGraph(basename);
+			basename.delete();
+		}
+	}
+
+	@Test
+	public void testStale() throws IOException {
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(100, .1, 0, false)).immutableView();
+		final File basename = File.createTempFile(GraphSketchTest.class.getSimpleName(), "test");
+		BVGraph.store(g, basename.toString(), -1, -1, -1, -1, 0, 1, true, null);
+		final File sketchFile = new File(basename + GraphSketch.SKETCH_EXTENSION);
+		sketchFile.setLastModified(new File(basename + ImmutableGraph.PROPERTIES_EXTENSION).lastModified() - 10000);
+		assertNull(GraphSketch.load(BVGraph.load(basename.toString())));
+		assertNull(GraphSketch.load(g));
+		deleteGraph(basename);
+		basename.delete();
+	}
+}
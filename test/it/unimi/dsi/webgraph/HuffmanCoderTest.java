@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+import java.io.IOException;
+import java.util.Arrays;
+
+import org.junit.Test;
+
+import it.unimi.dsi.fastutil.io.FastByteArrayOutputStream;
+import it.unimi.dsi.io.InputBitStream;
+import it.unimi.dsi.io.OutputBitStream;
+import it.unimi.dsi.util.XoRoShiRo128PlusRandom;
+
+public class HuffmanCoderTest {
+
+	private static void assertRoundTrip(final HuffmanCoder coder, final long[] x) throws IOException {
+		final FastByteArrayOutputStream fbaos = new FastByteArrayOutputStream();
+		final OutputBitStream obs = new OutputBitStream(fbaos, 0);
+		long bits = 0;
+		for(final long v : x) bits += coder.write(obs, v);
+		obs.flush();
+		assertEquals(bits, obs.writtenBits());
+
+		final InputBitStream ibs = new InputBitStream(fbaos.array);
+		for(final long v : x) assertEquals(v, coder.readLong(ibs));
+		assertEquals(bits, ibs.readBits());
+		ibs.close();
+	}
+
+	@Test
+	public void testSymbol() {
+		for(int i = 0; i < HuffmanCoder.DIRECT; i++) assertEquals(i, HuffmanCoder.symbol(i));
+		assertEquals(HuffmanCoder.DIRECT, HuffmanCoder.symbol(16));
+		assertEquals(HuffmanCoder.DIRECT, HuffmanCoder.symbol(23));
+		assertEquals(HuffmanCoder.DIRECT + 1, HuffmanCoder.symbol(24));
+		assertEquals(HuffmanCoder.DIRECT + 2, HuffmanCoder.symbol(32));
+		assertEquals(HuffmanCoder.NUMBER_OF_SYMBOLS - 1, HuffmanCoder.symbol(Long.MAX_VALUE));
+	}
+
+	@Test
+	public void testSkewed() throws IOException {
+		final XoRoShiRo128PlusRandom random = new XoRoShiRo128PlusRandom(0);
+		final long[] x = new long[100000];
+		final long[] frequency = new long[HuffmanCoder.NUMBER_OF_SYMBOLS];
+		// Geometrically distributed values
+		for(int i = 0; i < x.length; i++) {
+			x[i] = Long.numberOfTrailingZeros(random.nextLong() | 1L << 40);
+			frequency[HuffmanCoder.symbol(x[i])]++;
+		}
+
+		final HuffmanCoder coder = HuffmanCoder.build(frequency);
+		final int[] length = coder.codeLengths();
+		assertEquals(1, length[0]);
+		assertEquals(2, length[1]);
+		assertRoundTrip(coder, x);
+		// Values that did not appear in the distribution
+		assertRoundTrip(coder, new long[] { 1000, 0, Integer.MAX_VALUE, Long.MAX_VALUE, 17 });
+		assertArrayEquals(length, new HuffmanCoder(length).codeLengths());
+	}
+
+	@Test
+	public void testRandom() throws IOException {
+		final XoRoShiRo128PlusRandom random = new XoRoShiRo128PlusRandom(0);
+		final long[] x = new long[100000];
+		final long[] frequency = new long[HuffmanCoder.NUMBER_OF_SYMBOLS];
+		for(int i = 0; i < x.length; i++) {
+			x[i] = random.nextLong() >>> random.nextInt(Long.SIZE);
+			frequency[HuffmanCoder.symbol(x[i])]++;
+		}
+		assertRoundTrip(HuffmanCoder.build(frequency), x);
+	}
+
+	@Test
+	public void testMaxLength() throws IOException {
+		// Fibonacci frequencies yield the deepest possible tree
+		final long[] frequency = new long[HuffmanCoder.NUMBER_OF_SYMBOLS];
+		frequency[0] = frequency[1] = 1;
+		for(int i = 2; i < 90; i++) frequency[i] = frequency[i - 1] + frequency[i - 2];
+		final HuffmanCoder coder = HuffmanCoder.build(frequency);
+		for(final int l : coder.codeLengths()) assertTrue(l <= HuffmanCoder.MAX_CODEWORD_LENGTH);
+		final long[] x = new long[200];
+		for(int i = 0; i < x.length; i++) x[i] = 1L << i % 63 | i;
+		assertRoundTrip(coder, x);
+	}
+
+	@Test
+	public void testIncomplete() throws IOException {
+		final long[] x = new long[1000];
+		for(int i = 0; i < x.length; i++) x[i] = 1L << i % 63 | i;
+		final int[] length = new int[HuffmanCoder.NUMBER_OF_SYMBOLS];
+		// Shortest codeword short enough to use the decoding table
+		Arrays.fill(length, 8);
+		length[0] = 3;
+		assertRoundTrip(new HuffmanCoder(length), x);
+		// Shortest codeword too long to use the decoding table
+		Arrays.fill(length, 20);
+		length[0] = 30;
+		assertRoundTrip(new HuffmanCoder(length), x);
+	}
+
+	@Test(expected = IllegalArgumentException.class)
+	public void testKraft() {
+		final int[] length = new int[HuffmanCoder.NUMBER_OF_SYMBOLS];
+		Arrays.fill(length, 7);
+		new HuffmanCoder(length);
+	}
+}
@@ -19,6 +19,8 @@ package it.unimi.dsi.webgraph;
 
 import static org.junit.Assert.assertEquals;
 
+import java.io.File;
+import java.io.IOException;
 import java.util.Arrays;
 import java.util.Collections;
 import java.util.Random;
@@ -26,6 +28,7 @@ import java.util.Random;
 import org.junit.Test;
 
 import it.unimi.dsi.fastutil.ints.IntArrayList;
+import it.unimi.dsi.webgraph.examples.ErdosRenyiGraph;
 
 public class ImmutableSubgraphTest extends WebGraphTestCase {
 
@@ -84,5 +87,35 @@ public class ImmutableSubgraphTest extends WebGraphTestCase {
 		}
 	}
 
+	@Test
+	public void testSparse() throws IOException {
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(10000, .001, 0, false)).immutableView();
+		final File basename = BVGraphTest.storeTempGraph(g);
+		final Random random = new Random(0);
+		for(final int step: new int[] { 2, 50, 1000 }) {
+			final IntArrayList nodes = new IntArrayList();
+			for(int x = random.nextInt(step); x < g.numNodes(); x += 1 + random.nextInt(step)) nodes.add(x);
+			final int[] node = nodes.toIntArray();
+
+			// The induced subgraph, computed explicitly
+			final ArrayListMutableGraph induced = new ArrayListMutableGraph(node.length);
+			for(int i = 0; i < node.length; i++) {
+				final LazyIntIterator successors = g.successors(node[i]);
+				for(int s; (s = successors.nextInt()) != -1;) {
+					final int j = Arrays.binarySearch(node, s);
+					if (j >= 0) induced.addArc(i, j);
+				}
+			}
 
+			for(final ImmutableGraph supergraph: new ImmutableGraph[] { g, BVGraph.load(basename.toString()), BVGraph.loadOffline(basename.toString()) }) {
+				final ImmutableSubgraph sg = new ImmutableSubgraph(supergraph, node);
+				for(int x = 0; x < g.numNodes(); x++) assertEquals(Arrays.binarySearch(node, x) >= 0 ? Arrays.binarySearch(node, x) : -1, sg.fromSupergraphNode(x));
+				for(int i = 0; i < node.length; i++) assertEquals(node[i], sg.toSupergraphNode(i));
+				assertEquals(induced.immutableView(), sg);
+				if (supergraph.randomAccess()) assertGraph(sg);
+			}
+		}
+		deleteGraph(basename);
+		basename.delete();
+	}
 }
@@ -24,6 +24,7 @@ import java.io.IOException;
 import java.util.concurrent.ExecutionException;
 import java.util.concurrent.Executors;
 import java.util.concurrent.Future;
+import java.util.concurrent.atomic.AtomicInteger;
 
 import org.junit.Test;
 
@@ -56,4 +57,40 @@ public class IncrementalImmutableSequentialGraphTest extends WebGraphTestCase {
 		deleteGraph(basename);
 	}
 
+	@Test
+	public void testProducers() throws IOException, InterruptedException, ExecutionException {
+		final String basename = File.createTempFile(IncrementalImmutableSequentialGraph.class.getSimpleName() + "-", "-temp").toString();
+		for(final int size: new int[] { 0, 10, 100, 1000, 10000 }) {
+			for(final int batchSize: new int[] { 1, 7, 20 }) {
+				final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(size, .001, 0, false)).immutableView();
+				final IncrementalImmutableSequentialGraph incrementalImmutableSequentialGraph = new IncrementalImmutableSequentialGraph(64);
+				final Future<Void> future = Executors.newSingleThreadExecutor().submit(() -> {
+					BVGraph.store(incrementalImmutableSequentialGraph, basename);
+					return null;
+				});
+
+				final AtomicInteger nextNode = new AtomicInteger();
+				final Thread[] thread = new Thread[3];
+				for(int t = thread.length; t-- != 0;) {
+					thread[t] = new Thread(() -> {
+						try {
+							for(int from; (from = nextNode.getAndAdd(batchSize)) < size;)
+								for(int x = from; x < Math.min(size, from + batchSize); x++) incrementalImmutableSequentialGraph.add(x, g.successorArray(x), 0, g.outdegree(x));
+						}
+						catch(final InterruptedException e) {
+							throw new RuntimeException(e);
+						}
+					});
+					thread[t].start();
+				}
+				for(final Thread t : thread) t.join();
+				incrementalImmutableSequentialGraph.add(size, IncrementalImmutableSequentialGraph.END_OF_GRAPH);
+
+				future.get();
+				assertEquals(g, ImmutableGraph.load(basename));
+			}
+		}
+
+		deleteGraph(basename);
+	}
 }
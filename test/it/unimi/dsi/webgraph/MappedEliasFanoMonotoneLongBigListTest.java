@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import static org.junit.Assert.assertEquals;
+
+import java.io.File;
+import java.io.IOException;
+
+import org.junit.Test;
+
+import it.unimi.dsi.fastutil.longs.LongIterators;
+import it.unimi.dsi.util.XoRoShiRo128PlusRandom;
+
+public class MappedEliasFanoMonotoneLongBigListTest {
+
+	private static void check(final long[] value, final long upperBound) throws IOException {
+		final File file = File.createTempFile(MappedEliasFanoMonotoneLongBigListTest.class.getSimpleName(), ".ef");
+		MappedEliasFanoMonotoneLongBigList.store(LongIterators.wrap(value), value.length, upperBound, file.toString());
+		for(final MappedEliasFanoMonotoneLongBigList list : new MappedEliasFanoMonotoneLongBigList[] { MappedEliasFanoMonotoneLongBigList.load(file.toString()), MappedEliasFanoMonotoneLongBigList.loadMapped(file.toString()) }) {
+			assertEquals(value.length, list.size64());
+			assertEquals(upperBound, list.upperBound());
+			for(int i = 0; i < value.length; i++) assertEquals(value[i], list.getLong(i));
+
+			assertEquals(-1, list.weakPredecessorIndex(-1));
+			if (value.length == 0) assertEquals(-1, list.weakPredecessorIndex(0));
+			else {
+				// Check around each element, and at the end
+				for(int i = 0; i < value.length; i++)
+					for(long v = value[i] - 1; v <= value[i] + 1; v++) assertEquals(Long.toString(v), weakPredecessorIndex(value, v), list.weakPredecessorIndex(v));
+				assertEquals(value.length - 1, list.weakPredecessorIndex(upperBound));
+				assertEquals(value.length - 1, list.weakPredecessorIndex(Long.MAX_VALUE));
+			}
+		}
+		file.delete();
+	}
+
+	private static long weakPredecessorIndex(final long[] value, final long v) {
+		// Binary search for the first element larger than v
+		int from = 0, to = value.length;
+		while(from < to) {
+			final int mid = (from + to) >>> 1;
+			if (value[mid] <= v) from = mid + 1;
+			else to = mid;
+		}
+		return from - 1;
+	}
+
+	private static long[] random(final int n, final long maxGap, final double duplicates, final XoRoShiRo128PlusRandom random) {
+		final long[] value = new long[n];
+		long v = 0;
+		for(int i = 0; i < n; i++) value[i] = v += random.nextDouble() < duplicates ? 0 : random.nextLong(maxGap) + 1;
+		return value;
+	}
+
+	@Test
+	public void testSmall() throws IOException {
+		check(new long[0], 0);
+		check(new long[0], 100);
+		check(new long[] { 0 }, 1);
+		check(new long[] { 5 }, 6);
+		check(new long[] { 0, 0, 0 }, 1);
+		check(new long[] { 1, 2, 3, 100, 100, 1000 }, 1001);
+		check(new long[] { 1, 2, 3, 100, 100, 1000 }, 1L << 40);
+	}
+
+	@Test
+	public void testRandom() throws IOException {
+		final XoRoShiRo128PlusRandom random = new XoRoShiRo128PlusRandom(0);
+		for(final int n : new int[] { 10, 1000, 10000 })
+			for(final long maxGap : new long[] { 1, 10, 1000, 1L << 40 })
+				for(final double duplicates : new double[] { 0, .5, .99 }) {
+					final long[] value = random(n, maxGap, duplicates, random);
+					check(value, value[n - 1] + 1);
+					check(value, value[n - 1] + 1 + random.nextLong(1000));
+				}
+	}
+
+	@Test
+	public void testSpill() throws IOException {
+		// Long runs of equal values, and huge isolated gaps, force the creation of spilled inventory blocks
+		final long[] value = new long[100000];
+		for(int i = 0; i < value.length; i++) value[i] = i < 50000 ? (i / 10000) * 100000000L : 10000000000L + i * 3L;
+		check(value, value[value.length - 1] + 1);
+		// A dense prefix followed by a sparse suffix
+		final long[] dense = new long[200000];
+		for(int i = 0; i < dense.length; i++) dense[i] = i < 100000 ? i : 100000 + (i - 100000) * 2000L;
+		check(dense, dense[dense.length - 1] + 1);
+	}
+}
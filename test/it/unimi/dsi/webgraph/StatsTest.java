@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph;
+
+import static org.junit.Assert.assertArrayEquals;
+
+import java.io.File;
+import java.io.IOException;
+import java.nio.file.Files;
+
+import org.junit.Test;
+
+import it.unimi.dsi.webgraph.examples.ErdosRenyiGraph;
+
+public class StatsTest extends WebGraphTestCase {
+
+	private static final String[] EXTENSIONS = { ".stats", ".outdegree", ".indegree", ".outdegrees", ".indegrees" };
+
+	private static void assertSameStats(final ImmutableGraph g) throws IOException {
+		final File sequential = File.createTempFile(StatsTest.class.getSimpleName(), "seq");
+		final File parallel = File.createTempFile(StatsTest.class.getSimpleName(), "par");
+		Stats.run(g, null, null, sequential.toString(), true, 1, null);
+		for(final int threads: new int[] { 2, 3, 8 }) {
+			Stats.run(g, null, null, parallel.toString(), true, threads, null);
+			for(final String extension: EXTENSIONS)
+				assertArrayEquals(extension, Files.readAllBytes(new File(sequential + extension).toPath()), Files.readAllBytes(new File(parallel + extension).toPath()));
+		}
+		for(final String extension: EXTENSIONS) {
+			new File(sequential + extension).delete();
+			new File(parallel + extension).delete();
+		}
+		sequential.delete();
+		parallel.delete();
+	}
+
+	@Test
+	public void testSmall() throws IOException {
+		assertSameStats(ArrayListMutableGraph.newBidirectionalCycle(40).immutableView());
+		assertSameStats(ArrayListMutableGraph.newCompleteBinaryIntree(8).immutableView());
+		assertSameStats(ArrayListMutableGraph.newCompleteGraph(20, true).immutableView());
+	}
+
+	@Test
+	public void testErdosRenyi() throws IOException {
+		for(final int size: new int[] { 10, 100, 1000 })
+			assertSameStats(new ArrayListMutableGraph(new ErdosRenyiGraph(size, .01, 0, true)).immutableView());
+	}
+
+	@Test
+	public void testBVGraph() throws IOException {
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(1000, .01, 0, false)).immutableView();
+		final File basename = BVGraphTest.storeTempGraph(g);
+		assertSameStats(BVGraph.loadOffline(basename.toString()));
+		assertSameStats(BVGraph.loadMapped(basename.toString()));
+		deleteGraph(basename);
+		basename.delete();
+	}
+}
@@ -119,7 +119,10 @@ public abstract class WebGraphTestCase {
 		new File(basename + BVGraph.GRAPH_EXTENSION).delete();
 		new File(basename + BVGraph.OFFSETS_EXTENSION).delete();
 		new File(basename + BVGraph.OFFSETS_BIG_LIST_EXTENSION).delete();
+		new File(basename + BVGraph.OFFSETS_ELIAS_FANO_EXTENSION).delete();
 		new File(basename + ImmutableGraph.PROPERTIES_EXTENSION).delete();
+		new File(basename + GraphSketch.SKETCH_EXTENSION).delete();
+		new File(basename + OutdegreeIndex.OUTDEGREE_INDEX_EXTENSION).delete();
 	}
 
 	/** Performs a stress-test of an immutable graph. All available methods
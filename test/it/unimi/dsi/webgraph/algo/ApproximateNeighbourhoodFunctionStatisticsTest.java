@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph.algo;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+
+import java.io.ByteArrayOutputStream;
+import java.io.File;
+import java.io.IOException;
+import java.io.PrintStream;
+import java.nio.charset.StandardCharsets;
+
+import org.junit.Test;
+
+import it.unimi.dsi.fastutil.io.TextIO;
+import it.unimi.dsi.fastutil.objects.ObjectArrayList;
+import it.unimi.dsi.fastutil.objects.ObjectList;
+import it.unimi.dsi.stat.Jackknife;
+import it.unimi.dsi.util.XoRoShiRo128PlusRandom;
+
+public class ApproximateNeighbourhoodFunctionStatisticsTest {
+
+	private static double[][] randomSamples(final int n, final XoRoShiRo128PlusRandom random) {
+		final double[][] anf = new double[n][];
+		for(int i = 0; i < n; i++) {
+			anf[i] = new double[3 + random.nextInt(8)];
+			anf[i][0] = 1000;
+			for(int d = 1; d < anf[i].length; d++) anf[i][d] = anf[i][d - 1] + random.nextDouble() * 10000;
+		}
+		return anf;
+	}
+
+	@Test
+	public void testIdenticalSamples() {
+		final double[] nf = { 10, 30, 60, 80, 85 };
+		final ApproximateNeighbourhoodFunctionStatistics statistics = new ApproximateNeighbourhoodFunctionStatistics(new double[][] { nf.clone(), nf.clone(), nf.clone() }, Double.NaN, 2);
+		assertEquals(10, statistics.nodes, 0);
+		assertEquals(85, statistics.reachablePairs(), 0);
+		assertEquals(0, statistics.reachablePairsStandardError(), 0);
+
+		final ApproximateNeighbourhoodFunctionStatistics.Estimates jackknife = statistics.jackknife();
+		assertEquals(NeighbourhoodFunction.averageDistance(nf), jackknife.averageDistance, 1E-12);
+		assertEquals(ApproximateNeighbourhoodFunctionStatistics.averageDistance(nf), jackknife.averageDistance, 1E-12);
+		assertEquals(0, jackknife.averageDistanceStandardError, 0);
+		assertEquals(NeighbourhoodFunction.harmonicDiameter(10, nf), jackknife.harmonicDiameter, 1E-12);
+		assertEquals(ApproximateNeighbourhoodFunctionStatistics.harmonicDiameter(nf), jackknife.harmonicDiameter, 1E-12);
+		assertEquals(ApproximateNeighbourhoodFunctionStatistics.spid(nf), jackknife.spid, 1E-12);
+
+		final ApproximateNeighbourhoodFunctionStatistics.Estimates bootstrap = statistics.bootstrap(100, 0);
+		assertEquals(jackknife.averageDistance, bootstrap.averageDistance, 1E-12);
+		assertEquals(jackknife.harmonicDiameter, bootstrap.harmonicDiameter, 1E-12);
+		assertEquals(jackknife.spid, bootstrap.spid, 1E-12);
+	}
+
+	@Test
+	public void testSameAsJackknife() {
+		final XoRoShiRo128PlusRandom random = new XoRoShiRo128PlusRandom(0);
+		for(final int n : new int[] { 2, 10, 100 }) {
+			final double[][] anf = randomSamples(n, random);
+			final ObjectList<double[]> evenedOut = ApproximateNeighbourhoodFunctions.evenOut(ObjectArrayList.wrap(anf));
+			final ApproximateNeighbourhoodFunctionStatistics statistics = new ApproximateNeighbourhoodFunctionStatistics(anf, Double.NaN, 4);
+			final ApproximateNeighbourhoodFunctionStatistics.Estimates estimates = statistics.jackknife();
+
+			Jackknife jackknife = Jackknife.compute(evenedOut, ApproximateNeighbourhoodFunctions.AVERAGE_DISTANCE);
+			assertEquals(jackknife.estimate[0], estimates.averageDistance, 1E-9 * estimates.averageDistance);
+			jackknife = Jackknife.compute(evenedOut, ApproximateNeighbourhoodFunctions.SPID);
+			assertEquals(jackknife.estimate[0], estimates.spid, 1E-9 * estimates.spid);
+			jackknife = Jackknife.compute(evenedOut, ApproximateNeighbourhoodFunctions.CDF);
+			assertArrayEquals(jackknife.estimate, statistics.cdf(null), 1E-9);
+
+			// Results do not depend on the number of threads
+			final ApproximateNeighbourhoodFunctionStatistics sequential = new ApproximateNeighbourhoodFunctionStatistics(anf, Double.NaN, 1);
+			assertEquals(estimates.harmonicDiameter, sequential.jackknife().harmonicDiameter, 0);
+			assertEquals(statistics.bootstrap(0, 1).spid, sequential.bootstrap(0, 1).spid, 0);
+		}
+	}
+
+	@Test
+	public void testFormat() {
+		// Expected values printed by Ruby's Float#to_s
+		final double[] x = { 1E16, 1.2345E17, 9999999999999998., 1E15, 1234567890123456., 1234567890123456.8, 123456789012345.6, 123456789012345., 1E14,
+				1E-5, 1E-4, 1.2345E-4, 9.9999E-5, 123, 12345678, 0, -0., Double.NaN, Double.POSITIVE_INFINITY, Double.NEGATIVE_INFINITY,
+				1E100, Double.MIN_VALUE, .1 + .2, -2.5E-7, Double.MAX_VALUE, 0x1p60 };
+		final String[] expected = { "1.0e+16", "1.2345e+17", "9.999999999999998e+15", "1.0e+15", "1.234567890123456e+15", "1234567890123456.8", "123456789012345.6", "123456789012345.0", "100000000000000.0",
+				"1.0e-05", "0.0001", "0.00012345", "9.9999e-05", "123.0", "12345678.0", "0.0", "-0.0", "NaN", "Infinity", "-Infinity",
+				"1.0e+100", "5.0e-324", "0.30000000000000004", "-2.5e-07", "1.7976931348623157e+308", "1.152921504606847e+18" };
+		for(int i = 0; i < x.length; i++) assertEquals(expected[i], ApproximateNeighbourhoodFunctionStatistics.format(x[i]));
+	}
+
+	private static String printJackknife(final double[][] anf, final double[] exact) {
+		final ByteArrayOutputStream out = new ByteArrayOutputStream();
+		final PrintStream stream = new PrintStream(out, true);
+		new ApproximateNeighbourhoodFunctionStatistics(anf, exact != null ? exact[0] : Double.NaN, 2).printJackknife(exact, stream);
+		stream.close();
+		return new String(out.toByteArray(), StandardCharsets.US_ASCII);
+	}
+
+	@Test
+	public void testSameAsJackknifeRb() {
+		// Expected output of jackknife.rb on the same samples
+		double[][] anf = {
+				{ 100000, 412345.5, 3712345.25, 29876543.125, 412345678.5, 2876543210.75, 6123456789.5 },
+				{ 100000, 398765.25, 3698765.5, 30123456.75, 398765432.25, 2912345678.5, 6098765432.25, 6198765432.5 },
+				{ 100000, 420000.75, 3800000.125, 29500000.5, 405000000.25, 2850000000.5, 6150000000.75 }
+		};
+		assertEquals("reachablepairs=6157407407.583333\n" +
+				"reachablepairsstderr=22052967.93798397\n" +
+				"reachablepairsperc=61.57407407583332\n" +
+				"reachablepairspercstderr=0.2205296793798397\n" +
+				"averagedistance=5.466394705481056\n" +
+				"averagedistancestderr=0.00555326907615189\n" +
+				"harmonicdiameter=8.734147160967044\n" +
+				"harmonicdiameterstderr=0.02422651595475492\n" +
+				"spid=0.07594648713392496\n" +
+				"spidstderr=0.0017017904621173773\n", printJackknife(anf, null));
+
+		// The script prints a wrong reachablepairserr, and the spid error with key spid
+		final double[] exact = { 100000, 410000, 3700000, 30000000, 400000000, 2900000000., 6130000000., 6140000000. };
+		assertEquals("reachablepairs=6157407407.583333\n" +
+				"reachablepairsstderr=22052967.93798397\n" +
+				"reachablepairserr=0.0028350826682952794\n" +
+				"reachablepairsperc=61.57407407583332\n" +
+				"reachablepairspercstderr=0.2205296793798397\n" +
+				"averagedistance=5.466394705481056\n" +
+				"averagedistanceerr=0.0014283861921108728\n" +
+				"averagedistancestderr=0.00555326907615189\n" +
+				"harmonicdiameter=8.734147160967044\n" +
+				"harmonicdiametererr=-0.0016913453709706224\n" +
+				"harmonicdiameterstderr=0.02422651595475492\n" +
+				"spid=0.07594648713392496\n" +
+				"spiderr=0.02185964214042921\n" +
+				"spidstderr=0.0017017904621173773\n", printJackknife(anf, exact));
+
+		anf = new double[][] {
+				{ 1000000000, 12500000000., 3.5E14, 2.25E17, 3.125E17 },
+				{ 1000000000, 11750000000.5, 3.75E14, 2.5E17 }
+		};
+		assertEquals("reachablepairs=2.8125e+17\n" +
+				"reachablepairsstderr=3.125e+16\n" +
+				"reachablepairsperc=28.125\n" +
+				"reachablepairspercstderr=3.125\n" +
+				"averagedistance=3.1698432871\n" +
+				"averagedistancestderr=0.14019000389999992\n" +
+				"harmonicdiameter=11.027970222881011\n" +
+				"harmonicdiameterstderr=0.8373189814116593\n" +
+				"spid=0.05310139472515352\n" +
+				"spidstderr=0.030758693931976167\n", printJackknife(anf, null));
+	}
+
+	@Test
+	public void testLoad() throws IOException {
+		final double[][] anf = randomSamples(5, new XoRoShiRo128PlusRandom(1));
+		final String[] file = new String[anf.length];
+		for(int i = 0; i < anf.length; i++) {
+			file[i] = File.createTempFile(ApproximateNeighbourhoodFunctionStatisticsTest.class.getSimpleName(), ".nf").toString();
+			final PrintStream stream = new PrintStream(file[i]);
+			TextIO.storeDoubles(anf[i], stream);
+			stream.close();
+		}
+		final ApproximateNeighbourhoodFunctionStatistics loaded = ApproximateNeighbourhoodFunctionStatistics.load(file, Double.NaN, 2);
+		final ApproximateNeighbourhoodFunctionStatistics statistics = new ApproximateNeighbourhoodFunctionStatistics(anf, Double.NaN, 2);
+		assertEquals(statistics.jackknife().averageDistance, loaded.jackknife().averageDistance, 0);
+		assertEquals(statistics.reachablePairs(), loaded.reachablePairs(), 0);
+		for(final String f : file) new File(f).delete();
+	}
+}
@@ -17,6 +17,9 @@
 
 package it.unimi.dsi.webgraph.algo;
 
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+
 import org.junit.Test;
 
 import it.unimi.dsi.logging.ProgressLogger;
@@ -43,6 +46,42 @@ public class ConnectedComponentsTest extends WebGraphTestCase {
 		}
 	}
 
+	public static void sameAsUnionFind(final ImmutableGraph g) {
+		final ConnectedComponents expected = ConnectedComponents.compute(g, 0, null);
+		for(final int t : new int[] { 1, 2, 4 }) {
+			final ConnectedComponents connectedComponents = ConnectedComponents.computeUnionFind(g, t, null);
+			assertEquals(expected.numberOfComponents, connectedComponents.numberOfComponents);
+			assertArrayEquals(expected.component, connectedComponents.component);
+		}
+	}
+
+	@Test
+	public void testUnionFind() {
+		sameAsUnionFind(ArrayListMutableGraph.newBidirectionalCycle(40).immutableView());
+		sameAsUnionFind(Transform.symmetrize(ArrayListMutableGraph.newCompleteBinaryIntree(10).immutableView()));
+		sameAsUnionFind(new ArrayListMutableGraph(0).immutableView());
+		sameAsUnionFind(new ArrayListMutableGraph(100).immutableView());
+		for(final int size: new int[] { 10, 100, 1000, 100000 })
+			for(final double c : new double[] { .5, 1, 2, 10 })
+				sameAsUnionFind(Transform.symmetrize(new ArrayListMutableGraph(new ErdosRenyiGraph(size, c / size, size, true)).immutableView()));
+	}
+
+	@Test
+	public void testWeakly() {
+		for(final int size: new int[] { 10, 100, 1000, 100000 })
+			for(final double c : new double[] { .5, 1, 2, 10 }) {
+				final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(size, c / size, size, false)).immutableView();
+				final ConnectedComponents expected = ConnectedComponents.compute(Transform.symmetrize(g), 0, null);
+				for(final int t : new int[] { 1, 2, 4 }) {
+					final ConnectedComponents connectedComponents = ConnectedComponents.computeWeakly(g, t, null);
+					assertEquals(expected.numberOfComponents, connectedComponents.numberOfComponents);
+					assertArrayEquals(expected.component, connectedComponents.component);
+				}
+			}
+		final ImmutableGraph intree = ArrayListMutableGraph.newCompleteBinaryIntree(10).immutableView();
+		assertArrayEquals(ConnectedComponents.compute(Transform.symmetrize(intree), 0, null).component, ConnectedComponents.computeWeakly(intree, 2, null).component);
+	}
+
 	@Test
 	public void testSmall() {
 		sameComponents(ArrayListMutableGraph.newBidirectionalCycle(40).immutableView());
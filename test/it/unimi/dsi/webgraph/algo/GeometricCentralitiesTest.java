@@ -17,6 +17,7 @@
 
 package it.unimi.dsi.webgraph.algo;
 
+import static org.junit.Assert.assertArrayEquals;
 import static org.junit.Assert.assertEquals;
 
 import java.io.IOException;
@@ -95,4 +96,26 @@ public class GeometricCentralitiesTest {
 			}
 		}
 	}
+
+	@Test
+	public void testBitParallel() throws InterruptedException {
+		for(final int size: new int[] { 10, 100, 1000 }) {
+			for(final double density: new double[] { 0.5 / size, 2. / size, 10. / size }) {
+				final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(size, density, 0, false)).immutableView();
+				final GeometricCentralities expected = new GeometricCentralities(g, 1, null);
+				expected.compute();
+				for(final int threads: new int[] { 1, 4 }) {
+					final GeometricCentralities centralities = new GeometricCentralities(g, threads, null);
+					centralities.computeBitParallel();
+					assertArrayEquals(expected.reachable, centralities.reachable);
+					for(int i = 0; i < size; i++) {
+						assertEquals(expected.closeness[i], centralities.closeness[i], 1E-12);
+						assertEquals(expected.lin[i], centralities.lin[i], 1E-9 * expected.lin[i]);
+						assertEquals(expected.harmonic[i], centralities.harmonic[i], 1E-9 * expected.harmonic[i]);
+						assertEquals(expected.exponential[i], centralities.exponential[i], 1E-9 * expected.exponential[i]);
+					}
+				}
+			}
+		}
+	}
 }
@@ -295,6 +295,38 @@ public class HyperBallTest extends WebGraphTestCase {
 		}
 	}
 
+	@Test
+	public void testMultipleRuns() throws IOException {
+		final int runs = 3;
+		for(final int log2m: new int[] { 4, 6, 8 }) {
+			for(final int size: new int[] { 10, 100, 500 }) {
+				for(int attempt = 0; attempt < 6; attempt++) {
+					System.err.println("log2m: " + log2m + " size: " + size + " attempt: " + attempt);
+					final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(size, .05, attempt, false)).immutableView();
+					final HyperBall hyperBall = new HyperBall(g, attempt % 3 == 0 ? null : Transform.transpose(g), log2m, null, attempt % 2 + 1, 0, 10, false, false, false, null, null, runs, attempt);
+					final SequentialHyperBall[] sequentialHyperBall = new SequentialHyperBall[runs];
+					for(int r = 0; r < runs; r++) {
+						sequentialHyperBall[r] = new SequentialHyperBall(g, log2m, null, HyperBall.seed(attempt, r));
+						sequentialHyperBall[r].init();
+					}
+					hyperBall.init();
+					do {
+						hyperBall.iterate();
+						for(int r = 0; r < runs; r++) {
+							final double current = hyperBall.neighbourhoodFunctions[r].getDouble(hyperBall.neighbourhoodFunctions[r].size() - 1);
+							final double sequentialCurrent = sequentialHyperBall[r].iterate();
+							assertState(size, log2m, sequentialHyperBall[r].registers(), hyperBall.registers(r));
+							assertRelativeError(sequentialCurrent, current, THRESHOLD);
+						}
+					} while(hyperBall.modified() != 0);
+
+					hyperBall.close();
+					for(final SequentialHyperBall s : sequentialHyperBall) s.close();
+				}
+			}
+		}
+	}
+
 	@Test(expected=IllegalStateException.class)
 	public void testInitClosed() throws IOException {
 		final ImmutableGraph g = ArrayListMutableGraph.newCompleteBinaryIntree(3).immutableView();
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph.algo;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+import java.io.File;
+import java.io.IOException;
+import java.util.Arrays;
+
+import org.junit.Test;
+
+import it.unimi.dsi.fastutil.ints.IntArrayFIFOQueue;
+import it.unimi.dsi.webgraph.ArrayListMutableGraph;
+import it.unimi.dsi.webgraph.ImmutableGraph;
+import it.unimi.dsi.webgraph.LazyIntIterator;
+import it.unimi.dsi.webgraph.Transform;
+import it.unimi.dsi.webgraph.examples.ErdosRenyiGraph;
+
+public class LandmarkIndexTest {
+
+	/** Returns all distances from a node, with -1 for unreachable nodes. */
+	private static int[] distances(final ImmutableGraph graph, final int x) {
+		final int[] dist = new int[graph.numNodes()];
+		Arrays.fill(dist, -1);
+		final IntArrayFIFOQueue queue = new IntArrayFIFOQueue();
+		dist[x] = 0;
+		queue.enqueue(x);
+		while (! queue.isEmpty()) {
+			final int curr = queue.dequeueInt();
+			final LazyIntIterator successors = graph.successors(curr);
+			for(int s; (s = successors.nextInt()) != -1;) if (dist[s] == -1) {
+				dist[s] = dist[curr] + 1;
+				queue.enqueue(s);
+			}
+		}
+		return dist;
+	}
+
+	private static void assertBounds(final ImmutableGraph graph, final LandmarkIndex index) {
+		final int n = graph.numNodes();
+		int diameter = 0;
+		for(int x = 0; x < n; x++) {
+			final int[] dist = distances(graph, x);
+			int ecc = 0;
+			for(int y = 0; y < n; y++) {
+				final int lower = index.lowerBound(x, y), upper = index.upperBound(x, y);
+				if (dist[y] == -1) assertEquals(Integer.MAX_VALUE, upper);
+				else {
+					ecc = Math.max(ecc, dist[y]);
+					assertTrue(lower <= dist[y]);
+					assertTrue(upper >= dist[y]);
+				}
+			}
+			assertTrue(index.eccentricityLowerBound(x) <= ecc);
+			assertTrue(index.eccentricityUpperBound(x) >= ecc);
+			diameter = Math.max(diameter, ecc);
+		}
+		assertTrue(index.diameterLowerBound() <= diameter);
+	}
+
+	@Test
+	public void testRandom() {
+		for(final int n : new int[] { 1, 10, 100 }) {
+			for(final double c : new double[] { .5, 1.5, 4 }) {
+				final ImmutableGraph graph = new ArrayListMutableGraph(new ErdosRenyiGraph(n, Math.min(1, c / n), 0, false)).immutableView();
+				final ImmutableGraph transpose = new ArrayListMutableGraph(Transform.transpose(graph)).immutableView();
+				final ImmutableGraph symmetric = new ArrayListMutableGraph(Transform.symmetrize(graph)).immutableView();
+				for(final int k : new int[] { 1, 4, 16 }) {
+					assertBounds(graph, LandmarkIndex.compute(graph, transpose, k, 2, null));
+					assertBounds(symmetric, LandmarkIndex.compute(symmetric, null, k, 2, null));
+				}
+			}
+		}
+	}
+
+	@Test
+	public void testExactOnLandmarks() {
+		final ImmutableGraph graph = new ArrayListMutableGraph(new ErdosRenyiGraph(200, 3. / 200, 0, false)).immutableView();
+		final ImmutableGraph transpose = new ArrayListMutableGraph(Transform.transpose(graph)).immutableView();
+		final LandmarkIndex index = LandmarkIndex.compute(graph, transpose, 8, 0, null);
+		for(int i = 0; i < index.numLandmarks(); i++) {
+			final int l = index.landmark[i];
+			final int[] dist = distances(graph, l);
+			for(int y = 0; y < graph.numNodes(); y++) {
+				if (dist[y] == -1) assertEquals(Integer.MAX_VALUE, index.lowerBound(l, y));
+				else {
+					assertEquals(dist[y], index.lowerBound(l, y));
+					assertEquals(dist[y], index.upperBound(l, y));
+				}
+			}
+		}
+	}
+
+	@Test
+	public void testSaturation() {
+		// A long path has distances that cannot be represented in a byte
+		final ArrayListMutableGraph mutable = new ArrayListMutableGraph(600);
+		for(int i = 0; i < 599; i++) {
+			mutable.addArc(i, i + 1);
+			mutable.addArc(i + 1, i);
+		}
+		final ImmutableGraph graph = mutable.immutableView();
+		final LandmarkIndex index = LandmarkIndex.compute(graph, null, 3, 1, null);
+		// Landmarks are the first nodes of degree two
+		assertEquals(1, index.landmark[0]);
+		assertEquals(LandmarkIndex.SATURATED, index.distanceFrom(0, 599));
+		assertBounds(graph, index);
+		assertEquals(598, index.diameterLowerBound());
+	}
+
+	@Test
+	public void testStoreLoad() throws IOException {
+		final ImmutableGraph graph = new ArrayListMutableGraph(new ErdosRenyiGraph(100, 2. / 100, 0, false)).immutableView();
+		final ImmutableGraph transpose = new ArrayListMutableGraph(Transform.transpose(graph)).immutableView();
+		final LandmarkIndex index = LandmarkIndex.compute(graph, transpose, 10, 0, null);
+		final File basename = File.createTempFile(LandmarkIndexTest.class.getSimpleName(), "test");
+		index.store(basename.toString());
+		for(final LandmarkIndex loaded : new LandmarkIndex[] { LandmarkIndex.load(basename.toString()), LandmarkIndex.loadMapped(basename.toString()) }) {
+			assertEquals(index.numNodes, loaded.numNodes);
+			assertEquals(index.symmetric, loaded.symmetric);
+			for(int x = 0; x < 100; x++) {
+				assertEquals(index.eccentricityLowerBound(x), loaded.eccentricityLowerBound(x));
+				for(int y = 0; y < 100; y++) {
+					assertEquals(index.lowerBound(x, y), loaded.lowerBound(x, y));
+					assertEquals(index.upperBound(x, y), loaded.upperBound(x, y));
+				}
+			}
+		}
+		for(final String extension : new String[] { "", LandmarkIndex.LANDMARKS_EXTENSION, LandmarkIndex.DISTANCES_EXTENSION, LandmarkIndex.TRANSPOSE_DISTANCES_EXTENSION })
+			new File(basename + extension).delete();
+	}
+}
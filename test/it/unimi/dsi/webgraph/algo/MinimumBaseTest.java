@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph.algo;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+
+import java.util.Arrays;
+
+import org.junit.Test;
+
+import it.unimi.dsi.fastutil.ints.IntArrayList;
+import it.unimi.dsi.fastutil.objects.Object2IntOpenHashMap;
+import it.unimi.dsi.webgraph.ArrayListMutableGraph;
+import it.unimi.dsi.webgraph.ImmutableGraph;
+import it.unimi.dsi.webgraph.Transform;
+import it.unimi.dsi.webgraph.examples.ErdosRenyiGraph;
+
+public class MinimumBaseTest {
+
+	/** Refines partitions using exact signatures, numbering classes in order of appearance. */
+	private static int[] naive(final ImmutableGraph transpose) {
+		final int n = transpose.numNodes();
+		int[] label = new int[n];
+		int classes = 1;
+		for(;;) {
+			final Object2IntOpenHashMap<IntArrayList> map = new Object2IntOpenHashMap<>();
+			final int[] newLabel = new int[n];
+			for(int x = 0; x < n; x++) {
+				final int[] s = transpose.successorArray(x);
+				final int[] c = new int[transpose.outdegree(x)];
+				for(int i = c.length; i-- != 0;) c[i] = label[s[i]];
+				Arrays.sort(c);
+				final IntArrayList signature = new IntArrayList(c);
+				signature.add(label[x]);
+				if (! map.containsKey(signature)) map.put(signature, map.size());
+				newLabel[x] = map.getInt(signature);
+			}
+			label = newLabel;
+			if (map.size() == classes) return label;
+			classes = map.size();
+		}
+	}
+
+	@Test
+	public void testCycle() {
+		final ImmutableGraph cycle = ArrayListMutableGraph.newDirectedCycle(100).immutableView();
+		final MinimumBase minimumBase = MinimumBase.compute(new ArrayListMutableGraph(Transform.transpose(cycle)).immutableView(), 2, null);
+		assertEquals(1, minimumBase.numberOfClasses);
+		assertArrayEquals(new int[100], minimumBase.label);
+	}
+
+	@Test
+	public void testRandom() {
+		for(final int n : new int[] { 1, 10, 100, 1000 }) {
+			for(final double p : new double[] { .5 / n, 2. / n, 5. / n }) {
+				final ImmutableGraph transpose = new ArrayListMutableGraph(Transform.transpose(new ErdosRenyiGraph(n, Math.min(1, p), 0, true))).immutableView();
+				final int[] expected = naive(transpose);
+				for(final int threads : new int[] { 1, 4 }) {
+					final MinimumBase minimumBase = MinimumBase.compute(transpose, threads, null);
+					assertArrayEquals(expected, minimumBase.label);
+					assertEquals(Arrays.stream(expected).max().getAsInt() + 1, minimumBase.numberOfClasses);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph.algo;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+import org.junit.Test;
+
+import it.unimi.dsi.fastutil.ints.IntArrayFIFOQueue;
+import it.unimi.dsi.util.XoRoShiRo128PlusRandom;
+import it.unimi.dsi.webgraph.ArrayListMutableGraph;
+import it.unimi.dsi.webgraph.ImmutableGraph;
+import it.unimi.dsi.webgraph.LazyIntIterator;
+import it.unimi.dsi.webgraph.WebGraphTestCase;
+import it.unimi.dsi.webgraph.examples.ErdosRenyiGraph;
+
+public class ReachabilityTest extends WebGraphTestCase {
+
+	private static int[] reachable(final ImmutableGraph graph) {
+		final int n = graph.numNodes();
+		final int[] reachable = new int[n];
+		final int[] seen = new int[n];
+		final IntArrayFIFOQueue queue = new IntArrayFIFOQueue();
+		for(int x = 0; x < n; x++) {
+			seen[x] = x + 1;
+			queue.enqueue(x);
+			int count = 0;
+			while(! queue.isEmpty()) {
+				count++;
+				final LazyIntIterator successors = graph.successors(queue.dequeueInt());
+				for(int s; (s = successors.nextInt()) != -1;) if (seen[s] != x + 1) {
+					seen[s] = x + 1;
+					queue.enqueue(s);
+				}
+			}
+			reachable[x] = count;
+		}
+		return reachable;
+	}
+
+	@Test
+	public void testExact() {
+		final XoRoShiRo128PlusRandom r = new XoRoShiRo128PlusRandom(0);
+		for(final int n : new int[] { 1, 10, 100, 1000 }) {
+			for(final double p : new double[] { .1 / n, 1. / n, 3. / n }) {
+				final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(n, Math.min(1, p), r.nextLong(), true)).immutableView();
+				final int[] expected = reachable(g);
+				for(final int threads : new int[] { 1, 4 }) {
+					final Reachability reachability = Reachability.compute(g, Reachability.DEFAULT_MAX_EXACT_SIZE, Reachability.DEFAULT_LOG2M, threads, null);
+					for(int x = 0; x < n; x++) {
+						assertTrue(reachability.exact[reachability.component[x]]);
+						assertEquals(expected[x], reachability.reachable(x), 0);
+					}
+				}
+			}
+		}
+	}
+
+	@Test
+	public void testParallelLevels() {
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(10000, 1.5 / 10000, 0, false)).immutableView();
+		final int[] expected = reachable(g);
+		final Reachability reachability = Reachability.compute(g, Reachability.DEFAULT_MAX_EXACT_SIZE, Reachability.DEFAULT_LOG2M, 8, null);
+		for(int x = 0; x < g.numNodes(); x++) assertEquals(expected[x], reachability.reachable(x), 0);
+	}
+
+	@Test
+	public void testApproximate() {
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(5000, 1.2 / 5000, 0, false)).immutableView();
+		final int[] expected = reachable(g);
+		final Reachability reachability = Reachability.compute(g, 16, 12, 4, null);
+		int approximated = 0;
+		for(int x = 0; x < g.numNodes(); x++) {
+			if (reachability.exact[reachability.component[x]]) assertEquals(expected[x], reachability.reachable(x), 0);
+			else {
+				approximated++;
+				assertEquals(expected[x], reachability.reachable(x), expected[x] * .1);
+			}
+		}
+		assertTrue(approximated > 0);
+	}
+
+	@Test
+	public void testTotalSize() {
+		final ImmutableGraph g = new ArrayListMutableGraph(new ErdosRenyiGraph(5000, 1.2 / 5000, 0, false)).immutableView();
+		final int[] expected = reachable(g);
+		// No per-set limit, but a small global limit
+		final Reachability reachability = Reachability.compute(g, Reachability.DEFAULT_MAX_EXACT_SIZE, 100, 12, 4, null);
+		int approximated = 0;
+		for(int x = 0; x < g.numNodes(); x++) {
+			if (reachability.exact[reachability.component[x]]) assertEquals(expected[x], reachability.reachable(x), 0);
+			else {
+				approximated++;
+				assertEquals(expected[x], reachability.reachable(x), expected[x] * .1);
+			}
+		}
+		assertTrue(approximated > 0);
+	}
+}
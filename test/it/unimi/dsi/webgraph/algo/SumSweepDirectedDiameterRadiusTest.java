@@ -265,6 +265,35 @@ public class SumSweepDirectedDiameterRadiusTest {
 		}
 	}
 
+	@Test
+	public void testConcurrent() {
+		for (final int size : new int[] { 10, 100, 1000 }) {
+			for (final double c : new double[] { .5, 1.5, 5 }) {
+				final ImmutableGraph graph = new ArrayListMutableGraph(new ErdosRenyiGraph(size, c / size, 0, false))
+						.immutableView();
+				final int[] eccF = computeAllEccentricities(graph);
+				final int[] eccB = computeAllEccentricities(Transform.transpose(graph));
+				final SumSweepDirectedDiameterRadius sequential = new SumSweepDirectedDiameterRadius(graph,
+						OutputLevel.ALL, null, null);
+				sequential.compute();
+				for (final int threads : new int[] { 1, 2, 4 }) {
+					final SumSweepDirectedDiameterRadius ss = new SumSweepDirectedDiameterRadius(graph, OutputLevel.ALL,
+							null, null);
+					ss.compute(threads);
+					if (threads == 1)
+						assertEquals(sequential.getAllIterations(), ss.getAllIterations());
+					assertEquals(sequential.getDiameter(), ss.getDiameter());
+					assertEquals(sequential.getRadius(), ss.getRadius());
+					for (int v = 0; v < size; v++) {
+						assertEquals(eccF[v], ss.getEccentricity(v, true));
+						assertEquals(eccB[v], ss.getEccentricity(v, false));
+					}
+					assertTrue(ss.getVisitTime() > 0);
+				}
+			}
+		}
+	}
+
 	@Test(expected = IllegalArgumentException.class)
 	public void testInvalidAccRadial() {
 		final ImmutableGraph g = new ArrayListMutableGraph(2, new int[][] { { 0, 1 } }).immutableView();
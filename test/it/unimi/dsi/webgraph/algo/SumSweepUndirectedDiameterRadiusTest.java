@@ -224,6 +224,31 @@ public class SumSweepUndirectedDiameterRadiusTest {
 		}
 	}
 
+	@Test
+	public void testConcurrent() {
+		for (final int size : new int[] { 10, 100, 1000 }) {
+			for (final double c : new double[] { .5, 1.5, 5 }) {
+				final ImmutableGraph graph = Transform.symmetrize(
+						new ArrayListMutableGraph(new ErdosRenyiGraph(size, c / size, 0, false)).immutableView());
+				final int[] ecc = computeAllEccentricities(graph);
+				final SumSweepUndirectedDiameterRadius sequential = new SumSweepUndirectedDiameterRadius(graph,
+						OutputLevel.ALL, null);
+				sequential.compute();
+				for (final int threads : new int[] { 1, 2, 4 }) {
+					final SumSweepUndirectedDiameterRadius ss = new SumSweepUndirectedDiameterRadius(graph,
+							OutputLevel.ALL, null);
+					ss.compute(threads);
+					if (threads == 1)
+						assertEquals(sequential.getAllIterations(), ss.getAllIterations());
+					assertEquals(sequential.getDiameter(), ss.getDiameter());
+					assertEquals(sequential.getRadius(), ss.getRadius());
+					for (int v = 0; v < size; v++)
+						assertEquals(ecc[v], ss.getEccentricity(v));
+				}
+			}
+		}
+	}
+
 	@Test
 	public void testEmptyGraph() {
 		final ImmutableGraph g = new ArrayListMutableGraph(0, new int[][] {}).immutableView();
@@ -20,6 +20,7 @@ package it.unimi.dsi.webgraph.algo;
 import static org.junit.Assert.assertEquals;
 import static org.junit.Assert.assertTrue;
 
+import java.io.IOException;
 import java.util.Arrays;
 
 import org.junit.Test;
@@ -253,4 +254,37 @@ public class TopKGeometricCentralityTest {
 		final TopKGeometricCentrality cc = new TopKGeometricCentrality(g, 10, Centrality.EXPONENTIAL, 1, 5, null);
 		cc.compute();
 	}
+
+	@Test
+	public void testOrderBy() throws InterruptedException, IOException {
+		for (final int size : new int[] { 100, 1000 }) {
+			final ImmutableGraph graph = new ArrayListMutableGraph(new ErdosRenyiGraph(size, 3. / size, 0, false)).immutableView();
+			final GeometricCentralities exhaustive = new GeometricCentralities(graph);
+			exhaustive.compute();
+			for (final Centrality cCur : c) {
+				final double[] expected;
+				switch (cCur) {
+				case LIN:
+					expected = exhaustive.lin.clone();
+					break;
+				case HARMONIC:
+					expected = exhaustive.harmonic.clone();
+					break;
+				default:
+					expected = exhaustive.exponential.clone();
+					break;
+				}
+				Arrays.sort(expected);
+				DoubleArrays.reverse(expected);
+
+				for (final int threads : new int[] { 1, 4 }) {
+					final TopKGeometricCentrality cc = new TopKGeometricCentrality(graph, 10, cCur, threads, 0.5, null);
+					cc.orderBy(TopKGeometricCentrality.estimate(graph, cCur, 0.5, 5, threads, null));
+					cc.compute();
+					assertEquals(10, cc.topK.length);
+					for (int i = 0; i < cc.topK.length; i++) assertEquals(expected[i], cc.centrality[cc.topK[i]], 1E-12);
+				}
+			}
+		}
+	}
 }
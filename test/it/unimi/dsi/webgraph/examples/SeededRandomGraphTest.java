@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2021 Sebastiano Vigna
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the GNU Lesser General Public License v2.1 or later,
+ * which is available at
+ * http://www.gnu.org/licenses/old-licenses/lgpl-2.1-standalone.html,
+ * or the Apache Software License 2.0, which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later OR Apache-2.0
+ */
+
+package it.unimi.dsi.webgraph.examples;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNotEquals;
+import static org.junit.Assert.assertTrue;
+
+import java.io.File;
+import java.io.IOException;
+
+import org.junit.Test;
+
+import it.unimi.dsi.webgraph.ArrayListMutableGraph;
+import it.unimi.dsi.webgraph.BVGraph;
+import it.unimi.dsi.webgraph.ImmutableGraph;
+import it.unimi.dsi.webgraph.NodeIterator;
+import it.unimi.dsi.webgraph.WebGraphTestCase;
+
+public class SeededRandomGraphTest extends WebGraphTestCase {
+
+	private static long check(final ImmutableGraph graph, final boolean loops) {
+		long arcs = 0;
+		for(final NodeIterator nodeIterator = graph.nodeIterator(); nodeIterator.hasNext();) {
+			final int curr = nodeIterator.nextInt();
+			final int outdegree = nodeIterator.outdegree();
+			arcs += outdegree;
+			final int[] s = nodeIterator.successorArray();
+			for(int i = 0; i < outdegree; i++) {
+				assertTrue(s[i] >= 0 && s[i] < graph.numNodes());
+				if (i > 0) assertTrue(s[i] > s[i - 1]);
+				if (! loops) assertTrue(s[i] != curr);
+			}
+		}
+		return arcs;
+	}
+
+	private static void assertReproducible(final ImmutableGraph g, final ImmutableGraph h, final ImmutableGraph other) throws IOException {
+		final ImmutableGraph a = new ArrayListMutableGraph(g).immutableView();
+		assertEquals(a, new ArrayListMutableGraph(h).immutableView());
+		assertNotEquals(a, new ArrayListMutableGraph(other).immutableView());
+		assertGraph(g);
+		for(final int threads : new int[] { 1, 3, 8 }) assertSplitIterator(g, threads);
+
+		// Sequential and parallel compression must generate the same graph
+		final File basename = File.createTempFile(SeededRandomGraphTest.class.getSimpleName(), "test");
+		BVGraph.store(g, basename.toString(), 1, null);
+		final ImmutableGraph sequential = BVGraph.load(basename.toString());
+		assertEquals(a, sequential);
+		BVGraph.store(h, basename.toString(), 4, null);
+		assertEquals(a, BVGraph.load(basename.toString()));
+		deleteGraph(basename);
+	}
+
+	@Test
+	public void testRMat() throws IOException {
+		for(final boolean loops : new boolean[] { false, true }) {
+			for(final int n : new int[] { 1000, 1024, 1500 }) {
+				final RMatGraph g = new RMatGraph(n, 10 * n, 0, loops);
+				final long arcs = check(g, loops);
+				assertTrue(arcs > 5 * n && arcs <= 12 * n);
+				assertReproducible(g, new RMatGraph(n, 10 * n, 0, loops), new RMatGraph(n, 10 * n, 1, loops));
+			}
+		}
+	}
+
+	@Test
+	public void testRMatInvalidTargets() {
+		// With b = 0 node 0 can generate only loops
+		for(final int n : new int[] { 1000, 1024 }) {
+			final RMatGraph g = new RMatGraph(n, 10 * n, .6, 0, .2, 0, false);
+			assertTrue(check(g, false) > 0);
+			final NodeIterator nodeIterator = g.nodeIterator();
+			assertEquals(0, nodeIterator.nextInt());
+			assertEquals(0, nodeIterator.outdegree());
+		}
+	}
+
+	@Test
+	public void testChungLu() throws IOException {
+		for(final boolean loops : new boolean[] { false, true }) {
+			for(final double exponent : new double[] { .5, 1, 1.5 }) {
+				final ChungLuGraph g = new ChungLuGraph(100000, 500000, exponent, 0, loops);
+				final long arcs = check(g, loops);
+				assertTrue(arcs > 100000 && arcs <= 550000);
+				assertReproducible(g, new ChungLuGraph(100000, 500000, exponent, 0, loops), new ChungLuGraph(100000, 500000, exponent, 1, loops));
+			}
+		}
+	}
+
+	@Test
+	public void testCopyingModel() throws IOException {
+		for(final double alpha : new double[] { .1, .5, 1 }) {
+			final CopyingModelGraph g = new CopyingModelGraph(10000, 10, alpha, 0);
+			final long arcs = check(g, false);
+			assertTrue(arcs > 10000 && arcs <= 10 * 10000);
+			// The copying model generates only backward arcs
+			for(final NodeIterator nodeIterator = g.nodeIterator(); nodeIterator.hasNext();) {
+				final int curr = nodeIterator.nextInt();
+				if (nodeIterator.outdegree() != 0) assertTrue(nodeIterator.successorArray()[nodeIterator.outdegree() - 1] < curr);
+			}
+			assertReproducible(g, new CopyingModelGraph(10000, 10, alpha, 0), new CopyingModelGraph(10000, 10, alpha, 1));
+		}
+	}
+}